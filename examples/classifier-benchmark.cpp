@@ -0,0 +1,164 @@
+/**
+ * @file classifier-benchmark.cpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Throughput benchmark of the x86 classifier over the disassembly of
+ * a binary, from the text and from the machine code
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <efimon/asm-classifier.hpp>
+#include <efimon/asm-classifier/x86-classifier.hpp>
+#include <efimon/asm-classifier/x86-decoder.hpp>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <third-party/pstream.hpp>
+
+using namespace efimon;  // NOLINT
+
+/* Minimum number of instructions classified per measurement */
+static constexpr uint64_t kMinInstructions = 10000000;
+
+/* Keeps the results alive so the classification is not optimised out */
+static volatile uint64_t sink_ = 0;
+
+using Corpus = std::vector<std::pair<std::string, std::string>>;
+
+static Corpus LoadCorpus(const std::string &binary) {
+  Corpus corpus;
+  redi::ipstream ip("objdump -d --no-show-raw-insn " + binary,
+                    redi::pstreambuf::pstdout);
+  std::string line;
+  /* Lines: "  addr:\tmnemonic operands" */
+  while (std::getline(ip, line)) {
+    auto tab = line.find('\t');
+    auto colon = line.find(':');
+    if (std::string::npos == tab || std::string::npos == colon || colon > tab)
+      continue;
+    std::istringstream ss{line.substr(tab + 1)};
+    std::string mnemonic, operands;
+    ss >> mnemonic >> operands;
+    if (mnemonic.empty()) continue;
+    corpus.emplace_back(mnemonic, operands);
+  }
+  return corpus;
+}
+
+/* Machine code of the instructions: bytes and offset of each instruction */
+struct Code {
+  std::vector<uint8_t> bytes;
+  std::vector<std::size_t> offsets;
+};
+
+static Code LoadCode(const std::string &binary) {
+  Code code;
+  redi::ipstream ip("objdump -d --insn-width=15 " + binary,
+                    redi::pstreambuf::pstdout);
+  std::string line;
+  /* Lines: "  addr:\tbytes\tmnemonic operands" */
+  while (std::getline(ip, line)) {
+    auto tab = line.find('\t');
+    auto colon = line.find(':');
+    if (std::string::npos == tab || std::string::npos == colon || colon > tab)
+      continue;
+    auto next = line.find('\t', tab + 1);
+    if (std::string::npos == next) continue;
+    std::istringstream ss{line.substr(tab + 1, next - tab - 1)};
+    std::string byte;
+    code.offsets.push_back(code.bytes.size());
+    while (ss >> byte) {
+      code.bytes.push_back(static_cast<uint8_t>(std::stoul(byte, nullptr, 16)));
+    }
+  }
+  /* The decoder may look ahead up to the longest instruction */
+  code.bytes.resize(code.bytes.size() + x86Decoder::kMaxLength, 0);
+  return code;
+}
+
+template <typename F>
+static double Measure(const Corpus &corpus, F &&classify) {
+  uint64_t checksum = 0;
+  uint64_t count = 0;
+  auto start = std::chrono::steady_clock::now();
+  while (count < kMinInstructions) {
+    for (const auto &inst : corpus) {
+      InstructionPair pair = classify(inst.first, inst.second);
+      checksum += static_cast<uint64_t>(std::get<1>(pair)) + std::get<2>(pair);
+    }
+    count += corpus.size();
+  }
+  auto end = std::chrono::steady_clock::now();
+  std::chrono::duration<double, std::nano> elapsed = end - start;
+  sink_ = checksum;
+  return elapsed.count() / count;
+}
+
+int main(int argc, char **argv) {
+  std::string binary = argc > 1 ? argv[1] : argv[0];
+  Corpus corpus = LoadCorpus(binary);
+  if (corpus.empty()) {
+    std::cerr << "Cannot disassemble " << binary << std::endl;
+    return -1;
+  }
+
+  x86Classifier classifier;
+  uint64_t known = 0;
+  for (const auto &inst : corpus) {
+    known += x86Classifier::IsKnownMnemonic(inst.first) ? 1 : 0;
+  }
+  std::cout << "Corpus: " << binary << std::endl
+            << "Instructions: " << corpus.size() << std::endl
+            << "Known mnemonics: " << (100.0 * known / corpus.size()) << "%"
+            << std::endl;
+
+  double string_ns = Measure(
+      corpus, [&](const std::string &inst, const std::string &operands) {
+        return classifier.Classify(inst, classifier.OperandTypes(operands));
+      });
+  std::cout << "std::string API: " << string_ns << " ns/instruction"
+            << std::endl;
+
+  double view_ns =
+      Measure(corpus, [&](const std::string_view inst,
+                          const std::string_view operands) {
+        return classifier.Classify(inst, classifier.OperandTypes(operands));
+      });
+  std::cout << "std::string_view API: " << view_ns << " ns/instruction"
+            << std::endl;
+
+  double class_ns = Measure(
+      corpus, [&](const std::string_view inst, const std::string_view) {
+        return classifier.Classify(inst, std::string_view{"rr"});
+      });
+  std::cout << "Classification only: " << class_ns << " ns/instruction"
+            << std::endl;
+
+  Code code = LoadCode(binary);
+  x86Decoder decoder;
+  x86Instruction decoded;
+  uint64_t checksum = 0, count = 0;
+  auto start = std::chrono::steady_clock::now();
+  while (count < kMinInstructions && !code.offsets.empty()) {
+    for (const auto offset : code.offsets) {
+      checksum += decoder.Decode(code.bytes.data() + offset,
+                                 x86Decoder::kMaxLength, decoded);
+      checksum += static_cast<uint64_t>(std::get<1>(decoded.pair));
+    }
+    count += code.offsets.size();
+  }
+  auto end = std::chrono::steady_clock::now();
+  std::chrono::duration<double, std::nano> elapsed = end - start;
+  sink_ = checksum;
+  std::cout << "Decoder (machine code): "
+            << (0 == count ? 0.0 : elapsed.count() / count)
+            << " ns/instruction" << std::endl;
+
+  return 0;
+}
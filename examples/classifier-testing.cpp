@@ -0,0 +1,163 @@
+/**
+ * @file classifier-testing.cpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Validates a classifier against a corpus of objdump text annotated
+ * with the expected classification. The x86-decoder mode classifies the raw
+ * bytes of the corpus instead of the text
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#include <cstdint>
+#include <efimon/asm-classifier.hpp>
+#include <efimon/asm-classifier/x86-decoder.hpp>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace efimon;  // NOLINT
+
+static assembly::Architecture ParseArch(const std::string &arch) {
+  if ("x86" == arch || "x86-decoder" == arch)
+    return assembly::Architecture::X86;
+  if ("aarch64" == arch) return assembly::Architecture::AARCH64;
+  return assembly::Architecture::NONE;
+}
+
+/* objdump prints the x86 prefixes as words before the mnemonic */
+static bool IsPrefix(const std::string &word) {
+  return "lock" == word || "rep" == word || "repz" == word ||
+         "repnz" == word || "notrack" == word || "bnd" == word ||
+         "data16" == word || "addr32" == word;
+}
+
+/* Raw bytes printed by objdump -d: "48 89 e5" */
+static bool ParseBytes(const std::string &field, std::vector<uint8_t> &bytes) {
+  std::istringstream ss{field};
+  std::string byte;
+  bytes.clear();
+  while (ss >> byte) {
+    if (2 != byte.size() ||
+        std::string::npos != byte.find_first_not_of("0123456789abcdef"))
+      return false;
+    bytes.push_back(static_cast<uint8_t>(std::stoul(byte, nullptr, 16)));
+  }
+  return !bytes.empty();
+}
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0]
+              << " <x86|x86-decoder|aarch64> <corpus.txt>" << std::endl;
+    return -1;
+  }
+
+  const bool decode = std::string{"x86-decoder"} == argv[1];
+  x86Decoder decoder;
+
+  auto classifier = AsmClassifier::Build(ParseArch(argv[1]));
+  if (!classifier) {
+    std::cerr << "Unknown architecture: " << argv[1] << std::endl;
+    return -1;
+  }
+
+  std::ifstream corpus{argv[2]};
+  if (!corpus.is_open()) {
+    std::cerr << "Cannot open the corpus: " << argv[2] << std::endl;
+    return -1;
+  }
+
+  /* Lines: "  addr:\t[bytes\t]mnemonic operands\t;; expected classification" */
+  std::string line;
+  uint64_t total = 0, failed = 0;
+  while (std::getline(corpus, line)) {
+    auto colon = line.find(':');
+    auto tab = line.find('\t');
+    auto expectation = line.find(";;");
+    if (line.empty() || '#' == line[0] || std::string::npos == tab ||
+        std::string::npos == colon || colon > tab ||
+        std::string::npos == expectation)
+      continue;
+
+    /* The raw bytes (if any) go before the text */
+    std::vector<uint8_t> bytes;
+    auto next = line.find('\t', tab + 1);
+    if (next < expectation && ParseBytes(line.substr(tab + 1, next - tab - 1),
+                                         bytes)) {
+      tab = next;
+    }
+    if (decode && bytes.empty()) continue;
+
+    std::istringstream ss{line.substr(tab + 1, expectation - tab - 1)};
+    std::string mnemonic, operands;
+    ss >> mnemonic;
+    while (IsPrefix(mnemonic) && ss >> mnemonic) continue;
+    std::getline(ss >> std::ws, operands);
+    operands = operands.substr(0, operands.find_last_not_of(" \t") + 1);
+
+    std::istringstream es{line.substr(expectation + 2)};
+    std::string expected, word;
+    while (es >> word) expected += (expected.empty() ? "" : " ") + word;
+
+    /* "-": encoding that the decoder must reject */
+    if ("-" == expected) {
+      if (!decode) continue;
+      x86Instruction inst;
+      ++total;
+      if (0 != decoder.Decode(bytes.data(), bytes.size(), inst)) {
+        ++failed;
+        std::cerr << "FAIL: " << mnemonic << " " << operands
+                  << " (decoded as " << inst.Mnemonic() << ")" << std::endl;
+      }
+      continue;
+    }
+
+    std::string optypes;
+    InstructionPair pair;
+    VectorTriplet vector;
+    if (decode) {
+      x86Instruction inst;
+      if (bytes.size() != decoder.Decode(bytes.data(), bytes.size(), inst)) {
+        ++total;
+        ++failed;
+        std::cerr << "FAIL: " << mnemonic << " " << operands
+                  << " (cannot decode " << bytes.size() << " bytes)"
+                  << std::endl;
+        continue;
+      }
+      optypes = std::string{inst.OperandTypes()};
+      pair = inst.pair;
+      vector = inst.vector;
+    } else {
+      optypes = classifier->OperandTypes(operands);
+      pair = classifier->Classify(mnemonic, optypes);
+      vector = classifier->ClassifyVector(std::string_view{mnemonic},
+                                          std::string_view{operands});
+    }
+    std::string result = AsmClassifier::FamilyString(std::get<1>(pair)) +
+                         " " + AsmClassifier::TypeString(std::get<0>(pair)) +
+                         " " + AsmClassifier::OriginString(std::get<2>(pair)) +
+                         " " + AsmClassifier::WidthString(std::get<0>(vector)) +
+                         " " +
+                         AsmClassifier::ElementString(std::get<1>(vector)) +
+                         " " +
+                         AsmClassifier::PackingString(std::get<2>(vector));
+
+    ++total;
+    if (result != expected) {
+      ++failed;
+      std::cerr << "FAIL: " << mnemonic << " " << operands << " (" << optypes
+                << ")" << std::endl
+                << "  Expected: " << expected << std::endl
+                << "  Got:      " << result << std::endl;
+    }
+  }
+
+  std::cout << "Instructions: " << total << " Failed: " << failed
+            << std::endl;
+  return 0 == total || failed > 0 ? -1 : 0;
+}
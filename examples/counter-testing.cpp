@@ -0,0 +1,60 @@
+/**
+ * @file counter-testing.cpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Example of the hardware counters through perf_event_open
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#include <unistd.h>
+
+#include <cstdlib>
+#include <efimon/perf/counter.hpp>
+#include <iostream>
+#include <string>
+
+using namespace efimon;  // NOLINT
+
+static constexpr int kDelay = 1;  // 1 second
+
+int main(int argc, char **argv) {
+  uint pid = 0;
+  ObserverScope scope = ObserverScope::SYSTEM;
+
+  if (argc > 1) {
+    pid = std::atoi(argv[1]);
+    scope = ObserverScope::PROCESS;
+    std::cout << "PID: " << pid << std::endl;
+  } else {
+    std::cout << "Analysing the whole system" << std::endl;
+  }
+
+  try {
+    PerfCounterObserver counter{pid, scope};
+    auto readings_iface = counter.GetReadings()[0];
+    CounterReadings *readings = dynamic_cast<CounterReadings *>(readings_iface);
+
+    for (uint i = 0; i < 10; ++i) {
+      sleep(kDelay);
+      Status st = counter.Trigger();
+      if (Status::OK != st.code) {
+        std::cerr << st.what() << std::endl;
+        return -1;
+      }
+
+      std::cout << "Window: " << readings->difference << " ms" << std::endl;
+      std::cout << "\tCycles: " << readings->cycles << std::endl;
+      std::cout << "\tInstructions: " << readings->instructions << std::endl;
+      std::cout << "\tIPC: " << readings->ipc << std::endl;
+      std::cout << "\tCache MPKI: " << readings->cache_mpki << std::endl;
+      std::cout << "\tBranch MPKI: " << readings->branch_mpki << std::endl;
+      std::cout << "\tRunning ratio: " << readings->running_ratio
+                << std::endl;
+    }
+  } catch (const Status &st) {
+    std::cerr << st.what() << std::endl;
+    return -1;
+  }
+
+  return 0;
+}
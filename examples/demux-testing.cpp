@@ -0,0 +1,62 @@
+/**
+ * @file demux-testing.cpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Example of several processes sampled through a single system-wide
+ * perf session demultiplexed by PID
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#include <unistd.h>
+
+#include <cstdlib>
+#include <efimon/perf/sample.hpp>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace efimon;  // NOLINT
+
+static constexpr int kDelay = 1;  // 1 second
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " PID [PID...]" << std::endl;
+    return -1;
+  }
+
+  try {
+    std::vector<std::unique_ptr<PerfSampleObserver>> observers;
+    for (int i = 1; i < argc; ++i) {
+      uint pid = std::atoi(argv[i]);
+      observers.emplace_back(std::make_unique<PerfSampleObserver>(
+          pid, ObserverScope::PROCESS, 0, PerfSampleObserver::kDefaultFrequency,
+          true));
+    }
+    std::cout << "Processes: " << observers.size()
+              << " Sessions: " << PerfSessionManager::GetNumSessions()
+              << std::endl;
+
+    for (uint t = 0; t < 5; ++t) {
+      sleep(kDelay);
+      for (auto &observer : observers) {
+        Status st = observer->Trigger();
+        if (Status::OK != st.code) {
+          std::cerr << st.what() << std::endl;
+          return -1;
+        }
+        auto readings =
+            dynamic_cast<SampleReadings *>(observer->GetReadings()[0]);
+        std::cout << "PID " << observer->GetPID()
+                  << ": Samples: " << readings->samples
+                  << " IPs: " << readings->ip_histogram.size() << std::endl;
+      }
+    }
+  } catch (const Status &st) {
+    std::cerr << st.what() << std::endl;
+    return -1;
+  }
+
+  return 0;
+}
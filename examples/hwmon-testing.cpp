@@ -0,0 +1,66 @@
+/**
+ * @file hwmon-testing.cpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Example of hwmon testing
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#include <unistd.h>
+
+#include <efimon/power/hwmon.hpp>
+#include <iostream>
+#include <string>
+
+using namespace efimon;  // NOLINT
+
+static constexpr int kDelay = 1;  // 1 second
+
+int main(int argc, char **argv) {
+  /* Optional root of the hwmon class, i.e. a copy of /sys/class/hwmon */
+  std::string root = argc > 1 ? argv[1] : "";
+  HwmonMeterObserver hwmon_meter{0, ObserverScope::SYSTEM, 0, root};
+
+  auto readings = hwmon_meter.GetReadings();
+  FanReadings *fans = dynamic_cast<FanReadings *>(readings[0]);
+  ThermalReadings *thermal = dynamic_cast<ThermalReadings *>(readings[1]);
+  ElectricalReadings *electrical =
+      dynamic_cast<ElectricalReadings *>(readings[2]);
+
+  const auto &channels = hwmon_meter.GetChannels();
+  std::cout << "Channels Detected: " << channels.size() << std::endl;
+
+  for (uint i = 0; i < 10; ++i) {
+    sleep(kDelay);
+    hwmon_meter.Trigger();
+
+    uint fan = 0, temperature = 0, voltage = 0, power = 0, energy = 0;
+    for (const auto &channel : channels) {
+      std::cout << "\t" << channel.chip << " (" << channel.label << "): ";
+      switch (channel.type) {
+        case HwmonChannel::Type::FAN:
+          std::cout << fans->fan_speeds.at(fan++) << " RPM";
+          break;
+        case HwmonChannel::Type::TEMPERATURE:
+          std::cout << thermal->temperatures.at(temperature++) << " C";
+          break;
+        case HwmonChannel::Type::VOLTAGE:
+          std::cout << electrical->voltages.at(voltage++) << " V";
+          break;
+        case HwmonChannel::Type::POWER:
+          std::cout << electrical->power.at(power++) << " Watts";
+          break;
+        case HwmonChannel::Type::ENERGY:
+          std::cout << electrical->energy.at(energy++) << " Joules";
+          break;
+      }
+      std::cout << std::endl;
+    }
+    std::cout << "Average Fan Speed: " << fans->overall_speed << " RPM"
+              << std::endl;
+    std::cout << "Max Temperature: " << thermal->max_temperature << " C"
+              << std::endl;
+  }
+
+  return 0;
+}
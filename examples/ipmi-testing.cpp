@@ -20,6 +20,9 @@ int main(int, char **) {
   IPMIMeterObserver ipmi_meter{};
   auto readings_iface = ipmi_meter.GetReadings()[0];
   PSUReadings *readings = dynamic_cast<PSUReadings *>(readings_iface);
+  std::cout << "Backend: "
+            << (ipmi_meter.HasSession() ? "IPMI session" : "FreeIPMI tools")
+            << std::endl;
 
   for (uint i = 0; i < 10; ++i) {
     sleep(kDelay);
@@ -35,6 +38,13 @@ int main(int, char **) {
               << std::endl;
     std::cout << "Average Energy: " << readings->overall_energy << " Joules"
               << std::endl;
+    if (ipmi_meter.HasDCMI()) {
+      std::cout << "Platform Power (DCMI): " << readings->platform_power
+                << " Watts (min: " << readings->platform_min_power
+                << ", max: " << readings->platform_max_power
+                << ", avg: " << readings->platform_avg_power << " over "
+                << readings->platform_window << " ms)" << std::endl;
+    }
   }
 
   return 0;
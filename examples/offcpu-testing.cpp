@@ -0,0 +1,83 @@
+/**
+ * @file offcpu-testing.cpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Example of the off-CPU analysis through the scheduler tracepoints
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <efimon/perf/offcpu.hpp>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace efimon;  // NOLINT
+
+static constexpr int kDelay = 1;     // 1 second
+static constexpr uint kTopStacks = 3;  // Top-3 stacks
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " PID" << std::endl;
+    return -1;
+  }
+
+  uint pid = std::atoi(argv[1]);
+  std::cout << "PID: " << pid << std::endl;
+
+  const std::vector<std::pair<OffCPUReason, std::string>> reasons = {
+      {OffCPUReason::IO, "IO"},
+      {OffCPUReason::FUTEX, "Futex"},
+      {OffCPUReason::SLEEP, "Sleep"},
+      {OffCPUReason::PREEMPTED, "Preempted"},
+      {OffCPUReason::OTHER, "Other"}};
+
+  try {
+    OffCPUObserver offcpu{pid};
+    auto readings = dynamic_cast<OffCPUReadings *>(offcpu.GetReadings()[0]);
+
+    for (uint i = 0; i < 5; ++i) {
+      sleep(kDelay);
+      Status st = offcpu.Trigger();
+      if (Status::OK != st.code) {
+        std::cerr << st.what() << std::endl;
+        return -1;
+      }
+
+      std::cout << "Window: " << readings->difference
+                << " ms. Switches: " << readings->switches
+                << " Lost: " << readings->lost
+                << " Run-queue (us): " << readings->runqueue_time << std::endl;
+      if (!readings->wakeups) {
+        std::cout << "\tThe wake-ups are not traced: no run-queue time"
+                  << std::endl;
+      }
+      for (const auto &reason : reasons) {
+        auto it = readings->blocked_time.find(reason.first);
+        uint64_t time = readings->blocked_time.end() == it ? 0 : it->second;
+        std::cout << "\t" << reason.second << " (us): " << time << std::endl;
+      }
+
+      std::vector<std::pair<std::string, uint64_t>> stacks(
+          readings->stacks.begin(), readings->stacks.end());
+      std::sort(stacks.begin(), stacks.end(),
+                [](const auto &a, const auto &b) {
+                  return a.second > b.second;
+                });
+      for (uint s = 0; s < stacks.size() && s < kTopStacks; ++s) {
+        std::cout << "\t" << stacks[s].second << " us: " << stacks[s].first
+                  << std::endl;
+      }
+    }
+  } catch (const Status &st) {
+    std::cerr << st.what() << std::endl;
+    return -1;
+  }
+
+  return 0;
+}
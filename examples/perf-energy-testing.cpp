@@ -0,0 +1,55 @@
+/**
+ * @file perf-energy-testing.cpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Example of the energy events of the perf power PMU
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#include <unistd.h>
+
+#include <efimon/perf/energy-counter.hpp>
+#include <iostream>
+#include <string>
+
+using namespace efimon;  // NOLINT
+
+static constexpr int kDelay = 1;  // 1 second
+
+int main(int, char **) {
+  try {
+    PerfEnergyObserver meter{};
+    auto readings_iface = meter.GetReadings()[0];
+    PerfEnergyReadings *readings =
+        dynamic_cast<PerfEnergyReadings *>(readings_iface);
+
+    for (uint i = 0; i < 10; ++i) {
+      sleep(kDelay);
+      Status st = meter.Trigger();
+      if (Status::OK != st.code) {
+        std::cerr << st.what() << std::endl;
+        return -1;
+      }
+
+      std::cout << "Window: " << readings->window << " ns" << std::endl;
+      std::cout << "Sockets (-1: not available):" << std::endl;
+      for (uint s = 0; s < readings->package_energy.size(); ++s) {
+        std::cout << "\t" << s << ": Package " << readings->package_energy[s]
+                  << " J, Cores " << readings->core_energy[s] << " J, RAM "
+                  << readings->ram_energy[s] << " J, Instructions "
+                  << readings->instructions[s] << ", "
+                  << readings->energy_per_instruction[s] << " nJ/inst"
+                  << std::endl;
+      }
+      std::cout << "\tPsys: " << readings->psys_energy << " J" << std::endl;
+      std::cout << "Energy per instruction: "
+                << readings->overall_energy_per_instruction << " nJ/inst"
+                << std::endl;
+    }
+  } catch (const Status &st) {
+    std::cerr << st.what() << std::endl;
+    return -1;
+  }
+
+  return 0;
+}
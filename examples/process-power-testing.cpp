@@ -0,0 +1,75 @@
+/**
+ * @file process-power-testing.cpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Example of the per-process power estimation on top of RAPL
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#include <unistd.h>
+
+#include <cstdlib>
+#include <efimon/power/process-power.hpp>
+#include <efimon/power/rapl.hpp>
+#include <iostream>
+#include <memory>
+#include <string>
+
+using namespace efimon;  // NOLINT
+
+static constexpr int kDelay = 1;  // 1 second
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " PID [PID...] [-i IDLE_WATTS]"
+              << std::endl;
+    return -1;
+  }
+
+  ProcessPowerObserver::IdleModel idle{
+      0.f, ProcessPowerObserver::IdleModel::Policy::EXCLUDE};
+  auto rapl_meter = std::make_shared<RAPLMeterObserver>();
+  ProcessPowerObserver process_power{rapl_meter};
+
+  for (int i = 1; i < argc; ++i) {
+    /* The idle power is shared by the capacity used by each process */
+    if (std::string{"-i"} == argv[i] && i + 1 < argc) {
+      idle.socket_power = std::atof(argv[++i]);
+      idle.policy = ProcessPowerObserver::IdleModel::Policy::BY_CAPACITY;
+      continue;
+    }
+    Status st = process_power.AddPID(std::atoi(argv[i]));
+    if (Status::OK != st.code) {
+      std::cerr << "Cannot add the process: " << st.msg << std::endl;
+    }
+  }
+  process_power.SetIdleModel(idle);
+
+  /* Same rate for both: the meter goes first */
+  rapl_meter->Trigger();
+  process_power.Trigger();
+
+  for (uint i = 0; i < 10; ++i) {
+    sleep(kDelay);
+    rapl_meter->Trigger();
+    Status st = process_power.Trigger();
+    if (Status::OK != st.code) {
+      std::cerr << "Error: " << st.msg << std::endl;
+    }
+
+    auto system = dynamic_cast<CPUReadings *>(rapl_meter->GetReadings()[0]);
+    std::cout << "System Power: " << system->overall_power << " Watts"
+              << std::endl;
+
+    auto pids = process_power.GetPIDs();
+    auto readings = process_power.GetReadings();
+    for (uint p = 0; p < pids.size(); ++p) {
+      auto process = dynamic_cast<CPUReadings *>(readings[p]);
+      std::cout << "\tPID " << pids[p] << ": " << process->overall_power
+                << " Watts, " << process->overall_energy << " Joules, "
+                << process->overall_usage << " %" << std::endl;
+    }
+  }
+
+  return 0;
+}
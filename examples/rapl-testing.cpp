@@ -20,9 +20,12 @@ static constexpr int kDelay = 1;        // 1 second
 
 int main(int argc, char **argv) {
   uint socketid = kNumSockets;
+  uint64_t period = 0;
 
   if (argc > 2) {
     socketid = std::atoi(argv[1]);
+    /* Sampling period in ms of the background sampler. 0: disabled */
+    period = std::atoi(argv[2]);
   }
 
   if (kNumSockets == socketid) {
@@ -32,8 +35,21 @@ int main(int argc, char **argv) {
   }
 
   RAPLMeterObserver rapl_meter{};
+  std::cout << "Backend: "
+            << RAPLDomainTree::BackendString(rapl_meter.GetBackend())
+            << std::endl;
+  Status st = rapl_meter.EnableSampler(period);
+  if (Status::OK != st.code) {
+    std::cerr << "Cannot enable the sampler: " << st.msg << std::endl;
+  } else if (0 != period) {
+    std::cout << "Sampling every " << period << " ms" << std::endl;
+  }
   auto readings_iface = rapl_meter.GetReadings()[0];
   CPUReadings *readings = dynamic_cast<CPUReadings *>(readings_iface);
+  RAMReadings *ram_readings =
+      dynamic_cast<RAMReadings *>(rapl_meter.GetReadings()[1]);
+  RAPLReadings *rapl_readings =
+      dynamic_cast<RAPLReadings *>(rapl_meter.GetReadings()[2]);
 
   for (uint i = 0; i < 10; ++i) {
     sleep(kDelay);
@@ -52,6 +68,18 @@ int main(int argc, char **argv) {
               << std::endl;
     std::cout << "Average Energy: " << (readings->overall_energy) << " Joules"
               << std::endl;
+
+    std::cout << "Domains (-1: not available):" << std::endl;
+    for (uint i = 0; i < rapl_readings->package_power.size(); ++i) {
+      std::cout << "\t" << i << ": Package " << rapl_readings->package_power[i]
+                << " W, Core " << rapl_readings->core_power[i]
+                << " W, Uncore " << rapl_readings->uncore_power[i]
+                << " W, DRAM " << rapl_readings->dram_power[i] << " W"
+                << std::endl;
+    }
+    std::cout << "\tPsys: " << rapl_readings->psys_power << " W" << std::endl;
+    std::cout << "DRAM Power: " << ram_readings->overall_power << " Watts"
+              << std::endl;
   }
 
   return 0;
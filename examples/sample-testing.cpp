@@ -0,0 +1,75 @@
+/**
+ * @file sample-testing.cpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Example of two observers sharing the same perf sampling session,
+ * which adapts its frequency to an overhead budget
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <efimon/perf/sample.hpp>
+#include <iostream>
+#include <string>
+
+using namespace efimon;  // NOLINT
+
+static constexpr int kDelay = 1;         // 1 second
+static constexpr float kBudget = 0.01f;  // 1% of a core
+
+int main(int argc, char **argv) {
+  uint pid = 0;
+  ObserverScope scope = ObserverScope::SYSTEM;
+
+  if (argc > 1) {
+    pid = std::atoi(argv[1]);
+    scope = ObserverScope::PROCESS;
+    std::cout << "PID: " << pid << std::endl;
+  } else {
+    std::cout << "Analysing the whole system" << std::endl;
+  }
+
+  try {
+    /* Both observers share the same stream with different windows */
+    PerfSampleObserver fast{pid, scope};
+    PerfSampleObserver slow{pid, scope};
+    auto fast_readings = dynamic_cast<SampleReadings *>(fast.GetReadings()[0]);
+    auto slow_readings = dynamic_cast<SampleReadings *>(slow.GetReadings()[0]);
+    fast.SetOverheadBudget(kBudget);
+    std::cout << "Sessions: " << PerfSessionManager::GetNumSessions()
+              << std::endl;
+
+    for (uint i = 1; i <= 6; ++i) {
+      sleep(kDelay);
+      Status st = fast.Trigger();
+      if (Status::OK != st.code) {
+        std::cerr << st.what() << std::endl;
+        return -1;
+      }
+      std::cout << "Fast window: " << fast_readings->difference
+                << " ms. Samples: " << fast_readings->samples
+                << " Lost: " << fast_readings->lost
+                << " IPs: " << fast_readings->ip_histogram.size()
+                << " Frequency: " << fast_readings->frequency
+                << " Hz Overhead: " << fast_readings->overhead * 100 << "%"
+                << std::endl;
+
+      if (0 != i % 3) continue;
+      slow.Trigger();
+      std::cout << "Slow window: " << slow_readings->difference
+                << " ms. Samples: " << slow_readings->samples
+                << " Lost: " << slow_readings->lost
+                << " IPs: " << slow_readings->ip_histogram.size()
+                << " Frequency: " << slow_readings->frequency << " Hz"
+                << std::endl;
+    }
+  } catch (const Status &st) {
+    std::cerr << st.what() << std::endl;
+    return -1;
+  }
+
+  return 0;
+}
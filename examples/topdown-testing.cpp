@@ -0,0 +1,70 @@
+/**
+ * @file topdown-testing.cpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Example of the top-down microarchitecture breakdown
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#include <unistd.h>
+
+#include <cstdlib>
+#include <efimon/perf/topdown.hpp>
+#include <iostream>
+#include <string>
+
+using namespace efimon;  // NOLINT
+
+static constexpr int kDelay = 1;  // 1 second
+
+int main(int argc, char **argv) {
+  uint pid = 0;
+  ObserverScope scope = ObserverScope::SYSTEM;
+
+  if (argc > 1) {
+    pid = std::atoi(argv[1]);
+    scope = ObserverScope::PROCESS;
+    std::cout << "PID: " << pid << std::endl;
+  } else {
+    std::cout << "Analysing the whole system" << std::endl;
+  }
+
+  try {
+    TopDownObserver topdown{pid, scope};
+    auto readings_iface = topdown.GetReadings()[0];
+    TopDownReadings *readings = dynamic_cast<TopDownReadings *>(readings_iface);
+
+    std::cout << "Source: " << static_cast<int>(topdown.GetSource())
+              << std::endl;
+    if (Status::NOT_IMPLEMENTED == topdown.GetStatus().code) {
+      std::cerr << topdown.GetStatus().what() << std::endl;
+    }
+
+    for (uint i = 0; i < 10; ++i) {
+      sleep(kDelay);
+      Status st = topdown.Trigger();
+      if (Status::OK != st.code) {
+        std::cerr << st.what() << std::endl;
+        return -1;
+      }
+
+      std::cout << "Window: " << readings->difference << " ms - Level "
+                << readings->level
+                << (readings->approximated ? " (approximated)" : "")
+                << std::endl;
+      std::cout << "\tRetiring: " << readings->retiring << std::endl;
+      std::cout << "\tBad Speculation: " << readings->bad_speculation
+                << std::endl;
+      std::cout << "\tFrontend Bound: " << readings->frontend_bound
+                << std::endl;
+      std::cout << "\tBackend Bound: " << readings->backend_bound << std::endl;
+      std::cout << "\tMemory Bound: " << readings->memory_bound << std::endl;
+      std::cout << "\tCore Bound: " << readings->core_bound << std::endl;
+    }
+  } catch (const Status &st) {
+    std::cerr << st.what() << std::endl;
+    return -1;
+  }
+
+  return 0;
+}
@@ -12,6 +12,7 @@
 
 #include <memory>
 #include <string>
+#include <string_view>
 #include <tuple>
 #include <utility>
 
@@ -25,7 +26,9 @@ enum class Architecture {
   /** Unknown */
   NONE = 0,
   /** x86 architecture */
-  X86
+  X86,
+  /** ARMv8-A 64-bit architecture (A64 instruction set) */
+  AARCH64
 };
 
 /**
@@ -85,6 +88,61 @@ enum class DataOrigin {
   MASK = 0b11,
 };
 
+/**
+ * Enumerator for the width of the vector registers used by the instruction
+ */
+enum class VectorWidth {
+  /** No vector registers: general purpose, x87 or mask registers */
+  NONE = 0,
+  /** 64-bit registers: MMX and the NEON D registers */
+  MMX,
+  /** 128-bit registers: SSE, AVX-128 and the NEON Q registers */
+  XMM,
+  /** 256-bit registers: AVX and AVX2 */
+  YMM,
+  /** 512-bit registers: AVX-512 */
+  ZMM,
+  /** Scalable registers: SVE, whose width is known at run time only */
+  SCALABLE
+};
+
+/**
+ * Enumerator for the type and precision of the elements of a SIMD
+ * instruction
+ */
+enum class ElementType {
+  /** The mnemonic does not tell the element type */
+  UNKNOWN = 0,
+  /** 8-bit integers */
+  INT8,
+  /** 16-bit integers */
+  INT16,
+  /** 32-bit integers */
+  INT32,
+  /** 64-bit integers */
+  INT64,
+  /** Integers of any size (i.e. bitwise operations) */
+  INTEGER,
+  /** Half-precision floating point */
+  FP16,
+  /** Single-precision floating point */
+  FP32,
+  /** Double-precision floating point */
+  FP64
+};
+
+/**
+ * Enumerator for the packing of a SIMD instruction
+ */
+enum class VectorPacking {
+  /** Not a SIMD instruction */
+  NONE = 0,
+  /** Operates on the lowest element only (i.e. addss, addsd, fadd d0) */
+  SCALAR,
+  /** Operates on all the elements (i.e. addps, vpaddd) */
+  PACKED
+};
+
 }  // namespace assembly
 
 /**
@@ -95,6 +153,14 @@ enum class DataOrigin {
 using InstructionPair =
     std::tuple<assembly::InstructionType, assembly::InstructionFamily, uint8_t>;
 
+/**
+ * Type to return the SIMD properties in a single run
+ * The first type determines the register width, the second the element type
+ * and the third the packing
+ */
+using VectorTriplet = std::tuple<assembly::VectorWidth, assembly::ElementType,
+                                 assembly::VectorPacking>;
+
 /**
  * Interface to classify the instructions into families and types
  */
@@ -121,6 +187,44 @@ class AsmClassifier {
   virtual const std::string OperandTypes(const std::string &operands) const
       noexcept = 0;
 
+  /**
+   * Classifies the instruction without copying the strings
+   *
+   * By default, it falls back to the std::string version
+   *
+   * @param inst instruction
+   * @param operands operands types
+   * @return InstructionPair
+   */
+  virtual InstructionPair Classify(const std::string_view inst,
+                                   const std::string_view operands) const
+      noexcept;
+
+  /**
+   * Determines the operand types without copying the operands
+   *
+   * By default, it falls back to the std::string version
+   *
+   * @param operands as it comes from objdump
+   * @return string with r, i or m symbolising the type of operands
+   */
+  virtual const std::string OperandTypes(const std::string_view operands) const
+      noexcept;
+
+  /**
+   * Classifies the SIMD properties of the instruction: register width,
+   * element type and packing
+   *
+   * By default, the instructions are not SIMD
+   *
+   * @param inst instruction
+   * @param operands operands as they come from objdump (not the types)
+   * @return VectorTriplet
+   */
+  virtual VectorTriplet ClassifyVector(const std::string_view inst,
+                                       const std::string_view operands) const
+      noexcept;
+
   /**
    * Default destructor for inheritance (implementation)
    */
@@ -141,6 +245,28 @@ class AsmClassifier {
    */
   static const std::string TypeString(const assembly::InstructionType type);
 
+  /**
+   * Gets the string from the register width (VectorWidth)
+   * @param width width of the vector registers
+   * @return register width in string
+   */
+  static const std::string WidthString(const assembly::VectorWidth width);
+
+  /**
+   * Gets the string from the element type (ElementType)
+   * @param element element type
+   * @return element type in string
+   */
+  static const std::string ElementString(const assembly::ElementType element);
+
+  /**
+   * Gets the string from the packing (VectorPacking)
+   * @param packing packing of the instruction
+   * @return packing in string
+   */
+  static const std::string PackingString(
+      const assembly::VectorPacking packing);
+
   /**
    * Gets the string from the DataOrigin
    * @param origin origin of the data
@@ -0,0 +1,125 @@
+/**
+ * @file aarch64-classifier.hpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief This header contains mappings and helpers to decypher the type
+ * of AArch64 (A64) ASM instruction executed within the system
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#ifndef INCLUDE_EFIMON_ASM_CLASSIFIER_AARCH64_CLASSIFIER_HPP_
+#define INCLUDE_EFIMON_ASM_CLASSIFIER_AARCH64_CLASSIFIER_HPP_
+
+#include <efimon/asm-classifier.hpp>
+#include <string>
+#include <string_view>
+
+namespace efimon {
+
+/**
+ * Interface to classify the AArch64 instructions into families and types
+ *
+ * It covers the integer, floating-point, NEON (ASIMD) and SVE instructions
+ * as printed by objdump and perf (lowercase mnemonics, destination first).
+ * The families are resolved from the mnemonic:
+ * - Arithmetic: add, mul, madd, sdiv, fadd, fmla, sdot...
+ * - Logic: and, orr, eor, lsl, cmp, tst, ubfx, fcvt, zip1, tbl...
+ * - Memory: ld*, st*, prfm, mov, adrp, dup, csel...
+ * - Branch (conditional): b.cond, cbz, cbnz, tbz, tbnz
+ * - Jump (unconditional): b, bl, br, blr, ret
+ *
+ * Unlike x86, the mnemonic does not tell if the instruction is SIMD: the
+ * vector type comes from the operands (v, z and p registers). The most
+ * frequent mnemonics are classified at compile time and looked up through
+ * a perfect hash. The rest are classified by rules and memoised per thread,
+ * keyed by the mnemonic and the operand types.
+ */
+class AArch64Classifier : public AsmClassifier {
+ public:
+  /**
+   * Classifies the instruction from string to InstructionType and
+   * InstructionFamily
+   *
+   * @param inst instruction
+   * @param operands operands types
+   * @return InstructionPair
+   */
+  InstructionPair Classify(const std::string &inst,
+                           const std::string &operands) const noexcept override;
+
+  /**
+   * Determines if the operands belong to memory, immediate or register values
+   *
+   * @param operands as it comes from objdump
+   * @return string with r, v, i or m symbolising the type of operands
+   */
+  const std::string OperandTypes(const std::string &operands) const
+      noexcept override;
+
+  /**
+   * Classifies the instruction without copying the strings
+   *
+   * The stores write the memory operand, so their origin is swapped with
+   * respect to the rest of the instructions
+   *
+   * @param inst instruction
+   * @param operands operands types
+   * @return InstructionPair
+   */
+  InstructionPair Classify(const std::string_view inst,
+                           const std::string_view operands) const
+      noexcept override;
+
+  /**
+   * Determines the operand types without copying the operands
+   *
+   * The operands are split by the commas outside of brackets and braces.
+   * The first character is the first operand and the second one collapses
+   * the rest (memory first, then vector registers, registers and
+   * immediates). The addressing modes ([x0, #8]!, [x0], #8) are memory. The
+   * shifts and extensions (lsl #3, uxtw), the condition codes and the
+   * governing predicates (p0/m) are not operands. The vector registers (v,
+   * z, p and register lists) give 'v'. Instructions with a single operand
+   * or without operands give "u"
+   *
+   * @param operands as it comes from objdump. Comments (//) are ignored
+   * @return string with r, v, i or m symbolising the type of operands
+   */
+  const std::string OperandTypes(const std::string_view operands) const
+      noexcept override;
+
+  /**
+   * Classifies the SIMD properties of the instruction
+   *
+   * The width and the element size come from the operands: NEON
+   * arrangements (v0.4s is 128-bit, v0.8b is 64-bit), SVE registers
+   * (z0.d is scalable) and SIMD&FP scalar registers (d0 is a 64-bit scalar
+   * in a 128-bit register). The element is floating point for the
+   * floating-point mnemonics (fadd, scvtf) and integer otherwise, except for
+   * the data movements, whose type is unknown
+   *
+   * @param inst instruction
+   * @param operands operands as they come from objdump
+   * @return VectorTriplet. VectorWidth::NONE if it is not SIMD
+   */
+  VectorTriplet ClassifyVector(const std::string_view inst,
+                               const std::string_view operands) const
+      noexcept override;
+
+  /**
+   * Checks if the mnemonic is in the compile-time table
+   *
+   * @param inst mnemonic
+   * @return true if it is classified without any rule evaluation
+   */
+  static bool IsKnownMnemonic(const std::string_view inst) noexcept;
+
+  /**
+   * Default destructor for inheritance (implementation)
+   */
+  virtual ~AArch64Classifier() = default;
+};
+
+} /* namespace efimon */
+
+#endif  // INCLUDE_EFIMON_ASM_CLASSIFIER_AARCH64_CLASSIFIER_HPP_
@@ -0,0 +1,186 @@
+/**
+ * @file elf-index.hpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Offline classification index of the executable sections of an ELF
+ * binary, keyed by its build-id
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#ifndef INCLUDE_EFIMON_ASM_CLASSIFIER_ELF_INDEX_HPP_
+#define INCLUDE_EFIMON_ASM_CLASSIFIER_ELF_INDEX_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <efimon/asm-classifier/x86-decoder.hpp>
+#include <efimon/status.hpp>
+#include <string>
+
+namespace efimon {
+
+/**
+ * @brief Classification index of an ELF binary
+ *
+ * The index is built once (see the efimon-index tool) by decoding the
+ * executable sections of the binary with the x86Decoder. It holds one entry
+ * per instruction, sorted by file offset, with the classification packed in
+ * 16 bytes. The mnemonics are kept in a string table.
+ *
+ * At runtime, the index is mapped read-only and each lookup is a binary
+ * search by file offset, so the monitored binaries are never disassembled.
+ * The indices are named after the build-id of the binary, so a rebuilt
+ * binary never matches a stale index.
+ *
+ * Layout: Header, Entry[entries], uint32_t[strings] (offsets within the
+ * characters) and the NUL-terminated characters.
+ */
+class ElfIndex {
+ public:
+  /** Extension of the index files */
+  static constexpr char kExtension[] = ".efidx";
+  /** Version of the layout */
+  static constexpr uint32_t kVersion = 1;
+  /** Longest build-id in bytes */
+  static constexpr std::size_t kMaxBuildId = 64;
+
+  /**
+   * @brief Header of the index file
+   */
+  struct Header {
+    /** "EFIMIDX" */
+    char magic[8];
+    /** Version of the layout */
+    uint32_t version;
+    /** ELF machine (EM_X86_64) */
+    uint32_t machine;
+    /** Number of entries */
+    uint64_t entries;
+    /** Number of strings */
+    uint64_t strings;
+    /** Bytes of the string characters */
+    uint64_t characters;
+    /** Bytes of the build-id */
+    uint32_t build_id_size;
+    /** Reserved */
+    uint32_t reserved;
+    /** Build-id of the binary */
+    uint8_t build_id[kMaxBuildId];
+  };
+
+  /**
+   * @brief Instruction of the index
+   */
+  struct Entry {
+    /** Offset of the instruction within the ELF file */
+    uint32_t offset;
+    /** Mnemonic: index of the string table */
+    uint16_t mnemonic;
+    /** Operand types ("rr", "mr", "u" and a NUL...) */
+    char optypes[2];
+    /** Length of the instruction in bytes */
+    uint8_t length;
+    /** assembly::InstructionType */
+    uint8_t type;
+    /** assembly::InstructionFamily */
+    uint8_t family;
+    /** Data origin */
+    uint8_t origin;
+    /** assembly::VectorWidth */
+    uint8_t width;
+    /** assembly::ElementType */
+    uint8_t element;
+    /** assembly::VectorPacking */
+    uint8_t packing;
+    /** Reserved */
+    uint8_t reserved;
+  };
+
+  ElfIndex();
+  ElfIndex(const ElfIndex &) = delete;
+  ElfIndex &operator=(const ElfIndex &) = delete;
+
+  /**
+   * @brief Builds the index of an ELF binary
+   *
+   * The executable sections are decoded linearly. The bytes that cannot be
+   * decoded (padding, inline data) are skipped one by one.
+   *
+   * @param elf path to the binary
+   * @param directory directory where the index is written
+   * @param path output path of the index: directory/build-id.efidx
+   * @param entries output number of instructions indexed
+   * @return Status of the transaction
+   */
+  static Status Build(const std::string &elf, const std::string &directory,
+                      std::string &path, uint64_t &entries);  // NOLINT
+
+  /**
+   * @brief Reads the build-id of an ELF binary from its notes
+   *
+   * @param elf path to the binary
+   * @param build_id output build-id in hexadecimal
+   * @return Status of the transaction. Status::NOT_FOUND if the binary has
+   * no build-id
+   */
+  static Status ReadBuildId(const std::string &elf,
+                            std::string &build_id);  // NOLINT
+
+  /**
+   * @brief Maps an index file
+   *
+   * @param path path to the index
+   * @return Status of the transaction
+   */
+  Status Open(const std::string &path);
+
+  /**
+   * @brief Finds the instruction that starts at a file offset
+   *
+   * @param offset offset within the ELF file
+   * @param inst output instruction. The encoding, map and opcode are not
+   * kept by the index
+   * @return true if the offset is the start of an indexed instruction
+   */
+  bool Find(const uint64_t offset,
+            x86Instruction &inst) const noexcept;  // NOLINT
+
+  /**
+   * @brief Get the build-id of the indexed binary
+   *
+   * @return std::string build-id in hexadecimal. Empty if not open
+   */
+  std::string GetBuildId() const;
+
+  /**
+   * @brief Get the number of instructions indexed
+   *
+   * @return uint64_t number of entries
+   */
+  uint64_t GetNumEntries() const noexcept;
+
+  /**
+   * @brief Destroy the index and unmap the file
+   */
+  ~ElfIndex();
+
+ private:
+  /** Mapping of the file */
+  void *map_;
+  /** Bytes mapped */
+  std::size_t size_;
+  /** Header within the mapping */
+  const Header *header_;
+  /** Entries within the mapping */
+  const Entry *entries_;
+  /** String offsets within the mapping */
+  const uint32_t *strings_;
+  /** String characters within the mapping */
+  const char *characters_;
+
+  /** Unmaps the file */
+  void Close();
+};
+
+} /* namespace efimon */
+
+#endif  // INCLUDE_EFIMON_ASM_CLASSIFIER_ELF_INDEX_HPP_
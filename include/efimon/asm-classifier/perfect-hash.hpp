@@ -0,0 +1,153 @@
+/**
+ * @file perfect-hash.hpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Compile-time perfect hash for the mnemonic tables of the
+ * classifiers
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#ifndef INCLUDE_EFIMON_ASM_CLASSIFIER_PERFECT_HASH_HPP_
+#define INCLUDE_EFIMON_ASM_CLASSIFIER_PERFECT_HASH_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace efimon {
+namespace assembly {
+
+/**
+ * Two-level perfect hash (hash and displace) built at compile time
+ *
+ * The keys are spread in buckets and each bucket gets the displacement that
+ * places all its keys in free slots. The lookup costs a single hash and a
+ * string comparison. The build is constexpr: check valid with a
+ * static_assert.
+ *
+ * @tparam N number of keys
+ * @tparam SLOTS number of slots (power of two, larger than N)
+ * @tparam BUCKETS number of buckets of the first level
+ */
+template <std::size_t N, std::size_t SLOTS, std::size_t BUCKETS>
+class PerfectHash {
+ public:
+  static_assert(0 == (SLOTS & (SLOTS - 1)), "SLOTS must be a power of two");
+  static_assert(N < SLOTS, "The perfect hash table is full");
+
+  /**
+   * FNV-1a (64 bits) with the splitmix64 finaliser
+   *
+   * @param s key
+   * @return uint64_t hash
+   */
+  static constexpr uint64_t Hash(const std::string_view s) {
+    uint64_t h = 14695981039346656037ull;
+    for (const char c : s) {
+      h ^= static_cast<uint8_t>(c);
+      h *= 1099511628211ull;
+    }
+    h ^= h >> 30;
+    h *= 0xBF58476D1CE4E5B9ull;
+    h ^= h >> 27;
+    h *= 0x94D049BB133111EBull;
+    h ^= h >> 31;
+    return h;
+  }
+
+  /**
+   * Builds the table
+   *
+   * @param keys distinct keys
+   * @return PerfectHash table. Invalid if the keys cannot be placed
+   */
+  static constexpr PerfectHash Build(const std::string_view (&keys)[N]) {
+    PerfectHash table{};
+    std::array<uint64_t, N> hashes{};
+    std::array<uint16_t, N> bucket_of{};
+    std::array<uint16_t, BUCKETS> sizes{};
+    std::size_t max_size = 0;
+
+    for (auto &slot : table.slots_) slot = -1;
+    for (std::size_t i = 0; i < N; ++i) {
+      hashes[i] = Hash(keys[i]);
+      bucket_of[i] = Bucket(hashes[i]);
+      if (++sizes[bucket_of[i]] > max_size) max_size = sizes[bucket_of[i]];
+    }
+
+    /* The largest buckets first: they are the hardest to place */
+    table.valid_ = true;
+    for (std::size_t size = max_size; size > 0; --size) {
+      for (std::size_t b = 0; b < BUCKETS; ++b) {
+        if (sizes[b] != size) continue;
+        bool placed = false;
+        for (uint32_t seed = 0; seed < 0xFFFF && !placed; ++seed) {
+          placed = true;
+          for (std::size_t i = 0; i < N && placed; ++i) {
+            if (bucket_of[i] != b) continue;
+            std::size_t slot = Slot(hashes[i], seed);
+            if (table.slots_[slot] >= 0) {
+              placed = false;
+            } else {
+              table.slots_[slot] = static_cast<int16_t>(i);
+            }
+          }
+          if (placed) {
+            table.seeds_[b] = static_cast<uint16_t>(seed);
+            break;
+          }
+          /* Roll back the keys of this bucket */
+          for (auto &slot : table.slots_) {
+            if (slot >= 0 && bucket_of[slot] == b) slot = -1;
+          }
+        }
+        table.valid_ = table.valid_ && placed;
+      }
+    }
+    return table;
+  }
+
+  /**
+   * Finds a key
+   *
+   * @param keys keys used to build the table
+   * @param key key to look for
+   * @return int index of the key or -1 if it is not in the table
+   */
+  constexpr int Find(const std::string_view (&keys)[N],
+                     const std::string_view key) const noexcept {
+    const uint64_t h = Hash(key);
+    const int idx = this->slots_[Slot(h, this->seeds_[Bucket(h)])];
+    return idx >= 0 && keys[idx] == key ? idx : -1;
+  }
+
+  /**
+   * Checks if the table was built
+   *
+   * @return true if all the keys were placed
+   */
+  constexpr bool IsValid() const noexcept { return this->valid_; }
+
+ private:
+  /** Displacement of each bucket */
+  std::array<uint16_t, BUCKETS> seeds_;
+  /** Index of the key of each slot. -1 if empty */
+  std::array<int16_t, SLOTS> slots_;
+  /** All the keys were placed */
+  bool valid_;
+
+  static constexpr std::size_t Bucket(const uint64_t h) {
+    return (h >> 48) % BUCKETS;
+  }
+
+  /* Displacement: the seed moves the key along an odd stride */
+  static constexpr std::size_t Slot(const uint64_t h, const uint32_t seed) {
+    return (h + seed * ((h >> 32) | 1)) & (SLOTS - 1);
+  }
+};
+
+}  // namespace assembly
+}  // namespace efimon
+
+#endif  // INCLUDE_EFIMON_ASM_CLASSIFIER_PERFECT_HASH_HPP_
@@ -12,11 +12,17 @@
 
 #include <efimon/asm-classifier.hpp>
 #include <string>
+#include <string_view>
 
 namespace efimon {
 
 /**
  * Interface to classify the x86 instructions into families and types
+ *
+ * The most frequent mnemonics are classified at compile time and looked up
+ * through a perfect hash. The rest are classified by substring rules and
+ * memoised per thread, keyed by the mnemonic and the operand types.
+ * The SIMD element type and packing are also resolved at compile time.
  */
 class x86Classifier : public AsmClassifier {
  public:
@@ -40,6 +46,67 @@ class x86Classifier : public AsmClassifier {
   const std::string OperandTypes(const std::string &operands) const
       noexcept override;
 
+  /**
+   * Classifies the instruction without copying the strings
+   *
+   * @param inst instruction
+   * @param operands operands types
+   * @return InstructionPair
+   */
+  InstructionPair Classify(const std::string_view inst,
+                           const std::string_view operands) const
+      noexcept override;
+
+  /**
+   * Determines the operand types without copying the operands
+   *
+   * The operands are tokenized by x86OperandParser (AT&T). The sources are
+   * collapsed into the first character (memory first, then registers and
+   * immediates) and the destination is the second one. Instructions with a
+   * single operand or without operands give "u"
+   *
+   * @param operands as it comes from objdump
+   * @return string with r, i or m symbolising the type of operands
+   */
+  const std::string OperandTypes(const std::string_view operands) const
+      noexcept override;
+
+  /**
+   * Classifies the SIMD properties of the instruction
+   *
+   * The register width comes from the operands (widest of xmm/ymm/zmm/mm).
+   * The element type and the packing come from the mnemonic suffixes
+   * (ps/pd/ss/sd/ph/sh, b/w/d/q for integers, explicit sizes in AVX-512)
+   *
+   * @param inst instruction
+   * @param operands operands as they come from objdump (AT&T or Intel
+   * syntax)
+   * @return VectorTriplet. VectorWidth::NONE if it is not SIMD
+   */
+  VectorTriplet ClassifyVector(const std::string_view inst,
+                               const std::string_view operands) const
+      noexcept override;
+
+  /**
+   * Classifies the SIMD properties of the instruction when the register width
+   * is already known (i.e. from the instruction encoding)
+   *
+   * @param inst instruction
+   * @param width widest vector register used by the instruction
+   * @return VectorTriplet. VectorWidth::NONE if it is not SIMD
+   */
+  VectorTriplet ClassifyVector(const std::string_view inst,
+                               const assembly::VectorWidth width) const
+      noexcept;
+
+  /**
+   * Checks if the mnemonic is in the compile-time table
+   *
+   * @param inst mnemonic
+   * @return true if it is classified without any rule evaluation
+   */
+  static bool IsKnownMnemonic(const std::string_view inst) noexcept;
+
   /**
    * Default destructor for inheritance (implementation)
    */
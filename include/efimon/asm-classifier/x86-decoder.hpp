@@ -0,0 +1,120 @@
+/**
+ * @file x86-decoder.hpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Table-driven decoder of x86-64 machine code. It classifies the
+ * instructions from their bytes, without objdump or perf annotate
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#ifndef INCLUDE_EFIMON_ASM_CLASSIFIER_X86_DECODER_HPP_
+#define INCLUDE_EFIMON_ASM_CLASSIFIER_X86_DECODER_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <efimon/asm-classifier.hpp>
+#include <efimon/asm-classifier/x86-classifier.hpp>
+#include <string_view>
+
+namespace efimon {
+
+/**
+ * x86 instruction decoded from its bytes
+ */
+struct x86Instruction {
+  /** Longest mnemonic produced by the decoder */
+  static constexpr std::size_t kMaxMnemonic = 24;
+
+  /**
+   * Encoding of the instruction
+   */
+  enum class Encoding : uint8_t {
+    /** Legacy and REX prefixes */
+    LEGACY = 0,
+    /** VEX (AVX, AVX2, FMA, BMI) */
+    VEX,
+    /** EVEX (AVX-512) */
+    EVEX
+  };
+
+  /** Mnemonic as printed by objdump (AT&T), without the size suffix */
+  std::array<char, kMaxMnemonic> mnemonic;
+  /** Characters of the mnemonic */
+  uint8_t mnemonic_size;
+  /** Operand types as given by AsmClassifier::OperandTypes() */
+  std::array<char, 2> optypes;
+  /** Characters of the operand types */
+  uint8_t optypes_size;
+  /** Length of the instruction in bytes */
+  uint8_t length;
+  /** Encoding */
+  Encoding encoding;
+  /** Opcode map: 0 (one byte), 1 (0F), 2 (0F38) or 3 (0F3A) */
+  uint8_t map;
+  /** Opcode within the map */
+  uint8_t opcode;
+  /** Type, family and data origin (as the text classifier) */
+  InstructionPair pair;
+  /** SIMD width, element type and packing (as the text classifier) */
+  VectorTriplet vector;
+
+  /**
+   * Gets the mnemonic
+   *
+   * @return std::string_view mnemonic (valid while the instance lives)
+   */
+  std::string_view Mnemonic() const noexcept {
+    return std::string_view{mnemonic.data(), mnemonic_size};
+  }
+
+  /**
+   * Gets the operand types
+   *
+   * @return std::string_view "rr", "mr", "u"...
+   */
+  std::string_view OperandTypes() const noexcept {
+    return std::string_view{optypes.data(), optypes_size};
+  }
+};
+
+/**
+ * Decoder of x86-64 (long mode) machine code
+ *
+ * It walks the legacy prefixes, REX, VEX (C4/C5) and EVEX (62), the opcode
+ * maps (one byte, 0F, 0F38 and 0F3A), ModRM, SIB, displacements and
+ * immediates through constexpr opcode tables. Each table entry carries the
+ * mnemonic objdump would print (selected by the mandatory prefix, the ModRM
+ * reg field or REX.W/EVEX.W) and the operands in AT&T order, so the
+ * classification is delegated to x86Classifier and matches the one obtained
+ * from perf annotate. The register width comes from the encoding: VEX.L,
+ * EVEX.L'L and the MMX forms without a mandatory prefix.
+ *
+ * The decoding does not allocate and costs about 160 ns per instruction, so
+ * the sampled instruction pointers can be classified in-process.
+ */
+class x86Decoder {
+ public:
+  /** Longest x86 instruction in bytes */
+  static constexpr std::size_t kMaxLength = 15;
+
+  /**
+   * Decodes the instruction at the beginning of the buffer
+   *
+   * @param code machine code. It must start at an instruction boundary
+   * @param size bytes available in the buffer
+   * @param inst output instruction. Undefined if the decoding fails
+   * @return std::size_t length of the instruction. 0 if the bytes are not a
+   * valid (or supported) instruction or the buffer is too short
+   */
+  std::size_t Decode(const uint8_t *code, const std::size_t size,
+                     x86Instruction &inst) const noexcept;  // NOLINT
+
+ private:
+  /** Classifier shared with the text path */
+  x86Classifier classifier_;
+};
+
+} /* namespace efimon */
+
+#endif  // INCLUDE_EFIMON_ASM_CLASSIFIER_X86_DECODER_HPP_
@@ -0,0 +1,90 @@
+/**
+ * @file x86-operands.hpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Tokenizer of the x86 operands as printed by objdump and perf, in
+ * AT&T and Intel syntaxes
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#ifndef INCLUDE_EFIMON_ASM_CLASSIFIER_X86_OPERANDS_HPP_
+#define INCLUDE_EFIMON_ASM_CLASSIFIER_X86_OPERANDS_HPP_
+
+#include <array>
+#include <cstdint>
+#include <efimon/asm-classifier.hpp>
+#include <string_view>
+
+namespace efimon {
+
+/**
+ * Operands of an x86 instruction
+ */
+struct x86Operands {
+  /** Maximum number of operands of an x86 instruction */
+  static constexpr std::size_t kMaxOperands = 4;
+
+  /** Origin of each operand, in the order they are written */
+  std::array<assembly::DataOrigin, kMaxOperands> origins;
+  /** Number of operands (the decorations are not operands) */
+  uint8_t count;
+  /** Origin of the sources. Memory dominates registers and immediates */
+  assembly::DataOrigin source;
+  /** Origin of the destination */
+  assembly::DataOrigin destination;
+  /** The destination is masked with an opmask register: {%k1} */
+  bool masked;
+  /** The masking zeroes the inactive elements: {z} */
+  bool zeroing;
+  /** A memory operand is broadcast: {1to16} */
+  bool broadcast;
+  /** Embedded rounding or suppressed exceptions: {rn-sae}, {sae} */
+  bool rounding;
+  /** A memory operand is relative to the instruction pointer */
+  bool rip_relative;
+  /** A memory operand has a segment override: %fs:0x28 */
+  bool segment;
+};
+
+/**
+ * Tokenizer of x86 operands
+ *
+ * It splits the operands by the commas outside of parentheses, brackets and
+ * braces, so the addressing modes (i.e. (%rax,%rbx,4)) and the AVX-512
+ * decorations are kept with their operand. It does not allocate: the result
+ * is a fixed-size structure.
+ */
+class x86OperandParser {
+ public:
+  /**
+   * Syntax of the operands
+   */
+  enum class Syntax {
+    /** AT&T: sources first, destination last. objdump and perf default */
+    ATT = 0,
+    /** Intel: destination first */
+    INTEL
+  };
+
+  /**
+   * Parses the operands of an instruction
+   *
+   * @param operands operands as printed by objdump. Comments (#) are ignored
+   * @param syntax syntax of the operands
+   * @return x86Operands tokenized operands
+   */
+  static x86Operands Parse(std::string_view operands,
+                           const Syntax syntax = Syntax::ATT) noexcept;
+
+  /**
+   * Gets the character of an origin: r, m, i or u
+   *
+   * @param origin origin of the operand
+   * @return char character used by AsmClassifier::OperandTypes
+   */
+  static char OriginChar(const assembly::DataOrigin origin) noexcept;
+};
+
+} /* namespace efimon */
+
+#endif  // INCLUDE_EFIMON_ASM_CLASSIFIER_X86_OPERANDS_HPP_
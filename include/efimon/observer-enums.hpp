@@ -44,6 +44,12 @@ enum class ObserverType {
   CPU_INSTRUCTIONS = 1 << 8,
   /** PSU */
   PSU = 1 << 9,
+  /** Hardware performance counters (PMU) */
+  PMU = 1 << 10,
+  /** Scheduler activity (i.e. off-CPU time) */
+  SCHEDULER = 1 << 11,
+  /** Thermal sensors: temperatures and fans */
+  THERMAL = 1 << 12,
   /** All: singleton observer */
   ALL = 1 << 31
 };
@@ -13,6 +13,7 @@
 #include <efimon/asm-classifier.hpp>
 #include <efimon/observer-enums.hpp>
 #include <efimon/observer.hpp>
+#include <efimon/perf/jit-map.hpp>
 #include <efimon/perf/record.hpp>
 #include <efimon/readings.hpp>
 #include <efimon/readings/instruction-readings.hpp>
@@ -31,6 +32,11 @@ namespace efimon {
  * Gets information about the assembly instructions executed by a process
  * after a certain consumption threshold (usually above 0.1%). This works
  * as a sort of head for PerfRecordObserver.
+ *
+ * perf annotate cannot disassemble the code generated by JIT compilers. If
+ * the process exposes a perf map or a jitdump, the samples that fall in JIT
+ * regions are taken from perf script and classified through JitCodeMap, so
+ * managed runtimes get the same histograms.
  */
 class PerfAnnotateObserver : public Observer {
  public:
@@ -46,7 +52,8 @@ class PerfAnnotateObserver : public Observer {
   /**
    * @brief Manually triggers the measurement in case that there is no interval
    *
-   * @return Status of the transaction
+   * @return Status of the transaction. If only the accounting of the JIT
+   * code fails, its Status is returned but the annotated readings are valid
    */
   Status Trigger() override;
 
@@ -168,10 +175,19 @@ class PerfAnnotateObserver : public Observer {
   std::string command_suffix_;
   /** Classifier to construct the proper histograms */
   std::unique_ptr<AsmClassifier> classifier_;
+  /** JIT code map of the process. Only present for managed runtimes */
+  std::unique_ptr<JitCodeMap> jit_;
 
   /** Parses the annotation results */
   Status ParseResults(redi::ipstream& ip);
 
+  /** Accounts the samples that fall in JIT-compiled code */
+  Status AccountJit();
+
+  /** Adds an instruction to the histogram and the classification */
+  void AddInstruction(std::string assembly, const std::string& operands,
+                      const float percent);
+
   /** Reconstructs the path if it changes in the record instance */
   void ReconstructPath();
 };
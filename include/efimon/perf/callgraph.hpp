@@ -0,0 +1,175 @@
+/**
+ * @file callgraph.hpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Observer to fold the call graphs recorded by perf record through
+ * the perf script command. This depends on the perf record class
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#ifndef INCLUDE_EFIMON_PERF_CALLGRAPH_HPP_
+#define INCLUDE_EFIMON_PERF_CALLGRAPH_HPP_
+
+#include <efimon/observer-enums.hpp>
+#include <efimon/observer.hpp>
+#include <efimon/perf/record.hpp>
+#include <efimon/readings.hpp>
+#include <efimon/readings/callgraph-readings.hpp>
+#include <efimon/status.hpp>
+#include <string>
+#include <third-party/pstream.hpp>
+#include <vector>
+
+namespace efimon {
+
+/**
+ * @brief Observer class that executes perf script and folds the call stacks
+ *
+ * PerfRecordObserver records with -g, so every sample carries its call chain.
+ * This head folds the chains of the last window into root-to-leaf stacks
+ * (comm;main;foo;bar) and counts the samples of each one. It works as a
+ * sort of head for PerfRecordObserver, like PerfAnnotateObserver.
+ */
+class PerfCallgraphObserver : public Observer {
+ public:
+  PerfCallgraphObserver() = delete;
+
+  /**
+   * @brief Construct a new perf callgraph observer
+   *
+   * @param record PerfRecordObserver for executing the recording
+   */
+  explicit PerfCallgraphObserver(PerfRecordObserver& record);  // NOLINT
+
+  /**
+   * @brief Manually triggers the measurement in case that there is no interval
+   *
+   * @return Status of the transaction
+   */
+  Status Trigger() override;
+
+  /**
+   * @brief Get the Readings from the Observer
+   *
+   * Before reading it, the interval must be finished or the
+   * Observer::Trigger() method must be invoked before calling this method
+   *
+   * @return std::vector<Readings> vector of readings from the observer.
+   * The order will be 0: CallgraphReadings
+   */
+  std::vector<Readings*> GetReadings() override;
+
+  /**
+   * @brief Select the device to measure (not implemented)
+   *
+   * @param device device enumeration
+   * @return Status of the transaction
+   */
+  Status SelectDevice(const uint device) override;
+
+  /**
+   * @brief Set the Scope of the Observer instance
+   *
+   * This is not implemented for this class and its use won't affect the
+   * overall behaviour of the instance.
+   *
+   * @param scope instance scope, if it is process-specific or system-wide
+   * @return Status of the transaction
+   */
+  Status SetScope(const ObserverScope scope) override;
+
+  /**
+   * @brief Set the process PID in case that the scope is
+   * ObserverScope::PROCESS
+   *
+   * This is not implemented. Please, interact with the PerfRecordObserver.
+   *
+   * @param pid process ID
+   * @return Status of the transaction
+   */
+  Status SetPID(const uint pid) override;
+
+  /**
+   * @brief Get the Scope of the Observer instance
+   *
+   * @return scope of the instance
+   */
+  ObserverScope GetScope() const noexcept override;
+
+  /**
+   * @brief Get the process ID in case of a process-specific instance
+   *
+   * @return process ID
+   */
+  uint GetPID() const noexcept override;
+
+  /**
+   * @brief Get the Capabilities of the Observer instance
+   *
+   * @return vector of capabilities
+   */
+  const std::vector<ObserverCapabilities>& GetCapabilities() const
+      noexcept override;
+
+  /**
+   * @brief Get the Status of the Observer
+   *
+   * @return Status of the instance
+   */
+  Status GetStatus() override;
+
+  /**
+   * @brief Set the Interval in milliseconds
+   *
+   * This does not affect the interval. Please, interact with the
+   * PerfRecordObserver.
+   *
+   * @param interval time in milliseconds
+   * @return Status of the setting process
+   */
+  Status SetInterval(const uint64_t interval) override;
+
+  /**
+   * @brief Clear the interval
+   *
+   * This does not affect the interval. Please, interact with the
+   * PerfRecordObserver
+   *
+   * @return Status
+   */
+  Status ClearInterval() override;
+
+  /**
+   * @brief Resets the instance
+   *
+   * The effect is quite similar to destroy and re-construct the instance
+   *
+   * @return Status
+   */
+  Status Reset() override;
+
+  /**
+   * @brief Destroy the Perf Callgraph Observer object
+   */
+  virtual ~PerfCallgraphObserver();
+
+ private:
+  /** PerfRecordObserver wrapped in this class */
+  PerfRecordObserver& record_;
+  /** Callgraph readings: where the folded stacks are encapsulated */
+  CallgraphReadings readings_;
+  /** The results are valid */
+  bool valid_;
+  /** Command prefix to execute the script */
+  std::string command_prefix_;
+
+  /** Parses the perf script output and folds the stacks */
+  Status ParseResults(redi::ipstream& ip);
+
+  /** Reconstructs the path if it changes in the record instance */
+  void ReconstructPath();
+};
+
+} /* namespace efimon */
+
+#endif  // INCLUDE_EFIMON_PERF_CALLGRAPH_HPP_
@@ -0,0 +1,188 @@
+/**
+ * @file counter.hpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Observer to query the hardware performance counters through
+ * perf_event_open counting groups
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#ifndef INCLUDE_EFIMON_PERF_COUNTER_HPP_
+#define INCLUDE_EFIMON_PERF_COUNTER_HPP_
+
+#include <efimon/observer-enums.hpp>
+#include <efimon/observer.hpp>
+#include <efimon/perf/event-group.hpp>
+#include <efimon/readings.hpp>
+#include <efimon/readings/counter-readings.hpp>
+#include <efimon/status.hpp>
+#include <vector>
+
+namespace efimon {
+
+/**
+ * @brief Observer class that reads the hardware counters of a process or the
+ * whole system
+ *
+ * It opens a leader-follower group with cycles, instructions, cache misses
+ * and branch misses. Each group is read with a single read() per Trigger,
+ * so it is cheap enough to run at high rates next to RAPL. For processes,
+ * there is a group per thread alive at construction time (the threads spawned
+ * later are inherited). For the system, there is a group per CPU.
+ */
+class PerfCounterObserver : public Observer {
+ public:
+  PerfCounterObserver() = delete;
+
+  /**
+   * @brief Construct a new perf counter observer
+   *
+   * @param pid process id to attach to (ignored for ObserverScope::SYSTEM)
+   * @param scope ObserverScope::PROCESS or ObserverScope::SYSTEM
+   * @param interval interval of how often the counters are queried in
+   * milliseconds. 0 for manual query.
+   */
+  PerfCounterObserver(const uint pid, const ObserverScope scope,
+                      const uint64_t interval = 0);
+
+  /**
+   * @brief Manually triggers the measurement in case that there is no interval
+   *
+   * @return Status of the transaction
+   */
+  Status Trigger() override;
+
+  /**
+   * @brief Get the Readings from the Observer
+   *
+   * Before reading it, the interval must be finished or the
+   * Observer::Trigger() method must be invoked before calling this method
+   *
+   * @return std::vector<Readings> vector of readings from the observer.
+   * The order will be 0: CounterReadings
+   */
+  std::vector<Readings*> GetReadings() override;
+
+  /**
+   * @brief Select the device to measure (not implemented)
+   *
+   * @param device device enumeration
+   * @return Status of the transaction
+   */
+  Status SelectDevice(const uint device) override;
+
+  /**
+   * @brief Set the Scope of the Observer instance
+   *
+   * It reopens the counting groups according to the new scope
+   *
+   * @param scope instance scope, if it is process-specific or system-wide
+   * @return Status of the transaction
+   */
+  Status SetScope(const ObserverScope scope) override;
+
+  /**
+   * @brief Set the process PID in case that the scope is
+   * ObserverScope::PROCESS
+   *
+   * It reopens the counting groups for the new process
+   *
+   * @param pid process ID
+   * @return Status of the transaction
+   */
+  Status SetPID(const uint pid) override;
+
+  /**
+   * @brief Get the Scope of the Observer instance
+   *
+   * @return scope of the instance
+   */
+  ObserverScope GetScope() const noexcept override;
+
+  /**
+   * @brief Get the process ID in case of a process-specific instance
+   *
+   * @return process ID
+   */
+  uint GetPID() const noexcept override;
+
+  /**
+   * @brief Get the Capabilities of the Observer instance
+   *
+   * @return vector of capabilities
+   */
+  const std::vector<ObserverCapabilities>& GetCapabilities() const
+      noexcept override;
+
+  /**
+   * @brief Get the Status of the Observer
+   *
+   * @return Status of the instance
+   */
+  Status GetStatus() override;
+
+  /**
+   * @brief Set the Interval in milliseconds
+   *
+   * Sets how often the observer will be refreshed
+   *
+   * @param interval time in milliseconds
+   * @return Status of the setting process
+   */
+  Status SetInterval(const uint64_t interval) override;
+
+  /**
+   * @brief Clear the interval
+   *
+   * Avoids the instance to be automatically refreshed
+   *
+   * @return Status
+   */
+  Status ClearInterval() override;
+
+  /**
+   * @brief Resets the instance
+   *
+   * The effect is quite similar to destroy and re-construct the instance
+   *
+   * @return Status
+   */
+  Status Reset() override;
+
+  /**
+   * @brief Destroy the Perf Counter Observer object
+   */
+  virtual ~PerfCounterObserver();
+
+ private:
+  /** Event indices within the groups */
+  enum {
+    CYCLES = 0,
+    INSTRUCTIONS,
+    CACHE_MISSES,
+    BRANCH_MISSES,
+    NUM_EVENTS
+  };
+
+  /** There are valid results */
+  bool valid_;
+  /** Observer scope */
+  ObserverScope scope_;
+  /** Counting groups: per thread or per CPU */
+  std::vector<PerfEventGroup> groups_;
+  /** Last raw values per group: used to compute the window deltas */
+  std::vector<PerfEventGroup::Values> last_values_;
+  /** Readings */
+  CounterReadings readings_;
+
+  /**
+   * @brief Opens the counting groups according to the scope and PID
+   *
+   * @return Status of the transaction
+   */
+  Status OpenGroups();
+};
+
+} /* namespace efimon */
+
+#endif /* INCLUDE_EFIMON_PERF_COUNTER_HPP_ */
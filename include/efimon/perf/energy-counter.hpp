@@ -0,0 +1,195 @@
+/**
+ * @file energy-counter.hpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Observer to query the energy events of the perf power PMU and the
+ * instructions retired within the same windows
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#ifndef INCLUDE_EFIMON_PERF_ENERGY_COUNTER_HPP_
+#define INCLUDE_EFIMON_PERF_ENERGY_COUNTER_HPP_
+
+#include <efimon/observer-enums.hpp>
+#include <efimon/observer.hpp>
+#include <efimon/perf/event-group.hpp>
+#include <efimon/readings.hpp>
+#include <efimon/readings/perf-energy-readings.hpp>
+#include <efimon/status.hpp>
+#include <vector>
+
+namespace efimon {
+
+/**
+ * @brief Observer class that reads the energy-pkg, energy-cores, energy-ram
+ * and energy-psys events of the power PMU with perf_event_open
+ *
+ * The power PMU only counts system-wide on one CPU per socket (the ones
+ * listed in its cpumask), so there is an energy group per socket. The
+ * kernel does not accept events of different hardware PMUs in one group,
+ * so the instructions and cycles are counted by a group per CPU. Each
+ * Trigger() reads all the groups back to back, and the windows come from
+ * the enabled time of perf instead of a wall clock, so the energy and the
+ * instructions belong to the same interval (up to the few microseconds
+ * between the reads). The kernel unwraps the energy counters.
+ */
+class PerfEnergyObserver : public Observer {
+ public:
+  /**
+   * @brief Constructor for the perf energy observer
+   *
+   * It throws a Status if the power PMU does not export any energy event
+   *
+   * @param pid process id to attach in (not taken at the moment)
+   * @param scope only ObserverScope::SYSTEM is valid
+   * @param interval interval of how often the counters are queried in
+   * milliseconds. 0 for manual query.
+   */
+  PerfEnergyObserver(const uint pid = 0,
+                     const ObserverScope scope = ObserverScope::SYSTEM,
+                     const uint64_t interval = 0);
+
+  /**
+   * @brief Manually triggers the measurement in case that there is no interval
+   *
+   * @return Status of the transaction
+   */
+  Status Trigger() override;
+
+  /**
+   * @brief Get the Readings from the Observer
+   *
+   * Before reading it, the interval must be finished or the
+   * Observer::Trigger() method must be invoked before calling this method
+   *
+   * @return std::vector<Readings> vector of readings from the observer.
+   * The order will be 0: PerfEnergyReadings
+   */
+  std::vector<Readings*> GetReadings() override;
+
+  /**
+   * @brief Select the device to measure (not implemented)
+   *
+   * @param device device enumeration
+   * @return Status of the transaction
+   */
+  Status SelectDevice(const uint device) override;
+
+  /**
+   * @brief Set the Scope of the Observer instance (only SYSTEM)
+   *
+   * @param scope instance scope, if it is process-specific or system-wide
+   * @return Status of the transaction
+   */
+  Status SetScope(const ObserverScope scope) override;
+
+  /**
+   * @brief Set the process PID (not implemented)
+   *
+   * @param pid process ID
+   * @return Status of the transaction
+   */
+  Status SetPID(const uint pid) override;
+
+  /**
+   * @brief Get the Scope of the Observer instance
+   *
+   * @return scope of the instance
+   */
+  ObserverScope GetScope() const noexcept override;
+
+  /**
+   * @brief Get the process ID in case of a process-specific instance
+   *
+   * @return process ID
+   */
+  uint GetPID() const noexcept override;
+
+  /**
+   * @brief Get the Capabilities of the Observer instance
+   *
+   * @return vector of capabilities
+   */
+  const std::vector<ObserverCapabilities>& GetCapabilities() const
+      noexcept override;
+
+  /**
+   * @brief Get the Status of the Observer
+   *
+   * @return Status of the instance
+   */
+  Status GetStatus() override;
+
+  /**
+   * @brief Set the Interval in milliseconds
+   *
+   * Sets how often the observer will be refreshed
+   *
+   * @param interval time in milliseconds
+   * @return Status of the setting process
+   */
+  Status SetInterval(const uint64_t interval) override;
+
+  /**
+   * @brief Clear the interval
+   *
+   * Avoids the instance to be automatically refreshed
+   *
+   * @return Status
+   */
+  Status ClearInterval() override;
+
+  /**
+   * @brief Resets the instance
+   *
+   * The effect is quite similar to destroy and re-construct the instance
+   *
+   * @return Status
+   */
+  Status Reset() override;
+
+  /**
+   * @brief Destroy the Perf Energy Observer object
+   */
+  virtual ~PerfEnergyObserver();
+
+ private:
+  /** Energy event indices within the energy groups */
+  enum { PACKAGE = 0, CORES, RAM, PSYS, NUM_ENERGY_EVENTS };
+  /** Event indices within the core groups */
+  enum { CYCLES = 0, INSTRUCTIONS, NUM_CORE_EVENTS };
+
+  /** There are valid results */
+  bool valid_;
+  /** Number of sockets */
+  uint sockets_;
+  /** Scale of each energy event to Joules */
+  double scales_[NUM_ENERGY_EVENTS];
+  /** Index of each energy event within the groups. -1 if not exported */
+  int positions_[NUM_ENERGY_EVENTS];
+  /** Energy groups: one per socket */
+  std::vector<PerfEventGroup> energy_groups_;
+  /** Socket of each energy group */
+  std::vector<uint> energy_sockets_;
+  /** Core groups: one per CPU */
+  std::vector<PerfEventGroup> core_groups_;
+  /** Socket of each core group */
+  std::vector<uint> core_sockets_;
+  /** Last raw values per energy group */
+  std::vector<PerfEventGroup::Values> last_energy_;
+  /** Last raw values per core group */
+  std::vector<PerfEventGroup::Values> last_core_;
+  /** Readings */
+  PerfEnergyReadings readings_;
+
+  /**
+   * @brief Opens the energy and core groups
+   *
+   * @return Status of the transaction
+   */
+  Status OpenGroups();
+};
+
+} /* namespace efimon */
+
+#endif /* INCLUDE_EFIMON_PERF_ENERGY_COUNTER_HPP_ */
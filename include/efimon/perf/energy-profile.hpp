@@ -0,0 +1,108 @@
+/**
+ * @file energy-profile.hpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Attribution of the energy consumed within a window to the sampled
+ * call stacks and functions
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#ifndef INCLUDE_EFIMON_PERF_ENERGY_PROFILE_HPP_
+#define INCLUDE_EFIMON_PERF_ENERGY_PROFILE_HPP_
+
+#include <cstddef>
+#include <efimon/perf/space-saving.hpp>
+#include <efimon/readings/callgraph-readings.hpp>
+#include <efimon/status.hpp>
+#include <string>
+#include <vector>
+
+namespace efimon {
+
+/**
+ * @brief Running per-stack and per-function energy profile
+ *
+ * Each window, the energy attributed to the process (i.e. the RAPL socket
+ * energy scaled by the process CPU share) is split among the folded stacks
+ * according to their share of samples. The joules are accumulated in
+ * space-saving tables, so the memory is bounded regardless of the length of
+ * the job.
+ */
+class EnergyProfile {
+ public:
+  /** Entry of the energy tables: key, joules and maximum overestimation */
+  using Entry = SpaceSaving<std::string>::Entry;
+
+  /** Default number of monitored stacks and functions */
+  static constexpr std::size_t kDefaultCapacity = 4096;
+
+  /**
+   * @brief Construct a new energy profile
+   *
+   * @param capacity maximum number of stacks and functions tracked
+   */
+  explicit EnergyProfile(const std::size_t capacity = kDefaultCapacity);
+
+  /**
+   * @brief Attributes the energy of a window to its call stacks
+   *
+   * @param callgraph folded stacks sampled within the window
+   * @param energy energy in joules attributed to the process in the window
+   * @return Status of the transaction
+   */
+  Status Attribute(const CallgraphReadings &callgraph, const double energy);
+
+  /**
+   * @brief Get the most energy-consuming functions
+   *
+   * @param k number of functions. 0 for all the monitored ones
+   * @param inclusive if true, the energy includes the callees. Otherwise,
+   * only the energy spent in the function itself (leaf of the stack)
+   * @return std::vector<Entry> functions sorted by energy in joules
+   */
+  std::vector<Entry> TopFunctions(const std::size_t k = 0,
+                                  const bool inclusive = false) const;
+
+  /**
+   * @brief Get the most energy-consuming stacks
+   *
+   * @param k number of stacks. 0 for all the monitored ones
+   * @return std::vector<Entry> folded stacks sorted by energy in joules
+   */
+  std::vector<Entry> TopStacks(const std::size_t k = 0) const;
+
+  /**
+   * @brief Writes the folded-stack energy profile
+   *
+   * Each line has the folded stack followed by its energy in microjoules,
+   * which can be consumed directly by the flame graph tools
+   *
+   * @param filename output file
+   * @return Status of the transaction
+   */
+  Status WriteFolded(const std::string &filename) const;
+
+  /**
+   * @brief Get the total energy attributed so far in joules
+   *
+   * @return double energy
+   */
+  double GetTotalEnergy() const noexcept;
+
+  /**
+   * @brief Clears the profile
+   */
+  void Clear() noexcept;
+
+ private:
+  /** Energy per folded stack */
+  SpaceSaving<std::string> stacks_;
+  /** Energy per function (self) */
+  SpaceSaving<std::string> self_;
+  /** Energy per function (including callees) */
+  SpaceSaving<std::string> inclusive_;
+};
+
+} /* namespace efimon */
+
+#endif /* INCLUDE_EFIMON_PERF_ENERGY_PROFILE_HPP_ */
@@ -0,0 +1,185 @@
+/**
+ * @file event-group.hpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Thin wrapper around perf_event_open for counting groups. A group
+ * is composed by a leader and followers that are scheduled together on the
+ * PMU, so they can be read in a single read() call
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#ifndef INCLUDE_EFIMON_PERF_EVENT_GROUP_HPP_
+#define INCLUDE_EFIMON_PERF_EVENT_GROUP_HPP_
+
+#include <linux/perf_event.h>
+
+#include <cstdint>
+#include <efimon/status.hpp>
+#include <vector>
+
+namespace efimon {
+
+/**
+ * @brief Counting group based on perf_event_open
+ *
+ * The first event added becomes the group leader. The followers are opened
+ * against the leader file descriptor. All the events are read at once by
+ * using PERF_FORMAT_GROUP, including the enabled and running times to correct
+ * the multiplexing when the PMU is overcommitted.
+ */
+class PerfEventGroup {
+ public:
+  /**
+   * @brief Values read from the group in a single read() call
+   */
+  struct Values {
+    /** Time in ns that the group has been enabled */
+    uint64_t time_enabled;
+    /** Time in ns that the group has been actually counting */
+    uint64_t time_running;
+    /** Raw counter values in the order the events were added. The events
+        that could not be opened are reported as zero */
+    std::vector<uint64_t> counters;
+  };
+
+  /**
+   * @brief Construct a new empty group
+   */
+  PerfEventGroup();
+
+  /**
+   * @brief Move constructor: the file descriptors are transferred
+   *
+   * @param group group to move from
+   */
+  PerfEventGroup(PerfEventGroup &&group) noexcept;
+
+  /**
+   * @brief Move assignment: the file descriptors are transferred
+   *
+   * @param group group to move from
+   * @return PerfEventGroup& this instance
+   */
+  PerfEventGroup &operator=(PerfEventGroup &&group) noexcept;
+
+  PerfEventGroup(const PerfEventGroup &) = delete;
+  PerfEventGroup &operator=(const PerfEventGroup &) = delete;
+
+  /**
+   * @brief Adds an event to the group. The first event is the leader
+   *
+   * It must be invoked before PerfEventGroup::Open()
+   *
+   * @param type event type (i.e. PERF_TYPE_HARDWARE)
+   * @param config event configuration (i.e. PERF_COUNT_HW_CPU_CYCLES)
+   * @param required if true, the group cannot be opened without this event.
+   * Otherwise, it is silently dropped when the PMU does not support it
+   * @return Status of the transaction
+   */
+  Status AddEvent(const uint32_t type, const uint64_t config,
+                  const bool required = true);
+
+  /**
+   * @brief Opens the group for a given task or CPU
+   *
+   * @param pid task to monitor. -1 for all the tasks (requires cpu >= 0)
+   * @param cpu CPU to monitor. -1 for any CPU (requires pid >= 0)
+   * @param inherit count also the tasks spawned after opening
+   * @return Status of the transaction
+   */
+  Status Open(const int pid, const int cpu, const bool inherit = false);
+
+  /**
+   * @brief Reads all the counters of the group with a single syscall
+   *
+   * @param values output values
+   * @return Status of the transaction
+   */
+  Status Read(Values &values);  // NOLINT
+
+  /**
+   * @brief Enables the whole group
+   *
+   * @return Status of the transaction
+   */
+  Status Enable();
+
+  /**
+   * @brief Disables the whole group
+   *
+   * @return Status of the transaction
+   */
+  Status Disable();
+
+  /**
+   * @brief Closes all the file descriptors. The event list is kept
+   */
+  void Close() noexcept;
+
+  /**
+   * @brief Checks if a given event is being counted
+   *
+   * @param index event index according to the insertion order
+   * @return true if the event was opened successfully
+   */
+  bool IsCounting(const uint index) const noexcept;
+
+  /**
+   * @brief Get the number of events added to the group
+   *
+   * @return number of events
+   */
+  uint GetNumEvents() const noexcept;
+
+  /**
+   * @brief Get the leader file descriptor
+   *
+   * @return file descriptor. -1 if not open
+   */
+  int GetLeader() const noexcept;
+
+  /**
+   * @brief Invokes the perf_event_open syscall
+   *
+   * @param attr event attributes
+   * @param pid task id
+   * @param cpu cpu id
+   * @param group_fd leader file descriptor or -1
+   * @param flags perf_event_open flags
+   * @return file descriptor or -1 in case of error (errno is set)
+   */
+  static int OpenEvent(struct perf_event_attr *attr, const int pid,
+                       const int cpu, const int group_fd,
+                       const unsigned long flags);  // NOLINT
+
+  /**
+   * @brief Destroy the group, closing the file descriptors
+   */
+  virtual ~PerfEventGroup();
+
+ private:
+  /** Event definition */
+  struct Event {
+    /** Event type */
+    uint32_t type;
+    /** Event config */
+    uint64_t config;
+    /** Required to open the group */
+    bool required;
+    /** File descriptor. -1 if not opened */
+    int fd;
+    /** Position within the group read buffer. -1 if not opened */
+    int position;
+  };
+
+  /** Events in insertion order */
+  std::vector<Event> events_;
+  /** Number of events opened in the group */
+  uint opened_;
+  /** Read buffer: nr, time_enabled, time_running, values... */
+  std::vector<uint64_t> buffer_;
+};
+
+} /* namespace efimon */
+
+#endif /* INCLUDE_EFIMON_PERF_EVENT_GROUP_HPP_ */
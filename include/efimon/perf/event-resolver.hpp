@@ -0,0 +1,85 @@
+/**
+ * @file event-resolver.hpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Resolves the named PMU events exported by the kernel in sysfs into
+ * perf_event_attr type and config
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#ifndef INCLUDE_EFIMON_PERF_EVENT_RESOLVER_HPP_
+#define INCLUDE_EFIMON_PERF_EVENT_RESOLVER_HPP_
+
+#include <cstdint>
+#include <efimon/status.hpp>
+#include <string>
+
+namespace efimon {
+
+/**
+ * @brief Resolver of the events listed in
+ * /sys/bus/event_source/devices/PMU/events
+ *
+ * Each event file holds terms such as "event=0x3c,umask=0x01". The bits
+ * of each term are placed according to /sys/bus/event_source/devices/PMU/
+ * format/TERM (i.e. "config:8-15"). Only the terms that land in the config
+ * field are supported, which covers the core PMU events.
+ */
+class PerfEventResolver {
+ public:
+  /**
+   * @brief Resolved event
+   */
+  struct Event {
+    /** PMU dynamic type (perf_event_attr::type) */
+    uint32_t type;
+    /** Encoded configuration (perf_event_attr::config) */
+    uint64_t config;
+    /** Scale to apply to the raw counts (1 if the PMU does not provide it) */
+    double scale;
+  };
+
+  /**
+   * @brief Resolves an event from a given PMU
+   *
+   * @param pmu PMU name (i.e. cpu)
+   * @param name event name (i.e. topdown-retiring)
+   * @param event output event
+   * @return Status of the transaction. Status::NOT_FOUND if the PMU does not
+   * export the event
+   */
+  static Status Resolve(const std::string &pmu, const std::string &name,
+                        Event &event);  // NOLINT
+
+  /**
+   * @brief Resolves an event from the core PMU
+   *
+   * @param name event name (i.e. topdown-retiring)
+   * @param event output event
+   * @return Status of the transaction
+   */
+  static Status Resolve(const std::string &name, Event &event);  // NOLINT
+
+  /**
+   * @brief Checks if the core PMU exports a given event
+   *
+   * @param name event name
+   * @return true if it is exported
+   */
+  static bool Exists(const std::string &name);
+
+  /**
+   * @brief Get the name of the core PMU
+   *
+   * It is "cpu" in most systems and "cpu_core" in hybrid ones, where the
+   * efficiency cores have their own PMU (not covered here)
+   *
+   * @return std::string PMU name. Empty if no core PMU is exported (i.e.
+   * virtual machines without vPMU)
+   */
+  static std::string GetCorePMU();
+};
+
+} /* namespace efimon */
+
+#endif /* INCLUDE_EFIMON_PERF_EVENT_RESOLVER_HPP_ */
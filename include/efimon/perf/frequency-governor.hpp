@@ -0,0 +1,106 @@
+/**
+ * @file frequency-governor.hpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Controller that adapts the sampling frequency to keep the cost of
+ * the profiler under an overhead budget
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#ifndef INCLUDE_EFIMON_PERF_FREQUENCY_GOVERNOR_HPP_
+#define INCLUDE_EFIMON_PERF_FREQUENCY_GOVERNOR_HPP_
+
+#include <cstdint>
+
+namespace efimon {
+
+/**
+ * @brief Sampling frequency controller
+ *
+ * Each control window, it receives the cost of the profiler (the CPU time
+ * consumed by the consumer of the samples over the wall time) and the
+ * symptoms of saturation (lost records and throttling). It follows an
+ * AIMD-like policy:
+ *
+ * - Lost records or throttling: the frequency is halved
+ * - Overhead above the budget: the frequency is scaled down proportionally
+ * - Overhead below half of the budget: the frequency grows by 25%
+ *
+ * The frequency never goes above the one requested nor below the minimum.
+ * A budget of zero disables the controller.
+ */
+class FrequencyGovernor {
+ public:
+  /** Minimum frequency in Hz */
+  static constexpr uint64_t kMinFrequency = 10;
+
+  FrequencyGovernor() = delete;
+
+  /**
+   * @brief Construct a new frequency governor
+   *
+   * @param frequency requested frequency in Hz. It is also the maximum
+   * @param budget overhead budget as a fraction of a core (i.e. 0.01 is 1%).
+   * 0 disables the controller
+   * @param min minimum frequency in Hz
+   */
+  FrequencyGovernor(const uint64_t frequency, const float budget,
+                    const uint64_t min = kMinFrequency);
+
+  /**
+   * @brief Computes the frequency for the next window
+   *
+   * @param cpu_time CPU time consumed by the profiler within the window in
+   * ns
+   * @param wall_time duration of the window in ns
+   * @param lost records lost within the window
+   * @param throttled throttling events within the window
+   * @return uint64_t frequency in Hz for the next window
+   */
+  uint64_t Update(const uint64_t cpu_time, const uint64_t wall_time,
+                  const uint64_t lost, const uint64_t throttled);
+
+  /**
+   * @brief Set the overhead budget
+   *
+   * @param budget fraction of a core. 0 disables the controller
+   */
+  void SetBudget(const float budget) noexcept;
+
+  /**
+   * @brief Get the overhead budget
+   *
+   * @return float fraction of a core
+   */
+  float GetBudget() const noexcept;
+
+  /**
+   * @brief Get the current frequency
+   *
+   * @return uint64_t frequency in Hz
+   */
+  uint64_t GetFrequency() const noexcept;
+
+  /**
+   * @brief Get the overhead measured in the last window
+   *
+   * @return float fraction of a core
+   */
+  float GetOverhead() const noexcept;
+
+ private:
+  /** Maximum frequency: the one requested */
+  uint64_t max_;
+  /** Minimum frequency */
+  uint64_t min_;
+  /** Current frequency */
+  uint64_t frequency_;
+  /** Overhead budget */
+  float budget_;
+  /** Last overhead measured */
+  float overhead_;
+};
+
+} /* namespace efimon */
+
+#endif /* INCLUDE_EFIMON_PERF_FREQUENCY_GOVERNOR_HPP_ */
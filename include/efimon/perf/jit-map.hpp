@@ -0,0 +1,143 @@
+/**
+ * @file jit-map.hpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Map of the code generated by JIT compilers, built from the perf map
+ * files and the jitdump records that managed runtimes emit
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#ifndef INCLUDE_EFIMON_PERF_JIT_MAP_HPP_
+#define INCLUDE_EFIMON_PERF_JIT_MAP_HPP_
+
+#include <cstdint>
+#include <efimon/status.hpp>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace efimon {
+
+/**
+ * @brief JIT code map of a process
+ *
+ * It tails /tmp/perf-PID.map (written by the JVM perf-map-agent, node
+ * --perf-basic-prof, Python -X perf and others) and the jitdump file
+ * (-XX:+DumpPerfMapAtExit, -Xjit:perfTool, ...) as they grow: every
+ * Refresh() only reads the new complete lines and records.
+ *
+ * The jitdump records carry the code bytes. For the perf map entries, the
+ * bytes are fetched from /proc/PID/mem the first time a region is looked up.
+ * The regions are disassembled once with objdump and kept until the runtime
+ * unmaps them (checked against /proc/PID/maps) or reuses their addresses.
+ */
+class JitCodeMap {
+ public:
+  /**
+   * @brief JIT-compiled region
+   */
+  struct Region {
+    /** Start address */
+    uint64_t start;
+    /** Size in bytes */
+    uint64_t size;
+    /** Symbol name given by the runtime */
+    std::string name;
+    /** Code bytes. Empty if not fetched yet */
+    std::vector<uint8_t> code;
+    /** Instructions: address to mnemonic and operands */
+    std::map<uint64_t, std::pair<std::string, std::string>> instructions;
+    /** The region was already disassembled (even if it failed) */
+    bool decoded;
+  };
+
+  JitCodeMap() = delete;
+
+  /**
+   * @brief Construct a new JIT code map for a process
+   *
+   * @param pid process ID
+   */
+  explicit JitCodeMap(const uint pid);
+
+  /**
+   * @brief Checks if a process exposes a perf map or a jitdump
+   *
+   * @param pid process ID
+   * @return true if any of them exists
+   */
+  static bool Exists(const uint pid);
+
+  /**
+   * @brief Reads the new entries and drops the regions that are not mapped
+   * anymore
+   *
+   * @return Status of the transaction
+   */
+  Status Refresh();
+
+  /**
+   * @brief Finds the region that contains an address
+   *
+   * @param ip address
+   * @return const Region* region or nullptr if it is not JIT code
+   */
+  const Region *Find(const uint64_t ip) const;
+
+  /**
+   * @brief Gets the instruction at a given address, disassembling its region
+   * if needed
+   *
+   * @param ip address
+   * @param mnemonic output mnemonic
+   * @param operands output operands (as printed by objdump)
+   * @return Status of the transaction. Status::NOT_FOUND if it is not JIT
+   * code
+   */
+  Status Lookup(const uint64_t ip, std::string &mnemonic,  // NOLINT
+                std::string &operands);                    // NOLINT
+
+  /**
+   * @brief Get the number of regions tracked
+   *
+   * @return std::size_t number of regions
+   */
+  std::size_t GetNumRegions() const noexcept;
+
+  /**
+   * @brief Get the process ID
+   *
+   * @return uint PID
+   */
+  uint GetPID() const noexcept;
+
+ private:
+  /** Process ID */
+  uint pid_;
+  /** Regions sorted by start address */
+  std::map<uint64_t, Region> regions_;
+  /** Bytes of the perf map already consumed */
+  uint64_t map_offset_;
+  /** Path to the jitdump file. Empty if not found yet */
+  std::string dump_path_;
+  /** Bytes of the jitdump already consumed */
+  uint64_t dump_offset_;
+
+  /** Adds a region, replacing the ones that overlap with it */
+  void Insert(Region &&region);
+  /** Reads the new lines of the perf map */
+  Status TailPerfMap();
+  /** Reads the new records of the jitdump */
+  Status TailJitDump();
+  /** Removes the regions that are not mapped anymore */
+  void DropUnmapped();
+  /** Fetches the code bytes from /proc/PID/mem */
+  Status FetchCode(Region &region);  // NOLINT
+  /** Disassembles the region */
+  Status Decode(Region &region);  // NOLINT
+};
+
+} /* namespace efimon */
+
+#endif /* INCLUDE_EFIMON_PERF_JIT_MAP_HPP_ */
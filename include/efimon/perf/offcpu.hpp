@@ -0,0 +1,335 @@
+/**
+ * @file offcpu.hpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Observer to profile where a process waits through the scheduler
+ * tracepoints
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#ifndef INCLUDE_EFIMON_PERF_OFFCPU_HPP_
+#define INCLUDE_EFIMON_PERF_OFFCPU_HPP_
+
+#include <linux/perf_event.h>
+
+#include <atomic>
+#include <cstddef>
+#include <efimon/observer-enums.hpp>
+#include <efimon/observer.hpp>
+#include <efimon/perf/ring-buffer.hpp>
+#include <efimon/perf/space-saving.hpp>
+#include <efimon/readings.hpp>
+#include <efimon/readings/offcpu-readings.hpp>
+#include <efimon/status.hpp>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+namespace efimon {
+
+/**
+ * @brief Observer class that measures the time that a process spends off the
+ * CPU and why
+ *
+ * It samples sched:sched_switch on the threads of the process (inherited by
+ * the new ones) with the call chain, so each switch-out carries the stack
+ * that blocked and the task state. The switch-in is taken from the
+ * PERF_RECORD_SWITCH records of the same events. sched:sched_wakeup fires
+ * in the context of the waker (other processes, interrupts, kworkers), so it
+ * is traced on every CPU and filtered by the threads off the CPU. It splits
+ * the interval into blocked and run-queue time. If the system-wide
+ * tracepoint is not permitted, there is no split: the whole interval is
+ * accounted as blocked and OffCPUReadings::wakeups is false.
+ *
+ * The reason is inferred from the task state and the kernel frames: D state
+ * and poll/socket/pipe waits are IO, futex waits are FUTEX, nanosleep is
+ * SLEEP and runnable tasks are PREEMPTED. The kernel frames need
+ * /proc/kallsyms to be readable; otherwise, the interruptible waits fall in
+ * OTHER.
+ *
+ * The stacks are weighted by the blocked time, like the reasons, and kept in
+ * a SpaceSaving sketch per window, so the memory is bounded regardless of
+ * the number of distinct stacks.
+ */
+class OffCPUObserver : public Observer {
+ public:
+  /** Default number of stacks monitored per window */
+  static constexpr std::size_t kDefaultCapacity = 1024;
+
+  OffCPUObserver() = delete;
+
+  /**
+   * @brief Construct a new off-CPU observer
+   *
+   * @param pid process id to attach to
+   * @param interval interval of how often the window is closed in
+   * milliseconds. 0 for manual query.
+   * @param capacity maximum number of stacks monitored per window
+   */
+  OffCPUObserver(const uint pid, const uint64_t interval = 0,
+                 const std::size_t capacity = kDefaultCapacity);
+
+  /**
+   * @brief Manually triggers the measurement in case that there is no interval
+   *
+   * It closes the current window
+   *
+   * @return Status of the transaction
+   */
+  Status Trigger() override;
+
+  /**
+   * @brief Get the Readings from the Observer
+   *
+   * Before reading it, the interval must be finished or the
+   * Observer::Trigger() method must be invoked before calling this method
+   *
+   * @return std::vector<Readings> vector of readings from the observer.
+   * The order will be 0: OffCPUReadings
+   */
+  std::vector<Readings*> GetReadings() override;
+
+  /**
+   * @brief Select the device to measure (not implemented)
+   *
+   * @param device device enumeration
+   * @return Status of the transaction
+   */
+  Status SelectDevice(const uint device) override;
+
+  /**
+   * @brief Set the Scope of the Observer instance
+   *
+   * Only ObserverScope::PROCESS is supported
+   *
+   * @param scope instance scope, if it is process-specific or system-wide
+   * @return Status of the transaction
+   */
+  Status SetScope(const ObserverScope scope) override;
+
+  /**
+   * @brief Set the process PID
+   *
+   * It reopens the tracepoints for the new process
+   *
+   * @param pid process ID
+   * @return Status of the transaction
+   */
+  Status SetPID(const uint pid) override;
+
+  /**
+   * @brief Get the Scope of the Observer instance
+   *
+   * @return scope of the instance
+   */
+  ObserverScope GetScope() const noexcept override;
+
+  /**
+   * @brief Get the process ID in case of a process-specific instance
+   *
+   * @return process ID
+   */
+  uint GetPID() const noexcept override;
+
+  /**
+   * @brief Get the Capabilities of the Observer instance
+   *
+   * @return vector of capabilities
+   */
+  const std::vector<ObserverCapabilities>& GetCapabilities() const
+      noexcept override;
+
+  /**
+   * @brief Get the Status of the Observer
+   *
+   * @return Status of the instance
+   */
+  Status GetStatus() override;
+
+  /**
+   * @brief Set the Interval in milliseconds
+   *
+   * It is informative: the window is closed by Trigger()
+   *
+   * @param interval time in milliseconds
+   * @return Status of the setting process
+   */
+  Status SetInterval(const uint64_t interval) override;
+
+  /**
+   * @brief Clear the interval
+   *
+   * Avoids the instance to be automatically refreshed
+   *
+   * @return Status
+   */
+  Status ClearInterval() override;
+
+  /**
+   * @brief Resets the instance
+   *
+   * The effect is quite similar to destroy and re-construct the instance
+   *
+   * @return Status
+   */
+  Status Reset() override;
+
+  /**
+   * @brief Destroy the Off-CPU Observer object
+   */
+  virtual ~OffCPUObserver();
+
+ private:
+  /** Off-CPU interval in progress of a thread */
+  struct ThreadState {
+    /** The thread is off the CPU */
+    bool off;
+    /** Windows closed since the switch-out */
+    uint windows;
+    /** Time of the switch-out in ns */
+    uint64_t out_time;
+    /** Time of the wake-up in ns. 0 if unknown */
+    uint64_t wake_time;
+    /** Time of the switch-in in ns. 0 if it is still off the CPU */
+    uint64_t in_time;
+    /** Reason of the switch-out */
+    OffCPUReason reason;
+    /** Folded stack of the switch-out */
+    std::string stack;
+  };
+
+  /** Executable mapping of the process */
+  struct Mapping {
+    /** Start address */
+    uint64_t start;
+    /** End address */
+    uint64_t end;
+    /** Offset within the file */
+    uint64_t offset;
+    /** Module name */
+    std::string name;
+  };
+
+  /** There are valid results */
+  bool valid_;
+  /** The reader thread is running */
+  std::atomic<bool> running_;
+  /** Reader thread */
+  std::thread reader_;
+  /** Event file descriptors */
+  std::vector<int> fds_;
+  /** Ring buffers: one per CPU */
+  std::vector<PerfRingBuffer> buffers_;
+  /** Tracepoint id of sched:sched_switch */
+  uint64_t switch_id_;
+  /** Tracepoint id of sched:sched_wakeup */
+  uint64_t wakeup_id_;
+  /** Offset of prev_comm within the sched_switch raw data */
+  uint prev_comm_offset_;
+  /** Offset of prev_state within the sched_switch raw data */
+  uint prev_state_offset_;
+  /** Offset of pid within the sched_wakeup raw data */
+  uint wakee_offset_;
+  /** The wake-ups are traced on every CPU */
+  bool wakeups_;
+
+  /** Mutex to protect the window */
+  std::mutex mutex_;
+  /** Threads of the process that are off the CPU */
+  std::unordered_map<uint32_t, ThreadState> threads_;
+  /** Threads switched in within the drain, waiting for their wake-up */
+  std::vector<uint32_t> pending_;
+  /** Executable mappings of the process */
+  std::vector<Mapping> maps_;
+  /** The mappings were already reloaded within the window */
+  bool maps_reloaded_;
+  /** Blocked time per stack in ns */
+  SpaceSaving<std::string> stacks_;
+  /** Blocked time per reason in ns */
+  std::unordered_map<OffCPUReason, uint64_t> blocked_;
+  /** Run-queue time in ns */
+  uint64_t runqueue_;
+  /** Switches within the window */
+  uint64_t switches_;
+  /** Records lost within the window */
+  uint64_t lost_;
+  /** Readings of the last closed window */
+  OffCPUReadings readings_;
+
+  /**
+   * @brief Opens the tracepoints on the threads of the process
+   *
+   * @return Status of the transaction
+   */
+  Status Open();
+
+  /**
+   * @brief Stops the reader and closes the events
+   */
+  void Close() noexcept;
+
+  /**
+   * @brief Drops the threads that exited while off the CPU
+   *
+   * Important: it depends on the lock given by Trigger()
+   */
+  void PruneThreads();
+
+  /**
+   * @brief Accounts the threads switched in within the drain
+   *
+   * The wake-up may be in the buffer of another CPU, drained after the
+   * switch-in. Important: it depends on the lock given by Reader()
+   */
+  void Settle();
+
+  /**
+   * @brief Accounts an off-CPU interval
+   *
+   * @param thread thread switched in
+   */
+  void Account(const ThreadState& thread);
+
+  /**
+   * @brief Reader thread: drains the ring buffers
+   */
+  void Reader();
+
+  /**
+   * @brief Processes a record of the ring buffer
+   *
+   * @param header record
+   */
+  void Process(const struct perf_event_header* header);
+
+  /**
+   * @brief Folds a call chain into a root-to-leaf stack
+   *
+   * @param comm name of the thread
+   * @param ips call chain from the leaf to the root
+   * @param nr number of entries of the call chain
+   * @param kernel output: kernel frames joined by ';' (for the reason)
+   * @return std::string folded stack
+   */
+  std::string FoldStack(const std::string& comm, const uint64_t* ips,
+                        const uint64_t nr, std::string& kernel);  // NOLINT
+
+  /**
+   * @brief Resolves a user address as module+offset
+   *
+   * @param ip address
+   * @return std::string symbol
+   */
+  std::string ResolveUser(const uint64_t ip);
+
+  /**
+   * @brief Loads the executable mappings of the process
+   */
+  void LoadMaps();
+};
+
+} /* namespace efimon */
+
+#endif /* INCLUDE_EFIMON_PERF_OFFCPU_HPP_ */
@@ -21,6 +21,8 @@ namespace efimon {
 struct RecordReadings : public Readings {
   /** Path to the perf data */
   std::string perf_data_path;
+  /** Sampling frequency used for the record in Hz */
+  uint64_t frequency;
   /** Destructor for overloading */
   virtual ~RecordReadings() = default;
 };
@@ -23,6 +23,7 @@ namespace efimon {
 
 /* Opaque linking for friendship */
 class PerfAnnotateObserver;
+class PerfCallgraphObserver;
 
 /**
  * @brief Observer class that executes and queries the perf record command
@@ -30,6 +31,10 @@ class PerfAnnotateObserver;
  * Gets information about the process in terms of performance, like
  * instructions execute, calls to other functions, and so on. This is a
  * built-in kernel friendly profiler.
+ *
+ * Each instance spawns its own perf process and records into its own
+ * temporary folder. For several consumers of the same process, prefer
+ * PerfSampleObserver, which shares a single sampling stream.
  */
 class PerfRecordObserver : public Observer {
  public:
@@ -163,6 +168,7 @@ class PerfRecordObserver : public Observer {
   virtual ~PerfRecordObserver();
 
   friend class PerfAnnotateObserver;
+  friend class PerfCallgraphObserver;
 
  private:
   /** There are valid results */
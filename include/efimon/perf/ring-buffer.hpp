@@ -0,0 +1,112 @@
+/**
+ * @file ring-buffer.hpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Consumer of the perf_event mmap ring buffer. The kernel produces
+ * the records and this class consumes them without any syscall
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#ifndef INCLUDE_EFIMON_PERF_RING_BUFFER_HPP_
+#define INCLUDE_EFIMON_PERF_RING_BUFFER_HPP_
+
+#include <linux/perf_event.h>
+
+#include <cstdint>
+#include <efimon/status.hpp>
+#include <functional>
+#include <vector>
+
+namespace efimon {
+
+/**
+ * @brief perf_event ring buffer consumer
+ *
+ * It maps the metadata page plus a power-of-two number of data pages of a
+ * sampling event. The records are consumed in place when they are contiguous
+ * and copied into a scratch buffer when they wrap around.
+ */
+class PerfRingBuffer {
+ public:
+  /**
+   * @brief Record handler: receives the header and the whole record
+   * (including the header). The pointer is only valid during the call
+   */
+  using Handler = std::function<void(const struct perf_event_header *)>;
+
+  /** Default number of data pages: 512 KiB with 4 KiB pages */
+  static constexpr uint kDefaultPages = 128;
+
+  /**
+   * @brief Construct a new unmapped ring buffer
+   */
+  PerfRingBuffer();
+
+  /**
+   * @brief Move constructor: the mapping is transferred
+   *
+   * @param rb ring buffer to move from
+   */
+  PerfRingBuffer(PerfRingBuffer &&rb) noexcept;
+
+  /**
+   * @brief Move assignment: the mapping is transferred
+   *
+   * @param rb ring buffer to move from
+   * @return PerfRingBuffer& this instance
+   */
+  PerfRingBuffer &operator=(PerfRingBuffer &&rb) noexcept;
+
+  PerfRingBuffer(const PerfRingBuffer &) = delete;
+  PerfRingBuffer &operator=(const PerfRingBuffer &) = delete;
+
+  /**
+   * @brief Maps the ring buffer of a sampling event
+   *
+   * @param fd file descriptor of the event
+   * @param pages number of data pages. It must be a power of two
+   * @return Status of the transaction
+   */
+  Status Map(const int fd, const uint pages = kDefaultPages);
+
+  /**
+   * @brief Unmaps the ring buffer
+   */
+  void Unmap() noexcept;
+
+  /**
+   * @brief Consumes all the records available
+   *
+   * @param handler function to invoke per record
+   * @return uint64_t number of records consumed
+   */
+  uint64_t Consume(const Handler &handler);
+
+  /**
+   * @brief Get the file descriptor of the event that owns the buffer
+   *
+   * @return int file descriptor. -1 if not mapped
+   */
+  int GetFd() const noexcept;
+
+  /**
+   * @brief Destroy the ring buffer, unmapping it
+   */
+  virtual ~PerfRingBuffer();
+
+ private:
+  /** Event file descriptor (borrowed) */
+  int fd_;
+  /** Mapped region: metadata page + data pages */
+  void *base_;
+  /** Size of the mapped region */
+  uint64_t length_;
+  /** Size of the data region */
+  uint64_t data_size_;
+  /** Scratch buffer for the records that wrap around */
+  std::vector<uint8_t> scratch_;
+};
+
+} /* namespace efimon */
+
+#endif /* INCLUDE_EFIMON_PERF_RING_BUFFER_HPP_ */
@@ -0,0 +1,180 @@
+/**
+ * @file sample-classifier.hpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Classifies the instruction pointers sampled from a process by
+ * decoding its machine code in-process
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#ifndef INCLUDE_EFIMON_PERF_SAMPLE_CLASSIFIER_HPP_
+#define INCLUDE_EFIMON_PERF_SAMPLE_CLASSIFIER_HPP_
+
+#include <array>
+#include <cstdint>
+#include <efimon/asm-classifier/elf-index.hpp>
+#include <efimon/asm-classifier/x86-decoder.hpp>
+#include <efimon/readings/instruction-readings.hpp>
+#include <efimon/status.hpp>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace efimon {
+
+/**
+ * @brief Classifier of the sampled instruction pointers of a process
+ *
+ * It reads the code bytes from /proc/PID/mem and decodes them with the
+ * x86Decoder, so neither perf record nor perf annotate nor objdump are
+ * involved. The pages read are kept and each instruction pointer is decoded
+ * once, so a window of samples costs a few syscalls and a hash lookup per
+ * distinct address.
+ *
+ * With an index directory, the addresses that belong to binaries indexed by
+ * efimon-index are translated to file offsets through /proc/PID/maps and
+ * looked up in the mapped ElfIndex instead. The code is only decoded when
+ * there is no index (i.e. JIT code or binaries not indexed).
+ *
+ * The code of a process may change (JIT, dlclose). Each window reads
+ * /proc/PID/maps again: the pages and instructions outside the executable
+ * file mappings (anonymous or JIT code) are dropped, and everything is
+ * dropped when the file mappings change. The caches are bounded and flushed
+ * when they are full.
+ */
+class SampleClassifier {
+ public:
+  /** Page size used to read the code */
+  static constexpr uint64_t kPageSize = 4096;
+  /** Maximum number of pages kept */
+  static constexpr std::size_t kMaxPages = 256;
+  /** Maximum number of decoded instruction pointers kept */
+  static constexpr std::size_t kMaxInstructions = 65536;
+
+  SampleClassifier() = delete;
+
+  /**
+   * @brief Construct a new sample classifier
+   *
+   * @param pid process ID whose memory contains the sampled code
+   */
+  explicit SampleClassifier(const uint pid);
+
+  /**
+   * @brief Decodes the instruction at a sampled address
+   *
+   * @param ip instruction pointer
+   * @param inst output instruction
+   * @return Status of the transaction. Status::FILE_ERROR if the address is
+   * not readable and Status::INVALID_PARAMETER if it cannot be decoded
+   */
+  Status Classify(const uint64_t ip, x86Instruction &inst);  // NOLINT
+
+  /**
+   * @brief Classifies a histogram of instruction pointers
+   *
+   * The readings are filled as PerfAnnotateObserver does: the percentages
+   * are relative to the total number of samples (including the ones that
+   * cannot be decoded) and the histogram is keyed by "mnemonic_optypes".
+   *
+   * @param ip_histogram number of samples per instruction pointer
+   * @param readings output readings. The previous contents are cleared
+   * @return Status of the transaction
+   */
+  Status Accumulate(const std::unordered_map<uint64_t, uint64_t> &ip_histogram,
+                    InstructionReadings &readings);  // NOLINT
+
+  /**
+   * @brief Sets the directory of the ElfIndex files
+   *
+   * @param directory directory with the build-id.efidx files. Empty to
+   * disable the indices
+   * @return Status of the transaction
+   */
+  Status SetIndexDirectory(const std::string &directory);
+
+  /**
+   * @brief Drops the pages, the mappings and the decoded instructions
+   */
+  void Clear();
+
+  /**
+   * @brief Get the process ID
+   *
+   * @return uint PID
+   */
+  uint GetPID() const noexcept;
+
+  /**
+   * @brief Destroy the sample classifier and close the process memory
+   */
+  ~SampleClassifier();
+
+ private:
+  /**
+   * @brief Code page of the process
+   */
+  struct Page {
+    /** Bytes of the page */
+    std::array<uint8_t, kPageSize> bytes;
+    /** Bytes that could be read. 0 if the page is not readable */
+    uint64_t size;
+  };
+
+  /**
+   * @brief Executable file mapping of the process
+   */
+  struct Mapping {
+    /** Start address */
+    uint64_t start;
+    /** End address (exclusive) */
+    uint64_t end;
+    /** File offset of the start address */
+    uint64_t offset;
+    /** Mapped file (device and inode) */
+    std::string file;
+    /** Index of the file. nullptr if it is not indexed */
+    std::shared_ptr<ElfIndex> index;
+  };
+
+  /** Process ID */
+  uint pid_;
+  /** Descriptor of /proc/PID/mem. -1 if it cannot be opened */
+  int fd_;
+  /** Decoder */
+  x86Decoder decoder_;
+  /** Pages read, by page address */
+  std::unordered_map<uint64_t, Page> pages_;
+  /** Decoded instructions per address within the file mappings */
+  std::unordered_map<uint64_t, x86Instruction> instructions_;
+  /** Decoded instructions per address outside the file mappings */
+  std::unordered_map<uint64_t, x86Instruction> anonymous_;
+  /** Directory of the indices. Empty if disabled */
+  std::string index_directory_;
+  /** Indices by mapped file (device and inode). nullptr if not indexed */
+  std::unordered_map<std::string, std::shared_ptr<ElfIndex>> indices_;
+  /** Executable file mappings sorted by address */
+  std::vector<Mapping> mappings_;
+  /** The mappings were read within the current window */
+  bool mappings_fresh_;
+
+  /** Reads (or finds) the page that contains an address */
+  const Page &Read(const uint64_t address);
+  /** Copies the code at an address, crossing to the next page if needed */
+  std::size_t Fetch(const uint64_t ip, uint8_t *buffer);
+  /** Reads the executable file mappings and opens their indices */
+  void ReadMappings();
+  /** Finds the file mapping that contains an address */
+  const Mapping *FindMapping(const uint64_t ip) const;
+  /** Drops the cached code that may have changed since the last window */
+  void Invalidate();
+  /** Keeps a decoded instruction */
+  void Keep(const uint64_t ip, const x86Instruction &inst);
+  /** Looks an address up in the indices */
+  bool FindIndexed(const uint64_t ip, x86Instruction &inst);  // NOLINT
+};
+
+} /* namespace efimon */
+
+#endif /* INCLUDE_EFIMON_PERF_SAMPLE_CLASSIFIER_HPP_ */
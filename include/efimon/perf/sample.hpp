@@ -0,0 +1,268 @@
+/**
+ * @file sample.hpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Observer that consumes the instruction samples of a shared
+ * perf_event sampling session
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#ifndef INCLUDE_EFIMON_PERF_SAMPLE_HPP_
+#define INCLUDE_EFIMON_PERF_SAMPLE_HPP_
+
+#include <efimon/observer-enums.hpp>
+#include <efimon/observer.hpp>
+#include <efimon/perf/sample-classifier.hpp>
+#include <efimon/perf/session.hpp>
+#include <efimon/readings.hpp>
+#include <efimon/readings/instruction-readings.hpp>
+#include <efimon/readings/sample-readings.hpp>
+#include <efimon/status.hpp>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+namespace efimon {
+
+/**
+ * @brief Observer class that builds windows of instruction samples
+ *
+ * It subscribes to the PerfSampleSession of the process (or the system)
+ * through the PerfSessionManager, so several observers share the same
+ * sampling stream. Each observer accumulates the samples between two
+ * Trigger() calls, so each one can have its own window length.
+ *
+ * With demultiplex enabled, a process-scoped observer subscribes to the
+ * system-wide session instead and only receives the samples of its PID. This
+ * way, monitoring hundreds of processes costs a single per-CPU stream.
+ *
+ * The session may adapt its frequency to an overhead budget. The readings
+ * carry the effective frequency of each window, so the sample counts can be
+ * normalised even if the frequency changed within the window.
+ *
+ * On x86-64, a process-scoped observer can also classify the sampled
+ * instructions by decoding the code of the process (see SampleClassifier),
+ * giving the same InstructionReadings as PerfAnnotateObserver without perf
+ * record or perf annotate.
+ */
+class PerfSampleObserver : public Observer, public PerfSampleSink {
+ public:
+  /** Default sampling frequency in Hz */
+  static constexpr uint64_t kDefaultFrequency = 1000;
+
+  PerfSampleObserver() = delete;
+
+  /**
+   * @brief Construct a new perf sample observer
+   *
+   * @param pid process id to attach to (ignored for ObserverScope::SYSTEM)
+   * @param scope ObserverScope::PROCESS or ObserverScope::SYSTEM
+   * @param interval interval of how often the window is closed in
+   * milliseconds. 0 for manual query.
+   * @param frequency sampling frequency in Hz. It only applies if the
+   * session does not exist yet
+   * @param demultiplex for ObserverScope::PROCESS, take the samples from the
+   * system-wide session filtered by PID instead of a per-process session
+   */
+  PerfSampleObserver(const uint pid, const ObserverScope scope,
+                     const uint64_t interval = 0,
+                     const uint64_t frequency = kDefaultFrequency,
+                     const bool demultiplex = false);
+
+  /**
+   * @brief Manually triggers the measurement in case that there is no interval
+   *
+   * @return Status of the transaction
+   */
+  Status Trigger() override;
+
+  /**
+   * @brief Get the Readings from the Observer
+   *
+   * Before reading it, the interval must be finished or the
+   * Observer::Trigger() method must be invoked before calling this method
+   *
+   * @return std::vector<Readings> vector of readings from the observer.
+   * The order will be 0: SampleReadings, 1: InstructionReadings (only with
+   * the classification enabled)
+   */
+  std::vector<Readings*> GetReadings() override;
+
+  /**
+   * @brief Select the device to measure (not implemented)
+   *
+   * @param device device enumeration
+   * @return Status of the transaction
+   */
+  Status SelectDevice(const uint device) override;
+
+  /**
+   * @brief Set the Scope of the Observer instance
+   *
+   * It moves the subscription to the session of the new scope
+   *
+   * @param scope instance scope, if it is process-specific or system-wide
+   * @return Status of the transaction
+   */
+  Status SetScope(const ObserverScope scope) override;
+
+  /**
+   * @brief Set the process PID in case that the scope is
+   * ObserverScope::PROCESS
+   *
+   * It moves the subscription to the session of the new process
+   *
+   * @param pid process ID
+   * @return Status of the transaction
+   */
+  Status SetPID(const uint pid) override;
+
+  /**
+   * @brief Get the Scope of the Observer instance
+   *
+   * @return scope of the instance
+   */
+  ObserverScope GetScope() const noexcept override;
+
+  /**
+   * @brief Get the process ID in case of a process-specific instance
+   *
+   * @return process ID
+   */
+  uint GetPID() const noexcept override;
+
+  /**
+   * @brief Get the Capabilities of the Observer instance
+   *
+   * @return vector of capabilities
+   */
+  const std::vector<ObserverCapabilities>& GetCapabilities() const
+      noexcept override;
+
+  /**
+   * @brief Get the Status of the Observer
+   *
+   * @return Status of the instance
+   */
+  Status GetStatus() override;
+
+  /**
+   * @brief Set the Interval in milliseconds
+   *
+   * It is informative: the window is closed by Trigger()
+   *
+   * @param interval time in milliseconds
+   * @return Status of the setting process
+   */
+  Status SetInterval(const uint64_t interval) override;
+
+  /**
+   * @brief Clear the interval
+   *
+   * Avoids the instance to be automatically refreshed
+   *
+   * @return Status
+   */
+  Status ClearInterval() override;
+
+  /**
+   * @brief Resets the instance
+   *
+   * The effect is quite similar to destroy and re-construct the instance
+   *
+   * @return Status
+   */
+  Status Reset() override;
+
+  /**
+   * @brief Set the overhead budget of the sampling session
+   *
+   * The session is shared: the budget applies to all its subscribers
+   *
+   * @param budget fraction of a core (i.e. 0.01 is 1%). 0 disables the
+   * adaptation
+   * @return Status of the transaction
+   */
+  Status SetOverheadBudget(const float budget);
+
+  /**
+   * @brief Enables the in-process classification of the samples
+   *
+   * It only applies to ObserverScope::PROCESS: the system-wide samples
+   * belong to several address spaces
+   *
+   * @param enable classify the samples of each window
+   * @return Status of the transaction. Status::NOT_IMPLEMENTED if the host
+   * is not x86-64
+   */
+  Status EnableClassification(const bool enable);
+
+  /**
+   * @brief Sets the directory of the efimon-index files used by the
+   * classification
+   *
+   * @param directory directory with the indices. Empty to decode the code
+   * of the process instead
+   * @return Status of the transaction
+   */
+  Status SetIndexDirectory(const std::string &directory);
+
+  /**
+   * @brief Receives the samples from the session
+   *
+   * @param samples batch of samples
+   * @param lost samples lost by the kernel since the last batch
+   */
+  void OnSamples(const std::vector<PerfSample> &samples,
+                 const uint64_t lost) override;
+
+  /**
+   * @brief Destroy the Perf Sample Observer object
+   */
+  virtual ~PerfSampleObserver();
+
+ private:
+  /** There are valid results */
+  bool valid_;
+  /** Observer scope */
+  ObserverScope scope_;
+  /** Sampling frequency requested */
+  uint64_t frequency_;
+  /** Take the samples from the system-wide session */
+  bool demultiplex_;
+  /** Shared sampling session */
+  std::shared_ptr<PerfSampleSession> session_;
+  /** Window being accumulated by the session reader */
+  SampleReadings window_;
+  /** Mutex to protect the window */
+  std::mutex window_mutex_;
+  /** Readings of the last closed window */
+  SampleReadings readings_;
+  /** Frequency integral of the session when the window was opened */
+  uint64_t frequency_integral_;
+  /** Classify the samples of each window */
+  bool classify_;
+  /** Decoder of the sampled code. Created on the first window */
+  std::unique_ptr<SampleClassifier> classifier_;
+  /** Directory of the efimon-index files. Empty if not used */
+  std::string index_directory_;
+  /** Classification of the last closed window */
+  InstructionReadings instructions_;
+
+  /**
+   * @brief Subscribes to the session according to the scope and PID
+   *
+   * @return Status of the transaction
+   */
+  Status Attach();
+
+  /**
+   * @brief Unsubscribes from the current session
+   */
+  void Detach();
+};
+
+} /* namespace efimon */
+
+#endif /* INCLUDE_EFIMON_PERF_SAMPLE_HPP_ */
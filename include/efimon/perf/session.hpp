@@ -0,0 +1,300 @@
+/**
+ * @file session.hpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Shared perf_event sampling sessions. A session owns the sampling
+ * stream of a process (or the whole system) and fans the samples out to
+ * any number of subscribers
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#ifndef INCLUDE_EFIMON_PERF_SESSION_HPP_
+#define INCLUDE_EFIMON_PERF_SESSION_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <efimon/observer-enums.hpp>
+#include <efimon/perf/frequency-governor.hpp>
+#include <efimon/perf/ring-buffer.hpp>
+#include <efimon/status.hpp>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+namespace efimon {
+
+/**
+ * @brief Sample decoded from the ring buffer
+ */
+struct PerfSample {
+  /** Instruction pointer */
+  uint64_t ip;
+  /** Process ID */
+  uint32_t pid;
+  /** Thread ID */
+  uint32_t tid;
+  /** Timestamp in ns (perf clock) */
+  uint64_t time;
+  /** CPU where the sample was taken */
+  uint32_t cpu;
+};
+
+/**
+ * @brief Interface of the consumers of a sampling session
+ */
+class PerfSampleSink {
+ public:
+  /**
+   * @brief Receives a batch of samples
+   *
+   * It is invoked from the reader thread of the session. It must be quick:
+   * copy or aggregate the samples and return
+   *
+   * @param samples batch of samples
+   * @param lost samples lost by the kernel since the last batch
+   */
+  virtual void OnSamples(const std::vector<PerfSample> &samples,
+                         const uint64_t lost) = 0;
+
+  /**
+   * @brief Destroy the sink
+   */
+  virtual ~PerfSampleSink() = default;
+};
+
+/**
+ * @brief Sampling stream of a process or of the whole system
+ *
+ * It samples the retired instructions at a given frequency (or the CPU clock
+ * if there is no PMU). For processes, there is an inherited event per thread
+ * and CPU. For the system, there is an event per CPU. In both cases, there is
+ * a ring buffer per CPU. A reader thread drains the ring buffers and forwards
+ * the samples to the subscribers, either the whole stream or only the samples
+ * of a given PID. Use PerfSessionManager to get a shared instance instead of
+ * constructing one.
+ *
+ * Optionally, the frequency adapts to an overhead budget through a
+ * FrequencyGovernor: every second, the reader measures its own CPU time (it
+ * includes the subscribers) and counts the lost records and the throttling
+ * events, and retunes the events with PERF_EVENT_IOC_PERIOD. The threads
+ * spawned before a change keep the frequency they inherited.
+ */
+class PerfSampleSession {
+ public:
+  PerfSampleSession() = delete;
+
+  /**
+   * @brief Construct a new sampling session and starts sampling
+   *
+   * @param pid process to sample (ignored for ObserverScope::SYSTEM)
+   * @param scope ObserverScope::PROCESS or ObserverScope::SYSTEM
+   * @param frequency sampling frequency in Hz
+   */
+  PerfSampleSession(const uint pid, const ObserverScope scope,
+                    const uint64_t frequency);
+
+  PerfSampleSession(const PerfSampleSession &) = delete;
+  PerfSampleSession &operator=(const PerfSampleSession &) = delete;
+
+  /**
+   * @brief Subscribes a sink to the stream
+   *
+   * @param sink consumer (borrowed). It must unsubscribe before dying
+   * @return Status of the transaction
+   */
+  Status Subscribe(PerfSampleSink *sink);
+
+  /**
+   * @brief Subscribes a sink to the samples of a single process
+   *
+   * Only valid for the system-wide session. The samples are routed to the
+   * sink according to their PID through a hash map, so the cost of the
+   * session does not depend on the number of processes monitored
+   *
+   * @param sink consumer (borrowed). It must unsubscribe before dying
+   * @param pid process whose samples are forwarded to the sink
+   * @return Status of the transaction
+   */
+  Status Subscribe(PerfSampleSink *sink, const uint pid);
+
+  /**
+   * @brief Unsubscribes a sink from the stream
+   *
+   * Once it returns, the sink does not receive more samples
+   *
+   * @param sink consumer
+   * @return Status of the transaction
+   */
+  Status Unsubscribe(PerfSampleSink *sink);
+
+  /**
+   * @brief Get the process ID of the session
+   *
+   * @return uint PID. 0 for the system-wide session
+   */
+  uint GetPID() const noexcept;
+
+  /**
+   * @brief Get the scope of the session
+   *
+   * @return ObserverScope scope
+   */
+  ObserverScope GetScope() const noexcept;
+
+  /**
+   * @brief Set the overhead budget of the session
+   *
+   * It is shared by all the subscribers: the last one wins
+   *
+   * @param budget fraction of a core (i.e. 0.01 is 1%). 0 disables the
+   * adaptation and keeps the current frequency
+   * @return Status of the transaction
+   */
+  Status SetOverheadBudget(const float budget);
+
+  /**
+   * @brief Get the overhead budget of the session
+   *
+   * @return float fraction of a core. 0 if disabled
+   */
+  float GetOverheadBudget();
+
+  /**
+   * @brief Get the overhead measured in the last control window
+   *
+   * @return float fraction of a core
+   */
+  float GetOverhead();
+
+  /**
+   * @brief Get the current sampling frequency
+   *
+   * @return uint64_t frequency in Hz
+   */
+  uint64_t GetFrequency() const noexcept;
+
+  /**
+   * @brief Get the integral of the frequency over time since the start
+   *
+   * The difference between two readings over the time elapsed gives the
+   * effective frequency of that interval, even if it changed in between
+   *
+   * @return uint64_t integral in Hz x ms
+   */
+  uint64_t GetFrequencyIntegral();
+
+  /**
+   * @brief Get the number of throttling events since the start
+   *
+   * @return uint64_t number of throttling events
+   */
+  uint64_t GetNumThrottled() const noexcept;
+
+  /**
+   * @brief Get the number of samples received since the start
+   *
+   * @return uint64_t number of samples
+   */
+  uint64_t GetNumSamples() const noexcept;
+
+  /**
+   * @brief Get the number of samples lost since the start
+   *
+   * @return uint64_t number of samples lost
+   */
+  uint64_t GetNumLost() const noexcept;
+
+  /**
+   * @brief Destroy the session: stops the reader and closes the events
+   */
+  virtual ~PerfSampleSession();
+
+ private:
+  /** Process ID */
+  uint pid_;
+  /** Session scope */
+  ObserverScope scope_;
+  /** Current sampling frequency */
+  std::atomic<uint64_t> frequency_;
+  /** The events sample the CPU clock because there is no PMU */
+  bool cpu_clock_;
+  /** Event file descriptors */
+  std::vector<int> fds_;
+  /** Ring buffers: one per event */
+  std::vector<PerfRingBuffer> buffers_;
+  /** Subscribers to the whole stream (borrowed) */
+  std::vector<PerfSampleSink *> sinks_;
+  /** Subscribers per PID (borrowed) */
+  std::unordered_map<uint32_t, std::vector<PerfSampleSink *>> routes_;
+  /** Batches of the subscribers per PID */
+  std::unordered_map<PerfSampleSink *, std::vector<PerfSample>> routed_;
+  /** Mutex to protect the subscribers */
+  std::mutex sinks_mutex_;
+  /** Reader running flag */
+  std::atomic<bool> running_;
+  /** Number of samples received */
+  std::atomic<uint64_t> samples_;
+  /** Number of samples lost */
+  std::atomic<uint64_t> lost_;
+  /** Number of throttling events */
+  std::atomic<uint64_t> throttled_;
+  /** Mutex to protect the frequency control */
+  std::mutex control_mutex_;
+  /** Frequency controller */
+  FrequencyGovernor governor_;
+  /** Integral of the frequency up to the last change in Hz x ms */
+  uint64_t frequency_integral_;
+  /** Time of the last frequency change in ms */
+  uint64_t frequency_since_;
+  /** Reader thread */
+  std::thread reader_;
+
+  /** Opens the sampling events and maps their buffers */
+  Status Open();
+  /** Closes the events */
+  void Close() noexcept;
+  /** Reader thread function */
+  void Reader();
+  /** Feeds the governor with the costs of a window and applies the result */
+  void Control(const uint64_t cpu_time, const uint64_t wall_time,
+               const uint64_t lost, const uint64_t throttled);
+};
+
+/**
+ * @brief Manager of the sampling sessions
+ *
+ * It keeps at most one session per PID and one system-wide session. The
+ * sessions are reference-counted: they live while any consumer holds them.
+ */
+class PerfSessionManager {
+ public:
+  /**
+   * @brief Gets the session of a process or the system. It is created if it
+   * does not exist
+   *
+   * If the session exists, it is shared regardless of the frequency
+   * requested, which only applies to the creation
+   *
+   * @param pid process ID (ignored for ObserverScope::SYSTEM)
+   * @param scope ObserverScope::PROCESS or ObserverScope::SYSTEM
+   * @param frequency sampling frequency in Hz
+   * @return std::shared_ptr<PerfSampleSession> shared session. It throws a
+   * Status if the session cannot be created
+   */
+  static std::shared_ptr<PerfSampleSession> Acquire(const uint pid,
+                                                    const ObserverScope scope,
+                                                    const uint64_t frequency);
+
+  /**
+   * @brief Get the number of sessions alive
+   *
+   * @return uint number of sessions
+   */
+  static uint GetNumSessions();
+};
+
+} /* namespace efimon */
+
+#endif /* INCLUDE_EFIMON_PERF_SESSION_HPP_ */
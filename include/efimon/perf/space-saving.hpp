@@ -0,0 +1,160 @@
+/**
+ * @file space-saving.hpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Weighted space-saving sketch to keep the top-K heaviest keys of a
+ * stream within a bounded amount of memory
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#ifndef INCLUDE_EFIMON_PERF_SPACE_SAVING_HPP_
+#define INCLUDE_EFIMON_PERF_SPACE_SAVING_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace efimon {
+
+/**
+ * @brief Weighted space-saving (Metwally et al.) heavy-hitter sketch
+ *
+ * It monitors at most capacity keys. When a new key arrives and the table is
+ * full, the lightest key is evicted and the newcomer inherits its weight as
+ * overestimation error. Any key whose real weight is above Total() / capacity
+ * is guaranteed to be in the table.
+ *
+ * @tparam Key type of the key. It must be hashable and copyable
+ * @tparam Hash hash functor of the key
+ */
+template <typename Key, typename Hash = std::hash<Key>>
+class SpaceSaving {
+ public:
+  /**
+   * @brief Monitored key
+   */
+  struct Entry {
+    /** Key */
+    Key key;
+    /** Estimated weight (upper bound of the real weight) */
+    double weight;
+    /** Maximum overestimation of the weight */
+    double error;
+  };
+
+  SpaceSaving() = delete;
+
+  /**
+   * @brief Construct a new sketch
+   *
+   * @param capacity maximum number of monitored keys
+   */
+  explicit SpaceSaving(const std::size_t capacity)
+      : capacity_{capacity > 0 ? capacity : 1}, total_{0.} {}
+
+  /**
+   * @brief Accounts a weight for a given key
+   *
+   * @param key key to account
+   * @param weight weight to add (must be non-negative)
+   */
+  void Add(const Key &key, const double weight = 1.) {
+    this->total_ += weight;
+
+    auto it = this->index_.find(key);
+    if (this->index_.end() != it) {
+      this->Bump(it->second, weight);
+      return;
+    }
+
+    if (this->index_.size() < this->capacity_) {
+      auto oit = this->order_.emplace(weight, Entry{key, weight, 0.});
+      this->index_.emplace(key, oit);
+      return;
+    }
+
+    /* Evict the lightest one and reuse its weight as error */
+    auto lightest = this->order_.begin();
+    const double floor = lightest->first;
+    this->index_.erase(lightest->second.key);
+    this->order_.erase(lightest);
+    auto oit =
+        this->order_.emplace(floor + weight, Entry{key, floor + weight, floor});
+    this->index_.emplace(key, oit);
+  }
+
+  /**
+   * @brief Get the heaviest keys sorted in descending weight
+   *
+   * @param k number of keys to return. 0 returns all the monitored ones
+   * @return std::vector<Entry> heaviest keys
+   */
+  std::vector<Entry> Top(const std::size_t k = 0) const {
+    std::vector<Entry> ret;
+    const std::size_t num = 0 == k ? this->order_.size()
+                                   : std::min(k, this->order_.size());
+    ret.reserve(num);
+    for (auto it = this->order_.rbegin();
+         it != this->order_.rend() && ret.size() < num; ++it) {
+      ret.push_back(it->second);
+    }
+    return ret;
+  }
+
+  /**
+   * @brief Get the number of monitored keys
+   *
+   * @return std::size_t number of keys
+   */
+  std::size_t Size() const noexcept { return this->index_.size(); }
+
+  /**
+   * @brief Get the maximum number of monitored keys
+   *
+   * @return std::size_t capacity
+   */
+  std::size_t Capacity() const noexcept { return this->capacity_; }
+
+  /**
+   * @brief Get the total weight accounted, including the evicted keys
+   *
+   * @return double total weight
+   */
+  double Total() const noexcept { return this->total_; }
+
+  /**
+   * @brief Removes all the keys
+   */
+  void Clear() noexcept {
+    this->index_.clear();
+    this->order_.clear();
+    this->total_ = 0.;
+  }
+
+ private:
+  using Order = std::multimap<double, Entry>;
+
+  /** Maximum number of monitored keys */
+  std::size_t capacity_;
+  /** Total weight accounted */
+  double total_;
+  /** Keys sorted by weight */
+  Order order_;
+  /** Key to its position within the order */
+  std::unordered_map<Key, typename Order::iterator, Hash> index_;
+
+  void Bump(typename Order::iterator &it, const double weight) {
+    auto node = this->order_.extract(it);
+    node.key() += weight;
+    node.mapped().weight += weight;
+    it = this->order_.insert(std::move(node));
+  }
+};
+
+} /* namespace efimon */
+
+#endif /* INCLUDE_EFIMON_PERF_SPACE_SAVING_HPP_ */
@@ -0,0 +1,270 @@
+/**
+ * @file topdown.hpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Observer to compute the top-down microarchitecture breakdown through
+ * perf_event_open counting groups
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#ifndef INCLUDE_EFIMON_PERF_TOPDOWN_HPP_
+#define INCLUDE_EFIMON_PERF_TOPDOWN_HPP_
+
+#include <efimon/observer-enums.hpp>
+#include <efimon/observer.hpp>
+#include <efimon/perf/event-group.hpp>
+#include <efimon/readings.hpp>
+#include <efimon/readings/topdown-readings.hpp>
+#include <efimon/status.hpp>
+#include <vector>
+
+namespace efimon {
+
+/**
+ * @brief Observer class that computes the top-down breakdown of the pipeline
+ * slots of a process or the whole system
+ *
+ * The events are picked at construction according to what the core PMU
+ * exports in sysfs:
+ *
+ * - PERF_METRICS: slots and topdown-{retiring,bad-spec,fe-bound,be-bound}
+ *   (Intel Ice Lake and newer). topdown-mem-bound adds level 2 when present.
+ * - SLOTS: topdown-{total-slots,slots-issued,slots-retired,fetch-bubbles,
+ *   recovery-bubbles} (Intel Skylake-era). Level 1 only.
+ * - GENERIC: cycles, stalled-cycles-{frontend,backend} and branch-misses
+ *   (AMD and most vPMUs). Level 1 approximated from the stalls, and only the
+ *   metrics whose events exist are computed.
+ *
+ * The groups are handled like in PerfCounterObserver: one per thread for
+ * processes and one per CPU for the system, scaled to compensate the
+ * multiplexing.
+ */
+class TopDownObserver : public Observer {
+ public:
+  /**
+   * @brief Event sources used to compute the metrics
+   */
+  enum class Source {
+    /** No usable events: the readings are always -1 */
+    NONE = 0,
+    /** Intel perf metrics: slots as leader */
+    PERF_METRICS,
+    /** Intel topdown slot events */
+    SLOTS,
+    /** Generic stall cycles */
+    GENERIC,
+  };
+
+  TopDownObserver() = delete;
+
+  /**
+   * @brief Construct a new top-down observer
+   *
+   * @param pid process id to attach to (ignored for ObserverScope::SYSTEM)
+   * @param scope ObserverScope::PROCESS or ObserverScope::SYSTEM
+   * @param interval interval of how often the counters are queried in
+   * milliseconds. 0 for manual query.
+   */
+  TopDownObserver(const uint pid, const ObserverScope scope,
+                  const uint64_t interval = 0);
+
+  /**
+   * @brief Manually triggers the measurement in case that there is no interval
+   *
+   * @return Status of the transaction
+   */
+  Status Trigger() override;
+
+  /**
+   * @brief Get the Readings from the Observer
+   *
+   * Before reading it, the interval must be finished or the
+   * Observer::Trigger() method must be invoked before calling this method
+   *
+   * @return std::vector<Readings> vector of readings from the observer.
+   * The order will be 0: TopDownReadings
+   */
+  std::vector<Readings*> GetReadings() override;
+
+  /**
+   * @brief Select the device to measure (not implemented)
+   *
+   * @param device device enumeration
+   * @return Status of the transaction
+   */
+  Status SelectDevice(const uint device) override;
+
+  /**
+   * @brief Set the Scope of the Observer instance
+   *
+   * It reopens the counting groups according to the new scope
+   *
+   * @param scope instance scope, if it is process-specific or system-wide
+   * @return Status of the transaction
+   */
+  Status SetScope(const ObserverScope scope) override;
+
+  /**
+   * @brief Set the process PID in case that the scope is
+   * ObserverScope::PROCESS
+   *
+   * It reopens the counting groups for the new process
+   *
+   * @param pid process ID
+   * @return Status of the transaction
+   */
+  Status SetPID(const uint pid) override;
+
+  /**
+   * @brief Get the Scope of the Observer instance
+   *
+   * @return scope of the instance
+   */
+  ObserverScope GetScope() const noexcept override;
+
+  /**
+   * @brief Get the process ID in case of a process-specific instance
+   *
+   * @return process ID
+   */
+  uint GetPID() const noexcept override;
+
+  /**
+   * @brief Get the Capabilities of the Observer instance
+   *
+   * @return vector of capabilities
+   */
+  const std::vector<ObserverCapabilities>& GetCapabilities() const
+      noexcept override;
+
+  /**
+   * @brief Get the Status of the Observer
+   *
+   * @return Status of the instance. Status::NOT_IMPLEMENTED if the PMU has
+   * no events for the analysis (Source::NONE)
+   */
+  Status GetStatus() override;
+
+  /**
+   * @brief Set the Interval in milliseconds
+   *
+   * Sets how often the observer will be refreshed
+   *
+   * @param interval time in milliseconds
+   * @return Status of the setting process
+   */
+  Status SetInterval(const uint64_t interval) override;
+
+  /**
+   * @brief Clear the interval
+   *
+   * Avoids the instance to be automatically refreshed
+   *
+   * @return Status
+   */
+  Status ClearInterval() override;
+
+  /**
+   * @brief Resets the instance
+   *
+   * The effect is quite similar to destroy and re-construct the instance
+   *
+   * @return Status
+   */
+  Status Reset() override;
+
+  /**
+   * @brief Get the source of the events used by the instance
+   *
+   * @return Source of the events
+   */
+  Source GetSource() const noexcept;
+
+  /**
+   * @brief Destroy the Top-Down Observer object
+   */
+  virtual ~TopDownObserver();
+
+ private:
+  /** Event definition resolved at construction */
+  struct Event {
+    /** PMU type */
+    uint32_t type;
+    /** PMU config */
+    uint64_t config;
+    /** Scale of the raw counts */
+    double scale;
+    /** Required to open the group */
+    bool required;
+  };
+
+  /** Event indices for Source::PERF_METRICS */
+  enum { PM_SLOTS = 0, PM_RETIRING, PM_BAD_SPEC, PM_FE, PM_BE, PM_MEM };
+  /** Event indices for Source::SLOTS */
+  enum {
+    SL_TOTAL = 0,
+    SL_ISSUED,
+    SL_RETIRED,
+    SL_FETCH_BUBBLES,
+    SL_RECOVERY_BUBBLES
+  };
+  /** Event indices for Source::GENERIC */
+  enum { GN_CYCLES = 0, GN_FE_STALLS, GN_BE_STALLS, GN_BRANCH_MISSES };
+
+  /** There are valid results */
+  bool valid_;
+  /** Observer scope */
+  ObserverScope scope_;
+  /** Source of the events */
+  Source source_;
+  /** Events to add to each group in order */
+  std::vector<Event> events_;
+  /** Counting groups: per thread or per CPU */
+  std::vector<PerfEventGroup> groups_;
+  /** Last raw values per group: used to compute the window deltas */
+  std::vector<PerfEventGroup::Values> last_values_;
+  /** Readings */
+  TopDownReadings readings_;
+
+  /**
+   * @brief Resolves the events of a given source
+   *
+   * @param source source to resolve
+   * @return true if the PMU exports all the required events
+   */
+  bool ResolveEvents(const Source source);
+
+  /**
+   * @brief Opens the counting groups according to the scope and PID
+   *
+   * The sources are tried from the most to the least accurate. If none of
+   * them can be opened, the instance remains with Source::NONE, which is
+   * not an error
+   *
+   * @return Status of the transaction
+   */
+  Status OpenGroups();
+
+  /**
+   * @brief Opens a group with the resolved events per task or CPU
+   *
+   * @param pids tasks to monitor
+   * @param cpus CPUs to monitor
+   * @return Status of the transaction
+   */
+  Status OpenSource(const std::vector<int>& pids,
+                    const std::vector<int>& cpus);
+
+  /**
+   * @brief Computes the metrics from the window counts
+   *
+   * @param counts scaled counts of the window in the order of events_
+   * @param counting whether each event could be opened
+   */
+  void ComputeMetrics(const std::vector<double>& counts,
+                      const std::vector<bool>& counting);
+};
+
+} /* namespace efimon */
+
+#endif /* INCLUDE_EFIMON_PERF_TOPDOWN_HPP_ */
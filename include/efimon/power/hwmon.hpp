@@ -0,0 +1,247 @@
+/**
+ * @file hwmon.hpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Hardware monitoring (hwmon) wrapper to read the fan, temperature,
+ * voltage, power and energy sensors exposed by the kernel drivers
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#ifndef INCLUDE_EFIMON_POWER_HWMON_HPP_
+#define INCLUDE_EFIMON_POWER_HWMON_HPP_
+
+#include <cstdint>
+#include <efimon/observer.hpp>
+#include <efimon/readings.hpp>
+#include <efimon/readings/electrical-readings.hpp>
+#include <efimon/readings/fan-readings.hpp>
+#include <efimon/readings/thermal-readings.hpp>
+#include <string>
+#include <vector>
+
+namespace efimon {
+
+/**
+ * @brief hwmon sensor channel (i.e. temp1_input)
+ */
+struct HwmonChannel {
+  /**
+   * @brief Kind of channel
+   */
+  enum class Type {
+    /** Fan speed in RPM (fanN_input) */
+    FAN = 0,
+    /** Temperature in millidegree Celsius (tempN_input) */
+    TEMPERATURE,
+    /** Voltage in mV (inN_input) */
+    VOLTAGE,
+    /** Power in uW (powerN_input) */
+    POWER,
+    /** Energy counter in uJ (energyN_input) */
+    ENERGY,
+  };
+
+  /** Kind of channel */
+  Type type;
+  /** Name of the chip (i.e. coretemp, k10temp, nct6775) */
+  std::string chip;
+  /** Label of the channel. The file prefix if the driver has no labels */
+  std::string label;
+  /** Channel number within its chip and type */
+  uint index;
+  /** Path of the input file */
+  std::string path;
+  /** Descriptor of the input file */
+  int fd;
+};
+
+/**
+ * @brief Observer class that wraps the hwmon interface and gets the fan
+ * speeds, temperatures, voltages, power and energy of the board sensors.
+ *
+ * The chips under /sys/class/hwmon are discovered once and the input file
+ * of every channel stays open. Each Trigger() reads all of them with
+ * pread(), a syscall per channel without allocations, so a full sweep takes
+ * microseconds and can be done every tick. Most drivers cache the values
+ * and refresh them at their own rate (usually 1-2 s for the Super I/O
+ * chips), so the readings may repeat when triggered faster.
+ *
+ * The channels are sorted by type, chip and number, and the readings keep
+ * that order. Use GetChannels() to know which sensor is which.
+ */
+class HwmonMeterObserver : public Observer {
+ public:
+  /** Root of the hwmon class */
+  static constexpr char kHwmonPath[] = "/sys/class/hwmon";
+
+  HwmonMeterObserver(const HwmonMeterObserver&) = delete;
+  HwmonMeterObserver& operator=(const HwmonMeterObserver&) = delete;
+
+  /**
+   * @brief Constructor for the hwmon Meter Observer
+   *
+   * It throws a Status::NOT_FOUND if there are no sensors
+   *
+   * @param pid process id to attach in (not taken at the moment)
+   * @param scope only ObserverScope::SYSTEM is valid
+   * @param interval interval of how often the profiler is queried in
+   * milliseconds. 0 for manual query.
+   * @param root root of the hwmon class. Empty for kHwmonPath
+   */
+  HwmonMeterObserver(const uint pid = 0,
+                     const ObserverScope = ObserverScope::SYSTEM,
+                     const uint64_t interval = 0, const std::string& root = "");
+
+  /**
+   * @brief Manually triggers the update in case that there is no interval
+   *
+   * @return Status of the transaction
+   */
+  Status Trigger() override;
+
+  /**
+   * @brief Get the Readings from the Observer
+   *
+   * Before reading it, the interval must be finished or the
+   * Observer::Trigger() method must be invoked before calling this method
+   *
+   * @return std::vector<Readings*> vector of readings from the observer.
+   * In this case, the Readings* can be dynamic-casted to:
+   *
+   * - 0: FanReadings. Fan speeds
+   * - 1: ThermalReadings. Temperatures
+   * - 2: ElectricalReadings. Voltages, power and energy
+   *
+   * The channels that could not be read in the last trigger are reported
+   * as -1 and left out of the averages
+   */
+  std::vector<Readings*> GetReadings() override;
+
+  /**
+   * @brief Select the device to measure (not implemented)
+   *
+   * @param device device enumeration
+   * @return Status of the transaction
+   */
+  Status SelectDevice(const uint device) override;
+
+  /**
+   * @brief Set the Scope of the Observer instance (not implemented)
+   *
+   * @param scope instance scope, if it is process-specific or system-wide
+   * @return Status of the transaction
+   */
+  Status SetScope(const ObserverScope scope) override;
+
+  /**
+   * @brief Set the process PID (not implemented)
+   *
+   * @param pid process ID
+   * @return Status of the transaction
+   */
+  Status SetPID(const uint pid) override;
+
+  /**
+   * @brief Get the Scope of the Observer instance
+   *
+   * @return scope of the instance
+   */
+  ObserverScope GetScope() const noexcept override;
+
+  /**
+   * @brief Get the process ID in case of a process-specific instance
+   *
+   * @return process ID
+   */
+  uint GetPID() const noexcept override;
+
+  /**
+   * @brief Get the Capabilities of the Observer instance
+   *
+   * @return vector of capabilities
+   */
+  const std::vector<ObserverCapabilities>& GetCapabilities() const
+      noexcept override;
+
+  /**
+   * @brief Get the Status of the Observer
+   *
+   * @return Status of the instance
+   */
+  Status GetStatus() override;
+
+  /**
+   * @brief Set the Interval in milliseconds
+   *
+   * Sets how often the observer will be refreshed
+   *
+   * @param interval time in milliseconds
+   * @return Status of the setting process
+   */
+  Status SetInterval(const uint64_t interval) override;
+
+  /**
+   * @brief Clear the interval
+   *
+   * Avoids the instance to be automatically refreshed
+   *
+   * @return Status
+   */
+  Status ClearInterval() override;
+
+  /**
+   * @brief Resets the instance
+   *
+   * The effect is quite similar to destroy and re-construct the instance
+   *
+   * @return Status
+   */
+  Status Reset() override;
+
+  /**
+   * @brief Get the channels in the order of the readings
+   *
+   * @return const std::vector<HwmonChannel>& channels
+   */
+  const std::vector<HwmonChannel>& GetChannels() const noexcept;
+
+  /**
+   * @brief Destroy the Observer and close the channels
+   */
+  virtual ~HwmonMeterObserver();
+
+ private:
+  /** If true, the instance has valid measurements */
+  bool valid_;
+  /** Channels of all the chips */
+  std::vector<HwmonChannel> channels_;
+  /** Raw values per channel: Before */
+  std::vector<int64_t> before_values_;
+  /** Raw values per channel: Current */
+  std::vector<int64_t> after_values_;
+  /** The channel could not be read in the last trigger */
+  std::vector<bool> failed_;
+  /** Readings from the fans */
+  FanReadings fan_readings_;
+  /** Readings from the temperature sensors */
+  ThermalReadings thermal_readings_;
+  /** Readings from the voltage, power and energy sensors */
+  ElectricalReadings electrical_readings_;
+
+  /**
+   * @brief Discovers the channels of a chip
+   *
+   * @param chip path of the chip (hwmonN or its device directory)
+   * @param name name of the chip
+   */
+  void DiscoverChip(const std::string& chip, const std::string& name);
+
+  /**
+   * @brief Fills the readings from the raw values
+   */
+  void ParseResults();
+};
+
+} /* namespace efimon */
+
+#endif  // INCLUDE_EFIMON_POWER_HWMON_HPP_
@@ -15,10 +15,16 @@
 #include <efimon/observer.hpp>
 #include <efimon/readings.hpp>
 #include <efimon/readings/cpu-readings.hpp>
+#include <memory>
 #include <vector>
 
 namespace efimon {
 
+/** Background collector of the PCM counters (shared by all the instances) */
+class PCMCollector;
+/** Snapshot of the PCM counters */
+struct PCMSnapshot;
+
 /**
  * @brief Observer class that wraps the Intel PCM and queries several
  * measurements such as Power Consumption in CPU, RAM, and Bandwidth.
@@ -28,16 +34,26 @@ namespace efimon {
  * - Power consumption: CPU, RAM
  * - DRAM and I/O bandwidth
  * - Memory Hiearchy: hits / misses
+ *
+ * PCM is programmed once per process. A collector thread shared by all the
+ * instances takes a snapshot of the counters every 100 ms, and lives while
+ * any instance does. Each instance keeps its own previous snapshot, so the
+ * instances can be triggered at different rates without affecting each
+ * other. Triggering copies the last snapshot, or takes a new one if this
+ * instance already has the last one.
  */
 class IntelMeterObserver : public Observer {
  public:
   IntelMeterObserver() = delete;
 
+  IntelMeterObserver(const IntelMeterObserver&) = delete;
+  IntelMeterObserver& operator=(const IntelMeterObserver&) = delete;
+
   /**
    * @brief Constructor for the Intel Meter Observer
    *
-   * If there is an existing instance of IntelMeterObserver, it works as a
-   * wrapper, behaving as a singleton class.
+   * The first instance programs PCM and starts the collector. It throws a
+   * Status if PCM cannot be programmed.
    *
    * @param pid process id to attach in (not taken at the moment)
    * @param scope only ObserverScope::SYSTEM is valid
@@ -161,12 +177,16 @@ class IntelMeterObserver : public Observer {
   bool valid_;
   /** Readings from CPU */
   CPUReadings readings_;
+  /** Shared collector */
+  std::shared_ptr<PCMCollector> collector_;
+  /** Snapshots of this instance: Before */
+  std::unique_ptr<PCMSnapshot> before_;
+  /** Snapshots of this instance: Current */
+  std::unique_ptr<PCMSnapshot> after_;
 
   /**
-   * @brief Parses the results of Intel PCM
-   *
-   * Important: it is not thread-safe and depends on the lock given by
-   * Trigger()
+   * @brief Parses the results of Intel PCM from the snapshots of this
+   * instance
    */
   void ParseResults();
 };
@@ -0,0 +1,170 @@
+/**
+ * @file ipmi-poller.hpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Asynchronous poller of the IPMI observer. A thread triggers it at
+ * its own rate and publishes the last PSU and fan readings in a lock-free
+ * snapshot
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#ifndef INCLUDE_EFIMON_POWER_IPMI_POLLER_HPP_
+#define INCLUDE_EFIMON_POWER_IPMI_POLLER_HPP_
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <efimon/observer.hpp>
+#include <efimon/readings/fan-readings.hpp>
+#include <efimon/readings/psu-readings.hpp>
+#include <efimon/status.hpp>
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+
+namespace efimon {
+
+/**
+ * @brief Poller of the IPMI observer
+ *
+ * The BMC takes from hundreds of milliseconds to seconds to answer, so the
+ * observer is triggered by a thread of its own, one acquisition after the
+ * other at most every period. Each acquisition is published in a snapshot
+ * guarded by a sequence number (seqlock): the thread is the only writer and
+ * the readers copy the snapshot without locks, retrying if it changed in
+ * the meantime. Hence, the consumers of other meters are never held up by
+ * the BMC latency.
+ *
+ * The timestamp of the readings is the uptime (ms) of the acquisition, so
+ * the consumers can tell how stale they are with GetAge().
+ */
+class IPMIPoller {
+ public:
+  /** Maximum number of PSUs held by the snapshot */
+  static constexpr uint kMaxPSUs = 16;
+  /** Maximum number of fans held by the snapshot */
+  static constexpr uint kMaxFans = 64;
+
+  IPMIPoller() = delete;
+  IPMIPoller(const IPMIPoller &) = delete;
+  IPMIPoller &operator=(const IPMIPoller &) = delete;
+
+  /**
+   * @brief Construct a new IPMI poller. The thread is not started
+   *
+   * The readings the observer already holds (i.e. the ones acquired by its
+   * constructor) are published, so GetReadings() has readings from the
+   * start, with the same PSUs and fans as the following acquisitions.
+   *
+   * @param meter IPMI observer. Its readings must be PSUReadings (0) and
+   * FanReadings (1)
+   * @param period minimum time between acquisitions in milliseconds
+   */
+  IPMIPoller(std::shared_ptr<Observer> meter, const uint64_t period);
+
+  /**
+   * @brief Starts the poller thread
+   *
+   * @return Status of the transaction
+   */
+  Status Start();
+
+  /**
+   * @brief Stops the poller thread. It waits for the acquisition in flight
+   *
+   * @return Status of the transaction
+   */
+  Status Stop();
+
+  /**
+   * @brief Copies the last readings published
+   *
+   * @param psu output PSU readings
+   * @param fan output fan readings
+   * @return Status of the transaction. Status::NOT_READY if the observer
+   * did not report PSU and fan readings yet
+   */
+  Status GetReadings(PSUReadings &psu, FanReadings &fan) const;  // NOLINT
+
+  /**
+   * @brief Get the age of the last readings published
+   *
+   * @return uint64_t milliseconds since the acquisition. UINT64_MAX if there
+   * are no readings yet
+   */
+  uint64_t GetAge() const noexcept;
+
+  /**
+   * @brief Get how long the last acquisition took
+   *
+   * @return uint64_t latency of the BMC in milliseconds
+   */
+  uint64_t GetLatency() const noexcept;
+
+  /**
+   * @brief Get the status of the last acquisition
+   *
+   * @return int Status::OK or the error code of the last Trigger()
+   */
+  int GetLastCode() const noexcept;
+
+  /**
+   * @brief Stop the thread and destroy the poller
+   */
+  ~IPMIPoller();
+
+ private:
+  /** IPMI observer */
+  std::shared_ptr<Observer> meter_;
+  /** Minimum time between acquisitions in ms */
+  uint64_t period_;
+  /** Sequence number: odd while being written */
+  std::atomic<uint64_t> sequence_;
+  /** Uptime of the acquisition in ms */
+  std::atomic<uint64_t> timestamp_;
+  /** Time since the previous acquisition in ms */
+  std::atomic<uint64_t> difference_;
+  /** Latency of the acquisition in ms */
+  std::atomic<uint64_t> latency_;
+  /** Status code of the acquisition */
+  std::atomic<int> code_;
+  /** Number of PSUs */
+  std::atomic<uint> num_psus_;
+  /** Power of all the PSUs in W */
+  std::atomic<float> overall_power_;
+  /** Energy of all the PSUs in J */
+  std::atomic<float> overall_energy_;
+  /** Power per PSU in W */
+  std::atomic<float> psu_power_[kMaxPSUs];
+  /** Rated power per PSU in W */
+  std::atomic<float> psu_max_power_[kMaxPSUs];
+  /** Energy per PSU in J */
+  std::atomic<float> psu_energy_[kMaxPSUs];
+  /** Platform power: current, minimum, maximum and average in W */
+  std::atomic<float> platform_power_[4];
+  /** Window of the platform power statistics in ms */
+  std::atomic<uint64_t> platform_window_;
+  /** Number of fans */
+  std::atomic<uint> num_fans_;
+  /** Average fan speed in RPM */
+  std::atomic<float> overall_speed_;
+  /** Speed per fan in RPM */
+  std::atomic<float> fan_speeds_[kMaxFans];
+  /** The thread is running */
+  std::atomic<bool> running_;
+  /** Mutex of the sleeps. It does not guard the snapshot */
+  std::mutex sleep_mutex_;
+  /** Wakes the thread up when stopping */
+  std::condition_variable wake_;
+  /** Poller thread */
+  std::thread poller_;
+
+  /** Body of the poller thread */
+  void Poller();
+  /** Publishes the readings of the observer */
+  void Publish(const Status &status, const uint64_t latency);
+};
+
+} /* namespace efimon */
+
+#endif  // INCLUDE_EFIMON_POWER_IPMI_POLLER_HPP_
@@ -0,0 +1,164 @@
+/**
+ * @file ipmi-session.hpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief In-band IPMI session based on libfreeipmi. It keeps the session
+ * and the SDR records open to read the power and fan sensors, and the DCMI
+ * platform power, without launching the FreeIPMI tools
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#ifndef INCLUDE_EFIMON_POWER_IPMI_SESSION_HPP_
+#define INCLUDE_EFIMON_POWER_IPMI_SESSION_HPP_
+
+#include <cstdint>
+#include <efimon/status.hpp>
+#include <string>
+#include <vector>
+
+/* Opaque contexts of libfreeipmi */
+struct ipmi_ctx;
+struct ipmi_sdr_ctx;
+struct ipmi_sensor_read_ctx;
+
+namespace efimon {
+
+/**
+ * @brief In-band IPMI session
+ *
+ * The BMC is opened once through the in-band driver (OpenIPMI, KCS, SSIF).
+ * The SDR repository is cached on disk and scanned once to keep the full
+ * records of the sensors in Watts and in RPM (fans). The sensors in Watts
+ * are told apart by the entity of the SDR: power supplies (0x0A), the
+ * whole system (system board, power unit or chassis) or other components.
+ * Read() then issues a Get Sensor Reading per sensor over the same session,
+ * with no process launches nor text parsing. If the BMC supports DCMI,
+ * ReadDCMI() gets the platform power statistics in a single command.
+ *
+ * It requires the library to be built with libfreeipmi (ENABLE_FREEIPMI).
+ * Otherwise, the constructor throws Status::NOT_IMPLEMENTED.
+ */
+class IPMISession {
+ public:
+  /**
+   * @brief IPMI sensor
+   */
+  struct Sensor {
+    /**
+     * @brief Kind of sensor
+     */
+    enum class Type {
+      /** Power in Watts of a component (i.e. processor or memory) */
+      POWER = 0,
+      /** Fan speed in RPM */
+      FAN,
+      /** Power in Watts of a power supply */
+      PSU,
+      /** Power in Watts of the whole system */
+      SYSTEM,
+    };
+
+    /** Kind of sensor */
+    Type type;
+    /** Name (SDR ID string) */
+    std::string name;
+    /** Entity ID of the SDR */
+    uint8_t entity;
+    /** Entity instance of the SDR (i.e. the PSU number) */
+    uint8_t instance;
+    /** Maximum reading of the sensor. -1 if the SDR does not define it */
+    double max_reading;
+    /** Full SDR record */
+    std::vector<uint8_t> record;
+  };
+
+  /**
+   * @brief DCMI system power statistics
+   */
+  struct DCMIPower {
+    /** Current power in Watts */
+    float current;
+    /** Minimum power over the window in Watts */
+    float minimum;
+    /** Maximum power over the window in Watts */
+    float maximum;
+    /** Average power over the window in Watts */
+    float average;
+    /** Window of the statistics in ms */
+    uint64_t window;
+  };
+
+  /**
+   * @brief Construct a new IPMI session
+   *
+   * It throws a Status if the BMC cannot be opened (i.e. no driver or no
+   * permissions), the SDR cache cannot be built or there are neither power
+   * nor fan sensors nor DCMI support
+   *
+   * @param cache path of the SDR cache. Empty for a file in the temporary
+   * directory
+   */
+  explicit IPMISession(const std::string &cache = "");
+  IPMISession(const IPMISession &) = delete;
+  IPMISession &operator=(const IPMISession &) = delete;
+
+  /**
+   * @brief Reads all the sensors over the open session
+   *
+   * @param readings output readings in the order of GetSensors(). It is -1
+   * for the sensors that cannot be read
+   * @return Status of the transaction
+   */
+  Status Read(std::vector<double> &readings);  // NOLINT
+
+  /**
+   * @brief Reads the platform power with a DCMI Get Power Reading command
+   *
+   * @param power output power statistics
+   * @return Status of the transaction. Status::NOT_IMPLEMENTED if the BMC
+   * does not support DCMI and Status::NOT_READY if the measurement is off
+   */
+  Status ReadDCMI(DCMIPower &power);  // NOLINT
+
+  /**
+   * @brief Get the sensors found in the SDR
+   *
+   * @return const std::vector<Sensor>& sensors
+   */
+  const std::vector<Sensor> &GetSensors() const noexcept;
+
+  /**
+   * @brief Checks if the BMC answers the DCMI power readings
+   *
+   * @return true if ReadDCMI() is supported
+   */
+  bool HasDCMI() const noexcept;
+
+  /**
+   * @brief Destroy the IPMI session
+   */
+  ~IPMISession();
+
+ private:
+  /** IPMI context (session) */
+  ipmi_ctx *ipmi_;
+  /** SDR context */
+  ipmi_sdr_ctx *sdr_;
+  /** Sensor reading context */
+  ipmi_sensor_read_ctx *sensor_read_;
+  /** Sensors in Watts and RPM */
+  std::vector<Sensor> sensors_;
+  /** The BMC supports the DCMI power readings */
+  bool dcmi_;
+
+  /** Opens the SDR cache, building it if needed */
+  Status OpenCache(const std::string &cache);
+  /** Scans the SDR for the sensors */
+  Status ScanSensors();
+  /** Releases the contexts */
+  void Close() noexcept;
+};
+
+} /* namespace efimon */
+
+#endif  // INCLUDE_EFIMON_POWER_IPMI_SESSION_HPP_
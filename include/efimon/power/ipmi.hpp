@@ -11,9 +11,11 @@
 #define INCLUDE_EFIMON_POWER_IPMI_HPP_
 
 #include <efimon/observer.hpp>
+#include <efimon/power/ipmi-session.hpp>
 #include <efimon/readings.hpp>
 #include <efimon/readings/fan-readings.hpp>
 #include <efimon/readings/psu-readings.hpp>
+#include <memory>
 #include <vector>
 
 namespace efimon {
@@ -22,6 +24,16 @@ namespace efimon {
  * @brief Observer class that wraps the IPMI interface and gets the
  * energy and fan speed in a granular and general overview.
  *
+ * When the library is built with libfreeipmi, the sensors in Watts and RPM
+ * are read through a persistent in-band IPMISession. Otherwise, or if the
+ * BMC cannot be opened that way, it falls back to the FreeIPMI tools
+ * (ipmi-oem for the Dell PSUs and ipmi-sensors for the fans).
+ *
+ * If the BMC supports DCMI, the platform power statistics (current, min,
+ * max and average over the BMC window) are read with a single command. The
+ * per-PSU queries are only issued when the PSUs are found. The overall
+ * power and energy come from the platform power, then from the system
+ * power sensor, and only from the sum of the PSUs when there is neither.
  */
 class IPMIMeterObserver : public Observer {
  public:
@@ -147,6 +159,20 @@ class IPMIMeterObserver : public Observer {
    */
   Status Reset() override;
 
+  /**
+   * @brief Checks if the sensors are read through the persistent session
+   *
+   * @return true if the IPMISession is in use, false for the FreeIPMI tools
+   */
+  bool HasSession() const noexcept;
+
+  /**
+   * @brief Checks if the platform power is read through DCMI
+   *
+   * @return true if the BMC supports the DCMI power readings
+   */
+  bool HasDCMI() const noexcept;
+
   /**
    * @brief Destroy the Observer
    */
@@ -165,6 +191,16 @@ class IPMIMeterObserver : public Observer {
   PSUReadings readings_;
   /** Readings from Fan speed*/
   FanReadings fan_readings_;
+  /** Persistent IPMI session. nullptr when using the FreeIPMI tools */
+  std::unique_ptr<IPMISession> session_;
+  /** Sensor readings of the session */
+  std::vector<double> session_values_;
+  /** Session sensors of the PSUs, one per PSU */
+  std::vector<std::size_t> psu_sensors_;
+  /** Session sensor of the system power. -1 if there is none */
+  int system_sensor_;
+  /** The BMC supports the DCMI power readings */
+  bool dcmi_;
 
   /**
    * @brief Parse the results
@@ -173,6 +209,13 @@ class IPMIMeterObserver : public Observer {
    */
   void ParseResults(const uint psu_id);
 
+  /**
+   * @brief Parses the overall power and integrates the overall energy
+   *
+   * @param power overall power in Watts
+   */
+  void ParseOverall(const float power);
+
   /**
    * @brief Gets info from the IPMI about PSUs
    */
@@ -189,6 +232,30 @@ class IPMIMeterObserver : public Observer {
    * @brief Gets the fan speed from IPMI
    */
   Status GetFanSpeed();
+
+  /**
+   * @brief Gets the PSUs from the sensors of the session
+   */
+  Status GetSessionInfo();
+
+  /**
+   * @brief Reads the power and fan sensors through the session
+   */
+  Status ReadSession();
+
+  /**
+   * @brief Gets the platform power with the ipmi-dcmi tool
+   *
+   * @param power output power statistics
+   */
+  Status GetDCMIPower(IPMISession::DCMIPower &power);  // NOLINT
+
+  /**
+   * @brief Parses the platform power into the readings
+   *
+   * @param power power statistics
+   */
+  void ParseDCMI(const IPMISession::DCMIPower &power);
 };
 
 } /* namespace efimon */
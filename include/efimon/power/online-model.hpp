@@ -0,0 +1,145 @@
+/**
+ * @file online-model.hpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Linear power model fitted online through recursive least squares.
+ * It relates the instruction-class mix of the processes with the measured
+ * power
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#ifndef INCLUDE_EFIMON_POWER_ONLINE_MODEL_HPP_
+#define INCLUDE_EFIMON_POWER_ONLINE_MODEL_HPP_
+
+#include <cstdint>
+#include <efimon/readings/instruction-readings.hpp>
+#include <efimon/status.hpp>
+#include <string>
+#include <vector>
+
+namespace efimon {
+
+/**
+ * @brief Online linear power model
+ *
+ * It fits power = sum(coefficient_i * feature_i) with recursive least squares
+ * and exponential forgetting, so the coefficients follow slow changes of the
+ * machine (i.e. temperature or frequency policies). The memory is constant:
+ * a covariance matrix of NxN and N coefficients, where N is the number of
+ * features.
+ *
+ * The helpers ClassMix() and ClassName() define the instruction-class
+ * features: one per (InstructionType, InstructionFamily) pair, which is the
+ * same granularity logged by the Probability* columns.
+ */
+class OnlinePowerModel {
+ public:
+  /** Default forgetting factor: ~200 windows of memory */
+  static constexpr double kDefaultForgetting = 0.995;
+  /** Default initial covariance: weak prior on the coefficients */
+  static constexpr double kDefaultCovariance = 1e4;
+
+  OnlinePowerModel() = delete;
+
+  /**
+   * @brief Construct a new online power model
+   *
+   * @param num_features number of features (including the bias if required)
+   * @param forgetting forgetting factor in (0, 1]. 1 means no forgetting
+   * @param covariance initial value of the covariance diagonal
+   */
+  explicit OnlinePowerModel(const uint num_features,
+                            const double forgetting = kDefaultForgetting,
+                            const double covariance = kDefaultCovariance);
+
+  /**
+   * @brief Updates the model with a new observation
+   *
+   * @param features feature vector of the window
+   * @param power measured power within the window in watts
+   * @return Status of the transaction
+   */
+  Status Update(const std::vector<double> &features, const double power);
+
+  /**
+   * @brief Predicts the power from a feature vector
+   *
+   * @param features feature vector
+   * @param power output power in watts
+   * @return Status of the transaction
+   */
+  Status Predict(const std::vector<double> &features,
+                 double &power) const;  // NOLINT
+
+  /**
+   * @brief Get the coefficients of the model
+   *
+   * @return const std::vector<double>& coefficients in watts per unit of
+   * feature
+   */
+  const std::vector<double> &GetCoefficients() const noexcept;
+
+  /**
+   * @brief Get the number of observations used to fit the model
+   *
+   * @return uint64_t number of updates
+   */
+  uint64_t GetNumUpdates() const noexcept;
+
+  /**
+   * @brief Get the number of features
+   *
+   * @return uint number of features
+   */
+  uint GetNumFeatures() const noexcept;
+
+  /**
+   * @brief Restarts the model from scratch
+   */
+  void Reset() noexcept;
+
+  /**
+   * @brief Get the number of instruction classes
+   *
+   * @return uint number of (type, family) pairs
+   */
+  static uint NumClasses() noexcept;
+
+  /**
+   * @brief Get the name of an instruction class
+   *
+   * @param index class index
+   * @return std::string type and family names concatenated (i.e.
+   * ScalarArithmetic)
+   */
+  static std::string ClassName(const uint index);
+
+  /**
+   * @brief Computes the instruction-class mix from the instruction readings
+   *
+   * @param readings instruction histogram of a window
+   * @return std::vector<double> fraction of the samples per class (sums up
+   * to 1 if the histogram is not empty)
+   */
+  static std::vector<double> ClassMix(const InstructionReadings &readings);
+
+ private:
+  /** Number of features */
+  uint num_features_;
+  /** Forgetting factor */
+  double forgetting_;
+  /** Initial covariance */
+  double covariance_;
+  /** Number of updates */
+  uint64_t updates_;
+  /** Coefficients */
+  std::vector<double> theta_;
+  /** Inverse correlation matrix (row-major NxN) */
+  std::vector<double> p_;
+  /** Scratch: P * x */
+  std::vector<double> px_;
+};
+
+} /* namespace efimon */
+
+#endif /* INCLUDE_EFIMON_POWER_ONLINE_MODEL_HPP_ */
@@ -0,0 +1,319 @@
+/**
+ * @file process-power.hpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Per-process power estimation. It attributes the power of the
+ * processor to the monitored processes according to the CPU time of their
+ * threads on each core
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#ifndef INCLUDE_EFIMON_POWER_PROCESS_POWER_HPP_
+#define INCLUDE_EFIMON_POWER_PROCESS_POWER_HPP_
+
+#include <cstdint>
+#include <efimon/observer.hpp>
+#include <efimon/readings.hpp>
+#include <efimon/readings/cpu-readings.hpp>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace efimon {
+
+/**
+ * @brief Observer class that estimates the power of processes
+ *
+ * It takes the power from a system-wide meter whose first readings are
+ * CPUReadings (i.e. RAPLMeterObserver or IntelMeterObserver) and splits it
+ * per logical CPU:
+ *
+ * - The per-core power (CPUReadings::core_power, i.e. the AMD per-core
+ * counters) is shared among the SMT siblings of the core by their busy time
+ * - The rest of the socket power (or all of it when there are no per-core
+ * counters) is shared among the CPUs of the socket by their busy time
+ *
+ * The idle model removes the idle power of each socket from the power to
+ * split, and decides how it is attributed (see IdleModel). Then, each
+ * process gets the power of each CPU in proportion to the CPU time that its
+ * threads spent there out of the busy time of that CPU. The CPU of a thread
+ * is the last one it ran on (the processor field of its stat), so the
+ * shorter the window the finer the attribution.
+ *
+ * Any number of processes are attributed in a single pass: /proc/stat and
+ * the meter readings are read once per Trigger(). The meter is not
+ * triggered by this observer, so it must be triggered by its owner at the
+ * same rate, right before.
+ */
+class ProcessPowerObserver : public Observer {
+ public:
+  /**
+   * @brief Model of the idle power
+   */
+  struct IdleModel {
+    /**
+     * @brief How the idle power is attributed
+     */
+    enum class Policy {
+      /** The processes only get the power above the idle power */
+      EXCLUDE = 0,
+      /** The processes also get the idle power in proportion to the share
+          of the socket capacity they use */
+      BY_CAPACITY,
+      /** The idle power is shared among the busy processes in proportion to
+          their share of the busy time */
+      BY_USAGE,
+    };
+
+    /** Idle power per socket in Watts */
+    float socket_power;
+    /** How the idle power is attributed */
+    Policy policy;
+  };
+
+  ProcessPowerObserver() = delete;
+
+  /**
+   * @brief Constructor for the Process Power Observer
+   *
+   * It throws a Status::INVALID_PARAMETER if the meter is not valid
+   *
+   * @param meter system-wide power observer. Its first readings must be
+   * CPUReadings with the socket and/or core power
+   * @param pid first process to monitor. 0 for none
+   * @param idle idle power model
+   * @param interval interval of how often the profiler is queried in
+   * milliseconds. 0 for manual query.
+   */
+  ProcessPowerObserver(std::shared_ptr<Observer> meter, const uint pid = 0,
+                       const IdleModel &idle = IdleModel{},
+                       const uint64_t interval = 0);
+
+  /**
+   * @brief Manually triggers the update in case that there is no interval
+   *
+   * @return Status of the transaction. Status::NOT_FOUND if any process is
+   * gone. The rest of them are still updated
+   */
+  Status Trigger() override;
+
+  /**
+   * @brief Get the Readings from the Observer
+   *
+   * Before reading it, the interval must be finished or the
+   * Observer::Trigger() method must be invoked before calling this method
+   *
+   * @return std::vector<Readings*> vector of readings from the observer.
+   * There is a CPUReadings per process in the order of GetPIDs(), with:
+   *
+   * - overall_power and overall_energy: estimated power (W) within the last
+   * window and energy (J) since the process was added
+   * - overall_usage: CPU usage of the process over the whole system (%)
+   * - core_power and core_usage: power above the idle power and usage (%)
+   * per logical CPU
+   * - socket_power and socket_energy: power and energy per socket, with the
+   * share of the idle power given by the idle model
+   */
+  std::vector<Readings *> GetReadings() override;
+
+  /**
+   * @brief Select the device to measure (not implemented)
+   *
+   * @param device device enumeration
+   * @return Status of the transaction
+   */
+  Status SelectDevice(const uint device) override;
+
+  /**
+   * @brief Set the Scope of the Observer instance
+   *
+   * @param scope only ObserverScope::PROCESS is valid
+   * @return Status of the transaction
+   */
+  Status SetScope(const ObserverScope scope) override;
+
+  /**
+   * @brief Monitors only the given process
+   *
+   * @param pid process ID
+   * @return Status of the transaction
+   */
+  Status SetPID(const uint pid) override;
+
+  /**
+   * @brief Get the Scope of the Observer instance
+   *
+   * @return scope of the instance
+   */
+  ObserverScope GetScope() const noexcept override;
+
+  /**
+   * @brief Get the first process monitored
+   *
+   * @return process ID. 0 if there are none
+   */
+  uint GetPID() const noexcept override;
+
+  /**
+   * @brief Get the Capabilities of the Observer instance
+   *
+   * @return vector of capabilities
+   */
+  const std::vector<ObserverCapabilities> &GetCapabilities() const
+      noexcept override;
+
+  /**
+   * @brief Get the Status of the Observer
+   *
+   * @return Status of the instance
+   */
+  Status GetStatus() override;
+
+  /**
+   * @brief Set the Interval in milliseconds
+   *
+   * Sets how often the observer will be refreshed
+   *
+   * @param interval time in milliseconds
+   * @return Status of the setting process
+   */
+  Status SetInterval(const uint64_t interval) override;
+
+  /**
+   * @brief Clear the interval
+   *
+   * Avoids the instance to be automatically refreshed
+   *
+   * @return Status
+   */
+  Status ClearInterval() override;
+
+  /**
+   * @brief Resets the instance
+   *
+   * The effect is quite similar to destroy and re-construct the instance
+   *
+   * @return Status
+   */
+  Status Reset() override;
+
+  /**
+   * @brief Adds a process to the monitored ones
+   *
+   * @param pid process ID
+   * @return Status of the transaction
+   */
+  Status AddPID(const uint pid);
+
+  /**
+   * @brief Removes a process from the monitored ones
+   *
+   * @param pid process ID
+   * @return Status of the transaction
+   */
+  Status RemovePID(const uint pid);
+
+  /**
+   * @brief Get the monitored processes in the order of the readings
+   *
+   * @return std::vector<uint> process IDs
+   */
+  std::vector<uint> GetPIDs() const;
+
+  /**
+   * @brief Copies the readings of a process
+   *
+   * @param pid process ID
+   * @param readings output readings
+   * @return Status of the transaction. Status::NOT_FOUND if the process is
+   * not monitored
+   */
+  Status GetProcessReadings(const uint pid,
+                            CPUReadings &readings) const;  // NOLINT
+
+  /**
+   * @brief Set the idle power model
+   *
+   * @param idle idle power model
+   * @return Status of the transaction
+   */
+  Status SetIdleModel(const IdleModel &idle);
+
+  /**
+   * @brief Get the idle power model
+   *
+   * @return const IdleModel& idle power model
+   */
+  const IdleModel &GetIdleModel() const noexcept;
+
+  /**
+   * @brief Destroy the Observer
+   */
+  virtual ~ProcessPowerObserver() = default;
+
+ private:
+  /**
+   * @brief State of a monitored process
+   */
+  struct Process {
+    /** Readings of the process */
+    CPUReadings readings;
+    /** Accumulated CPU ticks per thread */
+    std::unordered_map<int, uint64_t> threads;
+    /** CPU ticks per logical CPU within the window */
+    std::vector<uint64_t> ticks;
+    /** The process has a previous sample */
+    bool valid;
+  };
+
+  /** System-wide power meter */
+  std::shared_ptr<Observer> meter_;
+  /** Idle power model */
+  IdleModel idle_;
+  /** Number of logical CPUs */
+  uint cpus_;
+  /** Number of sockets */
+  uint sockets_;
+  /** Socket per logical CPU */
+  std::vector<uint> cpu_socket_;
+  /** Physical core (global index) per logical CPU */
+  std::vector<uint> cpu_core_;
+  /** Busy ticks per logical CPU: Before */
+  std::vector<uint64_t> before_busy_;
+  /** Busy ticks per logical CPU: Current */
+  std::vector<uint64_t> after_busy_;
+  /** Busy ticks per logical CPU within the window */
+  std::vector<uint64_t> busy_;
+  /** Busy ticks per socket within the window */
+  std::vector<uint64_t> socket_busy_;
+  /** Number of logical CPUs per socket */
+  std::vector<uint> socket_cpus_;
+  /** Power to attribute per logical CPU in W */
+  std::vector<double> cpu_power_;
+  /** Idle power per socket in W */
+  std::vector<double> idle_power_;
+  /** Monitored processes */
+  std::map<uint, Process> processes_;
+  /** Uptime of the last trigger in ms */
+  uint64_t timestamp_;
+  /** The busy ticks have a previous sample */
+  bool valid_;
+
+  /** Reads the CPU topology */
+  void ReadTopology();
+  /** Reads the busy ticks per logical CPU from /proc/stat */
+  Status ReadBusy();
+  /** Splits the meter power per logical CPU */
+  Status SplitPower();
+  /** Reads the threads of a process and accumulates their ticks per CPU */
+  Status ReadProcess(const uint pid, Process &process);  // NOLINT
+  /** Attributes the power to a process */
+  void Attribute(Process &process, const uint64_t window);  // NOLINT
+  /** Resets the readings of a process */
+  void ResetProcess(Process &process);  // NOLINT
+};
+
+} /* namespace efimon */
+
+#endif  // INCLUDE_EFIMON_POWER_PROCESS_POWER_HPP_
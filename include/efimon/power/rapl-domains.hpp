@@ -0,0 +1,200 @@
+/**
+ * @file rapl-domains.hpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Tree of RAPL domains exposed by the powercap interface, the
+ * amd_energy hwmon driver or the energy MSRs. It keeps the energy counters
+ * open to read them without reopening the files
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#ifndef INCLUDE_EFIMON_POWER_RAPL_DOMAINS_HPP_
+#define INCLUDE_EFIMON_POWER_RAPL_DOMAINS_HPP_
+
+#include <cstdint>
+#include <efimon/status.hpp>
+#include <string>
+#include <vector>
+
+namespace efimon {
+
+/**
+ * @brief RAPL domain (powercap zone)
+ */
+struct RAPLDomain {
+  /**
+   * @brief Kind of domain
+   */
+  enum class Type {
+    /** Whole socket */
+    PACKAGE = 0,
+    /** Cores of the socket (PP0) */
+    CORE,
+    /** Uncore of the socket, usually the integrated GPU (PP1) */
+    UNCORE,
+    /** Memory attached to the socket */
+    DRAM,
+    /** Whole platform (SoC and the rest of the board) */
+    PSYS,
+  };
+
+  /** Kind of domain */
+  Type type;
+  /** Socket of the domain. 0 for the platform */
+  uint socket;
+  /** Logical CPU of a per-core domain. -1 for the socket-wide domains */
+  int cpu;
+  /** Path of the powercap zone, the hwmon channel or the MSR device */
+  std::string path;
+  /** Range of the energy counter in uJ (it wraps around at this value) */
+  uint64_t max_energy;
+  /** Address of the MSR. 0 if the counter is a sysfs file in uJ */
+  uint32_t msr;
+  /** Energy unit of the MSR in uJ */
+  double unit;
+  /** Descriptor of the counter */
+  int fd;
+};
+
+/**
+ * @brief Tree of RAPL domains
+ *
+ * The domains are discovered once from one of these backends:
+ *
+ * - POWERCAP: intel-rapl:N zones for the packages and the platform, and
+ * intel-rapl:N:M for their core, uncore and DRAM subzones. Intel and the
+ * AMD processors supported by the kernel driver
+ * - AMD_ENERGY: amd_energy hwmon driver, with an energy counter per socket
+ * (Esocket) and per physical core (Ecore)
+ * - MSR: MSR_PKG_ENERGY_STAT and MSR_CORE_ENERGY_STAT of the AMD
+ * processors, read through the msr driver (/dev/cpu/N/msr). The units come
+ * from MSR_RAPL_PWR_UNIT
+ *
+ * With Backend::AUTO, the first backend exposing any domain is taken, so
+ * the same binary runs on Intel and AMD hosts. The energy counters stay
+ * open and are read with pread(), so each read is a single syscall per
+ * domain without allocations. All of them are reported in uJ, and the
+ * ranges of the counters never change and are read at discovery.
+ */
+class RAPLDomainTree {
+ public:
+  /** Root of the powercap interface */
+  static constexpr char kPowercapPath[] = "/sys/class/powercap";
+  /** Root of the hwmon interface */
+  static constexpr char kHwmonPath[] = "/sys/class/hwmon";
+  /** Root of the msr driver */
+  static constexpr char kMsrPath[] = "/dev/cpu";
+
+  /**
+   * @brief Source of the energy counters
+   */
+  enum class Backend {
+    /** Takes the first one available in the order below */
+    AUTO = 0,
+    /** Powercap interface (intel-rapl) */
+    POWERCAP,
+    /** amd_energy hwmon driver */
+    AMD_ENERGY,
+    /** AMD energy MSRs */
+    MSR,
+    /** No domains found */
+    NONE,
+  };
+
+  /**
+   * @brief Construct a new RAPL domain tree. It discovers the domains
+   *
+   * @param backend source of the counters
+   * @param root root of the interface of the backend. Empty for the default
+   * one (kPowercapPath, kHwmonPath or kMsrPath). It is ignored with
+   * Backend::AUTO
+   */
+  explicit RAPLDomainTree(const Backend backend = Backend::AUTO,
+                          const std::string &root = "");
+  RAPLDomainTree(const RAPLDomainTree &) = delete;
+  RAPLDomainTree &operator=(const RAPLDomainTree &) = delete;
+
+  /**
+   * @brief Reads the energy counter of a domain
+   *
+   * @param domain index of the domain within GetDomains()
+   * @param energy output energy in uJ (raw counter)
+   * @return Status of the transaction
+   */
+  Status Read(const std::size_t domain, uint64_t &energy) const;  // NOLINT
+
+  /**
+   * @brief Reads the energy counters of all the domains in one pass
+   *
+   * @param energies output energies in uJ (raw counters), in the order of
+   * GetDomains()
+   * @return Status of the transaction. The domains that cannot be read keep
+   * their previous value
+   */
+  Status Read(std::vector<uint64_t> &energies) const;  // NOLINT
+
+  /**
+   * @brief Get the domains discovered, sorted by socket and type
+   *
+   * @return const std::vector<RAPLDomain>& domains
+   */
+  const std::vector<RAPLDomain> &GetDomains() const noexcept;
+
+  /**
+   * @brief Get the number of sockets with a package domain
+   *
+   * @return uint number of sockets (highest socket + 1)
+   */
+  uint GetNumSockets() const noexcept;
+
+  /**
+   * @brief Get the backend the domains were discovered from
+   *
+   * @return Backend backend. Backend::NONE if there are no domains
+   */
+  Backend GetBackend() const noexcept;
+
+  /**
+   * @brief Converts the backend to string
+   *
+   * @param backend backend
+   * @return std::string name
+   */
+  static std::string BackendString(const Backend backend);
+
+  /**
+   * @brief Converts the type of domain to string
+   *
+   * @param type type of domain
+   * @return std::string name
+   */
+  static std::string TypeString(const RAPLDomain::Type type);
+
+  /**
+   * @brief Destroy the RAPL domain tree and close the counters
+   */
+  ~RAPLDomainTree();
+
+ private:
+  /** Domains discovered */
+  std::vector<RAPLDomain> domains_;
+  /** Number of sockets */
+  uint sockets_;
+  /** Backend of the domains */
+  Backend backend_;
+
+  /** Discovers the powercap zones */
+  void DiscoverPowercap(const std::string &root);
+  /** Discovers the amd_energy channels */
+  void DiscoverAmdEnergy(const std::string &root);
+  /** Discovers the AMD energy MSRs */
+  void DiscoverMsr(const std::string &root);
+  /** Adds a zone and its subzones */
+  void AddZone(const std::string &path, const bool top, const uint socket);
+  /** Adds a domain if its counter can be read. It takes the descriptor */
+  void AddDomain(RAPLDomain &domain);  // NOLINT
+};
+
+} /* namespace efimon */
+
+#endif  // INCLUDE_EFIMON_POWER_RAPL_DOMAINS_HPP_
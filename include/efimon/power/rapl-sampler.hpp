@@ -0,0 +1,190 @@
+/**
+ * @file rapl-sampler.hpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief High-frequency sampler of the RAPL domains. A thread reads the
+ * energy counters every few milliseconds and publishes them into a
+ * lock-free ring buffer
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#ifndef INCLUDE_EFIMON_POWER_RAPL_SAMPLER_HPP_
+#define INCLUDE_EFIMON_POWER_RAPL_SAMPLER_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <efimon/power/rapl-domains.hpp>
+#include <efimon/status.hpp>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+namespace efimon {
+
+/**
+ * @brief Sampler of the RAPL domains
+ *
+ * RAPL refreshes its counters about every millisecond. The sampler thread
+ * reads all the domains every period (1 to 10 ms) and unwraps the raw
+ * counters into 64-bit accumulators in uJ, which never wrap around. Each
+ * sample (CLOCK_MONOTONIC time and accumulated energy per domain) is
+ * published into a ring buffer with a single producer and any number of
+ * consumers. The consumers do not take the samples out: they read any
+ * window still held by the buffer, and a sequence number per slot tells
+ * them if the producer overwrote it meanwhile.
+ *
+ * Since the energy is accumulated, the energy of any [t0, t1] interval is
+ * the difference of the accumulators, interpolated at both ends. It does
+ * not depend on how often the consumers read.
+ */
+class RAPLSampler {
+ public:
+  /** Minimum period in milliseconds */
+  static constexpr uint64_t kMinPeriod = 1;
+  /** Maximum period in milliseconds */
+  static constexpr uint64_t kMaxPeriod = 10;
+  /** Default number of samples held: 16 s at 1 ms */
+  static constexpr std::size_t kDefaultCapacity = 16384;
+
+  /**
+   * @brief Sample of the RAPL domains
+   */
+  struct Sample {
+    /** CLOCK_MONOTONIC time in nanoseconds */
+    uint64_t time;
+    /** Accumulated energy per domain in uJ, in the order of GetDomains() */
+    std::vector<uint64_t> energy;
+  };
+
+  RAPLSampler() = delete;
+  RAPLSampler(const RAPLSampler &) = delete;
+  RAPLSampler &operator=(const RAPLSampler &) = delete;
+
+  /**
+   * @brief Construct a new RAPL sampler and start its thread
+   *
+   * It throws a Status if the period is out of range or there are no RAPL
+   * domains
+   *
+   * @param period sampling period in milliseconds (1 to 10)
+   * @param capacity number of samples held by the ring buffer. It is
+   * rounded up to a power of two
+   * @param backend source of the counters (see RAPLDomainTree)
+   * @param root root of the interface of the backend. Empty for the default
+   */
+  explicit RAPLSampler(
+      const uint64_t period, const std::size_t capacity = kDefaultCapacity,
+      const RAPLDomainTree::Backend backend = RAPLDomainTree::Backend::AUTO,
+      const std::string &root = "");
+
+  /**
+   * @brief Gets the current CLOCK_MONOTONIC time in the time base of the
+   * samples
+   *
+   * @return uint64_t time in nanoseconds
+   */
+  static uint64_t Now() noexcept;
+
+  /**
+   * @brief Get the number of samples published since the start. The last
+   * one has the index GetHead() - 1
+   *
+   * @return uint64_t number of samples
+   */
+  uint64_t GetHead() const noexcept;
+
+  /**
+   * @brief Reads a sample from the ring buffer
+   *
+   * @param index index of the sample (0 is the first one)
+   * @param sample output sample
+   * @return true if the sample is still held by the buffer
+   */
+  bool GetSample(const uint64_t index, Sample &sample) const;  // NOLINT
+
+  /**
+   * @brief Reads the last sample published
+   *
+   * @param sample output sample
+   * @return Status of the transaction. Status::NOT_READY if there is none
+   */
+  Status GetLatest(Sample &sample) const;  // NOLINT
+
+  /**
+   * @brief Computes the energy of each domain within an interval
+   *
+   * The accumulators are linearly interpolated at t0 and t1 between the
+   * samples around them
+   *
+   * @param t0 start of the interval (CLOCK_MONOTONIC ns)
+   * @param t1 end of the interval (CLOCK_MONOTONIC ns)
+   * @param energy output energy per domain in Joules
+   * @return Status of the transaction. Status::NOT_FOUND if t0 is older
+   * than the buffer and Status::NOT_READY if t1 is newer than the last
+   * sample
+   */
+  Status GetEnergy(const uint64_t t0, const uint64_t t1,
+                   std::vector<double> &energy) const;  // NOLINT
+
+  /**
+   * @brief Get the domains sampled
+   *
+   * @return const std::vector<RAPLDomain>& domains
+   */
+  const std::vector<RAPLDomain> &GetDomains() const noexcept;
+
+  /**
+   * @brief Get the number of sockets with a package domain
+   *
+   * @return uint number of sockets
+   */
+  uint GetNumSockets() const noexcept;
+
+  /**
+   * @brief Get the sampling period
+   *
+   * @return uint64_t period in milliseconds
+   */
+  uint64_t GetPeriod() const noexcept;
+
+  /**
+   * @brief Stop the thread and destroy the sampler
+   */
+  ~RAPLSampler();
+
+ private:
+  /** RAPL domains */
+  RAPLDomainTree tree_;
+  /** Sampling period in nanoseconds */
+  uint64_t period_;
+  /** Number of slots (power of two) */
+  std::size_t capacity_;
+  /** Number of domains per slot */
+  std::size_t domains_;
+  /** Sequence per slot: 2 * (index + 1) once the sample is complete */
+  std::unique_ptr<std::atomic<uint64_t>[]> sequences_;
+  /** Time per slot */
+  std::unique_ptr<std::atomic<uint64_t>[]> times_;
+  /** Accumulated energy per slot and domain */
+  std::unique_ptr<std::atomic<uint64_t>[]> energies_;
+  /** Number of samples published */
+  std::atomic<uint64_t> head_;
+  /** The thread is running */
+  std::atomic<bool> running_;
+  /** Sampler thread */
+  std::thread sampler_;
+
+  /** Body of the sampler thread */
+  void Sampler();
+  /** Publishes a sample into the ring buffer */
+  void Publish(const uint64_t time, const std::vector<uint64_t> &energy);
+  /** Reads the time of a sample. false if it was overwritten */
+  bool GetTime(const uint64_t index, uint64_t &time) const;  // NOLINT
+  /** Finds the last sample with time <= t */
+  bool Find(const uint64_t t, uint64_t &index) const;  // NOLINT
+};
+
+} /* namespace efimon */
+
+#endif  // INCLUDE_EFIMON_POWER_RAPL_SAMPLER_HPP_
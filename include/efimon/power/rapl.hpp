@@ -11,10 +11,16 @@
 #ifndef INCLUDE_EFIMON_POWER_RAPL_HPP_
 #define INCLUDE_EFIMON_POWER_RAPL_HPP_
 
+#include <cstdint>
 #include <efimon/observer.hpp>
+#include <efimon/power/rapl-domains.hpp>
+#include <efimon/power/rapl-sampler.hpp>
 #include <efimon/proc/cpuinfo.hpp>
 #include <efimon/readings.hpp>
 #include <efimon/readings/cpu-readings.hpp>
+#include <efimon/readings/ram-readings.hpp>
+#include <efimon/readings/rapl-readings.hpp>
+#include <memory>
 #include <vector>
 
 namespace efimon {
@@ -23,6 +29,16 @@ namespace efimon {
  * @brief Observer class that wraps the RAPL interface and gets the
  * energy in a granular and general overview.
  *
+ * The domains (package, core, uncore, DRAM and psys) are discovered once by
+ * the RAPLDomainTree, whose energy counters stay open. Each Trigger() reads
+ * all of them in one pass and integrates the raw counters in uJ, handling
+ * their wrap-around. The backend is chosen at runtime: powercap, or the
+ * amd_energy driver or the energy MSRs on AMD hosts without it. The
+ * per-core counters of AMD are also reported in CPUReadings::core_power.
+ *
+ * With the sampler enabled, a RAPLSampler reads the domains every few
+ * milliseconds and each Trigger() takes the energy between the last samples
+ * of two consecutive triggers, so the windows are exact and contiguous.
  */
 class RAPLMeterObserver : public Observer {
  public:
@@ -54,11 +70,12 @@ class RAPLMeterObserver : public Observer {
    * @return std::vector<Readings*> vector of readings from the observer.
    * In this case, the Readings* can be dynamic-casted to:
    *
-   * - CPUReadings. The metrics here corresponds to the power measurements
-   * from RAPL. Usage metrics are not present. Please, use the power and
-   * energy metrics only
-   *
-   * More to be defined during the way
+   * - 0: CPUReadings. The metrics here corresponds to the power
+   * measurements from RAPL (package domains). Usage metrics are not present.
+   * Please, use the power and energy metrics only
+   * - 1: RAMReadings. Only the power of the DRAM domains (overall_power) is
+   * present. It is -1 if the platform does not expose them
+   * - 2: RAPLReadings. Power and energy of every domain per socket
    */
   std::vector<Readings*> GetReadings() override;
 
@@ -147,6 +164,29 @@ class RAPLMeterObserver : public Observer {
    */
   Status Reset() override;
 
+  /**
+   * @brief Enables the high-frequency sampler of the domains
+   *
+   * @param period sampling period in milliseconds (1 to 10). 0 disables the
+   * sampler and goes back to reading the counters on each Trigger()
+   * @return Status of the transaction
+   */
+  Status EnableSampler(const uint64_t period);
+
+  /**
+   * @brief Get the backend of the energy counters
+   *
+   * @return RAPLDomainTree::Backend backend in use
+   */
+  RAPLDomainTree::Backend GetBackend() const noexcept;
+
+  /**
+   * @brief Get the sampler to compute the energy of arbitrary intervals
+   *
+   * @return const RAPLSampler* sampler or nullptr if it is not enabled
+   */
+  const RAPLSampler* GetSampler() const noexcept;
+
   /**
    * @brief Destroy the Observer
    */
@@ -159,28 +199,33 @@ class RAPLMeterObserver : public Observer {
   bool valid_;
   /** Socket device */
   uint device_;
-  /** Socket energy meters: Before */
-  std::vector<double> before_socket_meters_;
-  /** Socket energy meters: Current */
-  std::vector<double> after_socket_meters_;
-  /** Socket energy meters: Maximum Range */
-  std::vector<double> max_socket_meters_;
+  /** RAPL domains */
+  RAPLDomainTree tree_;
+  /** Number of sockets reported */
+  uint sockets_;
+  /** Energy counters per domain in uJ: Before */
+  std::vector<uint64_t> before_meters_;
+  /** Energy counters per domain in uJ: Current */
+  std::vector<uint64_t> after_meters_;
   /** Readings from CPU */
   CPUReadings readings_;
+  /** Readings from the DRAM */
+  RAMReadings ram_readings_;
+  /** Readings per domain */
+  RAPLReadings rapl_readings_;
+  /** High-frequency sampler. nullptr if disabled */
+  std::unique_ptr<RAPLSampler> sampler_;
+  /** Last sample taken from the sampler */
+  RAPLSampler::Sample last_sample_;
 
   /**
-   * @brief Get the Socket Consumption
-   *
-   * @param socket_id socket identifier
-   */
-  Status GetSocketConsumption(const uint socket_id);
-
-  /**
-   * @brief Parse the results
+   * @brief Fills the readings with the energy of the domains
    *
-   * @param socket_id socket identifier
+   * @param energies energy per domain within the window in Joules
+   * @param interval length of the window in milliseconds
    */
-  void ParseResults(const uint socket_id);
+  void ParseResults(const std::vector<double>& energies,
+                    const double interval);
 };
 
 } /* namespace efimon */
@@ -0,0 +1,37 @@
+/**
+ * @file callgraph-readings.hpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Container interface to hold the folded call stacks sampled within a
+ * window
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#ifndef INCLUDE_EFIMON_READINGS_CALLGRAPH_READINGS_HPP_
+#define INCLUDE_EFIMON_READINGS_CALLGRAPH_READINGS_HPP_
+
+#include <cstdint>
+#include <efimon/readings.hpp>
+#include <string>
+#include <unordered_map>
+
+namespace efimon {
+
+/**
+ * @brief Readings specific to call graph sampling
+ *
+ * The stacks are folded from the root to the leaf, separated by ';' (the
+ * format used by the flame graphs)
+ */
+struct CallgraphReadings : public Readings {
+  /** Number of samples per folded stack */
+  std::unordered_map<std::string, uint64_t> stacks;
+  /** Total number of samples within the window */
+  uint64_t samples;
+  /** Destructor to enable the inheritance */
+  virtual ~CallgraphReadings() = default;
+};
+
+} /* namespace efimon */
+
+#endif /* INCLUDE_EFIMON_READINGS_CALLGRAPH_READINGS_HPP_ */
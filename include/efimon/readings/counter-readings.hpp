@@ -0,0 +1,48 @@
+/**
+ * @file counter-readings.hpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Container interface to hold the metering readings about the
+ * hardware performance counters
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#ifndef INCLUDE_EFIMON_READINGS_COUNTER_READINGS_HPP_
+#define INCLUDE_EFIMON_READINGS_COUNTER_READINGS_HPP_
+
+#include <cstdint>
+#include <efimon/readings.hpp>
+
+namespace efimon {
+
+/**
+ * @brief Readings specific to hardware performance counters
+ *
+ * The counts correspond to the last window and are already scaled to
+ * compensate the PMU multiplexing
+ */
+struct CounterReadings : public Readings {
+  /** CPU cycles within the window */
+  uint64_t cycles;
+  /** Retired instructions within the window */
+  uint64_t instructions;
+  /** Last-level cache misses within the window */
+  uint64_t cache_misses;
+  /** Branch mispredictions within the window */
+  uint64_t branch_misses;
+  /** Instructions per cycle */
+  float ipc;
+  /** Cache misses per kilo-instruction */
+  float cache_mpki;
+  /** Branch misses per kilo-instruction */
+  float branch_mpki;
+  /** Fraction of the window where the counters were actually scheduled in
+      the PMU (1: no multiplexing) */
+  float running_ratio;
+  /** Destructor to enable the inheritance */
+  virtual ~CounterReadings() = default;
+};
+
+} /* namespace efimon */
+
+#endif /* INCLUDE_EFIMON_READINGS_COUNTER_READINGS_HPP_ */
@@ -23,8 +23,8 @@ struct CPUReadings : public Readings {
   float overall_usage;
   /** Average power of all the cores */
   float overall_power;
-  /** Average energy of all the cores */
-  float overall_energy;
+  /** Average energy of all the cores. Double: it accumulates for long */
+  double overall_energy;
   /** Usage per core */
   std::vector<float> core_usage;
   /** Usage per socket */
@@ -34,9 +34,9 @@ struct CPUReadings : public Readings {
   /** Power per socket */
   std::vector<float> socket_power;
   /** Energy per core */
-  std::vector<float> core_energy;
+  std::vector<double> core_energy;
   /** Energy per socket */
-  std::vector<float> socket_energy;
+  std::vector<double> socket_energy;
   /** Frequency per socket */
   std::vector<float> socket_frequency;
   /** Frequency per socket */
@@ -0,0 +1,36 @@
+/**
+ * @file electrical-readings.hpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Container interface to hold the metering readings (voltage, power
+ * and energy sensors)
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#ifndef INCLUDE_EFIMON_READINGS_ELECTRICAL_READINGS_HPP_
+#define INCLUDE_EFIMON_READINGS_ELECTRICAL_READINGS_HPP_
+
+#include <cstdint>
+#include <efimon/readings.hpp>
+#include <vector>
+
+namespace efimon {
+
+/**
+ * @brief Readings specific to the voltage, power and energy sensors of the
+ * board
+ */
+struct ElectricalReadings : public Readings {
+  /** Voltage per sensor in Volts */
+  std::vector<float> voltages;
+  /** Power per sensor in Watts */
+  std::vector<float> power;
+  /** Energy per sensor since the last reset in Joules */
+  std::vector<double> energy;
+  /** Destructor to enable the inheritance */
+  virtual ~ElectricalReadings() = default;
+};
+
+} /* namespace efimon */
+
+#endif /* INCLUDE_EFIMON_READINGS_ELECTRICAL_READINGS_HPP_ */
@@ -32,6 +32,12 @@ struct InstructionReadings : public Readings {
   /** Contains the same information as above but containerised by
       instruction */
   std::unordered_map<std::string, float> histogram;
+  /** Probability of the SIMD instructions per register width */
+  std::unordered_map<assembly::VectorWidth, float> vector_width;
+  /** Probability of the SIMD instructions per element type */
+  std::unordered_map<assembly::ElementType, float> element_type;
+  /** Probability of the SIMD instructions per packing */
+  std::unordered_map<assembly::VectorPacking, float> vector_packing;
   /** Destructor to enable the inheritance */
   virtual ~InstructionReadings() = default;
 };
@@ -0,0 +1,65 @@
+/**
+ * @file offcpu-readings.hpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Container interface to hold the metering readings about the time
+ * that a process spends off the CPU
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#ifndef INCLUDE_EFIMON_READINGS_OFFCPU_READINGS_HPP_
+#define INCLUDE_EFIMON_READINGS_OFFCPU_READINGS_HPP_
+
+#include <cstdint>
+#include <efimon/readings.hpp>
+#include <string>
+#include <unordered_map>
+
+namespace efimon {
+
+/**
+ * @brief Reason why a thread left the CPU
+ */
+enum class OffCPUReason {
+  /** Uninterruptible wait (disk) or waiting on files, sockets and polls */
+  IO = 0,
+  /** Waiting on a futex (locks, condition variables, joins) */
+  FUTEX,
+  /** Explicit sleep (nanosleep and friends) */
+  SLEEP,
+  /** Runnable but preempted by the scheduler */
+  PREEMPTED,
+  /** Any other interruptible wait */
+  OTHER,
+};
+
+/**
+ * @brief Readings specific to off-CPU analysis
+ *
+ * The times are in microseconds and correspond to the off-CPU intervals that
+ * ended within the window. The stacks are folded from the root to the leaf,
+ * separated by ';' (the format used by the flame graphs), and include the
+ * kernel frames that led to the switch. The stacks and the reasons account
+ * the same blocked time: the run-queue time is apart.
+ */
+struct OffCPUReadings : public Readings {
+  /** Blocked time per reason */
+  std::unordered_map<OffCPUReason, uint64_t> blocked_time;
+  /** Blocked time per folded stack (only the heaviest ones) */
+  std::unordered_map<std::string, uint64_t> stacks;
+  /** Time between the wake-up and being back on the CPU */
+  uint64_t runqueue_time;
+  /** The wake-ups are traced. Otherwise, there is no run-queue time and
+      the whole off-CPU time is accounted as blocked */
+  bool wakeups;
+  /** Number of times that the threads left the CPU */
+  uint64_t switches;
+  /** Number of records lost by the kernel within the window */
+  uint64_t lost;
+  /** Destructor to enable the inheritance */
+  virtual ~OffCPUReadings() = default;
+};
+
+} /* namespace efimon */
+
+#endif /* INCLUDE_EFIMON_READINGS_OFFCPU_READINGS_HPP_ */
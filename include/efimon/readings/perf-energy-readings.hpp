@@ -0,0 +1,55 @@
+/**
+ * @file perf-energy-readings.hpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Readings of the energy events of the perf power PMU together with
+ * the instructions retired in the same window
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#ifndef INCLUDE_EFIMON_READINGS_PERF_ENERGY_READINGS_HPP_
+#define INCLUDE_EFIMON_READINGS_PERF_ENERGY_READINGS_HPP_
+
+#include <cstdint>
+#include <efimon/readings.hpp>
+#include <vector>
+
+namespace efimon {
+
+/**
+ * @brief Readings specific to the perf power PMU
+ *
+ * The vectors are indexed by socket. The energy is the one of the last
+ * window and is -1 if the event is not exported by the platform. The
+ * energy per instruction is -1 if the instructions cannot be counted.
+ */
+struct PerfEnergyReadings : public Readings {
+  /** Window in ns, measured by perf in the time base of the counters */
+  uint64_t window;
+  /** Package energy per socket in Joules (energy-pkg) */
+  std::vector<double> package_energy;
+  /** Core energy per socket in Joules (energy-cores) */
+  std::vector<double> core_energy;
+  /** DRAM energy per socket in Joules (energy-ram) */
+  std::vector<double> ram_energy;
+  /** Platform energy in Joules (energy-psys) */
+  double psys_energy;
+  /** Instructions retired per socket */
+  std::vector<uint64_t> instructions;
+  /** CPU cycles per socket */
+  std::vector<uint64_t> cycles;
+  /** Package energy per instruction per socket in nJ */
+  std::vector<double> energy_per_instruction;
+  /** Package energy of all the sockets in Joules */
+  double overall_energy;
+  /** Instructions retired by all the sockets */
+  uint64_t overall_instructions;
+  /** Package energy per instruction of all the sockets in nJ */
+  double overall_energy_per_instruction;
+  /** Destructor to enable the inheritance */
+  virtual ~PerfEnergyReadings() = default;
+};
+
+} /* namespace efimon */
+
+#endif /* INCLUDE_EFIMON_READINGS_PERF_ENERGY_READINGS_HPP_ */
@@ -29,6 +29,16 @@ struct PSUReadings : public Readings {
   std::vector<float> psu_max_power;
   /** Energy per PSU during the meter lifespan in Joules */
   std::vector<float> psu_energy;
+  /** Platform power reported by the BMC (DCMI) in Watts. -1 if absent */
+  float platform_power;
+  /** Minimum platform power over the BMC window in Watts */
+  float platform_min_power;
+  /** Maximum platform power over the BMC window in Watts */
+  float platform_max_power;
+  /** Average platform power over the BMC window in Watts */
+  float platform_avg_power;
+  /** Window of the platform power statistics in ms */
+  uint64_t platform_window;
   virtual ~PSUReadings() = default;
 };
 
@@ -0,0 +1,52 @@
+/**
+ * @file rapl-readings.hpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Container interface to hold the metering readings of the RAPL
+ * domains (package, core, uncore, DRAM and platform)
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#ifndef INCLUDE_EFIMON_READINGS_RAPL_READINGS_HPP_
+#define INCLUDE_EFIMON_READINGS_RAPL_READINGS_HPP_
+
+#include <cstdint>
+#include <efimon/readings.hpp>
+#include <vector>
+
+namespace efimon {
+
+/**
+ * @brief Readings specific to the RAPL domains
+ *
+ * The vectors are indexed by socket. The power is -1 if the domain is not
+ * exposed by the platform. The energy is accumulated since the last reset.
+ */
+struct RAPLReadings : public Readings {
+  /** Package power per socket in Watts */
+  std::vector<float> package_power;
+  /** Core (PP0) power per socket in Watts */
+  std::vector<float> core_power;
+  /** Uncore (PP1) power per socket in Watts */
+  std::vector<float> uncore_power;
+  /** DRAM power per socket in Watts */
+  std::vector<float> dram_power;
+  /** Platform (psys) power in Watts */
+  float psys_power;
+  /** Package energy per socket in Joules */
+  std::vector<double> package_energy;
+  /** Core (PP0) energy per socket in Joules */
+  std::vector<double> core_energy;
+  /** Uncore (PP1) energy per socket in Joules */
+  std::vector<double> uncore_energy;
+  /** DRAM energy per socket in Joules */
+  std::vector<double> dram_energy;
+  /** Platform (psys) energy in Joules */
+  double psys_energy;
+  /** Destructor to enable the inheritance */
+  virtual ~RAPLReadings() = default;
+};
+
+} /* namespace efimon */
+
+#endif /* INCLUDE_EFIMON_READINGS_RAPL_READINGS_HPP_ */
@@ -0,0 +1,39 @@
+/**
+ * @file sample-readings.hpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Container interface to hold the instruction samples taken within
+ * a window
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#ifndef INCLUDE_EFIMON_READINGS_SAMPLE_READINGS_HPP_
+#define INCLUDE_EFIMON_READINGS_SAMPLE_READINGS_HPP_
+
+#include <cstdint>
+#include <efimon/readings.hpp>
+#include <unordered_map>
+
+namespace efimon {
+
+/**
+ * @brief Readings specific to instruction sampling
+ */
+struct SampleReadings : public Readings {
+  /** Number of samples per instruction pointer */
+  std::unordered_map<uint64_t, uint64_t> ip_histogram;
+  /** Number of samples within the window */
+  uint64_t samples;
+  /** Number of samples lost by the kernel within the window */
+  uint64_t lost;
+  /** Effective sampling frequency within the window in Hz (time-weighted) */
+  uint64_t frequency;
+  /** Overhead of the profiler as a fraction of a core (last measured) */
+  float overhead;
+  /** Destructor to enable the inheritance */
+  virtual ~SampleReadings() = default;
+};
+
+} /* namespace efimon */
+
+#endif /* INCLUDE_EFIMON_READINGS_SAMPLE_READINGS_HPP_ */
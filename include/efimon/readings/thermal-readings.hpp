@@ -0,0 +1,34 @@
+/**
+ * @file thermal-readings.hpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Container interface to hold the metering readings (temperatures)
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#ifndef INCLUDE_EFIMON_READINGS_THERMAL_READINGS_HPP_
+#define INCLUDE_EFIMON_READINGS_THERMAL_READINGS_HPP_
+
+#include <cstdint>
+#include <efimon/readings.hpp>
+#include <vector>
+
+namespace efimon {
+
+/**
+ * @brief Readings specific to temperature measurements
+ */
+struct ThermalReadings : public Readings {
+  /** Average temperature of all the sensors in Celsius */
+  float overall_temperature;
+  /** Maximum temperature of all the sensors in Celsius */
+  float max_temperature;
+  /** Temperature per sensor in Celsius */
+  std::vector<float> temperatures;
+  /** Destructor to enable the inheritance */
+  virtual ~ThermalReadings() = default;
+};
+
+} /* namespace efimon */
+
+#endif /* INCLUDE_EFIMON_READINGS_THERMAL_READINGS_HPP_ */
@@ -0,0 +1,48 @@
+/**
+ * @file topdown-readings.hpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Container interface to hold the metering readings about the
+ * top-down microarchitecture analysis
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#ifndef INCLUDE_EFIMON_READINGS_TOPDOWN_READINGS_HPP_
+#define INCLUDE_EFIMON_READINGS_TOPDOWN_READINGS_HPP_
+
+#include <cstdint>
+#include <efimon/readings.hpp>
+
+namespace efimon {
+
+/**
+ * @brief Readings specific to the top-down breakdown of the pipeline slots
+ *
+ * All the metrics are fractions of the slots of the last window (0 to 1).
+ * The metrics that cannot be computed with the events available are set
+ * to -1.
+ */
+struct TopDownReadings : public Readings {
+  /** Slots retiring useful micro-operations */
+  float retiring;
+  /** Slots wasted by mispredictions and machine clears */
+  float bad_speculation;
+  /** Slots where the frontend did not deliver micro-operations */
+  float frontend_bound;
+  /** Slots where the backend could not accept micro-operations */
+  float backend_bound;
+  /** Backend bound slots waiting for the memory subsystem (level 2) */
+  float memory_bound;
+  /** Backend bound slots waiting for the execution units (level 2) */
+  float core_bound;
+  /** Deepest level computed: 0 (none), 1 or 2 */
+  uint32_t level;
+  /** The metrics come from generic stall events instead of slots */
+  bool approximated;
+  /** Destructor to enable the inheritance */
+  virtual ~TopDownReadings() = default;
+};
+
+} /* namespace efimon */
+
+#endif /* INCLUDE_EFIMON_READINGS_TOPDOWN_READINGS_HPP_ */
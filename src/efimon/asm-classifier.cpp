@@ -8,12 +8,33 @@
  */
 
 #include <efimon/asm-classifier.hpp>
+#include <efimon/asm-classifier/aarch64-classifier.hpp>
 #include <efimon/asm-classifier/x86-classifier.hpp>
 #include <memory>
 #include <string>
+#include <string_view>
 
 namespace efimon {
 
+InstructionPair AsmClassifier::Classify(const std::string_view inst,
+                                        const std::string_view operands) const
+    noexcept {
+  return this->Classify(std::string{inst}, std::string{operands});
+}
+
+const std::string AsmClassifier::OperandTypes(
+    const std::string_view operands) const noexcept {
+  return this->OperandTypes(std::string{operands});
+}
+
+VectorTriplet AsmClassifier::ClassifyVector(
+    const std::string_view /* inst */,
+    const std::string_view /* operands */) const noexcept {
+  return VectorTriplet{assembly::VectorWidth::NONE,
+                       assembly::ElementType::UNKNOWN,
+                       assembly::VectorPacking::NONE};
+}
+
 const std::string AsmClassifier::FamilyString(
     const assembly::InstructionFamily family) {
   switch (family) {
@@ -44,6 +65,60 @@ const std::string AsmClassifier::TypeString(
   }
 }
 
+const std::string AsmClassifier::WidthString(
+    const assembly::VectorWidth width) {
+  switch (width) {
+    case assembly::VectorWidth::MMX:
+      return "MMX";
+    case assembly::VectorWidth::XMM:
+      return "XMM";
+    case assembly::VectorWidth::YMM:
+      return "YMM";
+    case assembly::VectorWidth::ZMM:
+      return "ZMM";
+    case assembly::VectorWidth::SCALABLE:
+      return "Scalable";
+    default:
+      return "None";
+  }
+}
+
+const std::string AsmClassifier::ElementString(
+    const assembly::ElementType element) {
+  switch (element) {
+    case assembly::ElementType::INT8:
+      return "Int8";
+    case assembly::ElementType::INT16:
+      return "Int16";
+    case assembly::ElementType::INT32:
+      return "Int32";
+    case assembly::ElementType::INT64:
+      return "Int64";
+    case assembly::ElementType::INTEGER:
+      return "Integer";
+    case assembly::ElementType::FP16:
+      return "FP16";
+    case assembly::ElementType::FP32:
+      return "FP32";
+    case assembly::ElementType::FP64:
+      return "FP64";
+    default:
+      return "Unknown";
+  }
+}
+
+const std::string AsmClassifier::PackingString(
+    const assembly::VectorPacking packing) {
+  switch (packing) {
+    case assembly::VectorPacking::SCALAR:
+      return "Scalar";
+    case assembly::VectorPacking::PACKED:
+      return "Packed";
+    default:
+      return "None";
+  }
+}
+
 const std::string AsmClassifier::OriginString(const uint8_t origin) {
   uint8_t i = (origin >> static_cast<uint>(assembly::DataOrigin::INPUT)) &
               static_cast<uint>(assembly::DataOrigin::MASK);
@@ -88,6 +163,8 @@ std::unique_ptr<AsmClassifier> AsmClassifier::Build(
   switch (arch) {
     case assembly::Architecture::X86:
       return std::make_unique<x86Classifier>();
+    case assembly::Architecture::AARCH64:
+      return std::make_unique<AArch64Classifier>();
     default:
       return nullptr;
   }
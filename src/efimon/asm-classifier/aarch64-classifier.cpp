@@ -0,0 +1,520 @@
+/**
+ * @file aarch64-classifier.cpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief This header contains mappings and helpers to decypher the type
+ * of AArch64 (A64) ASM instruction executed within the system
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#include <array>
+#include <cstdint>
+#include <efimon/asm-classifier/aarch64-classifier.hpp>
+#include <efimon/asm-classifier/perfect-hash.hpp>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace efimon {
+
+using namespace assembly;  // NOLINT
+
+namespace {
+
+/* Exact mnemonics of the unconditional branches, including the
+ * authenticated ones (PAC) */
+constexpr std::string_view kJumpOp[] = {
+    "b",      "bl",     "br",     "blr",   "ret",    "braa",
+    "brab",   "braaz",  "brabz",  "blraa", "blrab",  "blraaz",
+    "blrabz", "retaa",  "retab",  "eret",  "eretaa", "eretab"};
+/* Exact mnemonics of the conditional branches (besides b.cond) */
+constexpr std::string_view kBranchOp[] = {"cbz", "cbnz", "tbz", "tbnz"};
+/* Prefixes of the data movements: loads, stores, atomics, moves and
+ * conditional selects. They take precedence over the substrings below
+ * (i.e. ldadd is an atomic, not an addition) */
+constexpr std::string_view kMemOp[] = {
+    "ld",   "st",    "prf",  "cas",  "swp",   "adr",   "mov",
+    "fmov", "dup",   "ins",  "umov", "smov",  "csel",  "cset",
+    "cinc", "csinc", "cinv", "csinv", "fcsel"};
+/* Substrings that determine the family, in order of precedence */
+constexpr std::string_view kArithOp[] = {
+    "add", "sub", "mul",  "div", "mla",   "mls",   "abs", "neg",
+    "dot", "sqrt", "max", "min", "abd",   "adc",   "sbc", "recp",
+    "rsqrt", "inc", "dec", "frint"};
+constexpr std::string_view kLogicOp[] = {
+    "and",  "orr", "orn", "eor",   "eon",    "bic",     "bsl",   "bit",
+    "bif",  "tst", "cm",  "lsl",   "lsr",    "asr",     "ror",   "shl",
+    "shr",  "sli", "sri", "bfm",   "bfx",    "bfi",     "bfc",   "ext",
+    "rev",  "clz", "cls", "cnt",   "not",    "mvn",     "tbl",   "tbx",
+    "zip",  "uzp", "trn", "cvt",   "xt",     "sel",     "ptest", "while",
+    "ptrue", "pfalse", "splice", "compact", "rbit"};
+
+/* Mnemonics known at compile time: the most frequent ones in system
+ * libraries, numerical libraries and interpreters (objdump -d) */
+constexpr std::string_view kMnemonics[] = {
+    "ldr", "str", "mov", "add", "ldp", "stp", "bl", "b", "cmp", "b.ne",
+    "b.eq", "adrp", "ret", "cbz", "cbnz", "sub", "ldrb", "and", "orr", "lsl",
+    "ldur", "stur", "strb", "csel", "b.hi", "b.ls", "b.gt", "b.le", "b.ge",
+    "b.lt", "b.cc", "b.cs", "b.lo", "b.hs", "b.mi", "b.pl", "b.vs", "b.vc",
+    "tbz", "tbnz", "br", "blr", "nop", "movk", "movz", "movn", "mul", "madd",
+    "msub", "sdiv", "udiv", "smull", "umull", "smulh", "umulh", "neg", "negs",
+    "adds", "subs", "ands", "eor", "bic", "tst", "cmn", "ccmp", "ccmn", "cset",
+    "csetm", "csinc", "csinv", "csneg", "cinc", "cneg", "lsr", "asr", "ror",
+    "ubfx", "sbfx", "ubfiz", "sbfiz", "bfi", "bfxil", "extr", "sxtw", "sxtb",
+    "sxth", "uxtb", "uxth", "clz", "rev", "rbit", "mvn", "ldrh", "strh",
+    "ldrsw", "ldrsb", "ldrsh", "ldurb", "sturb", "ldurh", "sturh", "ldursw",
+    "ldxr", "stxr", "ldaxr", "stlxr", "ldar", "stlr", "ldarb", "stlrb",
+    "ldadd", "ldaddal", "ldclr", "ldset", "swp", "swpal", "cas", "casal",
+    "prfm", "adr", "paciasp", "autiasp", "bti", "dmb", "dsb", "isb", "svc",
+    "brk", "mrs", "msr", "hint", "yield", "fmov", "fadd", "fsub", "fmul",
+    "fdiv", "fmadd", "fmsub", "fnmadd", "fnmsub", "fnmul", "fabs", "fneg",
+    "fsqrt", "fmax", "fmin", "fmaxnm", "fminnm", "fcmp", "fcmpe", "fccmp",
+    "fcsel", "fcvt", "fcvtzs", "fcvtzu", "fcvtas", "fcvtms", "fcvtps",
+    "scvtf", "ucvtf", "frintx", "frintz", "frintm", "frintp", "frinta",
+    "frintn", "fmla", "fmls", "faddp", "fmaxp", "fminp", "fmaxv", "fminv",
+    "fmulx", "frecpe", "frecps", "frsqrte", "frsqrts", "fcmeq", "fcmge",
+    "fcmgt", "fcvtl", "fcvtn", "fcmla", "fcadd", "ld1", "st1", "ld2", "st2",
+    "ld3", "st3", "ld4", "st4", "ld1r", "ld2r", "ld1d", "st1d", "ld1w", "st1w",
+    "ld1b", "st1b", "ld1h", "st1h", "ld1rw", "ld1rd", "ldff1d", "ldnf1d",
+    "prfd", "prfw", "movi", "mvni", "dup", "ins", "umov", "smov", "addp",
+    "addv", "uaddlv", "saddlv", "umaxv", "uminv", "smaxv", "sminv", "mla",
+    "mls", "sdot", "udot", "smlal", "umlal", "smlal2", "umlal2", "smull2",
+    "umull2", "pmull", "pmull2", "saddl", "uaddl", "saddw", "uaddw",
+    "ssubl", "usubl", "sqadd", "uqadd", "sqsub", "uqsub", "sqdmulh",
+    "sqrdmulh", "abs", "sabd", "uabd", "uaba", "smax", "smin", "umax", "umin",
+    "cmeq", "cmge", "cmgt", "cmhi", "cmhs", "cmtst", "bsl", "bit", "bif",
+    "orn", "not", "shl", "sshr", "ushr", "ushll", "sshll", "ushll2",
+    "sshll2", "shrn", "shrn2", "rshrn", "sqxtn", "uqxtn", "xtn", "xtn2",
+    "sxtl", "uxtl", "sxtl2", "uxtl2", "ext", "tbl", "tbx", "zip1", "zip2",
+    "uzp1", "uzp2", "trn1", "trn2", "rev64", "rev32", "rev16", "cnt",
+    "aese", "aesd", "aesmc", "aesimc", "sha256h", "sha256h2", "sha256su0",
+    "sha256su1", "eor3", "ptrue", "pfalse", "ptest", "whilelo", "whilelt",
+    "incd", "incw", "incb", "cntd", "cntw", "cntb", "sel", "movprfx", "fadda",
+    "faddv", "index", "compact", "splice", "lasta", "lastb",
+};
+
+constexpr std::size_t kNumMnemonics = std::size(kMnemonics);
+/* Slots of the perfect hash table (power of two) */
+constexpr std::size_t kNumSlots = 1024;
+/* Buckets of the first level of the perfect hash */
+constexpr std::size_t kNumBuckets = 128;
+/* Entries of the memoisation cache for the unknown mnemonics */
+constexpr std::size_t kMemoCapacity = 4096;
+
+template <std::size_t N>
+constexpr bool ContainsAny(const std::string_view inst,
+                           const std::string_view (&list)[N]) {
+  for (const auto &c : list) {
+    if (inst.find(c) != std::string_view::npos) return true;
+  }
+  return false;
+}
+
+template <std::size_t N>
+constexpr bool StartsWithAny(const std::string_view inst,
+                             const std::string_view (&list)[N]) {
+  for (const auto &c : list) {
+    if (inst.substr(0, c.size()) == c) return true;
+  }
+  return false;
+}
+
+template <std::size_t N>
+constexpr bool EqualsAny(const std::string_view inst,
+                         const std::string_view (&list)[N]) {
+  for (const auto &c : list) {
+    if (inst == c) return true;
+  }
+  return false;
+}
+
+constexpr bool IsDigit(const char c) { return c >= '0' && c <= '9'; }
+
+constexpr bool EndsWith(const std::string_view s, const std::string_view p) {
+  return s.size() >= p.size() && s.substr(s.size() - p.size()) == p;
+}
+
+/* Family of a mnemonic and the properties that change the operand
+ * semantics: independent of operands */
+struct MnemonicInfo {
+  InstructionFamily family;
+  /* Writes the memory operand: the origin is swapped */
+  bool store;
+  /* Operates on floating point elements */
+  bool fp;
+};
+
+constexpr MnemonicInfo ClassifyMnemonic(const std::string_view inst) {
+  InstructionFamily family = InstructionFamily::OTHER;
+  if (EqualsAny(inst, kJumpOp))
+    family = InstructionFamily::JUMP;
+  else if (EqualsAny(inst, kBranchOp) || inst.substr(0, 2) == "b." ||
+           inst.substr(0, 3) == "bc.")
+    family = InstructionFamily::BRANCH;
+  else if (StartsWithAny(inst, kMemOp))
+    family = InstructionFamily::MEMORY;
+  else if (ContainsAny(inst, kArithOp))
+    family = InstructionFamily::ARITHMETIC;
+  else if (ContainsAny(inst, kLogicOp))
+    family = InstructionFamily::LOGIC;
+
+  const bool store = inst.substr(0, 2) == "st";
+  /* The conversions from integers produce floating point: scvtf */
+  const bool fp = (!inst.empty() && 'f' == inst[0]) || EndsWith(inst, "cvtf");
+  return MnemonicInfo{family, store, fp};
+}
+
+using MnemonicHash = PerfectHash<kNumMnemonics, kNumSlots, kNumBuckets>;
+
+constexpr MnemonicHash kHash = MnemonicHash::Build(kMnemonics);
+static_assert(kHash.IsValid(),
+              "Cannot build the perfect hash of the mnemonics");
+
+constexpr std::array<MnemonicInfo, kNumMnemonics> BuildInfo() {
+  std::array<MnemonicInfo, kNumMnemonics> info{};
+  for (std::size_t i = 0; i < kNumMnemonics; ++i) {
+    info[i] = ClassifyMnemonic(kMnemonics[i]);
+  }
+  return info;
+}
+
+/* Classification of the known mnemonics, indexed as kMnemonics */
+constexpr std::array<MnemonicInfo, kNumMnemonics> kInfo = BuildInfo();
+
+/* Returns the index of the mnemonic or -1 if it is unknown */
+inline int FindMnemonic(const std::string_view inst) noexcept {
+  return kHash.Find(kMnemonics, inst);
+}
+
+/* Kinds of operand. The decorations are not operands */
+enum class OperandKind { NONE = 0, IMMEDIATE, REGISTER, VECTOR, MEMORY };
+
+/* Condition codes of csel, ccmp, cset... */
+constexpr std::string_view kConditions[] = {
+    "eq", "ne", "cs", "hs", "cc", "lo", "mi", "pl", "vs",
+    "vc", "hi", "ls", "ge", "lt", "gt", "le", "al", "nv"};
+/* Shifts and extensions of the last operand: add x0, x1, x2, lsl #3 */
+constexpr std::string_view kModifiers[] = {"lsl", "lsr", "asr", "ror", "msl",
+                                           "uxt", "sxt", "mul vl"};
+
+std::string_view Trim(std::string_view s) noexcept {
+  while (!s.empty() && (' ' == s.front() || '\t' == s.front()))
+    s.remove_prefix(1);
+  while (!s.empty() && (' ' == s.back() || '\t' == s.back()))
+    s.remove_suffix(1);
+  return s;
+}
+
+/* Register name followed by a number: x0, v31, z2 */
+bool IsRegister(const std::string_view op, const char prefix) noexcept {
+  return op.size() >= 2 && prefix == op[0] && IsDigit(op[1]);
+}
+
+OperandKind KindOf(const std::string_view op) noexcept {
+  if (op.empty()) return OperandKind::NONE;
+  switch (op.front()) {
+    case '[':
+      return OperandKind::MEMORY;
+    case '#':
+      return OperandKind::IMMEDIATE;
+    case '{':
+      /* Register lists are only used by the vector loads and stores */
+      return OperandKind::VECTOR;
+    default:
+      break;
+  }
+  /* Labels: pc-relative addresses as in the x86 absolute displacements */
+  if (IsDigit(op.front())) return OperandKind::MEMORY;
+  if (StartsWithAny(op, kModifiers) || EqualsAny(op, kConditions))
+    return OperandKind::NONE;
+  /* Governing predicates (p0/m, p1/z) are masks, not operands */
+  if (IsRegister(op, 'p')) {
+    return op.find('/') != std::string_view::npos ? OperandKind::NONE
+                                                  : OperandKind::VECTOR;
+  }
+  if (IsRegister(op, 'v') || IsRegister(op, 'z')) return OperandKind::VECTOR;
+  return OperandKind::REGISTER;
+}
+
+/* Ranks the kinds for the sources: memory dominates the cost */
+int Rank(const OperandKind kind) noexcept { return static_cast<int>(kind); }
+
+char KindChar(const OperandKind kind) noexcept {
+  switch (kind) {
+    case OperandKind::MEMORY:
+      return 'm';
+    case OperandKind::VECTOR:
+      return 'v';
+    case OperandKind::REGISTER:
+      return 'r';
+    case OperandKind::IMMEDIATE:
+      return 'i';
+    default:
+      return 'u';
+  }
+}
+
+/*
+ * Splits the operands by the commas at depth zero and calls f(op, kind)
+ * for each operand (decorations excluded). Stops when f returns false
+ */
+template <typename F>
+void ForEachOperand(std::string_view operands, F &&f) noexcept {
+  auto comment = operands.find("//");
+  if (std::string_view::npos != comment) operands = operands.substr(0, comment);
+
+  std::size_t start = 0;
+  int depth = 0;
+  for (std::size_t i = 0; i <= operands.size(); ++i) {
+    const char c = i < operands.size() ? operands[i] : ',';
+    if ('[' == c || '{' == c) {
+      ++depth;
+      continue;
+    } else if (']' == c || '}' == c) {
+      --depth;
+      continue;
+    } else if (',' != c || depth > 0) {
+      continue;
+    }
+
+    std::string_view op = Trim(operands.substr(start, i - start));
+    start = i + 1;
+    const OperandKind kind = KindOf(op);
+    if (OperandKind::NONE == kind) continue;
+    if (!f(op, kind)) return;
+  }
+}
+
+DataOrigin DetOrigin(const char in) noexcept {
+  switch (in) {
+    case 'r':
+    case 'v':
+      return DataOrigin::REGISTER;
+    case 'm':
+      return DataOrigin::MEMORY;
+    case 'i':
+      return DataOrigin::IMMEDIATE;
+    default:
+      return DataOrigin::UNKNOWN;
+  }
+}
+
+/*
+ * The operand types are written as the operands: the destination first.
+ * The stores are the exception: their destination is the memory operand.
+ * The result follows the x86 encoding: sources at the output shift and the
+ * destination at the input shift
+ */
+uint8_t DetOrigins(const std::string_view operands, const bool store) noexcept {
+  if (operands.size() == 2) {
+    uint8_t first = static_cast<uint8_t>(DetOrigin(operands[0]));
+    uint8_t rest = static_cast<uint8_t>(DetOrigin(operands[1]));
+    uint8_t src = store ? first : rest;
+    uint8_t dst = store ? rest : first;
+    return (dst << static_cast<uint8_t>(DataOrigin::INPUT)) |
+           (src << static_cast<uint8_t>(DataOrigin::OUTPUT));
+  } else if (operands.size() == 1) {
+    return static_cast<uint8_t>(DetOrigin(operands[0]));
+  }
+  return 0;
+}
+
+InstructionPair MakePair(const MnemonicInfo &info,
+                         const std::string_view operands) noexcept {
+  bool compute_op = info.family == InstructionFamily::ARITHMETIC ||
+                    info.family == InstructionFamily::LOGIC ||
+                    info.family == InstructionFamily::MEMORY;
+  InstructionType type = InstructionType::UNCLASSIFIED;
+  if (compute_op) {
+    type = operands.find('v') != std::string_view::npos
+               ? InstructionType::VECTOR
+               : InstructionType::SCALAR;
+  }
+  return InstructionPair{type, info.family, DetOrigins(operands, info.store)};
+}
+
+ElementType ElementOf(const char size, const bool fp) noexcept {
+  switch (size) {
+    case 'b':
+      return fp ? ElementType::UNKNOWN : ElementType::INT8;
+    case 'h':
+      return fp ? ElementType::FP16 : ElementType::INT16;
+    case 's':
+      return fp ? ElementType::FP32 : ElementType::INT32;
+    case 'd':
+      return fp ? ElementType::FP64 : ElementType::INT64;
+    case 'q':
+      return fp ? ElementType::UNKNOWN : ElementType::INTEGER;
+    default:
+      return ElementType::UNKNOWN;
+  }
+}
+
+uint64_t BitsOf(const char size) noexcept {
+  switch (size) {
+    case 'b':
+      return 8;
+    case 'h':
+      return 16;
+    case 's':
+      return 32;
+    case 'd':
+      return 64;
+    case 'q':
+      return 128;
+    default:
+      return 0;
+  }
+}
+
+/* SIMD properties of an operand: the element size is kept as a letter
+ * (b, h, s, d or q) until the mnemonic tells the element type */
+struct VectorOperand {
+  VectorWidth width;
+  char size;
+  VectorPacking packing;
+};
+
+VectorOperand VectorOf(std::string_view op) noexcept {
+  if (!op.empty() && '{' == op.front()) op = Trim(op.substr(1));
+  const VectorOperand none{VectorWidth::NONE, 0, VectorPacking::NONE};
+  std::size_t i = 1;
+  while (i < op.size() && IsDigit(op[i])) ++i;
+  if (i < 2) return none;
+
+  const char reg = op[0];
+  if ('z' == reg) {
+    /* SVE: z0.d. The width depends on the implementation */
+    const char size = i + 1 < op.size() && '.' == op[i] ? op[i + 1] : 0;
+    return VectorOperand{VectorWidth::SCALABLE, size, VectorPacking::PACKED};
+  }
+  if ('v' == reg) {
+    /* NEON arrangement: v0.4s (packed) or element: v0.s[1] */
+    if (i >= op.size() || '.' != op[i]) return none;
+    uint64_t lanes = 0;
+    for (++i; i < op.size() && IsDigit(op[i]); ++i) {
+      lanes = lanes * 10 + (op[i] - '0');
+    }
+    const char size = i < op.size() ? op[i] : 0;
+    if (0 == lanes) {
+      return VectorOperand{VectorWidth::XMM, size, VectorPacking::SCALAR};
+    }
+    const VectorWidth width =
+        lanes * BitsOf(size) > 64 ? VectorWidth::XMM : VectorWidth::MMX;
+    return VectorOperand{width, size, VectorPacking::PACKED};
+  }
+  if (i == op.size() && ('b' == reg || 'h' == reg || 's' == reg ||
+                         'd' == reg || 'q' == reg)) {
+    /* SIMD&FP scalar: d0 is the lowest element of the 128-bit v0. A q
+     * register moves the whole register */
+    return VectorOperand{VectorWidth::XMM, reg,
+                         'q' == reg ? VectorPacking::PACKED
+                                    : VectorPacking::SCALAR};
+  }
+  return none;
+}
+
+} /* namespace */
+
+VectorTriplet AArch64Classifier::ClassifyVector(
+    const std::string_view inst, const std::string_view operands) const
+    noexcept {
+  VectorOperand vector{VectorWidth::NONE, 0, VectorPacking::NONE};
+  if (!inst.empty()) {
+    /* The first packed operand wins over the scalar ones */
+    ForEachOperand(operands, [&](const std::string_view op,
+                                 const OperandKind kind) {
+      if (OperandKind::MEMORY == kind || OperandKind::IMMEDIATE == kind)
+        return true;
+      VectorOperand candidate = VectorOf(op);
+      if (VectorWidth::NONE == candidate.width) return true;
+      if (VectorWidth::NONE == vector.width ||
+          VectorPacking::SCALAR == vector.packing) {
+        vector = candidate;
+      }
+      return VectorPacking::PACKED != vector.packing;
+    });
+  }
+  if (VectorWidth::NONE == vector.width) {
+    return VectorTriplet{VectorWidth::NONE, ElementType::UNKNOWN,
+                         VectorPacking::NONE};
+  }
+
+  const int idx = FindMnemonic(inst);
+  const MnemonicInfo info = idx >= 0 ? kInfo[idx] : ClassifyMnemonic(inst);
+  /* The data movements do not interpret the elements */
+  const ElementType element =
+      InstructionFamily::MEMORY == info.family && !info.fp
+          ? ElementType::UNKNOWN
+          : ElementOf(vector.size, info.fp);
+  return VectorTriplet{vector.width, element, vector.packing};
+}
+
+bool AArch64Classifier::IsKnownMnemonic(const std::string_view inst) noexcept {
+  return FindMnemonic(inst) >= 0;
+}
+
+const std::string AArch64Classifier::OperandTypes(
+    const std::string &operands) const noexcept {
+  return this->OperandTypes(std::string_view{operands});
+}
+
+const std::string AArch64Classifier::OperandTypes(
+    const std::string_view operands) const noexcept {
+  OperandKind first = OperandKind::NONE;
+  OperandKind rest = OperandKind::NONE;
+  std::size_t count = 0;
+  ForEachOperand(operands,
+                 [&](const std::string_view, const OperandKind kind) {
+                   if (0 == count++) {
+                     first = kind;
+                   } else if (Rank(kind) > Rank(rest)) {
+                     rest = kind;
+                   }
+                   return true;
+                 });
+  if (count < 2) {
+    return "u";  // unique/none operand
+  }
+
+  /* Destination (or the stored register) and the rest collapsed into one */
+  std::string res(2, 'u');
+  res[0] = KindChar(first);
+  res[1] = KindChar(rest);
+  return res;
+}
+
+InstructionPair AArch64Classifier::Classify(const std::string &inst,
+                                            const std::string &operands) const
+    noexcept {
+  return this->Classify(std::string_view{inst}, std::string_view{operands});
+}
+
+InstructionPair AArch64Classifier::Classify(
+    const std::string_view inst, const std::string_view operands) const
+    noexcept {
+  if (inst.empty())
+    return InstructionPair{InstructionType::UNCLASSIFIED,
+                           InstructionFamily::OTHER, 0};
+
+  /* Known mnemonic: classified at compile time */
+  const int idx = FindMnemonic(inst);
+  if (idx >= 0) return MakePair(kInfo[idx], operands);
+
+  /* Unknown mnemonic: memoised per thread */
+  thread_local std::unordered_map<std::string, InstructionPair> memo;
+  thread_local std::string key;
+  key.assign(inst);
+  key += '_';
+  key.append(operands);
+  auto it = memo.find(key);
+  if (memo.end() != it) return it->second;
+
+  InstructionPair pair = MakePair(ClassifyMnemonic(inst), operands);
+  if (memo.size() >= kMemoCapacity) memo.clear();
+  memo.emplace(key, pair);
+  return pair;
+}
+
+} /* namespace efimon */
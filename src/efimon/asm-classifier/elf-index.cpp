@@ -0,0 +1,363 @@
+/**
+ * @file elf-index.cpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Offline classification index of the executable sections of an ELF
+ * binary, keyed by its build-id
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#include <elf.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <efimon/asm-classifier/elf-index.hpp>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace efimon {
+
+static constexpr char kMagic[8] = "EFIMIDX";
+
+/* Notes are 4-byte aligned in ELF64 too */
+static constexpr uint64_t AlignNote(const uint64_t size) {
+  return (size + 3) & ~static_cast<uint64_t>(3);
+}
+
+/* Reads a whole ELF64 file and checks its identification */
+static Status LoadElf(const std::string &elf,
+                      std::vector<uint8_t> &bytes) {  // NOLINT
+  std::ifstream file{elf, std::ios::binary};
+  if (!file.is_open()) {
+    return Status{Status::CANNOT_OPEN, "Cannot open the binary: " + elf};
+  }
+  bytes.assign(std::istreambuf_iterator<char>{file},
+               std::istreambuf_iterator<char>{});
+
+  if (bytes.size() < sizeof(Elf64_Ehdr) ||
+      0 != std::memcmp(bytes.data(), ELFMAG, SELFMAG)) {
+    return Status{Status::INCOMPATIBLE_PARAMETER, "Not an ELF file: " + elf};
+  }
+  if (ELFCLASS64 != bytes[EI_CLASS] || ELFDATA2LSB != bytes[EI_DATA]) {
+    return Status{Status::INCOMPATIBLE_PARAMETER,
+                  "Only little-endian ELF64 binaries are supported"};
+  }
+  return Status{};
+}
+
+/* Looks for NT_GNU_BUILD_ID within the note segments */
+static Status FindBuildId(const std::vector<uint8_t> &bytes,
+                          std::vector<uint8_t> &build_id) {  // NOLINT
+  Elf64_Ehdr ehdr;
+  std::memcpy(&ehdr, bytes.data(), sizeof(ehdr));
+  if (ehdr.e_phoff + ehdr.e_phnum * sizeof(Elf64_Phdr) > bytes.size()) {
+    return Status{Status::INVALID_PARAMETER, "Truncated program headers"};
+  }
+
+  for (uint16_t i = 0; i < ehdr.e_phnum; ++i) {
+    Elf64_Phdr phdr;
+    std::memcpy(&phdr, bytes.data() + ehdr.e_phoff + i * sizeof(phdr),
+                sizeof(phdr));
+    if (PT_NOTE != phdr.p_type || phdr.p_offset + phdr.p_filesz > bytes.size())
+      continue;
+
+    uint64_t offset = phdr.p_offset;
+    const uint64_t end = phdr.p_offset + phdr.p_filesz;
+    while (offset + sizeof(Elf64_Nhdr) <= end) {
+      Elf64_Nhdr nhdr;
+      std::memcpy(&nhdr, bytes.data() + offset, sizeof(nhdr));
+      const uint64_t name = offset + sizeof(nhdr);
+      const uint64_t desc = name + AlignNote(nhdr.n_namesz);
+      offset = desc + AlignNote(nhdr.n_descsz);
+      if (offset > end) break;
+
+      if (NT_GNU_BUILD_ID == nhdr.n_type && 4 == nhdr.n_namesz &&
+          0 == std::memcmp(bytes.data() + name, "GNU", 4) &&
+          nhdr.n_descsz <= ElfIndex::kMaxBuildId) {
+        build_id.assign(bytes.data() + desc,
+                        bytes.data() + desc + nhdr.n_descsz);
+        return Status{};
+      }
+    }
+  }
+  return Status{Status::NOT_FOUND, "The binary has no build-id"};
+}
+
+static std::string ToHex(const uint8_t *bytes, const std::size_t size) {
+  static constexpr char kDigits[] = "0123456789abcdef";
+  std::string hex;
+  hex.reserve(2 * size);
+  for (std::size_t i = 0; i < size; ++i) {
+    hex += kDigits[bytes[i] >> 4];
+    hex += kDigits[bytes[i] & 0xF];
+  }
+  return hex;
+}
+
+ElfIndex::ElfIndex()
+    : map_{nullptr},
+      size_{0},
+      header_{nullptr},
+      entries_{nullptr},
+      strings_{nullptr},
+      characters_{nullptr} {}
+
+Status ElfIndex::ReadBuildId(const std::string &elf, std::string &build_id) {
+  /* Only the headers and the notes are needed: read the first pages */
+  std::ifstream file{elf, std::ios::binary};
+  if (!file.is_open()) {
+    return Status{Status::CANNOT_OPEN, "Cannot open the binary: " + elf};
+  }
+  std::vector<uint8_t> bytes(64 * 1024);
+  file.read(reinterpret_cast<char *>(bytes.data()), bytes.size());
+  bytes.resize(file.gcount());
+  if (bytes.size() < sizeof(Elf64_Ehdr) ||
+      0 != std::memcmp(bytes.data(), ELFMAG, SELFMAG) ||
+      ELFCLASS64 != bytes[EI_CLASS]) {
+    return Status{Status::INCOMPATIBLE_PARAMETER, "Not an ELF64 file: " + elf};
+  }
+
+  std::vector<uint8_t> id;
+  Status st = FindBuildId(bytes, id);
+  if (Status::OK != st.code) return st;
+  build_id = ToHex(id.data(), id.size());
+  return Status{};
+}
+
+Status ElfIndex::Build(const std::string &elf, const std::string &directory,
+                       std::string &path, uint64_t &entries) {
+  std::vector<uint8_t> bytes;
+  Status st = LoadElf(elf, bytes);
+  if (Status::OK != st.code) return st;
+
+  Elf64_Ehdr ehdr;
+  std::memcpy(&ehdr, bytes.data(), sizeof(ehdr));
+  if (EM_X86_64 != ehdr.e_machine) {
+    return Status{Status::NOT_IMPLEMENTED,
+                  "Only x86-64 binaries can be indexed"};
+  }
+  if (ehdr.e_shoff + ehdr.e_shnum * sizeof(Elf64_Shdr) > bytes.size()) {
+    return Status{Status::INVALID_PARAMETER, "Truncated section headers"};
+  }
+
+  Header header{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.machine = ehdr.e_machine;
+  std::vector<uint8_t> build_id;
+  st = FindBuildId(bytes, build_id);
+  if (Status::OK != st.code) return st;
+  header.build_id_size = build_id.size();
+  std::memcpy(header.build_id, build_id.data(), build_id.size());
+
+  /* Decode the executable sections */
+  x86Decoder decoder;
+  x86Instruction inst;
+  std::vector<Entry> table;
+  std::vector<std::string> strings;
+  std::unordered_map<std::string, uint16_t> interned;
+  for (uint16_t i = 0; i < ehdr.e_shnum; ++i) {
+    Elf64_Shdr shdr;
+    std::memcpy(&shdr, bytes.data() + ehdr.e_shoff + i * sizeof(shdr),
+                sizeof(shdr));
+    if (SHT_PROGBITS != shdr.sh_type || !(SHF_EXECINSTR & shdr.sh_flags))
+      continue;
+    if (shdr.sh_offset + shdr.sh_size > bytes.size() ||
+        shdr.sh_offset + shdr.sh_size > UINT32_MAX) {
+      return Status{Status::INVALID_PARAMETER,
+                    "The executable section is out of bounds"};
+    }
+
+    const uint8_t *code = bytes.data() + shdr.sh_offset;
+    uint64_t offset = 0;
+    while (offset < shdr.sh_size) {
+      std::size_t length = decoder.Decode(
+          code + offset,
+          std::min<uint64_t>(x86Decoder::kMaxLength, shdr.sh_size - offset),
+          inst);
+      if (0 == length) {
+        ++offset;
+        continue;
+      }
+
+      std::string mnemonic{inst.Mnemonic()};
+      auto it = interned.find(mnemonic);
+      if (interned.end() == it) {
+        if (strings.size() > UINT16_MAX) {
+          return Status{Status::INVALID_PARAMETER, "Too many mnemonics"};
+        }
+        it = interned.emplace(mnemonic, strings.size()).first;
+        strings.push_back(mnemonic);
+      }
+
+      Entry entry{};
+      entry.offset = shdr.sh_offset + offset;
+      entry.mnemonic = it->second;
+      std::memcpy(entry.optypes, inst.optypes.data(), inst.optypes_size);
+      entry.length = length;
+      entry.type = static_cast<uint8_t>(std::get<0>(inst.pair));
+      entry.family = static_cast<uint8_t>(std::get<1>(inst.pair));
+      entry.origin = std::get<2>(inst.pair);
+      entry.width = static_cast<uint8_t>(std::get<0>(inst.vector));
+      entry.element = static_cast<uint8_t>(std::get<1>(inst.vector));
+      entry.packing = static_cast<uint8_t>(std::get<2>(inst.vector));
+      table.push_back(entry);
+      offset += length;
+    }
+  }
+
+  /* The sections are usually sorted, but the ELF does not require it */
+  std::sort(table.begin(), table.end(),
+            [](const Entry &a, const Entry &b) { return a.offset < b.offset; });
+
+  std::vector<uint32_t> offsets;
+  std::string characters;
+  for (const auto &str : strings) {
+    offsets.push_back(characters.size());
+    characters += str;
+    characters += '\0';
+  }
+  header.entries = table.size();
+  header.strings = offsets.size();
+  header.characters = characters.size();
+
+  /* Write to a temporary file and rename it: the index may be in use */
+  path = (std::filesystem::path{directory} /
+          (ToHex(build_id.data(), build_id.size()) + kExtension))
+             .string();
+  std::string tmp = path + ".tmp";
+  {
+    std::ofstream out{tmp, std::ios::binary | std::ios::trunc};
+    if (!out.is_open()) {
+      return Status{Status::FILE_ERROR, "Cannot create the index: " + tmp};
+    }
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(table.data()),
+              table.size() * sizeof(Entry));
+    out.write(reinterpret_cast<const char *>(offsets.data()),
+              offsets.size() * sizeof(uint32_t));
+    out.write(characters.data(), characters.size());
+    if (!out.good()) {
+      std::remove(tmp.c_str());
+      return Status{Status::FILE_ERROR, "Cannot write the index: " + tmp};
+    }
+  }
+  if (0 != std::rename(tmp.c_str(), path.c_str())) {
+    std::remove(tmp.c_str());
+    return Status{Status::FILE_ERROR, "Cannot move the index to: " + path};
+  }
+
+  entries = table.size();
+  return Status{};
+}
+
+Status ElfIndex::Open(const std::string &path) {
+  this->Close();
+
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return Status{Status::CANNOT_OPEN, "Cannot open the index: " + path};
+  }
+  struct stat info;
+  if (0 != fstat(fd, &info) ||
+      static_cast<std::size_t>(info.st_size) < sizeof(Header)) {
+    close(fd);
+    return Status{Status::INVALID_PARAMETER, "Truncated index: " + path};
+  }
+  void *map = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (MAP_FAILED == map) {
+    return Status{Status::FILE_ERROR, "Cannot map the index: " + path};
+  }
+
+  this->map_ = map;
+  this->size_ = info.st_size;
+  const auto *base = static_cast<const uint8_t *>(map);
+  const auto *header = reinterpret_cast<const Header *>(base);
+  const uint64_t expected = sizeof(Header) + header->entries * sizeof(Entry) +
+                            header->strings * sizeof(uint32_t) +
+                            header->characters;
+  if (0 != std::memcmp(header->magic, kMagic, sizeof(kMagic)) ||
+      kVersion != header->version || header->build_id_size > kMaxBuildId ||
+      expected != this->size_) {
+    this->Close();
+    return Status{Status::INCOMPATIBLE_PARAMETER,
+                  "Invalid or outdated index: " + path};
+  }
+
+  this->header_ = header;
+  this->entries_ = reinterpret_cast<const Entry *>(base + sizeof(Header));
+  this->strings_ =
+      reinterpret_cast<const uint32_t *>(this->entries_ + header->entries);
+  this->characters_ =
+      reinterpret_cast<const char *>(this->strings_ + header->strings);
+  return Status{};
+}
+
+bool ElfIndex::Find(const uint64_t offset, x86Instruction &inst) const
+    noexcept {
+  if (!this->header_) return false;
+
+  const Entry *end = this->entries_ + this->header_->entries;
+  const Entry *entry = std::lower_bound(
+      this->entries_, end, offset,
+      [](const Entry &e, const uint64_t off) { return e.offset < off; });
+  if (end == entry || entry->offset != offset ||
+      entry->mnemonic >= this->header_->strings)
+    return false;
+
+  const char *mnemonic = this->characters_ + this->strings_[entry->mnemonic];
+  std::size_t size =
+      strnlen(mnemonic, std::min<std::size_t>(x86Instruction::kMaxMnemonic,
+                                              this->characters_ +
+                                                  this->header_->characters -
+                                                  mnemonic));
+  std::memcpy(inst.mnemonic.data(), mnemonic, size);
+  inst.mnemonic_size = size;
+  inst.optypes = {entry->optypes[0], entry->optypes[1]};
+  inst.optypes_size = '\0' == entry->optypes[1] ? 1 : 2;
+  inst.length = entry->length;
+  inst.encoding = x86Instruction::Encoding::LEGACY;
+  inst.map = 0;
+  inst.opcode = 0;
+  inst.pair = InstructionPair{
+      static_cast<assembly::InstructionType>(entry->type),
+      static_cast<assembly::InstructionFamily>(entry->family), entry->origin};
+  inst.vector =
+      VectorTriplet{static_cast<assembly::VectorWidth>(entry->width),
+                    static_cast<assembly::ElementType>(entry->element),
+                    static_cast<assembly::VectorPacking>(entry->packing)};
+  return true;
+}
+
+std::string ElfIndex::GetBuildId() const {
+  if (!this->header_) return std::string{};
+  return ToHex(this->header_->build_id, this->header_->build_id_size);
+}
+
+uint64_t ElfIndex::GetNumEntries() const noexcept {
+  return this->header_ ? this->header_->entries : 0;
+}
+
+void ElfIndex::Close() {
+  if (this->map_) munmap(this->map_, this->size_);
+  this->map_ = nullptr;
+  this->size_ = 0;
+  this->header_ = nullptr;
+  this->entries_ = nullptr;
+  this->strings_ = nullptr;
+  this->characters_ = nullptr;
+}
+
+ElfIndex::~ElfIndex() { this->Close(); }
+
+} /* namespace efimon */
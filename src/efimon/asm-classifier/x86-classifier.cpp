@@ -7,155 +7,461 @@
  * @copyright Copyright (c) 2024. See License for Licensing
  */
 
-#include <algorithm>
-#include <cctype>
+#include <array>
+#include <cstdint>
 #include <efimon/asm-classifier/x86-classifier.hpp>
+#include <efimon/asm-classifier/perfect-hash.hpp>
+#include <efimon/asm-classifier/x86-operands.hpp>
+#include <iterator>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
 
 namespace efimon {
 
-const std::string x86Classifier::OperandTypes(const std::string &operands) const
-    noexcept {
-  std::string res = "";
-  std::string firstop = "";
-  std::string secondop = "";
-
-  auto classify = [=](const std::string &in) {
-    if (in.find("(") != std::string::npos) {
-      return "m";
-    } else if (in.find("$") != std::string::npos) {
-      return "i";
-    } else if (in.find("%") != std::string::npos) {
-      return "r";
-    } else {
-      return "u";
-    }
-  };
-
-  auto idx_firstmem = operands.find("),");
-  auto idx_firstcomma = operands.find(",");
-  if (idx_firstcomma == std::string::npos) {
-    return "u";  // unique/none operand
-  }
+using namespace assembly;  // NOLINT
 
-  /* Check if there is ),. Which means that the first operand is memory */
-  if (idx_firstmem != std::string::npos) {
-    res += "m";
-    secondop = operands.substr(idx_firstmem + 2);
-  } else {
-    firstop = operands.substr(0, idx_firstcomma);
-    secondop = operands.substr(idx_firstcomma + 1);
-  }
+namespace {
 
-  /* Check the other operands */
-  if (!firstop.empty()) {
-    res = classify(firstop) + res;
-  }
-
-  if (!secondop.empty()) {
-    res = res + classify(secondop);
-  }
-
-  return res;
-}
-
-InstructionPair x86Classifier::Classify(const std::string &inst,
-                                        const std::string &operands) const
-    noexcept {
-  static const std::string kArithOp[] = {"add", "sub", "div",  "mul",
+/* Substrings that determine the family, in order of precedence */
+constexpr std::string_view kArithOp[] = {"add", "sub", "div",  "mul",
                                          "dp",  "abs", "sign", "avg",
                                          "dec", "inc", "neg"};
-  static const std::string kBitManOp[] = {"shuf",     "lzcn",   "cvt",
+constexpr std::string_view kBitManOp[] = {"shuf",     "lzcn",   "cvt",
                                           "blend",    "perm",   "extract",
                                           "compress", "insert", "unpck"};
-  static const std::string kLogicOp[] = {"and",  "or",  "shl", "shr",
+constexpr std::string_view kLogicOp[] = {"and",  "or",  "shl", "shr",
                                          "sll",  "sra", "srl", "tern",
                                          "test", "xor", "cmp", "not"};
-  static const std::string kMemOp[] = {"expand", "gather", "scatter", "mov",
+constexpr std::string_view kMemOp[] = {"expand", "gather", "scatter", "mov",
                                        "sto",    "lah",    "lds",     "lea",
                                        "les",    "lod"};
-  static const std::string kJumpOp[] = {"jmp"};
-  static const std::string kBranchOp[] = {"ja",  "jb", "jc", "je", "jg", "jl",
+constexpr std::string_view kJumpOp[] = {"jmp"};
+constexpr std::string_view kBranchOp[] = {"ja",  "jb", "jc", "je", "jg", "jl",
                                           "jle", "jn", "jo", "jp", "js", "jz"};
 
-  using namespace assembly;  // NOLINT
+/* Mnemonics known at compile time: the most frequent ones in system
+ * libraries, numerical libraries and interpreters (objdump -d, AT&T) */
+constexpr std::string_view kMnemonics[] = {
+    "mov", "add", "lea", "movaps", "push", "test", "je", "cmp", "jmp", "call",
+    "movss", "xor", "sub", "pop", "mulps", "mulpd", "movsd", "jne", "addps",
+    "nopl", "addpd", "vmovss", "jle", "movapd", "shl", "vmovsd", "vmovups",
+    "movups", "imul", "pshufd", "movslq", "ret", "and", "movddup", "movq",
+    "vbroadcastss", "jg", "nopw", "vfmadd231ps", "pxor", "movl", "mulss",
+    "mulsd", "vmovupd", "vfmadd231pd", "sar", "vmovddup", "unpcklps", "movhps",
+    "movlps", "shufps", "prefetcht0", "movhpd", "xchg", "vfmaddps", "nop",
+    "vmulps", "cmpq", "addsd", "addss", "dec", "vfmaddpd", "xorps", "subpd",
+    "jge", "vbroadcastsd", "movzbl", "andps", "neg", "vmulss", "movdqa", "jl",
+    "or", "vmulpd", "vmulsd", "movupd", "movlhps", "js", "testb", "andpd",
+    "shr", "vaddps", "subps", "inc", "vaddss", "vmovhpd", "vpxor",
+    "vinsertf128", "jb", "movlpd", "subq", "subsd", "subss", "vinsertps", "ja",
+    "shufpd", "divss", "cmovg", "vfnmadd231ps", "addq", "vunpcklpd", "comisd",
+    "cltq", "vxorps", "comiss", "jbe", "unpcklpd", "vxorpd", "vunpcklps", "jae",
+    "divsd", "vmovapd", "cmpl", "vaddsd", "vmovaps", "prefetch", "vfnmaddps",
+    "vaddpd", "endbr64", "cmpb", "vmovlhps", "xorpd", "jp", "vshufps",
+    "vzeroupper", "insertps", "vpermilpd", "vfnmadd231pd", "vfnmaddpd",
+    "vpermilps", "movb", "vmovq", "movdqu", "cmovne", "vunpckhpd", "minpd",
+    "maxpd", "cmovle", "movabs", "vaddsubps", "vmovsldup", "ucomisd", "jns",
+    "vmovshdup", "vfmaddss", "movzwl", "vpxorq", "movd", "adc",
+    "vbroadcastf32x4", "sete", "vsubss", "ucomiss", "vaddsubpd", "sbb", "rol",
+    "vsubsd", "movsldup", "unpckhpd", "vsubps", "movshdup", "ror", "not",
+    "vmovlps", "maxss", "cmovl", "setne", "prefetchw", "vdivsd", "idiv",
+    "vunpckhps", "pcmpeqb", "cmove", "minps", "maxps", "addsubpd",
+    "vfmsubadd231ps", "cmovs", "vshufpd", "minss", "vmovdqu", "faddp",
+    "vmovdqa", "fldt", "vdivss", "fstp", "cqto", "addl", "vfmaddsub231ps",
+    "vfmsubadd231pd", "vfmaddsd", "vpaddd", "cvtsi2sd", "addsubps",
+    "vextractf128", "prefetcht1", "vfmadd213ps", "vfmaddsub231pd", "fxch",
+    "cmovge", "subl", "vblendps", "vzeroall", "maxsd", "punpcklqdq", "movsbl",
+    "mul", "div", "fmul", "unpckhps", "decq", "vperm2f128", "vpcmpeqb",
+    "vfmaddsub213ps", "setnp", "vsubpd", "psllq", "fldl", "vfmadd231sd",
+    "cmovns", "vbroadcastf128", "punpckldq", "vpsrld", "sqrtsd", "paddd",
+    "haddpd", "fstpt", "cmpeqpd", "prefetcht2", "orpd", "rorx", "palignr",
+    "pand", "vpmovmskb", "vandpd", "por", "in", "out", "cvtps2pd", "cltd",
+    "vfmadd213pd", "vfmaddsub213pd", "orps", "cvttsd2si", "vpslld", "vpaddq",
+    "shlx", "vfmsubadd213ps", "vextractps", "minsd", "psrld", "fld", "pmovmskb",
+    "shrd", "cvtsi2ss", "haddps", "vandps", "vextractf64x2", "sqrtss", "paddb",
+    "cvtss2sd", "vmovdqu64", "movhlps", "vfmsubadd213pd", "kmovb", "kmovw",
+    "incq", "pslld", "setg", "bswap", "vfmadd132sd", "cmpeqss", "vpermpd",
+    "vpermt2pd", "flds", "vpor", "vcomisd", "vmovlpd", "kmovd", "prefetchnta",
+    "vextractf64x4", "movsbq", "setp", "fldz", "vpand", "vextractf32x4",
+    "vmovdqa64", "stos", "pandn", "vfmadd231ss", "tzcnt", "aesenc", "divpd",
+    "cmpeqps", "setle", "syscall", "lret", "cvttss2si", "vpcmpeqd", "scas",
+    "vmovd", "vpandn", "orl", "pshufb", "vpaddb", "bsf", "cmpw", "cmova",
+    "lods", "vfmadd213sd", "vfmadd132ss", "sarq", "divps", "pcmpgtb", "vcomiss",
+    "pcmpeqd", "vpermt2ps", "vpmuludq", "cmovb", "movswl", "vucomisd", "vpsrlq",
+    "adcx", "cvtsi2sdl", "bt", "psrlq", "psrldq", "vfmadd132ps", "mulx",
+    "movmskpd", "aesdec", "vaesenc", "movmskps", "jnp", "vucomiss", "vpshufd",
+    "kmovq", "pslldq", "fabs", "jo", "adox", "vhaddps", "outsb", "orb",
+    "cmovbe", "psubb", "vscatterqpd", "vscatterdps", "fucomi", "leave", "movsb",
+    "insb", "vfmsub231ss", "cmpsl", "jno", "cwtl", "movsxd", "testl", "sti",
+    "outsl", "jrcxz", "int1", "fwait", "xlat", "vmovhlps", "cld", "fmulp",
+    "std", "movsl", "shld", "popf", "insl", "enter", "iret", "vfnmaddsd",
+    "loopne", "sahf", "vpminub", "int", "clc", "hlt", "stc", "mulq", "int3",
+    "vblendpd", "fucomip", "bsr", "loope", "lahf", "cmc", "cli", "pushf",
+    "andb", "vpinsrq", "vfmadd132pd", "vpshufb", "cmpsb", "negq", "fld1",
+    "loop", "vpinsrd", "vcvtss2sd", "fnstsw", "setae", "pcmpistri", "setb",
+    "fcomip", "fadd", "movw", "fsubrp", "fchs", "vpcmpgtb", "seta", "cmovae",
+    "shll", "setl", "andnpd", "andn", "paddq", "vpbroadcastq", "vfmaddsub132pd",
+    "fxam", "fcomi", "fldcw", "vfmsub231sd", "divl", "vfnmadd231sd", "btr",
+    "vpermd", "cvtsi2ssl", "vpalignr", "vgatherqpd", "vgatherdps",
+    "vextractf32x8", "stmxcsr", "punpcklwd", "vinserti128", "vfnmadd231ss",
+    "vmovdqa32", "ldmxcsr", "shlb", "femms", "andq", "vpermps", "vpunpckldq",
+    "sha256rnds2", "bts", "andnps", "vpsllq", "vfmadd213ss", "vshuff64x2",
+    "fstpl", "vhaddpd", "vfmsub132ps", "andl", "vpmadd52luq", "vpmadd52huq",
+    "pminub", "fdiv", "vpxord", "movswq", "fsub", "cvtsi2sdq", "fmuls",
+    "cvtsd2ss", "orq", "vfmsub132ss", "vfmsubadd132pd", "vaesdec", "fsubp",
+    "vmovntdq", "vptestmb", "pinsrw", "blendps", "vpandq", "vpsubb",
+    "vpcmpltub", "aesenclast", "vpunpckhqdq", "vfnmadd132sd",
+};
 
-  InstructionType type = InstructionType::UNCLASSIFIED; /* SCALAR, VECTOR... */
-  InstructionFamily family =
-      InstructionFamily::OTHER; /* ARITH, LOG, MEM, BRCH, JMP, OTHER */
-  uint8_t origin = 0;           /* Origin: OOII */
+constexpr std::size_t kNumMnemonics = std::size(kMnemonics);
+/* Slots of the perfect hash table (power of two) */
+constexpr std::size_t kNumSlots = 1024;
+/* Buckets of the first level of the perfect hash */
+constexpr std::size_t kNumBuckets = 256;
+/* Entries of the memoisation cache for the unknown mnemonics */
+constexpr std::size_t kMemoCapacity = 4096;
 
-  if (inst.empty())
-    return InstructionPair{InstructionType::UNCLASSIFIED,
-                           InstructionFamily::OTHER, origin};
-
-  /* Determine the origin */
-  auto detorigin = [](const char in) {
-    switch (in) {
-      case 'r':
-        return DataOrigin::REGISTER;
-      case 'm':
-        return DataOrigin::MEMORY;
-      case 'i':
-        return DataOrigin::IMMEDIATE;
+template <std::size_t N>
+constexpr bool ContainsAny(const std::string_view inst,
+                           const std::string_view (&list)[N]) {
+  for (const auto &c : list) {
+    if (inst.find(c) != std::string_view::npos) return true;
+  }
+  return false;
+}
+
+constexpr char ToLower(const char c) {
+  return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c;
+}
+
+constexpr bool IsDigit(const char c) { return c >= '0' && c <= '9'; }
+
+constexpr bool StartsWith(const std::string_view s, const std::string_view p) {
+  return s.size() >= p.size() && s.substr(0, p.size()) == p;
+}
+
+constexpr bool EndsWith(const std::string_view s, const std::string_view p) {
+  return s.size() >= p.size() && s.substr(s.size() - p.size()) == p;
+}
+
+/* Family, type and SIMD elements of a mnemonic: independent of operands */
+struct MnemonicInfo {
+  InstructionType type;
+  InstructionFamily family;
+  ElementType element;
+  VectorPacking packing;
+};
+
+constexpr ElementType IntegerOfBits(const uint64_t bits) {
+  switch (bits) {
+    case 8:
+      return ElementType::INT8;
+    case 16:
+      return ElementType::INT16;
+    case 32:
+      return ElementType::INT32;
+    case 64:
+      return ElementType::INT64;
+    default:
+      return ElementType::INTEGER;
+  }
+}
+
+constexpr ElementType FloatOfBits(const uint64_t bits) {
+  switch (bits) {
+    case 16:
+      return ElementType::FP16;
+    case 32:
+      return ElementType::FP32;
+    case 64:
+      return ElementType::FP64;
+    default:
+      return ElementType::UNKNOWN;
+  }
+}
+
+/*
+ * Element type and packing of a SIMD mnemonic, from its suffixes:
+ * - ps/pd/ph: packed FP32/FP64/FP16. ss/sd/sh: scalar (unless broadcast)
+ * - p-prefixed (integer) instructions: the last letter gives the size
+ *   (b/w/d/q), except for the bitwise ones
+ * - AVX-512 forms with explicit sizes: vmovdqu64, vextractf32x4
+ * - Conversions take the destination: cvtps2pd, cvtsi2sdl
+ * Only meaningful when the operands use vector registers
+ */
+constexpr std::pair<ElementType, VectorPacking> ClassifyElement(
+    std::string_view inst) {
+  using Result = std::pair<ElementType, VectorPacking>;
+  if (!inst.empty() && 'v' == inst[0]) inst.remove_prefix(1);
+  if (inst.empty()) return Result{ElementType::UNKNOWN, VectorPacking::NONE};
+
+  /* AT&T size suffix of the conversions from integers: cvtsi2sdl */
+  if (inst.find('2') != std::string_view::npos &&
+      (EndsWith(inst, "l") || EndsWith(inst, "q"))) {
+    std::string_view stripped = inst.substr(0, inst.size() - 1);
+    if (EndsWith(stripped, "ss") || EndsWith(stripped, "sd")) inst = stripped;
+  }
+
+  /* Crypto extensions operate on integers */
+  if (StartsWith(inst, "aes") || StartsWith(inst, "sha")) {
+    return Result{ElementType::INTEGER, VectorPacking::PACKED};
+  }
+
+  /* Explicit element size: vmovdqu64, vextractf32x4, vinserti128 */
+  std::size_t end = inst.size();
+  while (end > 0 && (IsDigit(inst[end - 1]) || 'x' == inst[end - 1])) --end;
+  if (end > 0 && end < inst.size() && IsDigit(inst[end])) {
+    uint64_t bits = 0;
+    for (std::size_t i = end; i < inst.size() && IsDigit(inst[i]); ++i) {
+      bits = bits * 10 + (inst[i] - '0');
+    }
+    bool fp = 'f' == inst[end - 1];
+    return Result{fp ? FloatOfBits(bits) : IntegerOfBits(bits),
+                  VectorPacking::PACKED};
+  }
+
+  const bool fp_packed =
+      EndsWith(inst, "ps") || EndsWith(inst, "pd") || EndsWith(inst, "ph");
+  const bool integer =
+      'p' == inst[0] && !(StartsWith(inst, "perm") && fp_packed);
+
+  if (integer) {
+    if (EndsWith(inst, "and")) {
+      return Result{ElementType::INTEGER, VectorPacking::PACKED};
+    }
+    switch (inst.back()) {
+      case 'b':
+        return Result{ElementType::INT8, VectorPacking::PACKED};
+      case 'w':
+        return Result{ElementType::INT16, VectorPacking::PACKED};
+      case 'd':
+        return Result{ElementType::INT32, VectorPacking::PACKED};
+      case 'q':
+        return Result{ElementType::INT64, VectorPacking::PACKED};
       default:
-        return DataOrigin::UNKNOWN;
+        return Result{ElementType::INTEGER, VectorPacking::PACKED};
     }
-  };
+  }
 
-  if (operands.size() == 2) {
-    uint8_t o = static_cast<uint8_t>(detorigin(operands[0]));
-    uint8_t i = static_cast<uint8_t>(detorigin(operands[1]));
-    origin = (i << static_cast<uint8_t>(DataOrigin::INPUT)) |
-             (o << static_cast<uint8_t>(DataOrigin::OUTPUT));
-  } else if (operands.size() == 1) {
-    origin = static_cast<uint8_t>(detorigin(operands[0]));
-  }
-
-  /* Determine the family */
-  auto pred = [&](const std::string &c) {
-    return inst.find(c) != std::string::npos;
-  };
-  auto arthit = std::find_if(std::begin(kArithOp), std::end(kArithOp), pred);
-  auto bitit = std::find_if(std::begin(kBitManOp), std::end(kBitManOp), pred);
-  auto logit = std::find_if(std::begin(kLogicOp), std::end(kLogicOp), pred);
-  auto memit = std::find_if(std::begin(kMemOp), std::end(kMemOp), pred);
-  auto jmpit = std::find_if(std::begin(kJumpOp), std::end(kJumpOp), pred);
-  auto branchit =
-      std::find_if(std::begin(kBranchOp), std::end(kBranchOp), pred);
-
-  if (arthit != std::end(kArithOp))
+  if (EndsWith(inst, "ps"))
+    return Result{ElementType::FP32, VectorPacking::PACKED};
+  if (EndsWith(inst, "pd"))
+    return Result{ElementType::FP64, VectorPacking::PACKED};
+  if (EndsWith(inst, "ph"))
+    return Result{ElementType::FP16, VectorPacking::PACKED};
+
+  const VectorPacking scalar = inst.find("broadcast") != std::string_view::npos
+                                   ? VectorPacking::PACKED
+                                   : VectorPacking::SCALAR;
+  if (EndsWith(inst, "ss")) return Result{ElementType::FP32, scalar};
+  if (EndsWith(inst, "sd")) return Result{ElementType::FP64, scalar};
+  if (EndsWith(inst, "sh")) return Result{ElementType::FP16, scalar};
+
+  /* Conversions to general purpose registers: cvttsd2si */
+  if (EndsWith(inst, "2si"))
+    return Result{ElementType::INTEGER, VectorPacking::SCALAR};
+  if ("movd" == inst) return Result{ElementType::INT32, VectorPacking::SCALAR};
+  if ("movq" == inst) return Result{ElementType::INT64, VectorPacking::SCALAR};
+  if (EndsWith(inst, "ddup"))
+    return Result{ElementType::FP64, VectorPacking::PACKED};
+  if (EndsWith(inst, "dup"))
+    return Result{ElementType::FP32, VectorPacking::PACKED};
+  if (inst.find("dq") != std::string_view::npos)
+    return Result{ElementType::INTEGER, VectorPacking::PACKED};
+
+  return Result{ElementType::UNKNOWN, VectorPacking::PACKED};
+}
+
+/* Widest vector register among the operands: %xmm0 (AT&T) or xmm0 (Intel).
+ * The name starts at a token boundary and is followed by its number, so
+ * neither the mm of xmm0 nor XMMWORD PTR are taken as registers */
+VectorWidth ClassifyWidth(const std::string_view operands) noexcept {
+  constexpr std::pair<std::string_view, VectorWidth> kRegisters[] = {
+      {"zmm", VectorWidth::ZMM},
+      {"ymm", VectorWidth::YMM},
+      {"xmm", VectorWidth::XMM},
+      {"mm", VectorWidth::MMX}};
+
+  VectorWidth width = VectorWidth::NONE;
+  for (std::size_t i = 0; i < operands.size(); ++i) {
+    const char prev = i > 0 ? ToLower(operands[i - 1]) : ' ';
+    if (IsDigit(prev) || (prev >= 'a' && prev <= 'z') || '_' == prev) continue;
+    const std::string_view token = operands.substr(i);
+    for (const auto &reg : kRegisters) {
+      if (StartsWith(token, reg.first) && token.size() > reg.first.size() &&
+          IsDigit(token[reg.first.size()])) {
+        if (reg.second > width) width = reg.second;
+        break;
+      }
+    }
+  }
+  return width;
+}
+
+constexpr MnemonicInfo ClassifyMnemonic(const std::string_view inst) {
+  InstructionFamily family = InstructionFamily::OTHER;
+  if (ContainsAny(inst, kArithOp))
     family = InstructionFamily::ARITHMETIC;
-  else if (bitit != std::end(kBitManOp))
+  else if (ContainsAny(inst, kBitManOp))
     family = InstructionFamily::LOGIC;
-  else if (logit != std::end(kLogicOp))
+  else if (ContainsAny(inst, kLogicOp))
     family = InstructionFamily::LOGIC;
-  else if (memit != std::end(kMemOp))
+  else if (ContainsAny(inst, kMemOp))
     family = InstructionFamily::MEMORY;
-  else if (jmpit != std::end(kJumpOp))
+  else if (ContainsAny(inst, kJumpOp))
     family = InstructionFamily::JUMP;
-  else if (branchit != std::end(kBranchOp))
+  else if (ContainsAny(inst, kBranchOp))
     family = InstructionFamily::BRANCH;
 
   bool compute_op = family == InstructionFamily::ARITHMETIC ||
                     family == InstructionFamily::LOGIC ||
                     family == InstructionFamily::MEMORY;
+  const auto element = ClassifyElement(inst);
+  if (!compute_op) {
+    return MnemonicInfo{InstructionType::UNCLASSIFIED, family, element.first,
+                        element.second};
+  }
+
+  const char first = ToLower(inst.at(0));
+  bool vector = 'v' == first || 'p' == first;
+  return MnemonicInfo{
+      vector ? InstructionType::VECTOR : InstructionType::SCALAR, family,
+      element.first, element.second};
+}
+
+using MnemonicHash = PerfectHash<kNumMnemonics, kNumSlots, kNumBuckets>;
+
+constexpr MnemonicHash kHash = MnemonicHash::Build(kMnemonics);
+static_assert(kHash.IsValid(),
+              "Cannot build the perfect hash of the mnemonics");
+
+constexpr std::array<MnemonicInfo, kNumMnemonics> BuildInfo() {
+  std::array<MnemonicInfo, kNumMnemonics> info{};
+  for (std::size_t i = 0; i < kNumMnemonics; ++i) {
+    info[i] = ClassifyMnemonic(kMnemonics[i]);
+  }
+  return info;
+}
+
+/* Classification of the known mnemonics, indexed as kMnemonics */
+constexpr std::array<MnemonicInfo, kNumMnemonics> kInfo = BuildInfo();
 
-  /* Determine the type */
-  switch (std::tolower(inst.at(0))) {
-    case 'v':
-      [[fallthrough]];
-    case 'p':
-      type =
-          compute_op ? InstructionType::VECTOR : InstructionType::UNCLASSIFIED;
-      break;
+/* Returns the index of the mnemonic or -1 if it is unknown */
+inline int FindMnemonic(const std::string_view inst) noexcept {
+  return kHash.Find(kMnemonics, inst);
+}
+
+DataOrigin DetOrigin(const char in) noexcept {
+  switch (in) {
+    case 'r':
+      return DataOrigin::REGISTER;
+    case 'm':
+      return DataOrigin::MEMORY;
+    case 'i':
+      return DataOrigin::IMMEDIATE;
     default:
-      type =
-          compute_op ? InstructionType::SCALAR : InstructionType::UNCLASSIFIED;
-      break;
+      return DataOrigin::UNKNOWN;
+  }
+}
+
+uint8_t DetOrigins(const std::string_view operands) noexcept {
+  if (operands.size() == 2) {
+    uint8_t o = static_cast<uint8_t>(DetOrigin(operands[0]));
+    uint8_t i = static_cast<uint8_t>(DetOrigin(operands[1]));
+    return (i << static_cast<uint8_t>(DataOrigin::INPUT)) |
+           (o << static_cast<uint8_t>(DataOrigin::OUTPUT));
+  } else if (operands.size() == 1) {
+    return static_cast<uint8_t>(DetOrigin(operands[0]));
+  }
+  return 0;
+}
+
+} /* namespace */
+
+VectorTriplet x86Classifier::ClassifyVector(
+    const std::string_view inst, const std::string_view operands) const
+    noexcept {
+  /* The comments may name registers: # <xmm0> */
+  return this->ClassifyVector(
+      inst, ClassifyWidth(operands.substr(0, operands.find('#'))));
+}
+
+VectorTriplet x86Classifier::ClassifyVector(const std::string_view inst,
+                                            const VectorWidth width) const
+    noexcept {
+  if (VectorWidth::NONE == width || inst.empty()) {
+    return VectorTriplet{VectorWidth::NONE, ElementType::UNKNOWN,
+                         VectorPacking::NONE};
+  }
+
+  const int idx = FindMnemonic(inst);
+  if (idx >= 0) {
+    const MnemonicInfo &info = kInfo[idx];
+    return VectorTriplet{width, info.element, info.packing};
+  }
+  const auto element = ClassifyElement(inst);
+  return VectorTriplet{width, element.first, element.second};
+}
+
+bool x86Classifier::IsKnownMnemonic(const std::string_view inst) noexcept {
+  return FindMnemonic(inst) >= 0;
+}
+
+const std::string x86Classifier::OperandTypes(const std::string &operands) const
+    noexcept {
+  return this->OperandTypes(std::string_view{operands});
+}
+
+const std::string x86Classifier::OperandTypes(
+    const std::string_view operands) const noexcept {
+  x86Operands ops = x86OperandParser::Parse(operands);
+  if (ops.count < 2) {
+    return "u";  // unique/none operand
+  }
+
+  /* Sources collapsed into one (memory first) and the destination */
+  std::string res(2, 'u');
+  res[0] = x86OperandParser::OriginChar(ops.source);
+  res[1] = x86OperandParser::OriginChar(ops.destination);
+  return res;
+}
+
+InstructionPair x86Classifier::Classify(const std::string &inst,
+                                        const std::string &operands) const
+    noexcept {
+  return this->Classify(std::string_view{inst}, std::string_view{operands});
+}
+
+InstructionPair x86Classifier::Classify(const std::string_view inst,
+                                        const std::string_view operands) const
+    noexcept {
+  if (inst.empty())
+    return InstructionPair{InstructionType::UNCLASSIFIED,
+                           InstructionFamily::OTHER, 0};
+
+  /* Known mnemonic: classified at compile time */
+  const int idx = FindMnemonic(inst);
+  if (idx >= 0) {
+    const MnemonicInfo &info = kInfo[idx];
+    return InstructionPair{info.type, info.family, DetOrigins(operands)};
   }
 
-  return InstructionPair{type, family, origin};
+  /* Unknown mnemonic: memoised per thread */
+  thread_local std::unordered_map<std::string, InstructionPair> memo;
+  thread_local std::string key;
+  key.assign(inst);
+  key += '_';
+  key.append(operands);
+  auto it = memo.find(key);
+  if (memo.end() != it) return it->second;
+
+  const MnemonicInfo info = ClassifyMnemonic(inst);
+  InstructionPair pair{info.type, info.family, DetOrigins(operands)};
+  if (memo.size() >= kMemoCapacity) memo.clear();
+  memo.emplace(key, pair);
+  return pair;
 }
 
 } /* namespace efimon */
@@ -0,0 +1,1201 @@
+/**
+ * @file x86-decoder.cpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Table-driven decoder of x86-64 machine code. It classifies the
+ * instructions from their bytes, without objdump or perf annotate
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#include <array>
+#include <cstdint>
+#include <efimon/asm-classifier/x86-decoder.hpp>
+#include <efimon/asm-classifier/x86-operands.hpp>
+#include <string_view>
+
+namespace efimon {
+
+using namespace assembly;  // NOLINT
+
+namespace {
+
+/* How the mnemonic of an entry is selected */
+enum class Select : uint8_t {
+  /* names[0] */
+  NONE = 0,
+  /* By mandatory prefix: names[0] none, [1] 66, [2] F3, [3] F2 */
+  PREFIX,
+  /* By REX.W/VEX.W/EVEX.W: names[0] W0, names[1] W1 */
+  W,
+  /* By the ModRM reg field: kGroups[group][reg] */
+  GROUP,
+  /* x87 escape: kX87Memory or kX87Register */
+  X87,
+  /* FMA: names[0] + ps/pd (names[1] is "p") or ss/sd ("s") by W */
+  FMA
+};
+
+/* Groups of opcodes extended by the ModRM reg field */
+enum Group : uint8_t {
+  kGroup1 = 0,
+  kGroup1A,
+  kGroup2,
+  kGroup3,
+  kGroup4,
+  kGroup5,
+  kGroup6,
+  kGroup7,
+  kGroup8,
+  kGroup9,
+  kGroup11,
+  kGroup12,
+  kGroup13,
+  kGroup14,
+  kGroup15,
+  kGroup16,
+  kGroup17,
+  kGroupPrefetch,
+  kNumGroups
+};
+
+constexpr std::array<std::string_view, 8> kGroups[kNumGroups] = {
+    /* 1: 80-83 */
+    {"add", "or", "adc", "sbb", "and", "sub", "xor", "cmp"},
+    /* 1A: 8F */
+    {"pop", "", "", "", "", "", "", ""},
+    /* 2: C0, C1, D0-D3 */
+    {"rol", "ror", "rcl", "rcr", "shl", "shr", "shl", "sar"},
+    /* 3: F6, F7 */
+    {"test", "test", "not", "neg", "mul", "imul", "div", "idiv"},
+    /* 4: FE */
+    {"inc", "dec", "", "", "", "", "", ""},
+    /* 5: FF */
+    {"inc", "dec", "call", "lcall", "jmp", "ljmp", "push", ""},
+    /* 6: 0F 00 */
+    {"sldt", "str", "lldt", "ltr", "verr", "verw", "", ""},
+    /* 7: 0F 01 */
+    {"sgdt", "sidt", "lgdt", "lidt", "smsw", "", "lmsw", "invlpg"},
+    /* 8: 0F BA */
+    {"", "", "", "", "bt", "bts", "btr", "btc"},
+    /* 9: 0F C7 */
+    {"", "cmpxchg8b", "", "", "", "", "rdrand", "rdseed"},
+    /* 11: C6, C7 */
+    {"mov", "", "", "", "", "", "", ""},
+    /* 12: 0F 71 */
+    {"", "", "psrlw", "", "psraw", "", "psllw", ""},
+    /* 13: 0F 72 */
+    {"", "", "psrld", "", "psrad", "", "pslld", ""},
+    /* 14: 0F 73 */
+    {"", "", "psrlq", "psrldq", "", "", "psllq", "pslldq"},
+    /* 15: 0F AE */
+    {"fxsave", "fxrstor", "ldmxcsr", "stmxcsr", "xsave", "xrstor", "xsaveopt",
+     "clflush"},
+    /* 16: 0F 18 */
+    {"prefetchnta", "prefetcht0", "prefetcht1", "prefetcht2", "nopl", "nopl",
+     "nopl", "nopl"},
+    /* 17: VEX 0F38 F3 */
+    {"", "blsr", "blsmsk", "blsi", "", "", "", ""},
+    /* 0F 0D */
+    {"prefetch", "prefetchw", "prefetchwt1", "prefetch", "prefetch",
+     "prefetch", "prefetch", "prefetch"},
+};
+
+/* x87 escapes (D8-DF) with a memory operand, by opcode and reg */
+constexpr std::array<std::string_view, 8> kX87Memory[8] = {
+    {"fadds", "fmuls", "fcoms", "fcomps", "fsubs", "fsubrs", "fdivs",
+     "fdivrs"},
+    {"flds", "", "fsts", "fstps", "fldenv", "fldcw", "fnstenv", "fnstcw"},
+    {"fiaddl", "fimull", "ficoml", "ficompl", "fisubl", "fisubrl", "fidivl",
+     "fidivrl"},
+    {"fildl", "fisttpl", "fistl", "fistpl", "", "fldt", "", "fstpt"},
+    {"faddl", "fmull", "fcoml", "fcompl", "fsubl", "fsubrl", "fdivl",
+     "fdivrl"},
+    {"fldl", "fisttpll", "fstl", "fstpl", "frstor", "", "fnsave", "fnstsw"},
+    {"fiadds", "fimuls", "ficoms", "ficomps", "fisubs", "fisubrs", "fidivs",
+     "fidivrs"},
+    {"filds", "fisttps", "fists", "fistps", "fbld", "fildll", "fbstp",
+     "fistpll"},
+};
+
+/* x87 escapes (D8-DF) on the register stack, by opcode and reg */
+constexpr std::array<std::string_view, 8> kX87Register[8] = {
+    {"fadd", "fmul", "fcom", "fcomp", "fsub", "fsubr", "fdiv", "fdivr"},
+    {"fld", "fxch", "fnop", "", "fchs", "fld1", "f2xm1", "fprem"},
+    {"fcmovb", "fcmove", "fcmovbe", "fcmovu", "", "fucompp", "", ""},
+    {"fcmovnb", "fcmovne", "fcmovnbe", "fcmovnu", "fninit", "fucomi",
+     "fcomi", ""},
+    {"fadd", "fmul", "fcom", "fcomp", "fsub", "fsubr", "fdiv", "fdivr"},
+    {"ffree", "", "fst", "fstp", "fucom", "fucomp", "", ""},
+    {"faddp", "fmulp", "", "fcompp", "fsubp", "fsubrp", "fdivp", "fdivrp"},
+    {"ffreep", "", "", "", "fnstsw", "fucomip", "fcomip", ""},
+};
+
+/* D9 E0-FF: x87 operations without operands, by the ModRM byte */
+constexpr std::string_view kX87Constants[32] = {
+    "fchs",   "fabs",    "",       "",        "ftst",   "fxam",  "",
+    "",       "fld1",    "fldl2t", "fldl2e",  "fldpi",  "fldlg2", "fldln2",
+    "fldz",   "",        "f2xm1",  "fyl2x",   "fptan",  "fpatan", "fxtract",
+    "fprem1", "fdecstp", "fincstp", "fprem",  "fyl2xp1", "fsqrt", "fsincos",
+    "frndint", "fscale", "fsin",   "fcos"};
+
+/* Operands of the x87 escapes on the register stack */
+constexpr std::string_view X87RegisterOperands(const uint8_t escape,
+                                               const uint8_t reg) {
+  switch (escape) {
+    case 1:
+      /* fld, fxch: st(i). The rest have no operands */
+      return reg < 2 ? "R" : "";
+    case 2:
+      /* fucompp */
+      return 5 == reg ? "" : "RR";
+    case 3:
+      /* fnclex, fninit */
+      return 4 == reg ? "" : "RR";
+    case 5:
+      return "R";
+    case 6:
+      /* fcompp */
+      return 3 == reg ? "" : "RR";
+    case 7:
+      /* ffreep st(i), fnstsw %ax */
+      return 0 == reg || 4 == reg ? "R" : "RR";
+    default:
+      return "RR";
+  }
+}
+
+/* Opmask instructions: VEX 0F 41-4B and 90-99 */
+constexpr std::string_view MaskName(const uint8_t opcode) {
+  switch (opcode) {
+    case 0x41:
+      return "kand";
+    case 0x42:
+      return "kandn";
+    case 0x44:
+      return "knot";
+    case 0x45:
+      return "kor";
+    case 0x46:
+      return "kxnor";
+    case 0x47:
+      return "kxor";
+    case 0x4A:
+      return "kadd";
+    case 0x4B:
+      return "kunpck";
+    case 0x90:
+    case 0x91:
+    case 0x92:
+    case 0x93:
+      return "kmov";
+    case 0x98:
+      return "kortest";
+    case 0x99:
+      return "ktest";
+    default:
+      return "";
+  }
+}
+
+/* Size suffix of the opmask instructions, from VEX.pp and VEX.W */
+constexpr std::string_view MaskSuffix(const uint8_t opcode, const uint8_t pp,
+                                      const bool w) {
+  if (0x4B == opcode) return 1 == pp ? "bw" : (w ? "dq" : "wd");
+  if (3 == pp) return w ? "q" : "d";
+  if (1 == pp) return w ? "d" : "b";
+  return w ? "q" : "w";
+}
+
+/*
+ * Entry of an opcode map. The operands are written in AT&T order (sources
+ * first, destination last):
+ * - E: ModRM r/m (register or memory)
+ * - G: ModRM reg. R: implicit or opcode register. V: VEX.vvvv
+ * - I: immediate
+ * - M: implicit memory (string instructions). O: absolute address (moffs)
+ * - J: relative branch target
+ * The immediates are:
+ * - b: 8 bits. w: 16 bits. d: 32 bits
+ * - z: 16 or 32 bits by operand size. v: 16, 32 or 64 bits (mov r, imm)
+ * - e: 24 bits (enter). o: address size (moffs)
+ * The SIMD entries use vector registers: 'x' for SSE and AVX, 'm' for the
+ * instructions that use MMX registers without a mandatory prefix
+ */
+struct OpcodeEntry {
+  std::array<std::string_view, 4> names;
+  std::string_view ops;
+  Select select;
+  char imm;
+  bool modrm;
+  char simd;
+  uint8_t group;
+};
+
+using OpcodeTable = std::array<OpcodeEntry, 256>;
+
+constexpr void Op(OpcodeTable &t, const uint8_t op, const std::string_view name,
+                  const std::string_view ops = "", const char imm = 0,
+                  const bool modrm = false) {
+  t[op] = OpcodeEntry{{name, "", "", ""}, ops, Select::NONE, imm, modrm, 0, 0};
+}
+
+constexpr void Grp(OpcodeTable &t, const uint8_t op, const uint8_t group,
+                   const std::string_view ops, const char imm = 0) {
+  t[op] =
+      OpcodeEntry{{"", "", "", ""}, ops, Select::GROUP, imm, true, 0, group};
+}
+
+constexpr void Wop(OpcodeTable &t, const uint8_t op, const std::string_view w0,
+                   const std::string_view w1, const std::string_view ops,
+                   const char imm = 0, const bool modrm = true,
+                   const char simd = 0) {
+  t[op] = OpcodeEntry{{w0, w1, "", ""}, ops, Select::W, imm, modrm, simd, 0};
+}
+
+/* Instructions whose mnemonic depends on the mandatory prefix */
+constexpr void Pfx(OpcodeTable &t, const uint8_t op, const std::string_view n,
+                   const std::string_view n66, const std::string_view nf3,
+                   const std::string_view nf2, const std::string_view ops,
+                   const char simd = 'x', const char imm = 0) {
+  t[op] = OpcodeEntry{{n, n66, nf3, nf2}, ops, Select::PREFIX, imm, true, simd,
+                      0};
+}
+
+/* SIMD instructions with a single mnemonic */
+constexpr void Simd(OpcodeTable &t, const uint8_t op,
+                    const std::string_view name,
+                    const std::string_view ops = "EG", const char simd = 'x',
+                    const char imm = 0) {
+  t[op] = OpcodeEntry{{name, "", "", ""}, ops, Select::NONE, imm, true, simd,
+                      0};
+}
+
+/* SIMD instructions whose mnemonic depends on W */
+constexpr void SimdW(OpcodeTable &t, const uint8_t op,
+                     const std::string_view w0, const std::string_view w1,
+                     const std::string_view ops = "EG", const char imm = 0) {
+  Wop(t, op, w0, w1, ops, imm, true, 'x');
+}
+
+constexpr OpcodeTable BuildOneByte() {
+  OpcodeTable t{};
+  constexpr std::string_view kAlu[] = {"add", "or",  "adc", "sbb",
+                                       "and", "sub", "xor", "cmp"};
+  for (uint8_t i = 0; i < 8; ++i) {
+    const uint8_t base = i * 8;
+    Op(t, base + 0, kAlu[i], "GE", 0, true);
+    Op(t, base + 1, kAlu[i], "GE", 0, true);
+    Op(t, base + 2, kAlu[i], "EG", 0, true);
+    Op(t, base + 3, kAlu[i], "EG", 0, true);
+    Op(t, base + 4, kAlu[i], "IR", 'b');
+    Op(t, base + 5, kAlu[i], "IR", 'z');
+  }
+  for (uint8_t i = 0; i < 8; ++i) {
+    Op(t, 0x50 + i, "push", "R");
+    Op(t, 0x58 + i, "pop", "R");
+    Op(t, 0xB0 + i, "mov", "IR", 'b');
+    Wop(t, 0xB8 + i, "mov", "movabs", "IR", 'v', false);
+  }
+  Op(t, 0x63, "movslq", "EG", 0, true);
+  Op(t, 0x68, "push", "I", 'z');
+  Op(t, 0x69, "imul", "IEG", 'z', true);
+  Op(t, 0x6A, "push", "I", 'b');
+  Op(t, 0x6B, "imul", "IEG", 'b', true);
+  Op(t, 0x6C, "insb", "MM");
+  Op(t, 0x6D, "insl", "MM");
+  Op(t, 0x6E, "outsb", "MM");
+  Op(t, 0x6F, "outsl", "MM");
+  constexpr std::string_view kJcc[] = {"jo", "jno", "jb",  "jae", "je", "jne",
+                                       "jbe", "ja", "js",  "jns", "jp", "jnp",
+                                       "jl", "jge", "jle", "jg"};
+  for (uint8_t i = 0; i < 16; ++i) Op(t, 0x70 + i, kJcc[i], "J", 'b');
+  Grp(t, 0x80, kGroup1, "IE", 'b');
+  Grp(t, 0x81, kGroup1, "IE", 'z');
+  Grp(t, 0x83, kGroup1, "IE", 'b');
+  Op(t, 0x84, "test", "GE", 0, true);
+  Op(t, 0x85, "test", "GE", 0, true);
+  Op(t, 0x86, "xchg", "GE", 0, true);
+  Op(t, 0x87, "xchg", "GE", 0, true);
+  Op(t, 0x88, "mov", "GE", 0, true);
+  Op(t, 0x89, "mov", "GE", 0, true);
+  Op(t, 0x8A, "mov", "EG", 0, true);
+  Op(t, 0x8B, "mov", "EG", 0, true);
+  Op(t, 0x8C, "mov", "GE", 0, true);
+  Op(t, 0x8D, "lea", "EG", 0, true);
+  Op(t, 0x8E, "mov", "EG", 0, true);
+  Grp(t, 0x8F, kGroup1A, "E");
+  t[0x90] = OpcodeEntry{
+      {"nop", "xchg", "pause", "nop"}, "", Select::PREFIX, 0, false, 0, 0};
+  for (uint8_t i = 1; i < 8; ++i) Op(t, 0x90 + i, "xchg", "RR");
+  Wop(t, 0x98, "cwtl", "cltq", "", 0, false);
+  Wop(t, 0x99, "cltd", "cqto", "", 0, false);
+  Op(t, 0x9B, "fwait");
+  Op(t, 0x9C, "pushf");
+  Op(t, 0x9D, "popf");
+  Op(t, 0x9E, "sahf");
+  Op(t, 0x9F, "lahf");
+  Op(t, 0xA0, "movabs", "OR", 'o');
+  Op(t, 0xA1, "movabs", "OR", 'o');
+  Op(t, 0xA2, "movabs", "RO", 'o');
+  Op(t, 0xA3, "movabs", "RO", 'o');
+  Op(t, 0xA4, "movsb", "MM");
+  Op(t, 0xA5, "movsl", "MM");
+  Op(t, 0xA6, "cmpsb", "MM");
+  Op(t, 0xA7, "cmpsl", "MM");
+  Op(t, 0xA8, "test", "IR", 'b');
+  Op(t, 0xA9, "test", "IR", 'z');
+  Op(t, 0xAA, "stos", "RM");
+  Op(t, 0xAB, "stos", "RM");
+  Op(t, 0xAC, "lods", "MR");
+  Op(t, 0xAD, "lods", "MR");
+  Op(t, 0xAE, "scas", "MR");
+  Op(t, 0xAF, "scas", "MR");
+  Grp(t, 0xC0, kGroup2, "IE", 'b');
+  Grp(t, 0xC1, kGroup2, "IE", 'b');
+  Op(t, 0xC2, "ret", "I", 'w');
+  Op(t, 0xC3, "ret");
+  Grp(t, 0xC6, kGroup11, "IE", 'b');
+  Grp(t, 0xC7, kGroup11, "IE", 'z');
+  Op(t, 0xC8, "enter", "II", 'e');
+  Op(t, 0xC9, "leave");
+  Op(t, 0xCA, "lret", "I", 'w');
+  Op(t, 0xCB, "lret");
+  Op(t, 0xCC, "int3");
+  Op(t, 0xCD, "int", "I", 'b');
+  Op(t, 0xCF, "iret");
+  Grp(t, 0xD0, kGroup2, "E");
+  Grp(t, 0xD1, kGroup2, "E");
+  Grp(t, 0xD2, kGroup2, "RE");
+  Grp(t, 0xD3, kGroup2, "RE");
+  Op(t, 0xD7, "xlat", "M");
+  for (uint8_t i = 0; i < 8; ++i) {
+    t[0xD8 + i] =
+        OpcodeEntry{{"", "", "", ""}, "E", Select::X87, 0, true, 0, i};
+  }
+  Op(t, 0xE0, "loopne", "J", 'b');
+  Op(t, 0xE1, "loope", "J", 'b');
+  Op(t, 0xE2, "loop", "J", 'b');
+  Op(t, 0xE3, "jrcxz", "J", 'b');
+  Op(t, 0xE4, "in", "IR", 'b');
+  Op(t, 0xE5, "in", "IR", 'b');
+  Op(t, 0xE6, "out", "RI", 'b');
+  Op(t, 0xE7, "out", "RI", 'b');
+  Op(t, 0xE8, "call", "J", 'd');
+  Op(t, 0xE9, "jmp", "J", 'd');
+  Op(t, 0xEB, "jmp", "J", 'b');
+  Op(t, 0xEC, "in", "MR");
+  Op(t, 0xED, "in", "MR");
+  Op(t, 0xEE, "out", "RM");
+  Op(t, 0xEF, "out", "RM");
+  Op(t, 0xF1, "int1");
+  Op(t, 0xF4, "hlt");
+  Op(t, 0xF5, "cmc");
+  Grp(t, 0xF6, kGroup3, "IE", 'b');
+  Grp(t, 0xF7, kGroup3, "IE", 'z');
+  Op(t, 0xF8, "clc");
+  Op(t, 0xF9, "stc");
+  Op(t, 0xFA, "cli");
+  Op(t, 0xFB, "sti");
+  Op(t, 0xFC, "cld");
+  Op(t, 0xFD, "std");
+  Grp(t, 0xFE, kGroup4, "E");
+  Grp(t, 0xFF, kGroup5, "E");
+  return t;
+}
+
+constexpr OpcodeTable BuildTwoByte() {
+  OpcodeTable t{};
+  Grp(t, 0x00, kGroup6, "E");
+  Grp(t, 0x01, kGroup7, "E");
+  Op(t, 0x02, "lar", "EG", 0, true);
+  Op(t, 0x03, "lsl", "EG", 0, true);
+  Op(t, 0x05, "syscall");
+  Op(t, 0x06, "clts");
+  Op(t, 0x07, "sysret");
+  Op(t, 0x08, "invd");
+  Op(t, 0x09, "wbinvd");
+  Op(t, 0x0B, "ud2");
+  Grp(t, 0x0D, kGroupPrefetch, "E");
+  Op(t, 0x0E, "femms");
+
+  Pfx(t, 0x10, "movups", "movupd", "movss", "movsd", "EG");
+  Pfx(t, 0x11, "movups", "movupd", "movss", "movsd", "GE");
+  Pfx(t, 0x12, "movlps", "movlpd", "movsldup", "movddup", "EG");
+  Pfx(t, 0x13, "movlps", "movlpd", "", "", "GE");
+  Pfx(t, 0x14, "unpcklps", "unpcklpd", "", "", "EG");
+  Pfx(t, 0x15, "unpckhps", "unpckhpd", "", "", "EG");
+  Pfx(t, 0x16, "movhps", "movhpd", "movshdup", "", "EG");
+  Pfx(t, 0x17, "movhps", "movhpd", "", "", "GE");
+  Grp(t, 0x18, kGroup16, "E");
+  for (uint8_t op = 0x19; op <= 0x1F; ++op) {
+    t[op] = OpcodeEntry{
+        {"nopl", "nopw", "nopl", "nopl"}, "E", Select::PREFIX, 0, true, 0, 0};
+  }
+  for (uint8_t op = 0x20; op <= 0x23; ++op) Op(t, op, "mov", "RR", 0, true);
+
+  Pfx(t, 0x28, "movaps", "movapd", "", "", "EG");
+  Pfx(t, 0x29, "movaps", "movapd", "", "", "GE");
+  Pfx(t, 0x2A, "cvtpi2ps", "cvtpi2pd", "cvtsi2ss", "cvtsi2sd", "EG");
+  Pfx(t, 0x2B, "movntps", "movntpd", "", "", "GE");
+  Pfx(t, 0x2C, "cvttps2pi", "cvttpd2pi", "cvttss2si", "cvttsd2si", "EG");
+  Pfx(t, 0x2D, "cvtps2pi", "cvtpd2pi", "cvtss2si", "cvtsd2si", "EG");
+  Pfx(t, 0x2E, "ucomiss", "ucomisd", "", "", "EG");
+  Pfx(t, 0x2F, "comiss", "comisd", "", "", "EG");
+
+  Op(t, 0x30, "wrmsr");
+  Op(t, 0x31, "rdtsc");
+  Op(t, 0x32, "rdmsr");
+  Op(t, 0x33, "rdpmc");
+  Op(t, 0x34, "sysenter");
+  Op(t, 0x35, "sysexit");
+  Op(t, 0x37, "getsec");
+
+  constexpr std::string_view kCmov[] = {
+      "cmovo", "cmovno", "cmovb", "cmovae", "cmove", "cmovne",
+      "cmovbe", "cmova", "cmovs", "cmovns", "cmovp", "cmovnp",
+      "cmovl", "cmovge", "cmovle", "cmovg"};
+  for (uint8_t i = 0; i < 16; ++i) Op(t, 0x40 + i, kCmov[i], "EG", 0, true);
+
+  Pfx(t, 0x50, "movmskps", "movmskpd", "", "", "EG");
+  Pfx(t, 0x51, "sqrtps", "sqrtpd", "sqrtss", "sqrtsd", "EG");
+  Pfx(t, 0x52, "rsqrtps", "", "rsqrtss", "", "EG");
+  Pfx(t, 0x53, "rcpps", "", "rcpss", "", "EG");
+  Pfx(t, 0x54, "andps", "andpd", "", "", "EG");
+  Pfx(t, 0x55, "andnps", "andnpd", "", "", "EG");
+  Pfx(t, 0x56, "orps", "orpd", "", "", "EG");
+  Pfx(t, 0x57, "xorps", "xorpd", "", "", "EG");
+  Pfx(t, 0x58, "addps", "addpd", "addss", "addsd", "EG");
+  Pfx(t, 0x59, "mulps", "mulpd", "mulss", "mulsd", "EG");
+  Pfx(t, 0x5A, "cvtps2pd", "cvtpd2ps", "cvtss2sd", "cvtsd2ss", "EG");
+  Pfx(t, 0x5B, "cvtdq2ps", "cvtps2dq", "cvttps2dq", "", "EG");
+  Pfx(t, 0x5C, "subps", "subpd", "subss", "subsd", "EG");
+  Pfx(t, 0x5D, "minps", "minpd", "minss", "minsd", "EG");
+  Pfx(t, 0x5E, "divps", "divpd", "divss", "divsd", "EG");
+  Pfx(t, 0x5F, "maxps", "maxpd", "maxss", "maxsd", "EG");
+
+  constexpr std::string_view kMmx60[] = {
+      "punpcklbw", "punpcklwd", "punpckldq", "packsswb",
+      "pcmpgtb",   "pcmpgtw",   "pcmpgtd",   "packuswb",
+      "punpckhbw", "punpckhwd", "punpckhdq", "packssdw",
+      "punpcklqdq", "punpckhqdq"};
+  for (uint8_t i = 0; i < 14; ++i) Simd(t, 0x60 + i, kMmx60[i], "EG", 'm');
+  Wop(t, 0x6E, "movd", "movq", "EG", 0, true, 'm');
+  Pfx(t, 0x6F, "movq", "movdqa", "movdqu", "", "EG", 'm');
+  Pfx(t, 0x70, "pshufw", "pshufd", "pshufhw", "pshuflw", "IEG", 'm', 'b');
+  t[0x71] = OpcodeEntry{{"", "", "", ""}, "IE", Select::GROUP, 'b', true, 'm',
+                        kGroup12};
+  t[0x72] = OpcodeEntry{{"", "", "", ""}, "IE", Select::GROUP, 'b', true, 'm',
+                        kGroup13};
+  t[0x73] = OpcodeEntry{{"", "", "", ""}, "IE", Select::GROUP, 'b', true, 'm',
+                        kGroup14};
+  Simd(t, 0x74, "pcmpeqb", "EG", 'm');
+  Simd(t, 0x75, "pcmpeqw", "EG", 'm');
+  Simd(t, 0x76, "pcmpeqd", "EG", 'm');
+  Op(t, 0x77, "emms");
+  Pfx(t, 0x7C, "", "haddpd", "", "haddps", "EG");
+  Pfx(t, 0x7D, "", "hsubpd", "", "hsubps", "EG");
+  Wop(t, 0x7E, "movd", "movq", "GE", 0, true, 'm');
+  Pfx(t, 0x7F, "movq", "movdqa", "movdqu", "", "GE", 'm');
+
+  constexpr std::string_view kJcc[] = {"jo", "jno", "jb",  "jae", "je", "jne",
+                                       "jbe", "ja", "js",  "jns", "jp", "jnp",
+                                       "jl", "jge", "jle", "jg"};
+  constexpr std::string_view kSet[] = {
+      "seto", "setno", "setb", "setae", "sete", "setne", "setbe", "seta",
+      "sets", "setns", "setp", "setnp", "setl", "setge", "setle", "setg"};
+  for (uint8_t i = 0; i < 16; ++i) {
+    Op(t, 0x80 + i, kJcc[i], "J", 'd');
+    Op(t, 0x90 + i, kSet[i], "E", 0, true);
+  }
+
+  Op(t, 0xA0, "push", "R");
+  Op(t, 0xA1, "pop", "R");
+  Op(t, 0xA2, "cpuid");
+  Op(t, 0xA3, "bt", "GE", 0, true);
+  Op(t, 0xA4, "shld", "IGE", 'b', true);
+  Op(t, 0xA5, "shld", "RGE", 0, true);
+  Op(t, 0xA8, "push", "R");
+  Op(t, 0xA9, "pop", "R");
+  Op(t, 0xAA, "rsm");
+  Op(t, 0xAB, "bts", "GE", 0, true);
+  Op(t, 0xAC, "shrd", "IGE", 'b', true);
+  Op(t, 0xAD, "shrd", "RGE", 0, true);
+  Grp(t, 0xAE, kGroup15, "E");
+  Op(t, 0xAF, "imul", "EG", 0, true);
+  Op(t, 0xB0, "cmpxchg", "GE", 0, true);
+  Op(t, 0xB1, "cmpxchg", "GE", 0, true);
+  Op(t, 0xB2, "lss", "EG", 0, true);
+  Op(t, 0xB3, "btr", "GE", 0, true);
+  Op(t, 0xB4, "lfs", "EG", 0, true);
+  Op(t, 0xB5, "lgs", "EG", 0, true);
+  Op(t, 0xB6, "movzbl", "EG", 0, true);
+  Op(t, 0xB7, "movzwl", "EG", 0, true);
+  Pfx(t, 0xB8, "", "", "popcnt", "", "EG", 0);
+  Op(t, 0xB9, "ud1", "EG", 0, true);
+  Grp(t, 0xBA, kGroup8, "IE", 'b');
+  Op(t, 0xBB, "btc", "GE", 0, true);
+  Pfx(t, 0xBC, "bsf", "bsf", "tzcnt", "bsf", "EG", 0);
+  Pfx(t, 0xBD, "bsr", "bsr", "lzcnt", "bsr", "EG", 0);
+  Op(t, 0xBE, "movsbl", "EG", 0, true);
+  Op(t, 0xBF, "movswl", "EG", 0, true);
+
+  Op(t, 0xC0, "xadd", "GE", 0, true);
+  Op(t, 0xC1, "xadd", "GE", 0, true);
+  Pfx(t, 0xC2, "cmpps", "cmppd", "cmpss", "cmpsd", "IEG", 'x', 'b');
+  Op(t, 0xC3, "movnti", "GE", 0, true);
+  Simd(t, 0xC4, "pinsrw", "IEG", 'm', 'b');
+  Simd(t, 0xC5, "pextrw", "IEG", 'm', 'b');
+  Pfx(t, 0xC6, "shufps", "shufpd", "", "", "IEG", 'x', 'b');
+  Grp(t, 0xC7, kGroup9, "E");
+  for (uint8_t i = 0; i < 8; ++i) Op(t, 0xC8 + i, "bswap", "R");
+
+  Pfx(t, 0xD0, "", "addsubpd", "", "addsubps", "EG");
+  constexpr std::string_view kMmxD1[] = {
+      "psrlw",   "psrld",   "psrlq",  "paddq",   "pmullw",  "movq",
+      "pmovmskb", "psubusb", "psubusw", "pminub",  "pand",    "paddusb",
+      "paddusw", "pmaxub",  "pandn",  "pavgb",   "psraw",   "psrad",
+      "pavgw",   "pmulhuw", "pmulhw"};
+  for (uint8_t i = 0; i < 21; ++i) Simd(t, 0xD1 + i, kMmxD1[i], "EG", 'm');
+  Simd(t, 0xD6, "movq", "GE", 'm');
+  Pfx(t, 0xE6, "", "cvttpd2dq", "cvtdq2pd", "cvtpd2dq", "EG");
+  Pfx(t, 0xE7, "movntq", "movntdq", "", "", "GE", 'm');
+  constexpr std::string_view kMmxE8[] = {
+      "psubsb", "psubsw", "pminsw",  "por",     "paddsb",  "paddsw",
+      "pmaxsw", "pxor",   "lddqu",   "psllw",   "pslld",   "psllq",
+      "pmuludq", "pmaddwd", "psadbw", "maskmovq", "psubb",  "psubw",
+      "psubd",  "psubq",  "paddb",   "paddw",   "paddd"};
+  for (uint8_t i = 0; i < 23; ++i) Simd(t, 0xE8 + i, kMmxE8[i], "EG", 'm');
+  Pfx(t, 0xF7, "maskmovq", "maskmovdqu", "", "", "EG", 'm');
+  Op(t, 0xFF, "ud0", "EG", 0, true);
+  return t;
+}
+
+constexpr OpcodeTable BuildThreeByte38() {
+  OpcodeTable t{};
+  constexpr std::string_view kSsse3[] = {
+      "pshufb", "phaddw", "phaddd", "phaddsw", "pmaddubsw", "phsubw",
+      "phsubd", "phsubsw", "psignb", "psignw", "psignd",    "pmulhrsw"};
+  for (uint8_t i = 0; i < 12; ++i) Simd(t, i, kSsse3[i], "EG", 'm');
+  Simd(t, 0x0C, "vpermilps");
+  Simd(t, 0x0D, "vpermilpd");
+  Simd(t, 0x0E, "vtestps");
+  Simd(t, 0x0F, "vtestpd");
+  Simd(t, 0x10, "pblendvb", "REG");
+  Simd(t, 0x13, "vcvtph2ps");
+  Simd(t, 0x14, "blendvps", "REG");
+  Simd(t, 0x15, "blendvpd", "REG");
+  SimdW(t, 0x16, "vpermps", "vpermpd");
+  Simd(t, 0x17, "ptest");
+  Simd(t, 0x18, "vbroadcastss");
+  Simd(t, 0x19, "vbroadcastsd");
+  Simd(t, 0x1A, "vbroadcastf128");
+  Simd(t, 0x1C, "pabsb", "EG", 'm');
+  Simd(t, 0x1D, "pabsw", "EG", 'm');
+  Simd(t, 0x1E, "pabsd", "EG", 'm');
+  Simd(t, 0x1F, "vpabsq");
+  constexpr std::string_view kMovx[] = {"pmovsxbw", "pmovsxbd", "pmovsxbq",
+                                        "pmovsxwd", "pmovsxwq", "pmovsxdq"};
+  constexpr std::string_view kMovz[] = {"pmovzxbw", "pmovzxbd", "pmovzxbq",
+                                        "pmovzxwd", "pmovzxwq", "pmovzxdq"};
+  for (uint8_t i = 0; i < 6; ++i) {
+    Simd(t, 0x20 + i, kMovx[i]);
+    Simd(t, 0x30 + i, kMovz[i]);
+  }
+  SimdW(t, 0x26, "vptestmb", "vptestmw");
+  SimdW(t, 0x27, "vptestmd", "vptestmq");
+  Simd(t, 0x28, "pmuldq");
+  Simd(t, 0x29, "pcmpeqq");
+  Simd(t, 0x2A, "movntdqa");
+  Simd(t, 0x2B, "packusdw");
+  Simd(t, 0x2C, "vmaskmovps");
+  Simd(t, 0x2D, "vmaskmovpd");
+  Simd(t, 0x2E, "vmaskmovps", "GE");
+  Simd(t, 0x2F, "vmaskmovpd", "GE");
+  SimdW(t, 0x36, "vpermd", "vpermq");
+  Simd(t, 0x37, "pcmpgtq");
+  Simd(t, 0x38, "pminsb");
+  SimdW(t, 0x39, "pminsd", "pminsq");
+  Simd(t, 0x3A, "pminuw");
+  SimdW(t, 0x3B, "pminud", "pminuq");
+  Simd(t, 0x3C, "pmaxsb");
+  SimdW(t, 0x3D, "pmaxsd", "pmaxsq");
+  Simd(t, 0x3E, "pmaxuw");
+  SimdW(t, 0x3F, "pmaxud", "pmaxuq");
+  SimdW(t, 0x40, "pmulld", "pmullq");
+  Simd(t, 0x41, "phminposuw");
+  SimdW(t, 0x45, "vpsrlvd", "vpsrlvq");
+  SimdW(t, 0x46, "vpsravd", "vpsravq");
+  SimdW(t, 0x47, "vpsllvd", "vpsllvq");
+  Simd(t, 0x50, "vpdpbusd");
+  Simd(t, 0x51, "vpdpbusds");
+  Simd(t, 0x52, "vpdpwssd");
+  Simd(t, 0x53, "vpdpwssds");
+  Simd(t, 0x58, "vpbroadcastd");
+  Simd(t, 0x59, "vpbroadcastq");
+  Simd(t, 0x5A, "vbroadcasti128");
+  SimdW(t, 0x64, "vpblendmd", "vpblendmq");
+  SimdW(t, 0x65, "vblendmps", "vblendmpd");
+  SimdW(t, 0x76, "vpermi2d", "vpermi2q");
+  SimdW(t, 0x77, "vpermi2ps", "vpermi2pd");
+  Simd(t, 0x78, "vpbroadcastb");
+  Simd(t, 0x79, "vpbroadcastw");
+  Simd(t, 0x7A, "vpbroadcastb");
+  Simd(t, 0x7B, "vpbroadcastw");
+  SimdW(t, 0x7C, "vpbroadcastd", "vpbroadcastq");
+  SimdW(t, 0x7E, "vpermt2d", "vpermt2q");
+  SimdW(t, 0x7F, "vpermt2ps", "vpermt2pd");
+  SimdW(t, 0x88, "vexpandps", "vexpandpd");
+  SimdW(t, 0x89, "vpexpandd", "vpexpandq");
+  SimdW(t, 0x8A, "vcompressps", "vcompresspd", "GE");
+  SimdW(t, 0x8B, "vpcompressd", "vpcompressq", "GE");
+  SimdW(t, 0x8C, "vpmaskmovd", "vpmaskmovq");
+  SimdW(t, 0x8E, "vpmaskmovd", "vpmaskmovq", "GE");
+  SimdW(t, 0x90, "vpgatherdd", "vpgatherdq");
+  SimdW(t, 0x91, "vpgatherqd", "vpgatherqq");
+  SimdW(t, 0x92, "vgatherdps", "vgatherdpd");
+  SimdW(t, 0x93, "vgatherqps", "vgatherqpd");
+  SimdW(t, 0xA0, "vpscatterdd", "vpscatterdq", "GE");
+  SimdW(t, 0xA1, "vpscatterqd", "vpscatterqq", "GE");
+  SimdW(t, 0xA2, "vscatterdps", "vscatterdpd", "GE");
+  SimdW(t, 0xA3, "vscatterqps", "vscatterqpd", "GE");
+  Simd(t, 0xB4, "vpmadd52luq");
+  Simd(t, 0xB5, "vpmadd52huq");
+
+  /* FMA: 132, 213 and 231 forms */
+  constexpr std::string_view kFma[3][10] = {
+      {"vfmaddsub132", "vfmsubadd132", "vfmadd132", "vfmadd132", "vfmsub132",
+       "vfmsub132", "vfnmadd132", "vfnmadd132", "vfnmsub132", "vfnmsub132"},
+      {"vfmaddsub213", "vfmsubadd213", "vfmadd213", "vfmadd213", "vfmsub213",
+       "vfmsub213", "vfnmadd213", "vfnmadd213", "vfnmsub213", "vfnmsub213"},
+      {"vfmaddsub231", "vfmsubadd231", "vfmadd231", "vfmadd231", "vfmsub231",
+       "vfmsub231", "vfnmadd231", "vfnmadd231", "vfnmsub231", "vfnmsub231"}};
+  for (uint8_t form = 0; form < 3; ++form) {
+    for (uint8_t i = 0; i < 10; ++i) {
+      /* The odd opcodes from 0x99 are the scalar forms */
+      const bool scalar = i >= 2 && (i & 1);
+      t[0x96 + form * 0x10 + i] =
+          OpcodeEntry{{kFma[form][i], scalar ? "s" : "p", "", ""},
+                      "EG",
+                      Select::FMA,
+                      0,
+                      true,
+                      'x',
+                      0};
+    }
+  }
+
+  Simd(t, 0xC8, "sha1nexte");
+  Simd(t, 0xC9, "sha1msg1");
+  Simd(t, 0xCA, "sha1msg2");
+  Simd(t, 0xCB, "sha256rnds2");
+  Simd(t, 0xCC, "sha256msg1");
+  Simd(t, 0xCD, "sha256msg2");
+  Simd(t, 0xDB, "aesimc");
+  Simd(t, 0xDC, "aesenc");
+  Simd(t, 0xDD, "aesenclast");
+  Simd(t, 0xDE, "aesdec");
+  Simd(t, 0xDF, "aesdeclast");
+
+  /* General purpose: MOVBE, CRC32 and BMI */
+  Pfx(t, 0xF0, "movbe", "movbe", "", "crc32", "EG", 0);
+  Pfx(t, 0xF1, "movbe", "movbe", "", "crc32", "GE", 0);
+  Op(t, 0xF2, "andn", "EG", 0, true);
+  Grp(t, 0xF3, kGroup17, "EV");
+  Pfx(t, 0xF5, "bzhi", "", "pext", "pdep", "EG", 0);
+  Pfx(t, 0xF6, "", "adcx", "adox", "mulx", "EG", 0);
+  Pfx(t, 0xF7, "bextr", "shlx", "sarx", "shrx", "EG", 0);
+  return t;
+}
+
+constexpr OpcodeTable BuildThreeByte3A() {
+  OpcodeTable t{};
+  Simd(t, 0x00, "vpermq", "IEG", 'x', 'b');
+  Simd(t, 0x01, "vpermpd", "IEG", 'x', 'b');
+  Simd(t, 0x02, "vpblendd", "IEG", 'x', 'b');
+  SimdW(t, 0x03, "valignd", "valignq", "IEG", 'b');
+  Simd(t, 0x04, "vpermilps", "IEG", 'x', 'b');
+  Simd(t, 0x05, "vpermilpd", "IEG", 'x', 'b');
+  Simd(t, 0x06, "vperm2f128", "IEG", 'x', 'b');
+  Simd(t, 0x08, "roundps", "IEG", 'x', 'b');
+  Simd(t, 0x09, "roundpd", "IEG", 'x', 'b');
+  Simd(t, 0x0A, "roundss", "IEG", 'x', 'b');
+  Simd(t, 0x0B, "roundsd", "IEG", 'x', 'b');
+  Simd(t, 0x0C, "blendps", "IEG", 'x', 'b');
+  Simd(t, 0x0D, "blendpd", "IEG", 'x', 'b');
+  Simd(t, 0x0E, "pblendw", "IEG", 'x', 'b');
+  Simd(t, 0x0F, "palignr", "IEG", 'm', 'b');
+  Simd(t, 0x14, "pextrb", "IGE", 'x', 'b');
+  Simd(t, 0x15, "pextrw", "IGE", 'x', 'b');
+  SimdW(t, 0x16, "pextrd", "pextrq", "IGE", 'b');
+  Simd(t, 0x17, "extractps", "IGE", 'x', 'b');
+  Simd(t, 0x18, "vinsertf128", "IEG", 'x', 'b');
+  Simd(t, 0x19, "vextractf128", "IGE", 'x', 'b');
+  SimdW(t, 0x1A, "vinsertf32x8", "vinsertf64x4", "IEG", 'b');
+  SimdW(t, 0x1B, "vextractf32x8", "vextractf64x4", "IGE", 'b');
+  Simd(t, 0x1D, "vcvtps2ph", "IGE", 'x', 'b');
+  SimdW(t, 0x1E, "vpcmpud", "vpcmpuq", "IEG", 'b');
+  SimdW(t, 0x1F, "vpcmpd", "vpcmpq", "IEG", 'b');
+  Simd(t, 0x20, "pinsrb", "IEG", 'x', 'b');
+  Simd(t, 0x21, "insertps", "IEG", 'x', 'b');
+  SimdW(t, 0x22, "pinsrd", "pinsrq", "IEG", 'b');
+  SimdW(t, 0x23, "vshuff32x4", "vshuff64x2", "IEG", 'b');
+  SimdW(t, 0x25, "vpternlogd", "vpternlogq", "IEG", 'b');
+  Simd(t, 0x38, "vinserti128", "IEG", 'x', 'b');
+  Simd(t, 0x39, "vextracti128", "IGE", 'x', 'b');
+  SimdW(t, 0x3A, "vinserti32x8", "vinserti64x4", "IEG", 'b');
+  SimdW(t, 0x3B, "vextracti32x8", "vextracti64x4", "IGE", 'b');
+  SimdW(t, 0x3E, "vpcmpub", "vpcmpuw", "IEG", 'b');
+  SimdW(t, 0x3F, "vpcmpb", "vpcmpw", "IEG", 'b');
+  Simd(t, 0x40, "dpps", "IEG", 'x', 'b');
+  Simd(t, 0x41, "dppd", "IEG", 'x', 'b');
+  Simd(t, 0x42, "mpsadbw", "IEG", 'x', 'b');
+  SimdW(t, 0x43, "vshufi32x4", "vshufi64x2", "IEG", 'b');
+  Simd(t, 0x44, "pclmulqdq", "IEG", 'x', 'b');
+  Simd(t, 0x46, "vperm2i128", "IEG", 'x', 'b');
+  Simd(t, 0x4A, "vblendvps", "REG", 'x', 'b');
+  Simd(t, 0x4B, "vblendvpd", "REG", 'x', 'b');
+  Simd(t, 0x4C, "vpblendvb", "REG", 'x', 'b');
+  Simd(t, 0x60, "pcmpestrm", "IEG", 'x', 'b');
+  Simd(t, 0x61, "pcmpestri", "IEG", 'x', 'b');
+  Simd(t, 0x62, "pcmpistrm", "IEG", 'x', 'b');
+  Simd(t, 0x63, "pcmpistri", "IEG", 'x', 'b');
+  /* FMA4 (AMD): the fourth operand is in the immediate */
+  constexpr std::string_view kFma4[] = {
+      "vfmaddps", "vfmaddpd", "vfmaddss", "vfmaddsd",
+      "vfmsubps", "vfmsubpd", "vfmsubss", "vfmsubsd",
+      "", "", "", "", "", "", "", "",
+      "vfnmaddps", "vfnmaddpd", "vfnmaddss", "vfnmaddsd",
+      "vfnmsubps", "vfnmsubpd", "vfnmsubss", "vfnmsubsd"};
+  for (uint8_t i = 0; i < 24; ++i) {
+    if (!kFma4[i].empty()) Simd(t, 0x68 + i, kFma4[i], "REG", 'x', 'b');
+  }
+  Simd(t, 0x5C, "vfmaddsubps", "REG", 'x', 'b');
+  Simd(t, 0x5D, "vfmaddsubpd", "REG", 'x', 'b');
+  Simd(t, 0x5E, "vfmsubaddps", "REG", 'x', 'b');
+  Simd(t, 0x5F, "vfmsubaddpd", "REG", 'x', 'b');
+  Simd(t, 0xCC, "sha1rnds4", "IEG", 'x', 'b');
+  Simd(t, 0xDF, "aeskeygenassist", "IEG", 'x', 'b');
+  Pfx(t, 0xF0, "", "", "", "rorx", "IEG", 0, 'b');
+  return t;
+}
+
+constexpr OpcodeTable kOneByte = BuildOneByte();
+constexpr OpcodeTable kTwoByte = BuildTwoByte();
+constexpr OpcodeTable kThreeByte38 = BuildThreeByte38();
+constexpr OpcodeTable kThreeByte3A = BuildThreeByte3A();
+
+constexpr const OpcodeTable *kMaps[] = {&kOneByte, &kTwoByte, &kThreeByte38,
+                                        &kThreeByte3A};
+
+/* Ranks the origins for the sources: memory dominates the cost */
+int Rank(const DataOrigin origin) noexcept {
+  switch (origin) {
+    case DataOrigin::MEMORY:
+      return 3;
+    case DataOrigin::REGISTER:
+      return 2;
+    case DataOrigin::IMMEDIATE:
+      return 1;
+    default:
+      return 0;
+  }
+}
+
+DataOrigin OriginOf(const char op, const bool memory) noexcept {
+  switch (op) {
+    case 'E':
+      return memory ? DataOrigin::MEMORY : DataOrigin::REGISTER;
+    case 'G':
+    case 'R':
+    case 'V':
+      return DataOrigin::REGISTER;
+    case 'I':
+      return DataOrigin::IMMEDIATE;
+    case 'M':
+    case 'O':
+    case 'J':
+      return DataOrigin::MEMORY;
+    default:
+      return DataOrigin::UNKNOWN;
+  }
+}
+
+/* Same encoding as x86Classifier: sources at the output shift and the
+ * destination at the input shift */
+void OperandTypes(const std::string_view ops, const bool memory,
+                  x86Instruction &inst) noexcept {  // NOLINT
+  if (ops.size() < 2) {
+    inst.optypes[0] = 'u';
+    inst.optypes[1] = 0;
+    inst.optypes_size = 1;
+    return;
+  }
+  DataOrigin source = DataOrigin::UNKNOWN;
+  for (std::size_t i = 0; i + 1 < ops.size(); ++i) {
+    const DataOrigin origin = OriginOf(ops[i], memory);
+    if (Rank(origin) > Rank(source)) source = origin;
+  }
+  const DataOrigin destination = OriginOf(ops.back(), memory);
+  inst.optypes[0] = x86OperandParser::OriginChar(source);
+  inst.optypes[1] = x86OperandParser::OriginChar(destination);
+  inst.optypes_size = 2;
+}
+
+std::size_t ImmediateSize(const char imm, const bool opsize16,
+                          const bool rexw, const bool addr32) noexcept {
+  switch (imm) {
+    case 'b':
+      return 1;
+    case 'w':
+      return 2;
+    case 'd':
+      return 4;
+    case 'z':
+      return opsize16 && !rexw ? 2 : 4;
+    case 'v':
+      return rexw ? 8 : (opsize16 ? 2 : 4);
+    case 'e':
+      return 3;
+    case 'o':
+      return addr32 ? 4 : 8;
+    default:
+      return 0;
+  }
+}
+
+void Append(x86Instruction &inst, const std::string_view s) noexcept {
+  for (const char c : s) {
+    if (inst.mnemonic_size >= x86Instruction::kMaxMnemonic) return;
+    inst.mnemonic[inst.mnemonic_size++] = c;
+  }
+}
+
+/* Entries of the per-thread classification cache (power of two) */
+constexpr std::size_t kCacheEntries = 1024;
+
+/* Classification of a decoded form */
+struct ClassCache {
+  uint64_t hash;
+  std::array<char, x86Instruction::kMaxMnemonic> mnemonic;
+  uint8_t mnemonic_size;
+  std::array<char, 2> optypes;
+  bool valid;
+  InstructionPair pair;
+  VectorTriplet vector;
+};
+
+} /* namespace */
+
+std::size_t x86Decoder::Decode(const uint8_t *code, const std::size_t size,
+                               x86Instruction &inst) const noexcept {
+  if (!code || 0 == size) return 0;
+  const std::size_t limit = size < kMaxLength ? size : kMaxLength;
+
+  /* Legacy prefixes: the last of F2/F3 is the one that counts */
+  std::size_t pos = 0;
+  bool opsize16 = false, addr32 = false;
+  uint8_t rep = 0;
+  for (; pos < limit; ++pos) {
+    const uint8_t b = code[pos];
+    if (0x66 == b) {
+      opsize16 = true;
+    } else if (0x67 == b) {
+      addr32 = true;
+    } else if (0xF2 == b || 0xF3 == b) {
+      rep = b;
+    } else if (!(0xF0 == b || 0x2E == b || 0x36 == b || 0x3E == b ||
+                 0x26 == b || 0x64 == b || 0x65 == b)) {
+      break;
+    }
+  }
+  if (pos >= limit) return 0;
+
+  uint8_t rex = 0;
+  if (0x40 == (code[pos] & 0xF0)) rex = code[pos++];
+  if (pos >= limit) return 0;
+
+  /* Opcode map and escapes */
+  x86Instruction::Encoding encoding = x86Instruction::Encoding::LEGACY;
+  uint8_t map = 0, pp = 0, vlen = 0;
+  bool rexw = rex & 0x08, evex_b = false;
+  const uint8_t escape = code[pos];
+  if (0xC5 == escape) {
+    if (pos + 2 >= limit) return 0;
+    const uint8_t p = code[pos + 1];
+    encoding = x86Instruction::Encoding::VEX;
+    map = 1;
+    vlen = (p >> 2) & 1;
+    pp = p & 3;
+    pos += 2;
+  } else if (0xC4 == escape) {
+    if (pos + 3 >= limit) return 0;
+    const uint8_t p1 = code[pos + 1], p2 = code[pos + 2];
+    encoding = x86Instruction::Encoding::VEX;
+    map = p1 & 0x1F;
+    rexw = p2 & 0x80;
+    vlen = (p2 >> 2) & 1;
+    pp = p2 & 3;
+    pos += 3;
+  } else if (0x62 == escape) {
+    if (pos + 4 >= limit) return 0;
+    const uint8_t p0 = code[pos + 1], p1 = code[pos + 2], p2 = code[pos + 3];
+    encoding = x86Instruction::Encoding::EVEX;
+    map = p0 & 0x07;
+    rexw = p1 & 0x80;
+    pp = p1 & 3;
+    vlen = (p2 >> 5) & 3;
+    evex_b = p2 & 0x10;
+    pos += 4;
+  } else if (0x0F == escape) {
+    if (pos + 1 >= limit) return 0;
+    map = 1;
+    ++pos;
+    if (0x38 == code[pos] || 0x3A == code[pos]) {
+      map = 0x38 == code[pos] ? 2 : 3;
+      ++pos;
+    }
+  }
+  if (map > 3 ||
+      (x86Instruction::Encoding::LEGACY != encoding && 0 == map) ||
+      pos >= limit) {
+    return 0;
+  }
+
+  const uint8_t opcode = code[pos++];
+  const OpcodeEntry &entry = (*kMaps[map])[opcode];
+  std::string_view ops = entry.ops;
+  char imm = entry.imm;
+  if (map == 3) imm = 'b';
+
+  /* Mandatory prefix: VEX/EVEX.pp or the legacy 66/F3/F2 */
+  uint8_t mandatory = pp;
+  if (x86Instruction::Encoding::LEGACY == encoding) {
+    mandatory = 0xF3 == rep ? 2 : (0xF2 == rep ? 3 : (opsize16 ? 1 : 0));
+    /* The mandatory 66 is not an operand size override */
+    if (Select::PREFIX == entry.select && 1 == mandatory) opsize16 = false;
+  }
+
+  /* ModRM, SIB and displacement */
+  uint8_t modrm = 0;
+  bool has_modrm = entry.modrm || 2 == map || 3 == map;
+  std::size_t disp = 0;
+  if (has_modrm) {
+    if (pos >= limit) return 0;
+    modrm = code[pos++];
+    const uint8_t mod = modrm >> 6, rm = modrm & 7;
+    if (3 != mod && 4 == rm) {
+      if (pos >= limit) return 0;
+      const uint8_t sib = code[pos++];
+      if (0 == mod && 5 == (sib & 7)) disp = 4;
+    }
+    if (1 == mod) {
+      disp = 1;
+    } else if (2 == mod || (0 == mod && 5 == rm)) {
+      disp = 4;
+    }
+  }
+  const bool memory = has_modrm && 3 != (modrm >> 6);
+  const uint8_t reg = (modrm >> 3) & 7;
+
+  /* Mnemonic */
+  std::string_view name;
+  std::string_view suffix;
+  switch (entry.select) {
+    case Select::PREFIX:
+      name = entry.names[mandatory].empty() ? entry.names[0]
+                                            : entry.names[mandatory];
+      break;
+    case Select::W:
+      name = entry.names[rexw ? 1 : 0];
+      break;
+    case Select::GROUP:
+      name = kGroups[entry.group][reg];
+      break;
+    case Select::X87:
+      name = memory ? kX87Memory[entry.group][reg]
+                    : kX87Register[entry.group][reg];
+      if (!memory) ops = X87RegisterOperands(entry.group, reg);
+      if (!memory && 1 == entry.group && reg >= 4) {
+        name = kX87Constants[(modrm & 0x3F) - 0x20];
+      } else if (!memory && 3 == entry.group && 4 == reg) {
+        name = 0xE2 == modrm ? "fnclex" : "fninit";
+      }
+      break;
+    case Select::FMA:
+      name = entry.names[0];
+      suffix = "p" == entry.names[1] ? (rexw ? "pd" : "ps")
+                                     : (rexw ? "sd" : "ss");
+      break;
+    default:
+      name = entry.names[0];
+      break;
+  }
+
+  /* Forms that do not fit in the tables */
+  if (0 == map && (0xF6 == opcode || 0xF7 == opcode) && reg >= 2) {
+    ops = "E";
+    imm = 0;
+  } else if (1 == map && !memory && (0x12 == opcode || 0x16 == opcode) &&
+             0 == mandatory) {
+    name = 0x12 == opcode ? "movhlps" : "movlhps";
+  } else if (1 == map && 0x1E == opcode && 2 == mandatory && 0xFA == modrm) {
+    name = "endbr64";
+    ops = "";
+  } else if (1 == map && 0xAE == opcode && !memory) {
+    /* The prefixed register forms are not fences (i.e. F3: incssp) */
+    if (reg < 5 || 0 != mandatory) return 0;
+    name = 5 == reg ? "lfence" : (6 == reg ? "mfence" : "sfence");
+    ops = "";
+  } else if (1 == map && opcode >= 0x71 && opcode <= 0x73 &&
+             x86Instruction::Encoding::LEGACY != encoding) {
+    /* Shifts by immediate: the destination is VEX.vvvv. EVEX adds the
+       rotations and the quadword arithmetic shift to group 13 */
+    ops = "IEV";
+    if (0x72 == opcode && x86Instruction::Encoding::EVEX == encoding) {
+      if (reg <= 1) {
+        name = 0 == reg ? "vpror" : "vprol";
+        suffix = rexw ? "q" : "d";
+      } else if (4 == reg && rexw) {
+        name = "vpsraq";
+      }
+    }
+  } else if (0 == map && 0x90 == opcode && 1 == mandatory) {
+    /* xchg %ax,%ax */
+    ops = "RR";
+  } else if (0 == map && (0xC6 == opcode || 0xC7 == opcode) &&
+             0xF8 == modrm) {
+    name = 0xC6 == opcode ? "xabort" : "xbegin";
+    ops = 0xC6 == opcode ? "I" : "J";
+  } else if (1 == map && 0x01 == opcode && !memory) {
+    switch (modrm) {
+      case 0xD0:
+        name = "xgetbv";
+        break;
+      case 0xD5:
+        name = "xend";
+        break;
+      case 0xD6:
+        name = "xtest";
+        break;
+      case 0xEE:
+        name = "rdpkru";
+        break;
+      case 0xEF:
+        name = "wrpkru";
+        break;
+      case 0xF9:
+        name = "rdtscp";
+        break;
+      default:
+        break;
+    }
+    ops = "";
+  } else if (1 == map && x86Instruction::Encoding::VEX == encoding &&
+             !MaskName(opcode).empty()) {
+    name = MaskName(opcode);
+    suffix = MaskSuffix(opcode, pp, rexw);
+    ops = 0x91 == opcode ? "GE" : "EG";
+  } else if (2 == map && (0x26 == opcode || 0x27 == opcode) && 2 == pp) {
+    name = "vptestnm";
+    suffix = 0x26 == opcode ? (rexw ? "w" : "b") : (rexw ? "q" : "d");
+  } else if (1 == map && 0x7E == opcode && 2 == mandatory) {
+    name = "movq";
+    ops = "EG";
+  } else if (1 == map && 0x77 == opcode &&
+             x86Instruction::Encoding::LEGACY != encoding) {
+    name = vlen ? "vzeroall" : "vzeroupper";
+  } else if (1 == map && (0xB6 == opcode || 0xBE == opcode) && rexw) {
+    name = 0xB6 == opcode ? "movzbq" : "movsbq";
+  } else if (1 == map && (0xB7 == opcode || 0xBF == opcode) && rexw) {
+    name = 0xB7 == opcode ? "movzwq" : "movswq";
+  } else if (1 == map && 0xC7 == opcode && 1 == reg && rexw) {
+    name = "cmpxchg16b";
+  }
+  if (name.empty()) return 0;
+
+  const std::size_t length = pos + disp +
+                             ImmediateSize(imm, opsize16, rexw, addr32);
+  if (length > limit) return 0;
+
+  inst.mnemonic_size = 0;
+  if (x86Instruction::Encoding::LEGACY != encoding && entry.simd &&
+      'v' != name.front()) {
+    Append(inst, "v");
+  }
+  Append(inst, name);
+  Append(inst, suffix);
+
+  /* AVX-512 forms with the element size in the mnemonic */
+  if (x86Instruction::Encoding::EVEX == encoding && 1 == map) {
+    if ((0x6F == opcode || 0x7F == opcode) && 0 != mandatory) {
+      inst.mnemonic_size = 0;
+      Append(inst, 1 == mandatory ? "vmovdqa" : "vmovdqu");
+      if (3 == mandatory) {
+        Append(inst, rexw ? "16" : "8");
+      } else {
+        Append(inst, rexw ? "64" : "32");
+      }
+    } else if (0xDB == opcode || 0xDF == opcode || 0xEB == opcode ||
+               0xEF == opcode) {
+      Append(inst, rexw ? "q" : "d");
+    }
+  } else if (x86Instruction::Encoding::EVEX == encoding && 3 == map &&
+             (0x18 == opcode || 0x19 == opcode || 0x38 == opcode ||
+              0x39 == opcode)) {
+    /* vinsertf128 -> vinsertf32x4 / vinsertf64x2 */
+    inst.mnemonic_size -= 3;
+    Append(inst, rexw ? "64x2" : "32x4");
+  }
+
+  /* Register width from the encoding */
+  VectorWidth width = VectorWidth::NONE;
+  if (entry.simd) {
+    if (x86Instruction::Encoding::EVEX == encoding) {
+      width = evex_b && !memory
+                  ? VectorWidth::ZMM
+                  : (2 <= vlen ? VectorWidth::ZMM
+                               : (1 == vlen ? VectorWidth::YMM
+                                            : VectorWidth::XMM));
+    } else if (x86Instruction::Encoding::VEX == encoding) {
+      width = vlen ? VectorWidth::YMM : VectorWidth::XMM;
+    } else {
+      width = 'm' == entry.simd && 0 == mandatory ? VectorWidth::MMX
+                                                  : VectorWidth::XMM;
+    }
+  }
+
+  OperandTypes(ops, memory, inst);
+  inst.length = static_cast<uint8_t>(length);
+  inst.encoding = encoding;
+  inst.map = map;
+  inst.opcode = opcode;
+
+  /* Classification memoised per thread, keyed by mnemonic, operand types and
+   * width: the decoded forms repeat much more than the bytes */
+  thread_local std::array<ClassCache, kCacheEntries> cache{};
+  uint64_t h = 14695981039346656037ull;
+  for (uint8_t i = 0; i < inst.mnemonic_size; ++i) {
+    h = (h ^ static_cast<uint8_t>(inst.mnemonic[i])) * 1099511628211ull;
+  }
+  h = (h ^ static_cast<uint8_t>(inst.optypes[0])) * 1099511628211ull;
+  h = (h ^ static_cast<uint8_t>(inst.optypes[1])) * 1099511628211ull;
+  h = (h ^ static_cast<uint8_t>(width)) * 1099511628211ull;
+  ClassCache &slot = cache[(h >> 32) & (kCacheEntries - 1)];
+  if (!slot.valid || slot.hash != h || slot.optypes != inst.optypes ||
+      std::string_view{slot.mnemonic.data(), slot.mnemonic_size} !=
+          inst.Mnemonic()) {
+    slot.valid = true;
+    slot.hash = h;
+    slot.mnemonic = inst.mnemonic;
+    slot.mnemonic_size = inst.mnemonic_size;
+    slot.optypes = inst.optypes;
+    slot.pair =
+        this->classifier_.Classify(inst.Mnemonic(), inst.OperandTypes());
+    slot.vector = this->classifier_.ClassifyVector(inst.Mnemonic(), width);
+  }
+  inst.pair = slot.pair;
+  inst.vector = slot.vector;
+  return length;
+}
+
+} /* namespace efimon */
@@ -0,0 +1,165 @@
+/**
+ * @file x86-operands.cpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Tokenizer of the x86 operands as printed by objdump and perf, in
+ * AT&T and Intel syntaxes
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#include <efimon/asm-classifier/x86-operands.hpp>
+#include <string_view>
+
+namespace efimon {
+
+using namespace assembly;  // NOLINT
+
+static std::string_view Trim(std::string_view s) noexcept {
+  while (!s.empty() && (' ' == s.front() || '\t' == s.front()))
+    s.remove_prefix(1);
+  while (!s.empty() && (' ' == s.back() || '\t' == s.back()))
+    s.remove_suffix(1);
+  return s;
+}
+
+static bool IsDigit(const char c) noexcept { return c >= '0' && c <= '9'; }
+
+/* Ranks the origins for the sources: memory dominates the cost */
+static int Rank(const DataOrigin origin) noexcept {
+  switch (origin) {
+    case DataOrigin::MEMORY:
+      return 3;
+    case DataOrigin::REGISTER:
+      return 2;
+    case DataOrigin::IMMEDIATE:
+      return 1;
+    default:
+      return 0;
+  }
+}
+
+/* Consumes the trailing AVX-512 decorations: {%k1}{z}, {1to16}, {sae} */
+static std::string_view StripDecorations(std::string_view op,
+                                         x86Operands &res) noexcept {
+  while (!op.empty() && '}' == op.back()) {
+    auto open = op.rfind('{');
+    if (std::string_view::npos == open) break;
+    std::string_view deco = op.substr(open + 1, op.size() - open - 2);
+    op = Trim(op.substr(0, open));
+
+    if (!deco.empty() && '%' == deco.front()) deco.remove_prefix(1);
+    if (deco.size() >= 2 && 'k' == deco[0] && IsDigit(deco[1])) {
+      /* k0 means no masking */
+      res.masked = res.masked || "k0" != deco;
+    } else if ("z" == deco) {
+      res.zeroing = true;
+    } else if (deco.substr(0, 3) == "1to") {
+      res.broadcast = true;
+    } else if (deco.find("sae") != std::string_view::npos) {
+      res.rounding = true;
+    }
+  }
+  return op;
+}
+
+static DataOrigin ParseAtt(std::string_view op, x86Operands &res) noexcept {
+  /* Indirect branches: *%rax or *(%rax) */
+  if ('*' == op.front()) op.remove_prefix(1);
+  if (op.empty()) return DataOrigin::UNKNOWN;
+
+  if ('$' == op.front()) return DataOrigin::IMMEDIATE;
+  /* x87 stack registers: %st(1) */
+  if (op.substr(0, 3) == "%st") return DataOrigin::REGISTER;
+  if (op.find('(') != std::string_view::npos) {
+    res.rip_relative = res.rip_relative ||
+                       op.find("%rip") != std::string_view::npos ||
+                       op.find("%eip") != std::string_view::npos;
+    res.segment = res.segment || op.find(':') != std::string_view::npos;
+    return DataOrigin::MEMORY;
+  }
+  if ('%' == op.front()) {
+    /* Segment override with an absolute displacement: %fs:0x28 */
+    if (op.find(':') != std::string_view::npos) {
+      res.segment = true;
+      return DataOrigin::MEMORY;
+    }
+    return DataOrigin::REGISTER;
+  }
+  /* Bare displacement: absolute memory address */
+  return DataOrigin::MEMORY;
+}
+
+static DataOrigin ParseIntel(std::string_view op, x86Operands &res) noexcept {
+  const bool segment = op.find(':') != std::string_view::npos;
+  if (op.find('[') != std::string_view::npos || segment) {
+    res.rip_relative = res.rip_relative ||
+                       op.find("rip") != std::string_view::npos ||
+                       op.find("eip") != std::string_view::npos;
+    res.segment = res.segment || segment;
+    return DataOrigin::MEMORY;
+  }
+  if (IsDigit(op.front()) || '-' == op.front()) return DataOrigin::IMMEDIATE;
+  return DataOrigin::REGISTER;
+}
+
+x86Operands x86OperandParser::Parse(std::string_view operands,
+                                    const Syntax syntax) noexcept {
+  x86Operands res{};
+  res.origins.fill(DataOrigin::UNKNOWN);
+  res.source = DataOrigin::UNKNOWN;
+  res.destination = DataOrigin::UNKNOWN;
+
+  auto comment = operands.find('#');
+  if (std::string_view::npos != comment) operands = operands.substr(0, comment);
+
+  /* Split by the commas at depth zero */
+  std::size_t start = 0;
+  int depth = 0;
+  for (std::size_t i = 0; i <= operands.size(); ++i) {
+    const char c = i < operands.size() ? operands[i] : ',';
+    if ('(' == c || '[' == c || '{' == c) {
+      ++depth;
+      continue;
+    } else if (')' == c || ']' == c || '}' == c) {
+      --depth;
+      continue;
+    } else if (',' != c || depth > 0) {
+      continue;
+    }
+
+    std::string_view op = Trim(operands.substr(start, i - start));
+    start = i + 1;
+    op = StripDecorations(op, res);
+    /* Standalone decorations, i.e. {rn-sae}, are not operands */
+    if (op.empty() || res.count >= x86Operands::kMaxOperands) continue;
+
+    res.origins[res.count++] = Syntax::INTEL == syntax ? ParseIntel(op, res)
+                                                       : ParseAtt(op, res);
+  }
+
+  if (0 == res.count) return res;
+
+  /* AT&T writes the destination last and Intel first */
+  const std::size_t dst = Syntax::INTEL == syntax ? 0 : res.count - 1;
+  res.destination = res.origins[dst];
+  for (std::size_t i = 0; i < res.count; ++i) {
+    if (dst == i && 1 != res.count) continue;
+    if (Rank(res.origins[i]) > Rank(res.source)) res.source = res.origins[i];
+  }
+  return res;
+}
+
+char x86OperandParser::OriginChar(const DataOrigin origin) noexcept {
+  switch (origin) {
+    case DataOrigin::MEMORY:
+      return 'm';
+    case DataOrigin::REGISTER:
+      return 'r';
+    case DataOrigin::IMMEDIATE:
+      return 'i';
+    default:
+      return 'u';
+  }
+}
+
+} /* namespace efimon */
@@ -26,9 +26,11 @@ std::string CSVLogger::Stringify(const std::shared_ptr<Logger::IValue> val) {
       return std::string{"0"};
     }
     case Logger::FieldType::FLOAT: {
-      auto valc = std::dynamic_pointer_cast<const Logger::Value<float>>(val);
-      if (!valc) return std::string{"0.0"};
-      return std::to_string(valc->val);
+      auto valf = std::dynamic_pointer_cast<const Logger::Value<float>>(val);
+      auto vald = std::dynamic_pointer_cast<const Logger::Value<double>>(val);
+      if (valf) return std::to_string(valf->val);
+      if (vald) return std::to_string(vald->val);
+      return std::string{"0.0"};
     }
     case Logger::FieldType::STRING: {
       auto valc =
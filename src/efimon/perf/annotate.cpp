@@ -10,6 +10,7 @@
 #include <efimon/observer-enums.hpp>
 #include <efimon/observer.hpp>
 #include <efimon/perf/annotate.hpp>
+#include <efimon/perf/jit-map.hpp>
 #include <efimon/readings.hpp>
 #include <efimon/status.hpp>
 #include <fstream>
@@ -17,6 +18,8 @@
 #include <memory>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 #include <third-party/pstream.hpp>
@@ -44,6 +47,8 @@ PerfAnnotateObserver::PerfAnnotateObserver(PerfRecordObserver& record)
 #if defined(__x86_64__) || defined(_M_X64) || defined(i386) || \
     defined(__i386__) || defined(__i386) || defined(_M_IX86)
   this->classifier_ = AsmClassifier::Build(assembly::Architecture::X86);
+#elif defined(__aarch64__) || defined(_M_ARM64)
+  this->classifier_ = AsmClassifier::Build(assembly::Architecture::AARCH64);
 #else
   this->classifier_ = nullptr;
 #endif
@@ -78,7 +83,10 @@ Status PerfAnnotateObserver::Trigger() {
 
   /* Parsing the results */
   ret = this->ParseResults(ip);
-  return ret;
+  if (Status::OK != ret.code) return ret;
+
+  /* JIT code is not annotated by perf: account it from the samples */
+  return this->AccountJit();
 }
 
 Status PerfAnnotateObserver::ParseResults(redi::ipstream& ip) {
@@ -90,6 +98,9 @@ Status PerfAnnotateObserver::ParseResults(redi::ipstream& ip) {
   /* Cleat the histogram */
   this->readings_.histogram.clear();
   this->readings_.classification.clear();
+  this->readings_.vector_width.clear();
+  this->readings_.element_type.clear();
+  this->readings_.vector_packing.clear();
 
   /* Read the file line by line */
   std::string line;
@@ -114,50 +125,125 @@ Status PerfAnnotateObserver::ParseResults(redi::ipstream& ip) {
     sloc >> drop; /* Get rid of ':' */
     sloc >> drop; /* Get rid of 'address' */
     sloc >> assembly;
-    sloc >> operands;
+    /* The rest of the line: the AArch64 operands are separated by spaces */
+    std::getline(sloc >> std::ws, operands);
+    /* The branch targets are annotated as "4005d0 <main+0x20>", where the
+       symbol may have commas and parentheses (C++). It is not an operand */
+    operands = operands.substr(0, operands.find('<'));
+    operands.erase(operands.find_last_not_of(" \t") + 1);
 
     /* Classify */
-    if (!this->classifier_) continue;
-    std::string optypes = this->classifier_->OperandTypes(operands);
-    InstructionPair classification =
-        this->classifier_->Classify(assembly, optypes);
-    assembly += std::string("_") + optypes;
-
-    /* Add to the histogram */
-    if (this->readings_.histogram.find(assembly) ==
-        this->readings_.histogram.end()) {
-      this->readings_.histogram[assembly] = percent;
-    } else {
-      this->readings_.histogram[assembly] += percent;
-    }
-
-    /* Handle the creation of the maps */
-    bool family_found =
-        this->readings_.classification[std::get<0>(classification)].find(
-            std::get<1>(classification)) !=
-        this->readings_.classification[std::get<0>(classification)].end();
-    if (!family_found) {
-      this->readings_.classification[std::get<0>(classification)]
-                                    [std::get<1>(classification)] = {};
-    }
-    bool origin_found = this->readings_
-                            .classification[std::get<0>(classification)]
-                                           [std::get<1>(classification)]
-                            .find(std::get<2>(classification)) !=
-                        this->readings_
-                            .classification[std::get<0>(classification)]
-                                           [std::get<1>(classification)]
-                            .end();
-    if (!origin_found) {
-      this->readings_.classification[std::get<0>(classification)][std::get<1>(
-          classification)][std::get<2>(classification)] = 0.f;
-    }
+    this->AddInstruction(assembly, operands, percent);
+  }
+
+  this->valid_ = true;
+  return Status{};
+}
+
+void PerfAnnotateObserver::AddInstruction(std::string assembly,
+                                          const std::string& operands,
+                                          const float percent) {
+  if (!this->classifier_) return;
+
+  /* SIMD taxonomy: only for instructions on vector registers */
+  VectorTriplet vector = this->classifier_->ClassifyVector(
+      std::string_view{assembly}, std::string_view{operands});
+  if (assembly::VectorWidth::NONE != std::get<0>(vector)) {
+    this->readings_.vector_width[std::get<0>(vector)] += percent;
+    this->readings_.element_type[std::get<1>(vector)] += percent;
+    this->readings_.vector_packing[std::get<2>(vector)] += percent;
+  }
+
+  std::string optypes = this->classifier_->OperandTypes(operands);
+  InstructionPair classification =
+      this->classifier_->Classify(assembly, optypes);
+  assembly += std::string("_") + optypes;
+
+  /* Add to the histogram */
+  if (this->readings_.histogram.find(assembly) ==
+      this->readings_.histogram.end()) {
+    this->readings_.histogram[assembly] = percent;
+  } else {
+    this->readings_.histogram[assembly] += percent;
+  }
 
+  /* Handle the creation of the maps */
+  bool family_found =
+      this->readings_.classification[std::get<0>(classification)].find(
+          std::get<1>(classification)) !=
+      this->readings_.classification[std::get<0>(classification)].end();
+  if (!family_found) {
+    this->readings_.classification[std::get<0>(classification)]
+                                  [std::get<1>(classification)] = {};
+  }
+  bool origin_found = this->readings_
+                          .classification[std::get<0>(classification)]
+                                         [std::get<1>(classification)]
+                          .find(std::get<2>(classification)) !=
+                      this->readings_
+                          .classification[std::get<0>(classification)]
+                                         [std::get<1>(classification)]
+                          .end();
+  if (!origin_found) {
     this->readings_.classification[std::get<0>(classification)][std::get<1>(
-        classification)][std::get<2>(classification)] += percent;
+        classification)][std::get<2>(classification)] = 0.f;
   }
 
-  this->valid_ = true;
+  this->readings_.classification[std::get<0>(classification)][std::get<1>(
+      classification)][std::get<2>(classification)] += percent;
+}
+
+Status PerfAnnotateObserver::AccountJit() {
+  const uint pid = this->record_.GetPID();
+  if (ObserverScope::PROCESS != this->record_.GetScope() || 0 == pid) {
+    return Status{};
+  }
+
+  /* Only pay for perf script when the process has JIT code */
+  if (!this->jit_ || this->jit_->GetPID() != pid) {
+    if (!JitCodeMap::Exists(pid)) return Status{};
+    this->jit_ = std::make_unique<JitCodeMap>(pid);
+  }
+  Status st = this->jit_->Refresh();
+  if (Status::OK != st.code) return st;
+  if (0 == this->jit_->GetNumRegions()) return Status{};
+
+  /* Weight each sample by its period, like --percent-type global-period.
+     The data has call graphs: -G leaves a single line per sample */
+  std::string cmd = std::string("cd ") +
+                    std::string(this->record_.tmp_folder_path_) +
+                    " && perf script -G -F period,ip -i " +
+                    std::string(this->record_.path_to_perf_data_);
+  redi::ipstream ip(cmd, redi::pstreambuf::pstdout);
+  if (!ip.is_open()) {
+    return Status{Status::FILE_ERROR, "Cannot execute perf script command"};
+  }
+
+  std::unordered_map<uint64_t, uint64_t> jit_periods;
+  uint64_t total = 0;
+  std::string line;
+  while (std::getline(ip, line)) {
+    std::istringstream sline{line};
+    uint64_t period = 0;
+    std::string sip, extra;
+    sline >> period >> sip;
+    /* Only the sample lines: "<period> <ip>" */
+    if (sline.fail() || (sline >> extra)) continue;
+    total += period;
+
+    uint64_t address = std::strtoull(sip.c_str(), nullptr, 16);
+    if (this->jit_->Find(address)) jit_periods[address] += period;
+  }
+  if (0 == total) return Status{};
+
+  std::string mnemonic, operands;
+  for (const auto& entry : jit_periods) {
+    float percent = 100.f * entry.second / total;
+    if (PERF_ANNOTATE_THRES >= percent) continue;
+    if (Status::OK != this->jit_->Lookup(entry.first, mnemonic, operands).code)
+      continue;
+    this->AddInstruction(mnemonic, operands, percent);
+  }
   return Status{};
 }
 
@@ -0,0 +1,194 @@
+/**
+ * @file callgraph.cpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Observer to fold the call graphs recorded by perf record through
+ * the perf script command. This depends on the perf record class
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#include <algorithm>
+#include <efimon/observer-enums.hpp>
+#include <efimon/observer.hpp>
+#include <efimon/perf/callgraph.hpp>
+#include <efimon/readings.hpp>
+#include <efimon/status.hpp>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <third-party/pstream.hpp>
+
+namespace efimon {
+
+PerfCallgraphObserver::PerfCallgraphObserver(PerfRecordObserver& record)
+    : Observer{}, record_{record} {
+  this->valid_ = false;
+
+  uint64_t type = static_cast<uint64_t>(ObserverType::CPU) |
+                  static_cast<uint64_t>(ObserverType::INTERVAL) |
+                  static_cast<uint64_t>(ObserverType::CPU_INSTRUCTIONS);
+
+  /* Defines the commands and paths required */
+  this->ReconstructPath();
+
+  this->caps_.emplace_back();
+  this->caps_[0].type = type;
+
+  this->Reset();
+}
+
+void PerfCallgraphObserver::ReconstructPath() {
+  std::filesystem::path tmp_folder = this->record_.tmp_folder_path_;
+  this->command_prefix_ = std::string("cd ") + std::string(tmp_folder);
+  this->command_prefix_ += " && perf script -F comm,ip,sym -i ";
+}
+
+Status PerfCallgraphObserver::Trigger() {
+  if (!this->record_.valid_)
+    return Status{Status::NOT_READY, "Not ready to query"};
+
+  this->ReconstructPath();
+
+  /* Executing the script command */
+  std::string cmd =
+      this->command_prefix_ + std::string(this->record_.path_to_perf_data_);
+
+  redi::ipstream ip(cmd, redi::pstreambuf::pstdout);
+  if (!ip.is_open()) {
+    return Status{Status::FILE_ERROR, "Cannot execute perf script command"};
+  }
+
+  /* Parsing the results */
+  Status ret = this->ParseResults(ip);
+
+  this->readings_.type = static_cast<uint64_t>(ObserverType::CPU);
+  this->readings_.timestamp = this->record_.readings_.timestamp;
+  this->readings_.difference = this->record_.readings_.difference;
+  return ret;
+}
+
+/* The ';' is the frame separator of the folded stacks */
+static std::string SanitiseFrame(const std::string& line, const size_t begin) {
+  size_t end = line.find_last_not_of(" \t\r");
+  if (std::string::npos == end || end < begin) return "";
+  std::string frame = line.substr(begin, end - begin + 1);
+  std::replace(frame.begin(), frame.end(), ';', ':');
+  return frame;
+}
+
+Status PerfCallgraphObserver::ParseResults(redi::ipstream& ip) {
+  std::string line;
+  std::string folded;
+  std::vector<std::string> frames;
+  bool in_sample = false;
+
+  this->readings_.stacks.clear();
+  this->readings_.samples = 0;
+
+  /* Folds the current sample: the frames come from the leaf to the root */
+  auto fold = [&]() {
+    if (!in_sample) return;
+    for (auto it = frames.rbegin(); it != frames.rend(); ++it) {
+      folded += ";";
+      folded += *it;
+    }
+    this->readings_.stacks[folded]++;
+    this->readings_.samples++;
+    frames.clear();
+    in_sample = false;
+  };
+
+  /*
+   * Samples are separated by a blank line. The header of each sample holds
+   * the command name and each frame starts with a tab followed by the
+   * instruction pointer and the symbol
+   */
+  while (std::getline(ip, line)) {
+    if (line.empty()) {
+      fold();
+      continue;
+    }
+
+    if ('\t' != line[0]) {
+      fold();
+      size_t begin = line.find_first_not_of(" ");
+      if (std::string::npos == begin) continue;
+      folded = SanitiseFrame(line, begin);
+      in_sample = true;
+      continue;
+    }
+
+    /* Frame: skip the address */
+    size_t begin = line.find_first_not_of(" \t");
+    if (std::string::npos == begin) continue;
+    begin = line.find_first_of(" ", begin);
+    if (std::string::npos == begin) continue;
+    begin = line.find_first_not_of(" ", begin);
+    if (std::string::npos == begin) continue;
+    std::string frame = SanitiseFrame(line, begin);
+    if (!frame.empty()) frames.push_back(frame);
+  }
+  fold();
+
+  this->valid_ = true;
+  return Status{};
+}
+
+std::vector<Readings*> PerfCallgraphObserver::GetReadings() {
+  return std::vector<Readings*>{static_cast<Readings*>(&(this->readings_))};
+}
+
+Status PerfCallgraphObserver::SelectDevice(const uint /* device */) {
+  return Status{
+      Status::NOT_IMPLEMENTED,
+      "It is not possible to select a device since this is a wrapper class"};
+}
+
+Status PerfCallgraphObserver::SetScope(const ObserverScope /* scope */) {
+  return Status{
+      Status::NOT_IMPLEMENTED,
+      "It is not possible change the scope since this is a wrapper class"};
+}
+
+Status PerfCallgraphObserver::SetPID(const uint /* pid */) {
+  return Status{
+      Status::NOT_IMPLEMENTED,
+      "It is not possible change the PID since this is a wrapper class"};
+}
+
+ObserverScope PerfCallgraphObserver::GetScope() const noexcept {
+  return this->record_.GetScope();
+}
+
+uint PerfCallgraphObserver::GetPID() const noexcept {
+  return this->record_.GetPID();
+}
+
+const std::vector<ObserverCapabilities>&
+PerfCallgraphObserver::GetCapabilities() const noexcept {
+  return this->caps_;
+}
+
+Status PerfCallgraphObserver::GetStatus() { return Status{}; }
+
+Status PerfCallgraphObserver::SetInterval(const uint64_t interval) {
+  this->interval_ = interval;
+  return Status{};
+}
+
+Status PerfCallgraphObserver::ClearInterval() { return Status{}; }
+
+Status PerfCallgraphObserver::Reset() {
+  this->readings_.stacks.clear();
+  this->readings_.samples = 0;
+  this->readings_.timestamp = 0;
+  this->readings_.difference = 0;
+  this->valid_ = false;
+  this->readings_.type = static_cast<int>(ObserverType::CPU);
+  return Status{};
+}
+
+PerfCallgraphObserver::~PerfCallgraphObserver() {}
+
+} /* namespace efimon */
@@ -0,0 +1,240 @@
+/**
+ * @file counter.cpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Observer to query the hardware performance counters through
+ * perf_event_open counting groups
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#include <unistd.h>
+
+#include <efimon/perf/counter.hpp>
+#include <efimon/proc/thread-tree.hpp>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace efimon {
+
+extern uint64_t GetUptime();
+
+PerfCounterObserver::PerfCounterObserver(const uint pid,
+                                         const ObserverScope scope,
+                                         const uint64_t interval)
+    : Observer{}, valid_{false}, scope_{scope} {
+  uint64_t type = static_cast<uint64_t>(ObserverType::CPU) |
+                  static_cast<uint64_t>(ObserverType::PMU) |
+                  static_cast<uint64_t>(ObserverType::INTERVAL);
+
+  this->pid_ = pid;
+  this->interval_ = interval;
+
+  this->caps_.emplace_back();
+  this->caps_[0].type = type;
+  this->caps_[0].scope = scope;
+
+  this->Reset();
+  Status st = this->OpenGroups();
+  if (Status::OK != st.code) {
+    throw st;
+  }
+}
+
+Status PerfCounterObserver::OpenGroups() {
+  std::vector<int> pids, cpus;
+
+  this->groups_.clear();
+  this->last_values_.clear();
+  this->valid_ = false;
+
+  if (ObserverScope::SYSTEM == this->scope_) {
+    const int num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    for (int cpu = 0; cpu < num_cpus; ++cpu) {
+      pids.push_back(-1);
+      cpus.push_back(cpu);
+    }
+  } else {
+    if (0 == this->pid_) {
+      return Status{Status::NOT_READY, "Invalid PID. Assign one"};
+    }
+    std::filesystem::path task_path =
+        std::filesystem::path("/proc") / std::to_string(this->pid_) / "task";
+    if (!std::filesystem::exists(task_path)) {
+      return Status{Status::NOT_FOUND, "Cannot check that PID is alive"};
+    }
+    ThreadTree tree{static_cast<int>(this->pid_)};
+    for (const int tid : tree.GetTree()) {
+      pids.push_back(tid);
+      cpus.push_back(-1);
+    }
+  }
+
+  const bool inherit = ObserverScope::PROCESS == this->scope_;
+  Status error{Status::CANNOT_OPEN, "Cannot open any counting group"};
+  for (uint i = 0; i < pids.size(); ++i) {
+    PerfEventGroup group;
+    group.AddEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    group.AddEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, false);
+    group.AddEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, false);
+    group.AddEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, false);
+
+    Status st = group.Open(pids[i], cpus[i], inherit);
+    /* Threads may finish in between: skip them */
+    if (Status::OK != st.code && pids[i] > 0) {
+      error = st;
+      continue;
+    }
+    if (Status::OK != st.code) {
+      this->groups_.clear();
+      return st;
+    }
+    st = group.Enable();
+    if (Status::OK != st.code) {
+      this->groups_.clear();
+      return st;
+    }
+    this->groups_.emplace_back(std::move(group));
+  }
+
+  if (this->groups_.empty()) {
+    return error;
+  }
+
+  this->last_values_.resize(this->groups_.size());
+  for (uint i = 0; i < this->groups_.size(); ++i) {
+    Status st = this->groups_[i].Read(this->last_values_[i]);
+    if (Status::OK != st.code) {
+      this->groups_.clear();
+      this->last_values_.clear();
+      return st;
+    }
+  }
+  this->readings_.timestamp = GetUptime();
+  return Status{};
+}
+
+Status PerfCounterObserver::Trigger() {
+  if (this->groups_.empty()) {
+    return Status{Status::NOT_READY, "The counting groups are not open"};
+  }
+
+  double counts[NUM_EVENTS] = {0.};
+  uint64_t enabled = 0, running = 0;
+
+  for (uint g = 0; g < this->groups_.size(); ++g) {
+    PerfEventGroup::Values values;
+    Status st = this->groups_[g].Read(values);
+    if (Status::OK != st.code) return st;
+
+    auto &last = this->last_values_[g];
+    const uint64_t delta_enabled = values.time_enabled - last.time_enabled;
+    const uint64_t delta_running = values.time_running - last.time_running;
+    enabled += delta_enabled;
+    running += delta_running;
+
+    /* Scale to compensate the multiplexing */
+    if (0 != delta_running) {
+      const double scale = static_cast<double>(delta_enabled) /
+                           static_cast<double>(delta_running);
+      for (uint e = 0; e < NUM_EVENTS; ++e) {
+        counts[e] += scale * (values.counters[e] - last.counters[e]);
+      }
+    }
+    last = std::move(values);
+  }
+
+  /* Set readings common metadata */
+  auto time = GetUptime();
+  this->readings_.type = static_cast<uint64_t>(ObserverType::CPU) |
+                         static_cast<uint64_t>(ObserverType::PMU);
+  this->readings_.difference = time - this->readings_.timestamp;
+  this->readings_.timestamp = time;
+
+  this->readings_.cycles = static_cast<uint64_t>(counts[CYCLES]);
+  this->readings_.instructions = static_cast<uint64_t>(counts[INSTRUCTIONS]);
+  this->readings_.cache_misses = static_cast<uint64_t>(counts[CACHE_MISSES]);
+  this->readings_.branch_misses = static_cast<uint64_t>(counts[BRANCH_MISSES]);
+
+  const double kinst = counts[INSTRUCTIONS] / 1000.;
+  this->readings_.ipc =
+      counts[CYCLES] > 0. ? counts[INSTRUCTIONS] / counts[CYCLES] : 0.f;
+  this->readings_.cache_mpki = kinst > 0. ? counts[CACHE_MISSES] / kinst : 0.f;
+  this->readings_.branch_mpki =
+      kinst > 0. ? counts[BRANCH_MISSES] / kinst : 0.f;
+  this->readings_.running_ratio =
+      enabled > 0 ? static_cast<double>(running) / enabled : 0.f;
+
+  this->valid_ = true;
+  return Status{};
+}
+
+std::vector<Readings*> PerfCounterObserver::GetReadings() {
+  return std::vector<Readings*>{static_cast<Readings*>(&(this->readings_))};
+}
+
+Status PerfCounterObserver::SelectDevice(const uint /* device */) {
+  return Status{Status::NOT_IMPLEMENTED, "Cannot select a device"};
+}
+
+Status PerfCounterObserver::SetScope(const ObserverScope scope) {
+  this->scope_ = scope;
+  this->caps_[0].scope = scope;
+  return this->OpenGroups();
+}
+
+Status PerfCounterObserver::SetPID(const uint pid) {
+  this->pid_ = pid;
+  if (ObserverScope::SYSTEM == this->scope_) return Status{};
+  return this->OpenGroups();
+}
+
+ObserverScope PerfCounterObserver::GetScope() const noexcept {
+  return this->scope_;
+}
+
+uint PerfCounterObserver::GetPID() const noexcept { return this->pid_; }
+
+const std::vector<ObserverCapabilities>& PerfCounterObserver::GetCapabilities()
+    const noexcept {
+  return this->caps_;
+}
+
+Status PerfCounterObserver::GetStatus() {
+  if (!this->valid_) {
+    return Status{Status::NOT_READY,
+                  "The internal trigger() has not been launched yet"};
+  }
+  return Status{};
+}
+
+Status PerfCounterObserver::SetInterval(const uint64_t interval) {
+  this->interval_ = interval;
+  return Status{};
+}
+
+Status PerfCounterObserver::ClearInterval() {
+  return Status{Status::NOT_IMPLEMENTED,
+                "The clear interval is not implemented yet"};
+}
+
+Status PerfCounterObserver::Reset() {
+  this->readings_.type = static_cast<uint>(ObserverType::NONE);
+  this->readings_.timestamp = 0;
+  this->readings_.difference = 0;
+  this->readings_.cycles = 0;
+  this->readings_.instructions = 0;
+  this->readings_.cache_misses = 0;
+  this->readings_.branch_misses = 0;
+  this->readings_.ipc = 0.f;
+  this->readings_.cache_mpki = 0.f;
+  this->readings_.branch_mpki = 0.f;
+  this->readings_.running_ratio = 0.f;
+  this->valid_ = false;
+  return Status{};
+}
+
+PerfCounterObserver::~PerfCounterObserver() {}
+
+} /* namespace efimon */
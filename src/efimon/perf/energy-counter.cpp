@@ -0,0 +1,354 @@
+/**
+ * @file energy-counter.cpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Observer to query the energy events of the perf power PMU and the
+ * instructions retired within the same windows
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <efimon/perf/energy-counter.hpp>
+#include <efimon/perf/event-resolver.hpp>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace efimon {
+
+extern uint64_t GetUptime();
+
+/* PMU of the energy events and the CPUs where they are counted */
+static constexpr char kPowerPMU[] = "power";
+static constexpr char kPowerCpumask[] =
+    "/sys/bus/event_source/devices/power/cpumask";
+static constexpr char kCpuPath[] = "/sys/devices/system/cpu";
+
+/* Events in the order of the energy indices */
+static const char *kEnergyEvents[] = {"energy-pkg", "energy-cores",
+                                      "energy-ram", "energy-psys"};
+
+/* Parses a CPU list such as "0,28" or "0-3" */
+static std::vector<int> ParseCpuList(const std::string &list) {
+  std::vector<int> cpus;
+  std::istringstream ranges{list};
+  std::string range;
+  while (std::getline(ranges, range, ',')) {
+    if (range.empty()) continue;
+    auto dash = range.find('-');
+    const int lo = std::atoi(range.c_str());
+    const int hi =
+        std::string::npos == dash ? lo : std::atoi(range.c_str() + dash + 1);
+    for (int cpu = lo; cpu <= hi; ++cpu) cpus.push_back(cpu);
+  }
+  return cpus;
+}
+
+/* Socket of a logical CPU */
+static uint ReadSocket(const int cpu) {
+  std::ifstream file{std::filesystem::path{kCpuPath} /
+                     ("cpu" + std::to_string(cpu)) / "topology" /
+                     "physical_package_id"};
+  int socket = 0;
+  file >> socket;
+  return socket < 0 ? 0 : socket;
+}
+
+PerfEnergyObserver::PerfEnergyObserver(const uint /* pid */,
+                                       const ObserverScope scope,
+                                       const uint64_t interval)
+    : Observer{}, valid_{false}, sockets_{0} {
+  uint64_t type = static_cast<uint64_t>(ObserverType::CPU) |
+                  static_cast<uint64_t>(ObserverType::POWER) |
+                  static_cast<uint64_t>(ObserverType::PMU) |
+                  static_cast<uint64_t>(ObserverType::INTERVAL);
+
+  this->interval_ = interval;
+
+  if (ObserverScope::SYSTEM != scope) {
+    throw Status{Status::INVALID_PARAMETER, "Process-scope is not supported"};
+  }
+
+  this->caps_.emplace_back();
+  this->caps_[0].type = type;
+  this->caps_[0].scope = scope;
+
+  Status st = this->OpenGroups();
+  if (Status::OK != st.code) {
+    throw st;
+  }
+  this->Reset();
+}
+
+Status PerfEnergyObserver::OpenGroups() {
+  this->energy_groups_.clear();
+  this->energy_sockets_.clear();
+  this->core_groups_.clear();
+  this->core_sockets_.clear();
+
+  /* Energy events exported by the power PMU */
+  std::vector<PerfEventResolver::Event> events;
+  for (uint e = 0; e < NUM_ENERGY_EVENTS; ++e) {
+    PerfEventResolver::Event event;
+    this->positions_[e] = -1;
+    this->scales_[e] = 0.;
+    if (Status::OK ==
+        PerfEventResolver::Resolve(kPowerPMU, kEnergyEvents[e], event).code) {
+      this->positions_[e] = events.size();
+      this->scales_[e] = event.scale;
+      events.push_back(event);
+    }
+  }
+  if (events.empty()) {
+    return Status{Status::NOT_FOUND,
+                  "The power PMU does not export energy events"};
+  }
+
+  std::string cpumask;
+  std::ifstream{kPowerCpumask} >> cpumask;
+  const std::vector<int> energy_cpus = ParseCpuList(cpumask);
+  if (energy_cpus.empty()) {
+    return Status{Status::NOT_FOUND, "Cannot read the power PMU cpumask"};
+  }
+
+  /* One energy group per socket. The platform is only counted once */
+  for (uint i = 0; i < energy_cpus.size(); ++i) {
+    PerfEventGroup group;
+    for (uint e = 0; e < NUM_ENERGY_EVENTS; ++e) {
+      if (this->positions_[e] < 0 || (PSYS == e && 0 != i)) continue;
+      const auto &event = events[this->positions_[e]];
+      group.AddEvent(event.type, event.config, false);
+    }
+    Status st = group.Open(-1, energy_cpus[i]);
+    if (Status::OK != st.code) return st;
+    this->energy_groups_.emplace_back(std::move(group));
+    this->energy_sockets_.push_back(ReadSocket(energy_cpus[i]));
+  }
+
+  /* One core group per CPU. Without a core PMU (i.e. virtual machines),
+     only the energy is reported */
+  const int num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  for (int cpu = 0; cpu < num_cpus; ++cpu) {
+    PerfEventGroup group;
+    group.AddEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    group.AddEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, false);
+    if (Status::OK != group.Open(-1, cpu).code) continue;
+    this->core_groups_.emplace_back(std::move(group));
+    this->core_sockets_.push_back(ReadSocket(cpu));
+  }
+
+  this->sockets_ = 0;
+  for (const uint socket : this->energy_sockets_) {
+    this->sockets_ = std::max(this->sockets_, socket + 1);
+  }
+  for (const uint socket : this->core_sockets_) {
+    this->sockets_ = std::max(this->sockets_, socket + 1);
+  }
+
+  /* Enable everything back to back, so the windows start together */
+  for (auto &group : this->energy_groups_) {
+    Status st = group.Enable();
+    if (Status::OK != st.code) return st;
+  }
+  for (auto &group : this->core_groups_) {
+    Status st = group.Enable();
+    if (Status::OK != st.code) return st;
+  }
+
+  this->last_energy_.resize(this->energy_groups_.size());
+  this->last_core_.resize(this->core_groups_.size());
+  for (uint i = 0; i < this->energy_groups_.size(); ++i) {
+    Status st = this->energy_groups_[i].Read(this->last_energy_[i]);
+    if (Status::OK != st.code) {
+      this->energy_groups_.clear();
+      this->energy_sockets_.clear();
+      this->core_groups_.clear();
+      this->core_sockets_.clear();
+      this->last_energy_.clear();
+      this->last_core_.clear();
+      return st;
+    }
+  }
+
+  /* The core groups are optional: the ones that cannot be read are dropped */
+  for (uint i = 0; i < this->core_groups_.size();) {
+    if (Status::OK == this->core_groups_[i].Read(this->last_core_[i]).code) {
+      ++i;
+      continue;
+    }
+    this->core_groups_.erase(this->core_groups_.begin() + i);
+    this->core_sockets_.erase(this->core_sockets_.begin() + i);
+    this->last_core_.erase(this->last_core_.begin() + i);
+  }
+  this->readings_.timestamp = GetUptime();
+  return Status{};
+}
+
+Status PerfEnergyObserver::Trigger() {
+  if (this->energy_groups_.empty()) {
+    return Status{Status::NOT_READY, "The energy groups are not open"};
+  }
+
+  /* Read all the groups back to back before processing them */
+  std::vector<PerfEventGroup::Values> energy(this->energy_groups_.size());
+  std::vector<PerfEventGroup::Values> core(this->core_groups_.size());
+  for (uint i = 0; i < this->energy_groups_.size(); ++i) {
+    Status st = this->energy_groups_[i].Read(energy[i]);
+    if (Status::OK != st.code) return st;
+  }
+  for (uint i = 0; i < this->core_groups_.size(); ++i) {
+    Status st = this->core_groups_[i].Read(core[i]);
+    if (Status::OK != st.code) return st;
+  }
+
+  /* Set readings common metadata */
+  auto time = GetUptime();
+  this->readings_.type = static_cast<uint64_t>(ObserverType::CPU) |
+                         static_cast<uint64_t>(ObserverType::POWER) |
+                         static_cast<uint64_t>(ObserverType::PMU);
+  this->readings_.difference = time - this->readings_.timestamp;
+  this->readings_.timestamp = time;
+
+  auto &readings = this->readings_;
+  const double unavailable = -1.;
+  readings.package_energy.assign(this->sockets_, unavailable);
+  readings.core_energy.assign(this->sockets_, unavailable);
+  readings.ram_energy.assign(this->sockets_, unavailable);
+  readings.psys_energy = unavailable;
+  readings.instructions.assign(this->sockets_, 0);
+  readings.cycles.assign(this->sockets_, 0);
+  readings.window = energy[0].time_enabled - this->last_energy_[0].time_enabled;
+
+  /* The energy events are free-running: no multiplexing */
+  for (uint i = 0; i < energy.size(); ++i) {
+    const auto &values = energy[i];
+    const auto &last = this->last_energy_[i];
+    const uint socket = this->energy_sockets_[i];
+    std::vector<double> *slots[] = {&readings.package_energy,
+                                    &readings.core_energy,
+                                    &readings.ram_energy, nullptr};
+    for (uint e = 0; e < NUM_ENERGY_EVENTS; ++e) {
+      const int position = this->positions_[e];
+      if (position < 0 || !this->energy_groups_[i].IsCounting(position))
+        continue;
+      const double joules = this->scales_[e] * (values.counters[position] -
+                                                last.counters[position]);
+      double &slot = slots[e] ? slots[e]->at(socket) : readings.psys_energy;
+      /* Several dies may be reported per socket */
+      slot = unavailable == slot ? joules : slot + joules;
+    }
+  }
+
+  /* Scale to compensate the multiplexing */
+  for (uint i = 0; i < core.size(); ++i) {
+    const auto &values = core[i];
+    const auto &last = this->last_core_[i];
+    const uint64_t delta_enabled = values.time_enabled - last.time_enabled;
+    const uint64_t delta_running = values.time_running - last.time_running;
+    if (0 == delta_running) continue;
+    const double scale = static_cast<double>(delta_enabled) /
+                         static_cast<double>(delta_running);
+    const uint socket = this->core_sockets_[i];
+    readings.cycles.at(socket) += static_cast<uint64_t>(
+        scale * (values.counters[CYCLES] - last.counters[CYCLES]));
+    readings.instructions.at(socket) += static_cast<uint64_t>(
+        scale * (values.counters[INSTRUCTIONS] - last.counters[INSTRUCTIONS]));
+  }
+
+  readings.overall_energy = 0.;
+  readings.overall_instructions = 0;
+  readings.energy_per_instruction.assign(this->sockets_, unavailable);
+  for (uint s = 0; s < this->sockets_; ++s) {
+    if (unavailable == readings.package_energy[s]) continue;
+    readings.overall_energy += readings.package_energy[s];
+    readings.overall_instructions += readings.instructions[s];
+    if (0 != readings.instructions[s]) {
+      readings.energy_per_instruction[s] =
+          readings.package_energy[s] * 1e9 / readings.instructions[s];
+    }
+  }
+  readings.overall_energy_per_instruction =
+      0 == readings.overall_instructions
+          ? unavailable
+          : readings.overall_energy * 1e9 / readings.overall_instructions;
+
+  this->last_energy_ = std::move(energy);
+  this->last_core_ = std::move(core);
+  this->valid_ = true;
+  return Status{};
+}
+
+std::vector<Readings*> PerfEnergyObserver::GetReadings() {
+  return std::vector<Readings*>{static_cast<Readings*>(&(this->readings_))};
+}
+
+Status PerfEnergyObserver::SelectDevice(const uint /* device */) {
+  return Status{Status::NOT_IMPLEMENTED, "Cannot select a device"};
+}
+
+Status PerfEnergyObserver::SetScope(const ObserverScope scope) {
+  if (ObserverScope::SYSTEM == scope) return Status{};
+  return Status{Status::NOT_IMPLEMENTED, "The scope is only set to SYSTEM"};
+}
+
+Status PerfEnergyObserver::SetPID(const uint /* pid */) {
+  return Status{Status::NOT_IMPLEMENTED,
+                "It is not possible to set a PID in a SYSTEM wide Observer"};
+}
+
+ObserverScope PerfEnergyObserver::GetScope() const noexcept {
+  return ObserverScope::SYSTEM;
+}
+
+uint PerfEnergyObserver::GetPID() const noexcept { return 0; }
+
+const std::vector<ObserverCapabilities>& PerfEnergyObserver::GetCapabilities()
+    const noexcept {
+  return this->caps_;
+}
+
+Status PerfEnergyObserver::GetStatus() {
+  if (!this->valid_) {
+    return Status{Status::NOT_READY,
+                  "The internal trigger() has not been launched yet"};
+  }
+  return Status{};
+}
+
+Status PerfEnergyObserver::SetInterval(const uint64_t interval) {
+  this->interval_ = interval;
+  return Status{};
+}
+
+Status PerfEnergyObserver::ClearInterval() {
+  return Status{Status::NOT_IMPLEMENTED,
+                "The clear interval is not implemented yet"};
+}
+
+Status PerfEnergyObserver::Reset() {
+  this->readings_.type = static_cast<uint>(ObserverType::NONE);
+  this->readings_.difference = 0;
+  this->readings_.window = 0;
+  this->readings_.package_energy.assign(this->sockets_, -1.);
+  this->readings_.core_energy.assign(this->sockets_, -1.);
+  this->readings_.ram_energy.assign(this->sockets_, -1.);
+  this->readings_.psys_energy = -1.;
+  this->readings_.instructions.assign(this->sockets_, 0);
+  this->readings_.cycles.assign(this->sockets_, 0);
+  this->readings_.energy_per_instruction.assign(this->sockets_, -1.);
+  this->readings_.overall_energy = 0.;
+  this->readings_.overall_instructions = 0;
+  this->readings_.overall_energy_per_instruction = -1.;
+  this->valid_ = false;
+  return Status{};
+}
+
+PerfEnergyObserver::~PerfEnergyObserver() {}
+
+} /* namespace efimon */
@@ -0,0 +1,104 @@
+/**
+ * @file energy-profile.cpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Attribution of the energy consumed within a window to the sampled
+ * call stacks and functions
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <efimon/perf/energy-profile.hpp>
+#include <fstream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace efimon {
+
+static constexpr double kMicroJoules = 1e6;
+
+EnergyProfile::EnergyProfile(const std::size_t capacity)
+    : stacks_{capacity}, self_{capacity}, inclusive_{capacity} {}
+
+Status EnergyProfile::Attribute(const CallgraphReadings &callgraph,
+                                const double energy) {
+  if (energy < 0.) {
+    return Status{Status::INVALID_PARAMETER, "The energy cannot be negative"};
+  }
+  if (0 == callgraph.samples) {
+    return Status{};
+  }
+
+  const double joules_per_sample = energy / callgraph.samples;
+  std::unordered_set<std::string> seen;
+
+  for (const auto &stack : callgraph.stacks) {
+    const double joules = joules_per_sample * stack.second;
+    this->stacks_.Add(stack.first, joules);
+
+    /* The first frame is the command name: skip it for the functions */
+    const std::string &folded = stack.first;
+    size_t begin = folded.find(';');
+    if (std::string::npos == begin) continue;
+    ++begin;
+
+    /* Recursive functions only count once towards the inclusive energy */
+    seen.clear();
+    std::string function;
+    while (begin <= folded.size()) {
+      size_t end = folded.find(';', begin);
+      if (std::string::npos == end) end = folded.size();
+      function = folded.substr(begin, end - begin);
+      if (seen.insert(function).second) {
+        this->inclusive_.Add(function, joules);
+      }
+      begin = end + 1;
+    }
+    /* The leaf holds the self energy */
+    this->self_.Add(function, joules);
+  }
+
+  return Status{};
+}
+
+std::vector<EnergyProfile::Entry> EnergyProfile::TopFunctions(
+    const std::size_t k, const bool inclusive) const {
+  return inclusive ? this->inclusive_.Top(k) : this->self_.Top(k);
+}
+
+std::vector<EnergyProfile::Entry> EnergyProfile::TopStacks(
+    const std::size_t k) const {
+  return this->stacks_.Top(k);
+}
+
+Status EnergyProfile::WriteFolded(const std::string &filename) const {
+  std::ofstream ofs{filename};
+  if (!ofs.is_open()) {
+    return Status{Status::CANNOT_OPEN, "Cannot open the energy profile file"};
+  }
+
+  for (const auto &entry : this->stacks_.Top()) {
+    ofs << entry.key << " "
+        << static_cast<uint64_t>(std::llround(entry.weight * kMicroJoules))
+        << std::endl;
+  }
+
+  if (!ofs.good()) {
+    return Status{Status::FILE_ERROR, "Cannot write the energy profile"};
+  }
+  return Status{};
+}
+
+double EnergyProfile::GetTotalEnergy() const noexcept {
+  return this->stacks_.Total();
+}
+
+void EnergyProfile::Clear() noexcept {
+  this->stacks_.Clear();
+  this->self_.Clear();
+  this->inclusive_.Clear();
+}
+
+} /* namespace efimon */
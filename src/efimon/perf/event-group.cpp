@@ -0,0 +1,184 @@
+/**
+ * @file event-group.cpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Thin wrapper around perf_event_open for counting groups. A group
+ * is composed by a leader and followers that are scheduled together on the
+ * PMU, so they can be read in a single read() call
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <efimon/perf/event-group.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace efimon {
+
+/* nr + time_enabled + time_running */
+static constexpr uint kGroupHeaderSize = 3;
+
+PerfEventGroup::PerfEventGroup() : events_{}, opened_{0}, buffer_{} {}
+
+PerfEventGroup::PerfEventGroup(PerfEventGroup &&group) noexcept
+    : events_{std::move(group.events_)},
+      opened_{group.opened_},
+      buffer_{std::move(group.buffer_)} {
+  group.events_.clear();
+  group.opened_ = 0;
+}
+
+PerfEventGroup &PerfEventGroup::operator=(PerfEventGroup &&group) noexcept {
+  if (this != &group) {
+    this->Close();
+    this->events_ = std::move(group.events_);
+    this->opened_ = group.opened_;
+    this->buffer_ = std::move(group.buffer_);
+    group.events_.clear();
+    group.opened_ = 0;
+  }
+  return *this;
+}
+
+int PerfEventGroup::OpenEvent(struct perf_event_attr *attr, const int pid,
+                              const int cpu, const int group_fd,
+                              const unsigned long flags) {  // NOLINT
+  return static_cast<int>(
+      syscall(__NR_perf_event_open, attr, pid, cpu, group_fd, flags));
+}
+
+Status PerfEventGroup::AddEvent(const uint32_t type, const uint64_t config,
+                                const bool required) {
+  if (this->GetLeader() >= 0) {
+    return Status{Status::RESOURCE_BUSY,
+                  "Cannot add events to an already opened group"};
+  }
+  this->events_.push_back(Event{type, config, required, -1, -1});
+  return Status{};
+}
+
+Status PerfEventGroup::Open(const int pid, const int cpu, const bool inherit) {
+  if (this->events_.empty()) {
+    return Status{Status::CONFIGURATION_ERROR, "The group has no events"};
+  }
+
+  this->Close();
+  int leader = -1;
+
+  for (auto &event : this->events_) {
+    struct perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = event.type;
+    attr.config = event.config;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                       PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attr.disabled = leader < 0 ? 1 : 0;
+    attr.inherit = inherit ? 1 : 0;
+    attr.exclude_hv = 1;
+
+    int fd = PerfEventGroup::OpenEvent(&attr, pid, cpu, leader, 0);
+    /* System-wide PMUs (i.e. power) reject the exclusion bits */
+    if (fd < 0 && EINVAL == errno) {
+      attr.exclude_hv = 0;
+      fd = PerfEventGroup::OpenEvent(&attr, pid, cpu, leader, 0);
+    }
+    if (fd < 0 && event.required) {
+      int err = errno;
+      this->Close();
+      int code = EACCES == err || EPERM == err ? Status::ACCESS_DENIED
+                                               : Status::CANNOT_OPEN;
+      return Status{code, std::string("Cannot open the perf event: ") +
+                              std::strerror(err)};
+    } else if (fd < 0) {
+      continue;
+    }
+
+    event.fd = fd;
+    event.position = this->opened_++;
+    if (leader < 0) leader = fd;
+  }
+
+  if (leader < 0) {
+    return Status{Status::CANNOT_OPEN, "Cannot open the group leader"};
+  }
+
+  this->buffer_.resize(kGroupHeaderSize + this->opened_);
+  return Status{};
+}
+
+Status PerfEventGroup::Read(Values &values) {  // NOLINT
+  int leader = this->GetLeader();
+  if (leader < 0) {
+    return Status{Status::NOT_READY, "The group is not open"};
+  }
+
+  const ssize_t size = this->buffer_.size() * sizeof(uint64_t);
+  if (size != read(leader, this->buffer_.data(), size)) {
+    return Status{Status::FILE_ERROR, "Cannot read the perf event group"};
+  }
+
+  values.time_enabled = this->buffer_[1];
+  values.time_running = this->buffer_[2];
+  values.counters.resize(this->events_.size());
+  for (uint i = 0; i < this->events_.size(); ++i) {
+    int position = this->events_[i].position;
+    values.counters[i] =
+        position < 0 ? 0 : this->buffer_[kGroupHeaderSize + position];
+  }
+  return Status{};
+}
+
+Status PerfEventGroup::Enable() {
+  int leader = this->GetLeader();
+  if (leader < 0 || ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP) ||
+      ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP)) {
+    return Status{Status::CONFIGURATION_ERROR, "Cannot enable the group"};
+  }
+  return Status{};
+}
+
+Status PerfEventGroup::Disable() {
+  int leader = this->GetLeader();
+  if (leader < 0 ||
+      ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP)) {
+    return Status{Status::CONFIGURATION_ERROR, "Cannot disable the group"};
+  }
+  return Status{};
+}
+
+void PerfEventGroup::Close() noexcept {
+  /* Followers first, leader last */
+  for (auto it = this->events_.rbegin(); it != this->events_.rend(); ++it) {
+    if (it->fd >= 0) close(it->fd);
+    it->fd = -1;
+    it->position = -1;
+  }
+  this->opened_ = 0;
+}
+
+bool PerfEventGroup::IsCounting(const uint index) const noexcept {
+  return index < this->events_.size() && this->events_[index].fd >= 0;
+}
+
+uint PerfEventGroup::GetNumEvents() const noexcept {
+  return this->events_.size();
+}
+
+int PerfEventGroup::GetLeader() const noexcept {
+  for (const auto &event : this->events_) {
+    if (event.fd >= 0) return event.fd;
+  }
+  return -1;
+}
+
+PerfEventGroup::~PerfEventGroup() { this->Close(); }
+
+} /* namespace efimon */
@@ -0,0 +1,122 @@
+/**
+ * @file event-resolver.cpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Resolves the named PMU events exported by the kernel in sysfs into
+ * perf_event_attr type and config
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#include <cstdlib>
+#include <efimon/perf/event-resolver.hpp>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace efimon {
+
+static constexpr char kPMUPath[] = "/sys/bus/event_source/devices";
+
+/* Reads the first line of a sysfs file */
+static bool ReadLine(const std::filesystem::path &path,
+                     std::string &line) {  // NOLINT
+  std::ifstream file{path};
+  if (!file.is_open()) return false;
+  std::getline(file, line);
+  return !line.empty();
+}
+
+/* Places the value bits into the ranges of a format such as "config:0-7,21" */
+static Status PlaceBits(const std::string &format, uint64_t value,
+                        uint64_t &config) {  // NOLINT
+  auto colon = format.find(':');
+  if (std::string::npos == colon || format.substr(0, colon) != "config") {
+    return Status{Status::NOT_IMPLEMENTED,
+                  "Only config formats are supported: " + format};
+  }
+
+  std::istringstream ranges{format.substr(colon + 1)};
+  std::string range;
+  while (std::getline(ranges, range, ',')) {
+    auto dash = range.find('-');
+    const uint lo = std::strtoul(range.c_str(), nullptr, 10);
+    const uint hi = std::string::npos == dash
+                        ? lo
+                        : std::strtoul(range.c_str() + dash + 1, nullptr, 10);
+    for (uint bit = lo; bit <= hi && bit < 64; ++bit) {
+      config |= (value & 1ull) << bit;
+      value >>= 1;
+    }
+  }
+  return Status{};
+}
+
+Status PerfEventResolver::Resolve(const std::string &pmu,
+                                  const std::string &name, Event &event) {
+  std::filesystem::path pmu_path = std::filesystem::path(kPMUPath) / pmu;
+  std::string line;
+
+  if (!ReadLine(pmu_path / "events" / name, line)) {
+    return Status{Status::NOT_FOUND, "The PMU does not export " + name};
+  }
+  std::string stype;
+  if (!ReadLine(pmu_path / "type", stype)) {
+    return Status{Status::FILE_ERROR, "Cannot read the type of " + pmu};
+  }
+
+  event.type = std::strtoul(stype.c_str(), nullptr, 10);
+  event.config = 0;
+  event.scale = 1.;
+
+  /* Terms: name=value or name (value 1) */
+  std::istringstream terms{line};
+  std::string term;
+  while (std::getline(terms, term, ',')) {
+    auto equal = term.find('=');
+    std::string key = term.substr(0, equal);
+    uint64_t value = std::string::npos == equal
+                         ? 1ull
+                         : std::strtoull(term.c_str() + equal + 1, nullptr, 0);
+    std::string format;
+    if (!ReadLine(pmu_path / "format" / key, format)) {
+      return Status{Status::NOT_FOUND, "Unknown term " + key + " in " + name};
+    }
+    Status st = PlaceBits(format, value, event.config);
+    if (Status::OK != st.code) return st;
+  }
+
+  std::string sscale;
+  if (ReadLine(pmu_path / "events" / (name + ".scale"), sscale)) {
+    double scale = std::strtod(sscale.c_str(), nullptr);
+    event.scale = scale > 0. ? scale : 1.;
+  }
+  return Status{};
+}
+
+Status PerfEventResolver::Resolve(const std::string &name, Event &event) {
+  std::string pmu = PerfEventResolver::GetCorePMU();
+  if (pmu.empty()) {
+    return Status{Status::NOT_FOUND, "There is no core PMU exported"};
+  }
+  return PerfEventResolver::Resolve(pmu, name, event);
+}
+
+bool PerfEventResolver::Exists(const std::string &name) {
+  std::string pmu = PerfEventResolver::GetCorePMU();
+  if (pmu.empty()) return false;
+  return std::filesystem::exists(std::filesystem::path(kPMUPath) / pmu /
+                                 "events" / name);
+}
+
+std::string PerfEventResolver::GetCorePMU() {
+  for (const char *pmu : {"cpu", "cpu_core"}) {
+    if (std::filesystem::exists(std::filesystem::path(kPMUPath) / pmu /
+                                "type")) {
+      return pmu;
+    }
+  }
+  return "";
+}
+
+} /* namespace efimon */
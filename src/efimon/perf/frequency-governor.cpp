@@ -0,0 +1,66 @@
+/**
+ * @file frequency-governor.cpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Controller that adapts the sampling frequency to keep the cost of
+ * the profiler under an overhead budget
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#include <algorithm>
+#include <efimon/perf/frequency-governor.hpp>
+
+namespace efimon {
+
+/* Fraction of the budget targeted when scaling down: leaves some headroom */
+static constexpr float kTargetRatio = 0.9f;
+/* Below this fraction of the budget, the frequency can grow */
+static constexpr float kGrowthRatio = 0.5f;
+/* Growth factor per window */
+static constexpr float kGrowthFactor = 1.25f;
+
+FrequencyGovernor::FrequencyGovernor(const uint64_t frequency,
+                                     const float budget, const uint64_t min)
+    : max_{frequency},
+      min_{std::min(min, frequency)},
+      frequency_{frequency},
+      budget_{budget},
+      overhead_{0.f} {}
+
+uint64_t FrequencyGovernor::Update(const uint64_t cpu_time,
+                                   const uint64_t wall_time,
+                                   const uint64_t lost,
+                                   const uint64_t throttled) {
+  if (0 == wall_time) return this->frequency_;
+  this->overhead_ = static_cast<float>(cpu_time) / wall_time;
+  if (0.f >= this->budget_) return this->frequency_;
+
+  double next = static_cast<double>(this->frequency_);
+  if (0 != lost || 0 != throttled) {
+    next /= 2;
+  } else if (this->overhead_ > this->budget_) {
+    next *= kTargetRatio * this->budget_ / this->overhead_;
+  } else if (this->overhead_ < kGrowthRatio * this->budget_) {
+    next *= kGrowthFactor;
+  }
+
+  this->frequency_ = std::clamp(static_cast<uint64_t>(next), this->min_,
+                                this->max_);
+  return this->frequency_;
+}
+
+void FrequencyGovernor::SetBudget(const float budget) noexcept {
+  this->budget_ = budget;
+}
+
+float FrequencyGovernor::GetBudget() const noexcept { return this->budget_; }
+
+uint64_t FrequencyGovernor::GetFrequency() const noexcept {
+  return this->frequency_;
+}
+
+float FrequencyGovernor::GetOverhead() const noexcept {
+  return this->overhead_;
+}
+
+} /* namespace efimon */
@@ -0,0 +1,372 @@
+/**
+ * @file jit-map.cpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Map of the code generated by JIT compilers, built from the perf map
+ * files and the jitdump records that managed runtimes emit
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <efimon/perf/jit-map.hpp>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <third-party/pstream.hpp>
+
+namespace efimon {
+
+/* Architecture for objdump -b binary */
+#if defined(__x86_64__) || defined(_M_X64)
+static constexpr char kObjdumpArch[] = "i386:x86-64";
+#elif defined(__aarch64__)
+static constexpr char kObjdumpArch[] = "aarch64";
+#else
+static constexpr char kObjdumpArch[] = "";
+#endif
+
+/* jitdump definitions (tools/perf/util/jitdump.h) */
+static constexpr uint32_t kJitdumpMagic = 0x4A695444;
+static constexpr uint32_t kJitCodeLoad = 0;
+static constexpr uint32_t kJitCodeMove = 1;
+static constexpr uint32_t kJitCodeClose = 3;
+
+struct JitdumpHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t total_size;
+  uint32_t elf_mach;
+  uint32_t pad1;
+  uint32_t pid;
+  uint64_t timestamp;
+  uint64_t flags;
+};
+
+struct JitRecordHeader {
+  uint32_t id;
+  uint32_t total_size;
+  uint64_t timestamp;
+};
+
+struct JitCodeLoadRecord {
+  JitRecordHeader header;
+  uint32_t pid;
+  uint32_t tid;
+  uint64_t vma;
+  uint64_t code_addr;
+  uint64_t code_size;
+  uint64_t code_index;
+  /* name (null terminated) and code bytes follow */
+};
+
+struct JitCodeMoveRecord {
+  JitRecordHeader header;
+  uint32_t pid;
+  uint32_t tid;
+  uint64_t vma;
+  uint64_t old_code_addr;
+  uint64_t new_code_addr;
+  uint64_t code_size;
+  uint64_t code_index;
+};
+
+static std::string PerfMapPath(const uint pid) {
+  return "/tmp/perf-" + std::to_string(pid) + ".map";
+}
+
+/* The runtimes mmap the jitdump as a marker for perf: look for it */
+static std::string FindJitDump(const uint pid) {
+  const std::string name = "jit-" + std::to_string(pid) + ".dump";
+  std::ifstream maps{"/proc/" + std::to_string(pid) + "/maps"};
+  std::string line;
+  while (std::getline(maps, line)) {
+    auto pos = line.find('/');
+    if (std::string::npos == pos) continue;
+    std::string path = line.substr(pos);
+    if (std::filesystem::path(path).filename() == name) return path;
+  }
+  std::string fallback = "/tmp/" + name;
+  return std::filesystem::exists(fallback) ? fallback : "";
+}
+
+JitCodeMap::JitCodeMap(const uint pid)
+    : pid_{pid}, regions_{}, map_offset_{0}, dump_path_{}, dump_offset_{0} {}
+
+bool JitCodeMap::Exists(const uint pid) {
+  return std::filesystem::exists(PerfMapPath(pid)) ||
+         !FindJitDump(pid).empty();
+}
+
+Status JitCodeMap::Refresh() {
+  Status st = this->TailPerfMap();
+  if (Status::OK != st.code) return st;
+  st = this->TailJitDump();
+  if (Status::OK != st.code) return st;
+  this->DropUnmapped();
+  return Status{};
+}
+
+void JitCodeMap::Insert(Region &&region) {
+  if (0 == region.size) return;
+  const uint64_t end = region.start + region.size;
+
+  /* The runtime reuses the addresses of the discarded code */
+  auto it = this->regions_.lower_bound(region.start);
+  if (this->regions_.begin() != it) {
+    auto prev = std::prev(it);
+    if (prev->second.start + prev->second.size > region.start) it = prev;
+  }
+  while (this->regions_.end() != it && it->second.start < end) {
+    it = this->regions_.erase(it);
+  }
+  this->regions_.emplace(region.start, std::move(region));
+}
+
+Status JitCodeMap::TailPerfMap() {
+  std::ifstream file{PerfMapPath(this->pid_)};
+  if (!file.is_open()) return Status{};
+
+  file.seekg(this->map_offset_);
+  std::string line;
+  /* Only consume complete lines: the runtime may be writing the last one */
+  while (std::getline(file, line) && !file.eof()) {
+    this->map_offset_ += line.size() + 1;
+
+    std::istringstream ss{line};
+    std::string sstart, ssize, name;
+    ss >> sstart >> ssize;
+    std::getline(ss >> std::ws, name);
+    if (sstart.empty() || ssize.empty()) continue;
+
+    Region region{};
+    region.start = std::strtoull(sstart.c_str(), nullptr, 16);
+    region.size = std::strtoull(ssize.c_str(), nullptr, 16);
+    region.name = name;
+    region.decoded = false;
+    this->Insert(std::move(region));
+  }
+  return Status{};
+}
+
+Status JitCodeMap::TailJitDump() {
+  if (this->dump_path_.empty()) {
+    this->dump_path_ = FindJitDump(this->pid_);
+    if (this->dump_path_.empty()) return Status{};
+  }
+
+  std::ifstream file{this->dump_path_, std::ios::binary};
+  if (!file.is_open()) return Status{};
+
+  if (0 == this->dump_offset_) {
+    JitdumpHeader header;
+    if (!file.read(reinterpret_cast<char *>(&header), sizeof(header))) {
+      return Status{};
+    }
+    if (kJitdumpMagic != header.magic) {
+      this->dump_path_.clear();
+      return Status{Status::INCOMPATIBLE_PARAMETER,
+                    "The jitdump has an unknown magic or endianness"};
+    }
+    this->dump_offset_ = header.total_size;
+  }
+
+  file.seekg(this->dump_offset_);
+  std::vector<char> buffer;
+  JitRecordHeader rheader;
+  while (file.read(reinterpret_cast<char *>(&rheader), sizeof(rheader))) {
+    if (rheader.total_size < sizeof(rheader)) break;
+    buffer.resize(rheader.total_size);
+    std::memcpy(buffer.data(), &rheader, sizeof(rheader));
+    /* Incomplete record: retry in the next refresh */
+    if (!file.read(buffer.data() + sizeof(rheader),
+                   rheader.total_size - sizeof(rheader))) {
+      break;
+    }
+    this->dump_offset_ += rheader.total_size;
+
+    if (kJitCodeLoad == rheader.id &&
+        rheader.total_size >= sizeof(JitCodeLoadRecord)) {
+      JitCodeLoadRecord record;
+      std::memcpy(&record, buffer.data(), sizeof(record));
+      const char *name = buffer.data() + sizeof(record);
+      const std::size_t max_name = rheader.total_size - sizeof(record);
+      const std::size_t name_len = strnlen(name, max_name);
+      if (name_len + 1 + record.code_size > max_name) continue;
+
+      Region region{};
+      region.start = record.code_addr;
+      region.size = record.code_size;
+      region.name = std::string(name, name_len);
+      const uint8_t *code =
+          reinterpret_cast<const uint8_t *>(name + name_len + 1);
+      region.code.assign(code, code + record.code_size);
+      region.decoded = false;
+      this->Insert(std::move(region));
+    } else if (kJitCodeMove == rheader.id &&
+               rheader.total_size >= sizeof(JitCodeMoveRecord)) {
+      JitCodeMoveRecord record;
+      std::memcpy(&record, buffer.data(), sizeof(record));
+      auto it = this->regions_.find(record.old_code_addr);
+      if (this->regions_.end() == it) continue;
+      Region region = std::move(it->second);
+      this->regions_.erase(it);
+      region.start = record.new_code_addr;
+      region.instructions.clear();
+      region.decoded = false;
+      this->Insert(std::move(region));
+    } else if (kJitCodeClose == rheader.id) {
+      break;
+    }
+  }
+  return Status{};
+}
+
+void JitCodeMap::DropUnmapped() {
+  std::ifstream maps{"/proc/" + std::to_string(this->pid_) + "/maps"};
+  if (!maps.is_open()) return;
+
+  std::vector<std::pair<uint64_t, uint64_t>> ranges;
+  std::string line;
+  while (std::getline(maps, line)) {
+    std::istringstream ss{line};
+    std::string range, perms;
+    ss >> range >> perms;
+    if (std::string::npos == perms.find('x')) continue;
+    auto dash = range.find('-');
+    ranges.emplace_back(
+        std::strtoull(range.substr(0, dash).c_str(), nullptr, 16),
+        std::strtoull(range.substr(dash + 1).c_str(), nullptr, 16));
+  }
+
+  for (auto it = this->regions_.begin(); it != this->regions_.end();) {
+    bool mapped = false;
+    for (const auto &range : ranges) {
+      if (it->first >= range.first && it->first < range.second) {
+        mapped = true;
+        break;
+      }
+    }
+    it = mapped ? std::next(it) : this->regions_.erase(it);
+  }
+}
+
+const JitCodeMap::Region *JitCodeMap::Find(const uint64_t ip) const {
+  auto it = this->regions_.upper_bound(ip);
+  if (this->regions_.begin() == it) return nullptr;
+  --it;
+  if (ip >= it->second.start + it->second.size) return nullptr;
+  return &(it->second);
+}
+
+Status JitCodeMap::FetchCode(Region &region) {
+  std::string path = "/proc/" + std::to_string(this->pid_) + "/mem";
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return Status{Status::ACCESS_DENIED, "Cannot open " + path};
+  }
+  region.code.resize(region.size);
+  ssize_t bytes = pread(fd, region.code.data(), region.size, region.start);
+  close(fd);
+  if (bytes <= 0) {
+    region.code.clear();
+    return Status{Status::FILE_ERROR, "Cannot read the JIT code"};
+  }
+  region.code.resize(bytes);
+  return Status{};
+}
+
+Status JitCodeMap::Decode(Region &region) {
+  region.decoded = true;
+  if (0 == sizeof(kObjdumpArch) - 1) {
+    return Status{Status::NOT_IMPLEMENTED,
+                  "The JIT disassembly is not supported in this platform"};
+  }
+  if (region.code.empty()) {
+    Status st = this->FetchCode(region);
+    if (Status::OK != st.code) return st;
+  }
+
+  char tmp_path[] = "/tmp/efimon-jit-XXXXXX";
+  int fd = mkstemp(tmp_path);
+  if (fd < 0) {
+    return Status{Status::FILE_ERROR, "Cannot create the JIT code file"};
+  }
+  bool written = static_cast<ssize_t>(region.code.size()) ==
+                 write(fd, region.code.data(), region.code.size());
+  close(fd);
+  if (!written) {
+    unlink(tmp_path);
+    return Status{Status::FILE_ERROR, "Cannot write the JIT code file"};
+  }
+
+  char vma[24];
+  std::snprintf(vma, sizeof(vma), "0x%lx",
+                static_cast<unsigned long>(region.start));  // NOLINT
+  std::string cmd = std::string("objdump -D -b binary -m ") + kObjdumpArch +
+                    " --adjust-vma=" + vma + " " + tmp_path;
+  redi::ipstream ip(cmd, redi::pstreambuf::pstdout);
+
+  /* Lines: "  addr:\tbytes\tmnemonic operands" */
+  std::string line;
+  while (std::getline(ip, line)) {
+    auto tab1 = line.find('\t');
+    auto tab2 = std::string::npos == tab1 ? tab1 : line.find('\t', tab1 + 1);
+    if (std::string::npos == tab2) continue;
+    auto colon = line.find(':');
+    if (std::string::npos == colon || colon > tab1) continue;
+
+    uint64_t addr = std::strtoull(line.substr(0, colon).c_str(), nullptr, 16);
+    std::istringstream ss{line.substr(tab2 + 1)};
+    std::string mnemonic, operands;
+    ss >> mnemonic;
+    std::getline(ss >> std::ws, operands);
+    if (mnemonic.empty() || "(bad)" == mnemonic) continue;
+    region.instructions[addr] = {mnemonic, operands};
+  }
+  unlink(tmp_path);
+
+  if (region.instructions.empty()) {
+    return Status{Status::FILE_ERROR, "Cannot disassemble " + region.name};
+  }
+  return Status{};
+}
+
+Status JitCodeMap::Lookup(const uint64_t ip, std::string &mnemonic,
+                          std::string &operands) {
+  Region *region = const_cast<Region *>(this->Find(ip));
+  if (!region) {
+    return Status{Status::NOT_FOUND, "The address is not JIT code"};
+  }
+  if (!region->decoded) {
+    Status st = this->Decode(*region);
+    if (Status::OK != st.code) return st;
+  }
+
+  /* The closest instruction at or before the address */
+  auto it = region->instructions.upper_bound(ip);
+  if (region->instructions.begin() == it) {
+    return Status{Status::NOT_FOUND, "The address was not disassembled"};
+  }
+  --it;
+  mnemonic = it->second.first;
+  operands = it->second.second;
+  return Status{};
+}
+
+std::size_t JitCodeMap::GetNumRegions() const noexcept {
+  return this->regions_.size();
+}
+
+uint JitCodeMap::GetPID() const noexcept { return this->pid_; }
+
+} /* namespace efimon */
@@ -0,0 +1,665 @@
+/**
+ * @file offcpu.cpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Observer to profile where a process waits through the scheduler
+ * tracepoints
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#include <linux/perf_event.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <efimon/perf/event-group.hpp>
+#include <efimon/perf/offcpu.hpp>
+#include <efimon/proc/thread-tree.hpp>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <mutex>  // NOLINT
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace efimon {
+
+extern uint64_t GetUptime();
+
+/* Maximum time to wait for records before draining anyway */
+static constexpr int kPollTimeout = 100;  // 100 ms
+/* Data pages per ring buffer: switches with call chains are heavy */
+static constexpr uint kOffCPUPages = 64;  // 256 KiB with 4 KiB pages
+/* Maximum depth of the call chains */
+static constexpr uint kMaxStack = 64;
+/* Task states reported by sched_switch: S, D, T, t, X, Z, P, I */
+static constexpr int64_t kTaskStateMask = 0xff;
+static constexpr int64_t kTaskUninterruptible = 0x02;
+/* EXIT_DEAD | EXIT_ZOMBIE: the thread will not switch in again. 0x80 is
+   TASK_REPORT_IDLE (I), which is a regular wait */
+static constexpr int64_t kTaskExiting = 0x10 | 0x20;
+
+/* Tracefs mount points */
+static const char *kTracingPaths[] = {"/sys/kernel/tracing/events",
+                                      "/sys/kernel/debug/tracing/events"};
+
+/* Kernel frames that identify the wait */
+static const char *kFutexFrames[] = {"futex"};
+static const char *kSleepFrames[] = {"nanosleep"};
+static const char *kIOFrames[] = {"poll",  "select", "sock",      "tcp",
+                                  "unix_", "pipe",   "wait_woken", "io_"};
+
+/* Head of PERF_RECORD_SAMPLE with TID | TIME | CALLCHAIN | RAW */
+struct SampleHead {
+  struct perf_event_header header;
+  uint32_t pid;
+  uint32_t tid;
+  uint64_t time;
+  uint64_t nr;
+};
+
+/* PERF_RECORD_SWITCH followed by the sample_id with TID | TIME */
+struct SwitchRecord {
+  struct perf_event_header header;
+  uint32_t pid;
+  uint32_t tid;
+  uint64_t time;
+};
+
+/* Layout of PERF_RECORD_LOST */
+struct LostRecord {
+  struct perf_event_header header;
+  uint64_t id;
+  uint64_t lost;
+};
+
+/* Reads the id and the field offsets of a tracepoint */
+static Status ReadTracepoint(const std::string &name, uint64_t &id,
+                             std::unordered_map<std::string, uint> &fields) {
+  for (const char *root : kTracingPaths) {
+    std::filesystem::path path = std::filesystem::path(root) / name;
+    std::ifstream idfile{path / "id"};
+    std::ifstream format{path / "format"};
+    if (!idfile.is_open() || !format.is_open()) continue;
+
+    idfile >> id;
+    std::string line;
+    while (std::getline(format, line)) {
+      auto fpos = line.find("field:");
+      auto opos = line.find("offset:");
+      if (std::string::npos == fpos || std::string::npos == opos) continue;
+      /* field:char prev_comm[16]; -> prev_comm */
+      std::string decl = line.substr(fpos, line.find(';', fpos) - fpos);
+      std::string fname = decl.substr(decl.find_last_of(' ') + 1);
+      fname = fname.substr(0, fname.find('['));
+      fields[fname] = std::stoul(line.substr(opos + 7));
+    }
+    return Status{};
+  }
+  return Status{Status::NOT_FOUND,
+                "Cannot find the tracepoint " + name + ". Is tracefs mounted?"};
+}
+
+/* Text symbols of the kernel sorted by address. Empty if restricted */
+static const std::vector<std::pair<uint64_t, std::string>> &KernelSymbols() {
+  static std::vector<std::pair<uint64_t, std::string>> symbols;
+  static std::once_flag flag;
+  std::call_once(flag, []() {
+    std::ifstream kallsyms{"/proc/kallsyms"};
+    std::string line;
+    while (std::getline(kallsyms, line)) {
+      std::istringstream ss{line};
+      std::string saddr, type, name;
+      ss >> saddr >> type >> name;
+      if (type != "t" && type != "T") continue;
+      uint64_t addr = std::stoull(saddr, nullptr, 16);
+      /* kptr_restrict hides the addresses */
+      if (0 == addr) break;
+      symbols.emplace_back(addr, name);
+    }
+    std::sort(symbols.begin(), symbols.end());
+  });
+  return symbols;
+}
+
+static std::string Hex(const uint64_t value) {
+  char buf[24];
+  std::snprintf(buf, sizeof(buf), "0x%lx", static_cast<unsigned long>(value));
+  return buf;
+}
+
+static std::string ResolveKernel(const uint64_t ip) {
+  const auto &symbols = KernelSymbols();
+  auto it = std::upper_bound(
+      symbols.begin(), symbols.end(), ip,
+      [](const uint64_t addr, const auto &sym) { return addr < sym.first; });
+  if (symbols.begin() == it) return "[kernel]";
+  return std::prev(it)->second;
+}
+
+static bool Contains(const std::string &frames, const char *const *patterns,
+                     const std::size_t num) {
+  for (std::size_t i = 0; i < num; ++i) {
+    if (std::string::npos != frames.find(patterns[i])) return true;
+  }
+  return false;
+}
+
+static OffCPUReason Classify(const int64_t state, const std::string &kernel) {
+  if (0 == (state & kTaskStateMask)) return OffCPUReason::PREEMPTED;
+  if (state & kTaskUninterruptible) return OffCPUReason::IO;
+  if (Contains(kernel, kFutexFrames, std::size(kFutexFrames))) {
+    return OffCPUReason::FUTEX;
+  }
+  if (Contains(kernel, kSleepFrames, std::size(kSleepFrames))) {
+    return OffCPUReason::SLEEP;
+  }
+  if (Contains(kernel, kIOFrames, std::size(kIOFrames))) {
+    return OffCPUReason::IO;
+  }
+  return OffCPUReason::OTHER;
+}
+
+OffCPUObserver::OffCPUObserver(const uint pid, const uint64_t interval,
+                               const std::size_t capacity)
+    : Observer{},
+      valid_{false},
+      running_{false},
+      switch_id_{0},
+      wakeup_id_{0},
+      prev_comm_offset_{0},
+      prev_state_offset_{0},
+      wakee_offset_{0},
+      wakeups_{false},
+      maps_reloaded_{false},
+      stacks_{capacity},
+      runqueue_{0},
+      switches_{0},
+      lost_{0} {
+  uint64_t type = static_cast<uint64_t>(ObserverType::CPU) |
+                  static_cast<uint64_t>(ObserverType::SCHEDULER) |
+                  static_cast<uint64_t>(ObserverType::INTERVAL);
+
+  this->pid_ = pid;
+  this->interval_ = interval;
+
+  this->caps_.emplace_back();
+  this->caps_[0].type = type;
+  this->caps_[0].scope = ObserverScope::PROCESS;
+
+  std::unordered_map<std::string, uint> switch_fields, wakeup_fields;
+  Status st = ReadTracepoint("sched/sched_switch", this->switch_id_,
+                             switch_fields);
+  if (Status::OK == st.code) {
+    st = ReadTracepoint("sched/sched_wakeup", this->wakeup_id_,
+                        wakeup_fields);
+  }
+  if (Status::OK != st.code) {
+    throw st;
+  }
+  this->prev_comm_offset_ = switch_fields["prev_comm"];
+  this->prev_state_offset_ = switch_fields["prev_state"];
+  this->wakee_offset_ = wakeup_fields["pid"];
+
+  this->Reset();
+  st = this->Open();
+  if (Status::OK != st.code) {
+    throw st;
+  }
+}
+
+Status OffCPUObserver::Open() {
+  const int num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+  if (0 == this->pid_) {
+    return Status{Status::NOT_READY, "Invalid PID. Assign one"};
+  }
+  std::filesystem::path task_path =
+      std::filesystem::path("/proc") / std::to_string(this->pid_) / "task";
+  if (!std::filesystem::exists(task_path)) {
+    return Status{Status::NOT_FOUND, "Cannot check that PID is alive"};
+  }
+  ThreadTree tree{static_cast<int>(this->pid_)};
+  std::vector<int> tids = tree.GetTree();
+  this->LoadMaps();
+
+  struct perf_event_attr switch_attr;
+  std::memset(&switch_attr, 0, sizeof(switch_attr));
+  switch_attr.size = sizeof(switch_attr);
+  switch_attr.type = PERF_TYPE_TRACEPOINT;
+  switch_attr.config = this->switch_id_;
+  switch_attr.sample_period = 1;
+  switch_attr.sample_type = PERF_SAMPLE_TID | PERF_SAMPLE_TIME |
+                            PERF_SAMPLE_CALLCHAIN | PERF_SAMPLE_RAW;
+  switch_attr.sample_max_stack = kMaxStack;
+  switch_attr.disabled = 1;
+  switch_attr.inherit = 1;
+  switch_attr.sample_id_all = 1;
+  switch_attr.watermark = 1;
+  /* Wake up the reader at a quarter of the buffer */
+  switch_attr.wakeup_watermark = kOffCPUPages * sysconf(_SC_PAGESIZE) / 4;
+
+  /* Switch-in records come from the switch event only. The wake-ups are
+     system-wide: the call chains are not needed */
+  struct perf_event_attr wakeup_attr = switch_attr;
+  wakeup_attr.config = this->wakeup_id_;
+  wakeup_attr.inherit = 0;
+  wakeup_attr.exclude_callchain_user = 1;
+  wakeup_attr.exclude_callchain_kernel = 1;
+  switch_attr.context_switch = 1;
+
+  /* Maps the buffer of a CPU or redirects the event to it */
+  auto attach = [this](const int fd, int &owner) -> Status {
+    this->fds_.push_back(fd);
+    if (owner >= 0) {
+      if (ioctl(fd, PERF_EVENT_IOC_SET_OUTPUT, owner)) {
+        return Status{Status::CONFIGURATION_ERROR,
+                      "Cannot redirect the tracepoint"};
+      }
+      return Status{};
+    }
+    PerfRingBuffer buffer;
+    Status st = buffer.Map(fd, kOffCPUPages);
+    if (Status::OK == st.code) {
+      this->buffers_.emplace_back(std::move(buffer));
+      owner = fd;
+    }
+    return st;
+  };
+
+  /*
+   * Like PerfSampleSession: inherited events cannot be mapped with cpu = -1.
+   * There is an event per thread and CPU and all of them are redirected to
+   * the ring buffer of the first one of each CPU
+   */
+  Status error{Status::CANNOT_OPEN, "Cannot open any tracepoint"};
+  this->wakeups_ = true;
+  for (int cpu = 0; cpu < num_cpus; ++cpu) {
+    int owner = -1;
+    for (const int tid : tids) {
+      int fd = PerfEventGroup::OpenEvent(&switch_attr, tid, cpu, -1, 0);
+      if (fd < 0) {
+        int err = errno;
+        int code = EACCES == err || EPERM == err ? Status::ACCESS_DENIED
+                                                 : Status::CANNOT_OPEN;
+        error = Status{code, std::string("Cannot open the tracepoint: ") +
+                                 std::strerror(err)};
+        /* Threads may finish in between: skip them */
+        if (ESRCH == err) continue;
+        this->Close();
+        return error;
+      }
+      Status st = attach(fd, owner);
+      if (Status::OK != st.code) {
+        this->Close();
+        return st;
+      }
+    }
+    if (owner < 0 || !this->wakeups_) continue;
+
+    /* Without permissions for system-wide tracing, there is no split */
+    int fd = PerfEventGroup::OpenEvent(&wakeup_attr, -1, cpu, -1, 0);
+    if (fd < 0) {
+      this->wakeups_ = false;
+      continue;
+    }
+    Status st = attach(fd, owner);
+    if (Status::OK != st.code) {
+      this->Close();
+      return st;
+    }
+  }
+
+  if (this->fds_.empty()) {
+    return error;
+  }
+
+  for (const int fd : this->fds_) {
+    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+  }
+  this->readings_.timestamp = GetUptime();
+  this->running_.store(true);
+  this->reader_ = std::thread(&OffCPUObserver::Reader, this);
+  return Status{};
+}
+
+void OffCPUObserver::Close() noexcept {
+  this->running_.store(false);
+  if (this->reader_.joinable()) this->reader_.join();
+  for (const int fd : this->fds_) {
+    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+  }
+  this->buffers_.clear();
+  for (const int fd : this->fds_) {
+    close(fd);
+  }
+  this->fds_.clear();
+}
+
+void OffCPUObserver::Reader() {
+  std::vector<struct pollfd> pfds;
+
+  for (const auto &buffer : this->buffers_) {
+    pfds.push_back({buffer.GetFd(), POLLIN, 0});
+  }
+
+  auto handler = [this](const struct perf_event_header *header) {
+    this->Process(header);
+  };
+
+  while (this->running_.load()) {
+    poll(pfds.data(), pfds.size(), kPollTimeout);
+
+    std::scoped_lock lock(this->mutex_);
+    for (uint i = 0; i < this->buffers_.size(); ++i) {
+      this->buffers_[i].Consume(handler);
+      /* The thread finished: stop polling it once it is drained */
+      if (pfds[i].revents & (POLLHUP | POLLERR)) {
+        pfds[i].fd = -1;
+      }
+    }
+    this->Settle();
+  }
+}
+
+void OffCPUObserver::Settle() {
+  for (const uint32_t tid : this->pending_) {
+    auto it = this->threads_.find(tid);
+    if (this->threads_.end() == it || 0 == it->second.in_time) continue;
+    this->Account(it->second);
+    this->threads_.erase(it);
+  }
+  this->pending_.clear();
+}
+
+void OffCPUObserver::Account(const ThreadState &thread) {
+  if (thread.in_time < thread.out_time) return;
+  uint64_t blocked = thread.in_time - thread.out_time;
+  if (thread.wake_time > thread.out_time &&
+      thread.wake_time <= thread.in_time) {
+    blocked = thread.wake_time - thread.out_time;
+    this->runqueue_ += thread.in_time - thread.wake_time;
+  }
+  this->blocked_[thread.reason] += blocked;
+  this->stacks_.Add(thread.stack, static_cast<double>(blocked));
+}
+
+void OffCPUObserver::Process(const struct perf_event_header *header) {
+  if (PERF_RECORD_LOST == header->type) {
+    this->lost_ += reinterpret_cast<const LostRecord *>(header)->lost;
+    return;
+  }
+
+  if (PERF_RECORD_SWITCH == header->type) {
+    if (header->misc & PERF_RECORD_MISC_SWITCH_OUT) return;
+    auto record = reinterpret_cast<const SwitchRecord *>(header);
+    auto it = this->threads_.find(record->tid);
+    if (this->threads_.end() == it || !it->second.off ||
+        0 != it->second.in_time)
+      return;
+
+    /* Only the threads off the CPU are tracked. They are accounted once the
+       buffers of all the CPUs are drained */
+    it->second.in_time = record->time;
+    this->pending_.push_back(record->tid);
+    return;
+  }
+
+  if (PERF_RECORD_SAMPLE != header->type) return;
+
+  auto head = reinterpret_cast<const SampleHead *>(header);
+  auto ips = reinterpret_cast<const uint64_t *>(head + 1);
+  auto raw_size = reinterpret_cast<const uint32_t *>(ips + head->nr);
+  auto raw = reinterpret_cast<const uint8_t *>(raw_size + 1);
+  if (*raw_size < sizeof(uint16_t)) return;
+
+  uint16_t common_type = 0;
+  std::memcpy(&common_type, raw, sizeof(common_type));
+
+  if (this->switch_id_ == common_type) {
+    int64_t state = 0;
+    std::memcpy(&state, raw + this->prev_state_offset_, sizeof(state));
+
+    /* Back off the CPU within the same drain */
+    auto it = this->threads_.find(head->tid);
+    if (this->threads_.end() != it && 0 != it->second.in_time) {
+      this->Account(it->second);
+    }
+    if (state & kTaskExiting) {
+      this->threads_.erase(head->tid);
+      ++this->switches_;
+      return;
+    }
+    const char *comm =
+        reinterpret_cast<const char *>(raw + this->prev_comm_offset_);
+    std::string kernel;
+    std::string stack = this->FoldStack(std::string(comm, strnlen(comm, 16)),
+                                        ips, head->nr, kernel);
+
+    ThreadState &thread = this->threads_[head->tid];
+    thread.off = true;
+    thread.windows = 0;
+    thread.out_time = head->time;
+    thread.wake_time = 0;
+    thread.in_time = 0;
+    thread.reason = Classify(state, kernel);
+    thread.stack = std::move(stack);
+    ++this->switches_;
+  } else if (this->wakeup_id_ == common_type) {
+    int32_t wakee = 0;
+    std::memcpy(&wakee, raw + this->wakee_offset_, sizeof(wakee));
+    /* The wake-ups of other processes are traced as well */
+    auto it = this->threads_.find(wakee);
+    if (this->threads_.end() == it || !it->second.off) return;
+    ThreadState &thread = it->second;
+    if (head->time >= thread.out_time &&
+        (0 == thread.in_time || head->time <= thread.in_time) &&
+        (0 == thread.wake_time || head->time < thread.wake_time)) {
+      thread.wake_time = head->time;
+    }
+  }
+}
+
+std::string OffCPUObserver::FoldStack(const std::string &comm,
+                                      const uint64_t *ips, const uint64_t nr,
+                                      std::string &kernel) {
+  /* The chain goes from the leaf to the root, with context markers */
+  std::vector<std::string> frames;
+  bool in_kernel = true;
+  for (uint64_t i = 0; i < nr; ++i) {
+    const uint64_t ip = ips[i];
+    if (ip >= static_cast<uint64_t>(PERF_CONTEXT_MAX)) {
+      in_kernel = static_cast<uint64_t>(PERF_CONTEXT_KERNEL) == ip;
+      continue;
+    }
+    std::string frame = in_kernel ? ResolveKernel(ip) : this->ResolveUser(ip);
+    /* The tracepoint handler itself is not part of the wait */
+    if (in_kernel && 0 == frame.rfind("perf_trace_", 0)) continue;
+    std::replace(frame.begin(), frame.end(), ';', ':');
+    if (in_kernel) {
+      kernel += frame;
+      kernel += ';';
+    }
+    frames.emplace_back(std::move(frame));
+  }
+
+  std::string folded = comm;
+  for (auto it = frames.rbegin(); it != frames.rend(); ++it) {
+    folded += ';';
+    folded += *it;
+  }
+  return folded;
+}
+
+std::string OffCPUObserver::ResolveUser(const uint64_t ip) {
+  for (int attempt = 0; attempt < 2; ++attempt) {
+    for (const auto &map : this->maps_) {
+      if (ip >= map.start && ip < map.end) {
+        return map.name + "+" + Hex(ip - map.start + map.offset);
+      }
+    }
+    /* New libraries may have been loaded: reload once per window */
+    if (this->maps_reloaded_) break;
+    this->LoadMaps();
+    this->maps_reloaded_ = true;
+  }
+  return Hex(ip);
+}
+
+void OffCPUObserver::LoadMaps() {
+  std::ifstream maps{"/proc/" + std::to_string(this->pid_) + "/maps"};
+  std::string line;
+
+  this->maps_.clear();
+  while (std::getline(maps, line)) {
+    std::istringstream ss{line};
+    std::string range, perms, offset, dev, inode, path;
+    ss >> range >> perms >> offset >> dev >> inode >> path;
+    if (path.empty() || std::string::npos == perms.find('x')) continue;
+
+    Mapping map;
+    auto dash = range.find('-');
+    map.start = std::stoull(range.substr(0, dash), nullptr, 16);
+    map.end = std::stoull(range.substr(dash + 1), nullptr, 16);
+    map.offset = std::stoull(offset, nullptr, 16);
+    map.name = std::filesystem::path(path).filename().string();
+    this->maps_.emplace_back(std::move(map));
+  }
+}
+
+Status OffCPUObserver::Trigger() {
+  if (this->fds_.empty()) {
+    return Status{Status::NOT_READY, "The tracepoints are not open"};
+  }
+
+  std::scoped_lock lock(this->mutex_);
+
+  /* Set readings common metadata */
+  auto time = GetUptime();
+  this->readings_.type = static_cast<uint64_t>(ObserverType::CPU) |
+                         static_cast<uint64_t>(ObserverType::SCHEDULER);
+  this->readings_.difference = time - this->readings_.timestamp;
+  this->readings_.timestamp = time;
+
+  /* ns to us */
+  this->readings_.blocked_time.clear();
+  for (const auto &reason : this->blocked_) {
+    this->readings_.blocked_time[reason.first] = reason.second / 1000;
+  }
+  this->readings_.stacks.clear();
+  for (const auto &entry : this->stacks_.Top()) {
+    this->readings_.stacks[entry.key] =
+        static_cast<uint64_t>(entry.weight / 1000.);
+  }
+  this->readings_.runqueue_time = this->runqueue_ / 1000;
+  this->readings_.wakeups = this->wakeups_;
+  this->readings_.switches = this->switches_;
+  this->readings_.lost = this->lost_;
+
+  this->blocked_.clear();
+  this->stacks_.Clear();
+  this->runqueue_ = 0;
+  this->switches_ = 0;
+  this->lost_ = 0;
+  this->maps_reloaded_ = false;
+  this->PruneThreads();
+
+  this->valid_ = true;
+  return Status{};
+}
+
+void OffCPUObserver::PruneThreads() {
+  /* Killed threads may not report their exit: check the old ones */
+  for (auto it = this->threads_.begin(); it != this->threads_.end();) {
+    const std::string task = "/proc/" + std::to_string(it->first);
+    if (it->second.windows++ > 0 && 0 != access(task.c_str(), F_OK)) {
+      it = this->threads_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+std::vector<Readings *> OffCPUObserver::GetReadings() {
+  return std::vector<Readings *>{static_cast<Readings *>(&(this->readings_))};
+}
+
+Status OffCPUObserver::SelectDevice(const uint /* device */) {
+  return Status{Status::NOT_IMPLEMENTED, "Cannot select a device"};
+}
+
+Status OffCPUObserver::SetScope(const ObserverScope scope) {
+  if (ObserverScope::PROCESS != scope) {
+    return Status{Status::NOT_IMPLEMENTED,
+                  "The off-CPU analysis is only available for processes"};
+  }
+  return Status{};
+}
+
+Status OffCPUObserver::SetPID(const uint pid) {
+  this->Close();
+  this->pid_ = pid;
+  this->Reset();
+  return this->Open();
+}
+
+ObserverScope OffCPUObserver::GetScope() const noexcept {
+  return ObserverScope::PROCESS;
+}
+
+uint OffCPUObserver::GetPID() const noexcept { return this->pid_; }
+
+const std::vector<ObserverCapabilities> &OffCPUObserver::GetCapabilities()
+    const noexcept {
+  return this->caps_;
+}
+
+Status OffCPUObserver::GetStatus() {
+  if (!this->valid_) {
+    return Status{Status::NOT_READY,
+                  "The internal trigger() has not been launched yet"};
+  }
+  return Status{};
+}
+
+Status OffCPUObserver::SetInterval(const uint64_t interval) {
+  this->interval_ = interval;
+  return Status{};
+}
+
+Status OffCPUObserver::ClearInterval() {
+  return Status{Status::NOT_IMPLEMENTED,
+                "The clear interval is not implemented yet"};
+}
+
+Status OffCPUObserver::Reset() {
+  std::scoped_lock lock(this->mutex_);
+  this->readings_.type = static_cast<uint>(ObserverType::NONE);
+  this->readings_.timestamp = GetUptime();
+  this->readings_.difference = 0;
+  this->readings_.blocked_time.clear();
+  this->readings_.stacks.clear();
+  this->readings_.runqueue_time = 0;
+  this->readings_.wakeups = false;
+  this->readings_.switches = 0;
+  this->readings_.lost = 0;
+  this->threads_.clear();
+  this->pending_.clear();
+  this->blocked_.clear();
+  this->stacks_.Clear();
+  this->runqueue_ = 0;
+  this->switches_ = 0;
+  this->lost_ = 0;
+  this->valid_ = false;
+  return Status{};
+}
+
+OffCPUObserver::~OffCPUObserver() { this->Close(); }
+
+} /* namespace efimon */
@@ -7,16 +7,13 @@
  * @copyright Copyright (c) 2024. See License for Licensing
  */
 
-#include <algorithm>
+#include <stdlib.h>
+
 #include <efimon/perf/record.hpp>
 #include <filesystem>
-#include <mutex>  // NOLINT
 #include <string>
 #include <third-party/pstream.hpp>
-#include <unordered_map>
-
-static std::mutex singleton_mutex_;
-static std::vector<uint> active_pids_;
+#include <vector>
 
 #define MAX_LEN_FILE_PATH 255
 
@@ -43,6 +40,7 @@ PerfRecordObserver::PerfRecordObserver(const uint pid,
   this->no_dispose_ = no_dispose;
   if (interval == 0) interval_ = 1000;
   if (frequency == 0) frequency_ = 1000;
+  this->readings_.frequency = this->frequency_;
 
   this->caps_.emplace_back();
   this->caps_[0].type = type;
@@ -52,24 +50,21 @@ PerfRecordObserver::PerfRecordObserver(const uint pid,
     throw Status{Status::NOT_FOUND, "Cannot check that PID is alive"};
   }
 
-  singleton_mutex_.lock();
-  auto it = std::find(active_pids_.begin(), active_pids_.end(), pid);
-  if (active_pids_.end() != it) {
-    singleton_mutex_.unlock();
-    throw Status{Status::RESOURCE_BUSY,
-                 "The PID is already being tracked by perf record"};
-  }
-  active_pids_.push_back(pid);
-  singleton_mutex_.unlock();
-
   this->CreateTemporaryFolder();
   this->MakePerfCommand();
 }
 
 void PerfRecordObserver::CreateTemporaryFolder() {
-  tmp_folder_path_ = std::filesystem::temp_directory_path() /
-                     ("efimon-" + std::to_string(pid_));
-  std::filesystem::create_directory(tmp_folder_path_);
+  /* Unique per instance: several observers can record the same PID */
+  std::string folder_template =
+      std::filesystem::temp_directory_path() /
+      ("efimon-" + std::to_string(pid_) + "-XXXXXX");
+  std::vector<char> folder(folder_template.begin(), folder_template.end());
+  folder.push_back('\0');
+  if (nullptr == mkdtemp(folder.data())) {
+    throw Status{Status::FILE_ERROR, "Cannot create the temporary folder"};
+  }
+  tmp_folder_path_ = folder.data();
 }
 
 bool PerfRecordObserver::CheckAlive() {
@@ -111,7 +106,9 @@ void PerfRecordObserver::MovePerfData(const std::filesystem::path& ipath,
 }
 
 void PerfRecordObserver::DisposeTemporaryFolder() {
-  if (!this->no_dispose_) std::filesystem::remove_all(tmp_folder_path_);
+  if (!this->no_dispose_ && !tmp_folder_path_.empty()) {
+    std::filesystem::remove_all(tmp_folder_path_);
+  }
 }
 
 Status PerfRecordObserver::Trigger() {
@@ -135,6 +132,7 @@ Status PerfRecordObserver::Trigger() {
 
   auto time = GetUptime();
   this->readings_.perf_data_path = std::string(this->path_to_perf_data_);
+  this->readings_.frequency = this->frequency_;
   this->readings_.type = static_cast<uint64_t>(ObserverType::CPU);
   this->readings_.difference = time - this->readings_.timestamp;
   this->readings_.timestamp = time;
@@ -166,26 +164,16 @@ Status PerfRecordObserver::SetPID(const uint pid) {
     return Status{Status::NOT_FOUND, "Cannot check that PID is alive"};
   }
 
-  /* Singleton logic */
-  singleton_mutex_.lock();
-
   if (tmp_pid != 0) {
-    auto oit = std::find(active_pids_.begin(), active_pids_.end(), tmp_pid);
-    active_pids_.erase(oit);
     this->DisposeTemporaryFolder();
   }
 
-  auto iit = std::find(active_pids_.begin(), active_pids_.end(), pid);
-  if (active_pids_.end() != iit) {
-    singleton_mutex_.unlock();
-    this->valid_ = false;
-    return Status{Status::RESOURCE_BUSY,
-                  "The PID is already being tracked by perf record"};
+  this->valid_ = false;
+  try {
+    this->CreateTemporaryFolder();
+  } catch (const Status& st) {
+    return st;
   }
-  active_pids_.push_back(pid);
-  singleton_mutex_.unlock();
-
-  this->CreateTemporaryFolder();
   this->MakePerfCommand();
 
   return Status{};
@@ -216,6 +204,7 @@ Status PerfRecordObserver::ClearInterval() {
 
 Status PerfRecordObserver::Reset() {
   this->readings_.perf_data_path = "";
+  this->readings_.frequency = 0;
   this->readings_.type = static_cast<uint>(ObserverType::NONE);
   this->readings_.timestamp = 0;
   this->readings_.difference = 0;
@@ -0,0 +1,125 @@
+/**
+ * @file ring-buffer.cpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Consumer of the perf_event mmap ring buffer. The kernel produces
+ * the records and this class consumes them without any syscall
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <efimon/perf/ring-buffer.hpp>
+#include <string>
+#include <utility>
+
+namespace efimon {
+
+PerfRingBuffer::PerfRingBuffer()
+    : fd_{-1}, base_{nullptr}, length_{0}, data_size_{0}, scratch_{} {}
+
+PerfRingBuffer::PerfRingBuffer(PerfRingBuffer &&rb) noexcept
+    : fd_{rb.fd_},
+      base_{rb.base_},
+      length_{rb.length_},
+      data_size_{rb.data_size_},
+      scratch_{std::move(rb.scratch_)} {
+  rb.fd_ = -1;
+  rb.base_ = nullptr;
+  rb.length_ = 0;
+  rb.data_size_ = 0;
+}
+
+PerfRingBuffer &PerfRingBuffer::operator=(PerfRingBuffer &&rb) noexcept {
+  if (this != &rb) {
+    this->Unmap();
+    this->fd_ = rb.fd_;
+    this->base_ = rb.base_;
+    this->length_ = rb.length_;
+    this->data_size_ = rb.data_size_;
+    this->scratch_ = std::move(rb.scratch_);
+    rb.fd_ = -1;
+    rb.base_ = nullptr;
+    rb.length_ = 0;
+    rb.data_size_ = 0;
+  }
+  return *this;
+}
+
+Status PerfRingBuffer::Map(const int fd, const uint pages) {
+  if (0 == pages || 0 != (pages & (pages - 1))) {
+    return Status{Status::INVALID_PARAMETER,
+                  "The number of pages must be a power of two"};
+  }
+
+  this->Unmap();
+
+  const uint64_t page_size = sysconf(_SC_PAGESIZE);
+  const uint64_t length = (pages + 1) * page_size;
+  void *base = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (MAP_FAILED == base) {
+    return Status{Status::CANNOT_OPEN, std::string("Cannot map the buffer: ") +
+                                           std::strerror(errno)};
+  }
+
+  this->fd_ = fd;
+  this->base_ = base;
+  this->length_ = length;
+  this->data_size_ = pages * page_size;
+  return Status{};
+}
+
+void PerfRingBuffer::Unmap() noexcept {
+  if (this->base_) munmap(this->base_, this->length_);
+  this->fd_ = -1;
+  this->base_ = nullptr;
+  this->length_ = 0;
+  this->data_size_ = 0;
+}
+
+uint64_t PerfRingBuffer::Consume(const Handler &handler) {
+  if (!this->base_) return 0;
+
+  auto meta = static_cast<struct perf_event_mmap_page *>(this->base_);
+  auto data = static_cast<uint8_t *>(this->base_) + meta->data_offset;
+  const uint64_t mask = this->data_size_ - 1;
+
+  /* Pairs with the kernel store-release of data_head */
+  const uint64_t head = __atomic_load_n(&meta->data_head, __ATOMIC_ACQUIRE);
+  uint64_t tail = meta->data_tail;
+  uint64_t records = 0;
+
+  while (tail < head) {
+    const uint64_t offset = tail & mask;
+    auto header = reinterpret_cast<struct perf_event_header *>(data + offset);
+    const uint64_t size = header->size;
+    if (0 == size) break;
+
+    if (offset + size > this->data_size_) {
+      /* The record wraps around: linearise it */
+      const uint64_t first = this->data_size_ - offset;
+      this->scratch_.resize(size);
+      std::memcpy(this->scratch_.data(), data + offset, first);
+      std::memcpy(this->scratch_.data() + first, data, size - first);
+      header =
+          reinterpret_cast<struct perf_event_header *>(this->scratch_.data());
+    }
+
+    handler(header);
+    tail += size;
+    ++records;
+  }
+
+  /* Releases the space to the kernel once the records are consumed */
+  __atomic_store_n(&meta->data_tail, tail, __ATOMIC_RELEASE);
+  return records;
+}
+
+int PerfRingBuffer::GetFd() const noexcept { return this->fd_; }
+
+PerfRingBuffer::~PerfRingBuffer() { this->Unmap(); }
+
+} /* namespace efimon */
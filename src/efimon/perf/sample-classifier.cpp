@@ -0,0 +1,281 @@
+/**
+ * @file sample-classifier.cpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Classifies the instruction pointers sampled from a process by
+ * decoding its machine code in-process
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <efimon/perf/sample-classifier.hpp>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace efimon {
+
+SampleClassifier::SampleClassifier(const uint pid)
+    : pid_{pid},
+      fd_{-1},
+      decoder_{},
+      pages_{},
+      instructions_{},
+      anonymous_{},
+      index_directory_{},
+      indices_{},
+      mappings_{},
+      mappings_fresh_{false} {
+  std::string path = "/proc/" + std::to_string(pid) + "/mem";
+  this->fd_ = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+}
+
+const SampleClassifier::Page &SampleClassifier::Read(const uint64_t address) {
+  const uint64_t base = address & ~(kPageSize - 1);
+  auto it = this->pages_.find(base);
+  if (this->pages_.end() != it) return it->second;
+
+  if (this->pages_.size() >= kMaxPages) this->pages_.clear();
+  Page &page = this->pages_[base];
+  page.size = 0;
+  if (this->fd_ >= 0) {
+    ssize_t bytes = pread(this->fd_, page.bytes.data(), kPageSize,
+                          static_cast<off_t>(base));
+    page.size = bytes > 0 ? static_cast<uint64_t>(bytes) : 0;
+  }
+  return page;
+}
+
+std::size_t SampleClassifier::Fetch(const uint64_t ip, uint8_t *buffer) {
+  const uint64_t offset = ip & (kPageSize - 1);
+  const Page &page = this->Read(ip);
+  if (offset >= page.size) return 0;
+
+  std::size_t size = std::min<uint64_t>(x86Decoder::kMaxLength,
+                                        page.size - offset);
+  std::memcpy(buffer, page.bytes.data() + offset, size);
+  if (x86Decoder::kMaxLength == size || offset + size < kPageSize) return size;
+
+  /* The instruction may continue on the next page */
+  const Page &next = this->Read(ip - offset + kPageSize);
+  std::size_t remaining =
+      std::min<uint64_t>(x86Decoder::kMaxLength - size, next.size);
+  std::memcpy(buffer + size, next.bytes.data(), remaining);
+  return size + remaining;
+}
+
+void SampleClassifier::ReadMappings() {
+  this->mappings_fresh_ = true;
+  this->mappings_.clear();
+
+  std::ifstream maps{"/proc/" + std::to_string(this->pid_) + "/maps"};
+  std::string line;
+  /* Lines: "start-end perms offset dev inode path" */
+  while (std::getline(maps, line)) {
+    std::istringstream ss{line};
+    std::string range, perms, offset, device, inode, path;
+    ss >> range >> perms >> offset >> device >> inode;
+    std::getline(ss >> std::ws, path);
+    auto dash = range.find('-');
+    if (std::string::npos == dash || perms.size() < 3 || 'x' != perms[2] ||
+        path.empty() || '/' != path[0])
+      continue;
+
+    /* The index is searched once per file */
+    const std::string file = device + " " + inode;
+    auto it = this->indices_.find(file);
+    if (this->indices_.end() == it && this->index_directory_.empty()) {
+      it = this->indices_.emplace(file, nullptr).first;
+    } else if (this->indices_.end() == it) {
+      std::shared_ptr<ElfIndex> index;
+      std::string build_id;
+      if (Status::OK == ElfIndex::ReadBuildId(path, build_id).code) {
+        index = std::make_shared<ElfIndex>();
+        std::string name = build_id + ElfIndex::kExtension;
+        if (Status::OK !=
+            index->Open(std::filesystem::path{this->index_directory_} / name)
+                .code) {
+          index.reset();
+        }
+      }
+      it = this->indices_.emplace(file, std::move(index)).first;
+    }
+
+    Mapping mapping{};
+    mapping.start = std::strtoull(range.c_str(), nullptr, 16);
+    mapping.end = std::strtoull(range.c_str() + dash + 1, nullptr, 16);
+    mapping.offset = std::strtoull(offset.c_str(), nullptr, 16);
+    mapping.file = file;
+    mapping.index = it->second;
+    this->mappings_.push_back(std::move(mapping));
+  }
+  std::sort(this->mappings_.begin(), this->mappings_.end(),
+            [](const Mapping &a, const Mapping &b) {
+              return a.start < b.start;
+            });
+}
+
+const SampleClassifier::Mapping *SampleClassifier::FindMapping(
+    const uint64_t ip) const {
+  auto it = std::upper_bound(
+      this->mappings_.begin(), this->mappings_.end(), ip,
+      [](const uint64_t addr, const Mapping &m) { return addr < m.start; });
+  if (this->mappings_.begin() == it) return nullptr;
+  --it;
+  return ip < it->end ? &(*it) : nullptr;
+}
+
+void SampleClassifier::Invalidate() {
+  std::vector<Mapping> previous;
+  std::swap(previous, this->mappings_);
+  this->ReadMappings();
+
+  /* A library may have been replaced at the same addresses */
+  const bool same = std::equal(
+      previous.begin(), previous.end(), this->mappings_.begin(),
+      this->mappings_.end(), [](const Mapping &a, const Mapping &b) {
+        return a.start == b.start && a.end == b.end &&
+               a.offset == b.offset && a.file == b.file;
+      });
+  this->anonymous_.clear();
+  if (!same) {
+    this->pages_.clear();
+    this->instructions_.clear();
+    return;
+  }
+
+  /* The anonymous pages may hold JIT code that has been rewritten */
+  for (auto it = this->pages_.begin(); this->pages_.end() != it;) {
+    it = this->FindMapping(it->first) ? std::next(it) : this->pages_.erase(it);
+  }
+}
+
+void SampleClassifier::Keep(const uint64_t ip, const x86Instruction &inst) {
+  auto &cache =
+      this->FindMapping(ip) ? this->instructions_ : this->anonymous_;
+  if (cache.size() >= kMaxInstructions) cache.clear();
+  cache.emplace(ip, inst);
+}
+
+bool SampleClassifier::FindIndexed(const uint64_t ip, x86Instruction &inst) {
+  if (this->index_directory_.empty()) return false;
+
+  /* New libraries may have been loaded: read the maps once per window */
+  const Mapping *mapping = this->FindMapping(ip);
+  if (!mapping && !this->mappings_fresh_) {
+    this->ReadMappings();
+    mapping = this->FindMapping(ip);
+  }
+  if (!mapping || !mapping->index) return false;
+  return mapping->index->Find(ip - mapping->start + mapping->offset, inst);
+}
+
+Status SampleClassifier::Classify(const uint64_t ip, x86Instruction &inst) {
+  for (const auto *cache : {&this->instructions_, &this->anonymous_}) {
+    auto it = cache->find(ip);
+    if (cache->end() != it) {
+      inst = it->second;
+      return Status{};
+    }
+  }
+
+  if (this->FindIndexed(ip, inst)) {
+    this->Keep(ip, inst);
+    return Status{};
+  }
+
+  if (this->fd_ < 0) {
+    return Status{Status::FILE_ERROR, "Cannot open the process memory"};
+  }
+
+  std::array<uint8_t, x86Decoder::kMaxLength> code;
+  std::size_t size = this->Fetch(ip, code.data());
+  if (0 == size) {
+    return Status{Status::FILE_ERROR, "The address is not readable"};
+  }
+  if (0 == this->decoder_.Decode(code.data(), size, inst)) {
+    return Status{Status::INVALID_PARAMETER, "Cannot decode the instruction"};
+  }
+
+  this->Keep(ip, inst);
+  return Status{};
+}
+
+Status SampleClassifier::Accumulate(
+    const std::unordered_map<uint64_t, uint64_t> &ip_histogram,
+    InstructionReadings &readings) {
+  readings.classification.clear();
+  readings.histogram.clear();
+  readings.vector_width.clear();
+  readings.element_type.clear();
+  readings.vector_packing.clear();
+
+  if (this->fd_ < 0) {
+    return Status{Status::FILE_ERROR, "Cannot open the process memory"};
+  }
+
+  this->Invalidate();
+  uint64_t total = 0;
+  for (const auto &entry : ip_histogram) total += entry.second;
+  if (0 == total) return Status{};
+
+  x86Instruction inst;
+  std::string key;
+  for (const auto &entry : ip_histogram) {
+    if (Status::OK != this->Classify(entry.first, inst).code) continue;
+    const float percent = 100.f * entry.second / total;
+
+    /* SIMD taxonomy: only for instructions on vector registers */
+    if (assembly::VectorWidth::NONE != std::get<0>(inst.vector)) {
+      readings.vector_width[std::get<0>(inst.vector)] += percent;
+      readings.element_type[std::get<1>(inst.vector)] += percent;
+      readings.vector_packing[std::get<2>(inst.vector)] += percent;
+    }
+
+    key.assign(inst.Mnemonic());
+    key += '_';
+    key.append(inst.OperandTypes());
+    readings.histogram[key] += percent;
+    readings.classification[std::get<0>(inst.pair)][std::get<1>(inst.pair)]
+                           [std::get<2>(inst.pair)] += percent;
+  }
+  return Status{};
+}
+
+Status SampleClassifier::SetIndexDirectory(const std::string &directory) {
+  if (!directory.empty() && !std::filesystem::is_directory(directory)) {
+    return Status{Status::INVALID_PARAMETER,
+                  "The index directory does not exist: " + directory};
+  }
+  this->index_directory_ = directory;
+  this->Clear();
+  return Status{};
+}
+
+void SampleClassifier::Clear() {
+  this->pages_.clear();
+  this->instructions_.clear();
+  this->anonymous_.clear();
+  this->indices_.clear();
+  this->mappings_.clear();
+  this->mappings_fresh_ = false;
+}
+
+uint SampleClassifier::GetPID() const noexcept { return this->pid_; }
+
+SampleClassifier::~SampleClassifier() {
+  if (this->fd_ >= 0) close(this->fd_);
+}
+
+} /* namespace efimon */
@@ -0,0 +1,250 @@
+/**
+ * @file sample.cpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Observer that consumes the instruction samples of a shared
+ * perf_event sampling session
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#include <efimon/perf/sample.hpp>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace efimon {
+
+extern uint64_t GetUptime();
+
+PerfSampleObserver::PerfSampleObserver(const uint pid,
+                                       const ObserverScope scope,
+                                       const uint64_t interval,
+                                       const uint64_t frequency,
+                                       const bool demultiplex)
+    : Observer{},
+      valid_{false},
+      scope_{scope},
+      frequency_{frequency},
+      demultiplex_{demultiplex},
+      frequency_integral_{0},
+      classify_{false},
+      classifier_{nullptr},
+      index_directory_{} {
+  uint64_t type = static_cast<uint64_t>(ObserverType::CPU) |
+                  static_cast<uint64_t>(ObserverType::INTERVAL) |
+                  static_cast<uint64_t>(ObserverType::CPU_INSTRUCTIONS);
+
+  this->pid_ = pid;
+  this->interval_ = interval;
+  if (0 == frequency) this->frequency_ = kDefaultFrequency;
+
+  this->caps_.emplace_back();
+  this->caps_[0].type = type;
+  this->caps_[0].scope = scope;
+
+  this->Reset();
+  Status st = this->Attach();
+  if (Status::OK != st.code) {
+    throw st;
+  }
+}
+
+Status PerfSampleObserver::Attach() {
+  this->Detach();
+
+  if (ObserverScope::PROCESS == this->scope_ && 0 == this->pid_) {
+    return Status{Status::NOT_READY, "Invalid PID. Assign one"};
+  }
+
+  const bool routed = ObserverScope::PROCESS == this->scope_ &&
+                      this->demultiplex_;
+  try {
+    this->session_ = PerfSessionManager::Acquire(
+        this->pid_, routed ? ObserverScope::SYSTEM : this->scope_,
+        this->frequency_);
+  } catch (const Status &st) {
+    return st;
+  }
+
+  {
+    std::scoped_lock lock(this->window_mutex_);
+    this->window_.ip_histogram.clear();
+    this->window_.samples = 0;
+    this->window_.lost = 0;
+  }
+  this->readings_.timestamp = GetUptime();
+  this->frequency_integral_ = this->session_->GetFrequencyIntegral();
+  Status st = routed ? this->session_->Subscribe(this, this->pid_)
+                     : this->session_->Subscribe(this);
+  if (Status::OK != st.code) this->session_.reset();
+  return st;
+}
+
+void PerfSampleObserver::Detach() {
+  if (!this->session_) return;
+  this->session_->Unsubscribe(this);
+  this->session_.reset();
+}
+
+void PerfSampleObserver::OnSamples(const std::vector<PerfSample> &samples,
+                                   const uint64_t lost) {
+  std::scoped_lock lock(this->window_mutex_);
+  for (const auto &sample : samples) {
+    this->window_.ip_histogram[sample.ip]++;
+  }
+  this->window_.samples += samples.size();
+  this->window_.lost += lost;
+}
+
+Status PerfSampleObserver::Trigger() {
+  if (!this->session_) {
+    return Status{Status::NOT_READY, "The observer is not subscribed"};
+  }
+
+  /* Close the window: the session keeps filling a fresh one */
+  {
+    std::scoped_lock lock(this->window_mutex_);
+    std::swap(this->readings_.ip_histogram, this->window_.ip_histogram);
+    this->readings_.samples = this->window_.samples;
+    this->readings_.lost = this->window_.lost;
+    this->window_.ip_histogram.clear();
+    this->window_.samples = 0;
+    this->window_.lost = 0;
+  }
+
+  auto time = GetUptime();
+  uint64_t integral = this->session_->GetFrequencyIntegral();
+  this->readings_.type = static_cast<uint64_t>(ObserverType::CPU) |
+                         static_cast<uint64_t>(ObserverType::CPU_INSTRUCTIONS);
+  this->readings_.difference = time - this->readings_.timestamp;
+  this->readings_.timestamp = time;
+  this->readings_.frequency =
+      0 == this->readings_.difference
+          ? this->session_->GetFrequency()
+          : (integral - this->frequency_integral_) /
+                this->readings_.difference;
+  this->readings_.overhead = this->session_->GetOverhead();
+  this->frequency_integral_ = integral;
+
+  if (this->classify_ && ObserverScope::PROCESS == this->scope_) {
+    if (!this->classifier_ || this->classifier_->GetPID() != this->pid_) {
+      this->classifier_ = std::make_unique<SampleClassifier>(this->pid_);
+      Status st = this->classifier_->SetIndexDirectory(this->index_directory_);
+      if (Status::OK != st.code) return st;
+    }
+    Status st = this->classifier_->Accumulate(this->readings_.ip_histogram,
+                                              this->instructions_);
+    if (Status::OK != st.code) return st;
+    this->instructions_.type = this->readings_.type;
+    this->instructions_.difference = this->readings_.difference;
+    this->instructions_.timestamp = this->readings_.timestamp;
+  }
+
+  this->valid_ = true;
+  return Status{};
+}
+
+std::vector<Readings*> PerfSampleObserver::GetReadings() {
+  if (this->classify_) {
+    return std::vector<Readings*>{
+        static_cast<Readings*>(&(this->readings_)),
+        static_cast<Readings*>(&(this->instructions_))};
+  }
+  return std::vector<Readings*>{static_cast<Readings*>(&(this->readings_))};
+}
+
+Status PerfSampleObserver::EnableClassification(const bool enable) {
+#if defined(__x86_64__) || defined(_M_X64)
+  this->classify_ = enable;
+  if (!enable) this->classifier_.reset();
+  return Status{};
+#else
+  this->classify_ = false;
+  return enable ? Status{Status::NOT_IMPLEMENTED,
+                         "The samples can only be decoded on x86-64"}
+                : Status{};
+#endif
+}
+
+Status PerfSampleObserver::SetOverheadBudget(const float budget) {
+  if (!this->session_) {
+    return Status{Status::NOT_READY, "The observer is not subscribed"};
+  }
+  return this->session_->SetOverheadBudget(budget);
+}
+
+Status PerfSampleObserver::SetIndexDirectory(const std::string &directory) {
+  this->index_directory_ = directory;
+  if (!this->classifier_) return Status{};
+  return this->classifier_->SetIndexDirectory(directory);
+}
+
+Status PerfSampleObserver::SelectDevice(const uint /* device */) {
+  return Status{Status::NOT_IMPLEMENTED, "Cannot select a device"};
+}
+
+Status PerfSampleObserver::SetScope(const ObserverScope scope) {
+  this->scope_ = scope;
+  this->caps_[0].scope = scope;
+  this->valid_ = false;
+  return this->Attach();
+}
+
+Status PerfSampleObserver::SetPID(const uint pid) {
+  this->pid_ = pid;
+  if (ObserverScope::SYSTEM == this->scope_) return Status{};
+  this->valid_ = false;
+  return this->Attach();
+}
+
+ObserverScope PerfSampleObserver::GetScope() const noexcept {
+  return this->scope_;
+}
+
+uint PerfSampleObserver::GetPID() const noexcept { return this->pid_; }
+
+const std::vector<ObserverCapabilities>& PerfSampleObserver::GetCapabilities()
+    const noexcept {
+  return this->caps_;
+}
+
+Status PerfSampleObserver::GetStatus() {
+  if (!this->valid_) {
+    return Status{Status::NOT_READY,
+                  "The internal trigger() has not been launched yet"};
+  }
+  return Status{};
+}
+
+Status PerfSampleObserver::SetInterval(const uint64_t interval) {
+  this->interval_ = interval;
+  return Status{};
+}
+
+Status PerfSampleObserver::ClearInterval() {
+  return Status{Status::NOT_IMPLEMENTED,
+                "The clear interval is not implemented yet"};
+}
+
+Status PerfSampleObserver::Reset() {
+  this->readings_.type = static_cast<uint>(ObserverType::NONE);
+  this->readings_.timestamp = 0;
+  this->readings_.difference = 0;
+  this->readings_.ip_histogram.clear();
+  this->readings_.samples = 0;
+  this->readings_.lost = 0;
+  this->readings_.frequency = 0;
+  this->readings_.overhead = 0.f;
+  this->instructions_.classification.clear();
+  this->instructions_.histogram.clear();
+  this->instructions_.vector_width.clear();
+  this->instructions_.element_type.clear();
+  this->instructions_.vector_packing.clear();
+  this->valid_ = false;
+  return Status{};
+}
+
+PerfSampleObserver::~PerfSampleObserver() { this->Detach(); }
+
+} /* namespace efimon */
@@ -0,0 +1,445 @@
+/**
+ * @file session.cpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Shared perf_event sampling sessions. A session owns the sampling
+ * stream of a process (or the whole system) and fans the samples out to
+ * any number of subscribers
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#include <linux/perf_event.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <efimon/perf/event-group.hpp>
+#include <efimon/perf/session.hpp>
+#include <efimon/proc/thread-tree.hpp>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+static std::mutex manager_mutex_;
+static std::map<int64_t, std::weak_ptr<efimon::PerfSampleSession>> sessions_;
+
+namespace efimon {
+
+/* Maximum time to wait for samples before draining anyway */
+static constexpr int kPollTimeout = 100;  // 100 ms
+/* Data pages per ring buffer: drained every kPollTimeout at most */
+static constexpr uint kSessionPages = 16;  // 64 KiB with 4 KiB pages
+/* Length of the frequency control window */
+static constexpr uint64_t kControlPeriod = 1000000000;  // 1 s
+
+extern uint64_t GetUptime();
+
+static uint64_t ClockNs(const clockid_t clock) {
+  struct timespec ts;
+  clock_gettime(clock, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+}
+
+/* Layout of PERF_RECORD_SAMPLE with IP | TID | TIME | CPU */
+struct SampleRecord {
+  struct perf_event_header header;
+  uint64_t ip;
+  uint32_t pid;
+  uint32_t tid;
+  uint64_t time;
+  uint32_t cpu;
+  uint32_t res;
+};
+
+/* Layout of PERF_RECORD_LOST */
+struct LostRecord {
+  struct perf_event_header header;
+  uint64_t id;
+  uint64_t lost;
+};
+
+PerfSampleSession::PerfSampleSession(const uint pid, const ObserverScope scope,
+                                     const uint64_t frequency)
+    : pid_{ObserverScope::SYSTEM == scope ? 0 : pid},
+      scope_{scope},
+      frequency_{frequency},
+      cpu_clock_{false},
+      running_{false},
+      samples_{0},
+      lost_{0},
+      throttled_{0},
+      governor_{frequency, 0.f},
+      frequency_integral_{0},
+      frequency_since_{GetUptime()} {
+  if (0 == frequency) {
+    throw Status{Status::INVALID_PARAMETER, "The frequency cannot be zero"};
+  }
+
+  Status st = this->Open();
+  if (Status::OK != st.code) {
+    throw st;
+  }
+
+  this->running_.store(true);
+  this->reader_ = std::thread(&PerfSampleSession::Reader, this);
+}
+
+Status PerfSampleSession::Open() {
+  const int num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  std::vector<int> tids;
+
+  if (ObserverScope::SYSTEM == this->scope_) {
+    tids.push_back(-1);
+  } else {
+    if (0 == this->pid_) {
+      return Status{Status::NOT_READY, "Invalid PID. Assign one"};
+    }
+    std::filesystem::path task_path =
+        std::filesystem::path("/proc") / std::to_string(this->pid_) / "task";
+    if (!std::filesystem::exists(task_path)) {
+      return Status{Status::NOT_FOUND, "Cannot check that PID is alive"};
+    }
+    ThreadTree tree{static_cast<int>(this->pid_)};
+    tids = tree.GetTree();
+  }
+
+  struct perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+  attr.freq = 1;
+  attr.sample_freq = this->frequency_.load();
+  attr.sample_type =
+      PERF_SAMPLE_IP | PERF_SAMPLE_TID | PERF_SAMPLE_TIME | PERF_SAMPLE_CPU;
+  attr.disabled = 1;
+  attr.inherit = ObserverScope::PROCESS == this->scope_ ? 1 : 0;
+  attr.exclude_hv = 1;
+  attr.watermark = 1;
+  /* Wake up the reader at a quarter of the buffer */
+  attr.wakeup_watermark = kSessionPages * sysconf(_SC_PAGESIZE) / 4;
+
+  /*
+   * Inherited events cannot be mapped with cpu = -1. Thus, there is an event
+   * per thread and CPU and all the events of a CPU are redirected to the ring
+   * buffer of the first one (as perf record does)
+   */
+  Status error{Status::CANNOT_OPEN, "Cannot open any sampling event"};
+  for (int cpu = 0; cpu < num_cpus; ++cpu) {
+    int owner = -1;
+    for (const int tid : tids) {
+      int fd = PerfEventGroup::OpenEvent(&attr, tid, cpu, -1, 0);
+      /* Without privileges, the kernel cannot be sampled */
+      if (fd < 0 && (EACCES == errno || EPERM == errno) &&
+          !attr.exclude_kernel) {
+        attr.exclude_kernel = 1;
+        fd = PerfEventGroup::OpenEvent(&attr, tid, cpu, -1, 0);
+      }
+      /* Without PMU (i.e. VMs), fall back to the CPU clock like perf does */
+      if (fd < 0 && (ENOENT == errno || EOPNOTSUPP == errno) &&
+          PERF_TYPE_HARDWARE == attr.type) {
+        attr.type = PERF_TYPE_SOFTWARE;
+        attr.config = PERF_COUNT_SW_CPU_CLOCK;
+        fd = PerfEventGroup::OpenEvent(&attr, tid, cpu, -1, 0);
+      }
+      if (fd < 0) {
+        int err = errno;
+        int code = EACCES == err || EPERM == err ? Status::ACCESS_DENIED
+                                                 : Status::CANNOT_OPEN;
+        error = Status{code, std::string("Cannot open the sampling event: ") +
+                                 std::strerror(err)};
+        /* Threads may finish in between: skip them */
+        if (tid > 0) continue;
+        this->Close();
+        return error;
+      }
+      this->fds_.push_back(fd);
+
+      Status st{};
+      if (owner < 0) {
+        PerfRingBuffer buffer;
+        st = buffer.Map(fd, kSessionPages);
+        if (Status::OK == st.code) {
+          this->buffers_.emplace_back(std::move(buffer));
+          owner = fd;
+        }
+      } else if (ioctl(fd, PERF_EVENT_IOC_SET_OUTPUT, owner)) {
+        st = Status{Status::CONFIGURATION_ERROR,
+                    "Cannot redirect the sampling event"};
+      }
+      if (Status::OK != st.code) {
+        this->Close();
+        return st;
+      }
+    }
+  }
+
+  if (this->fds_.empty()) {
+    return error;
+  }
+  this->cpu_clock_ = PERF_TYPE_SOFTWARE == attr.type;
+
+  for (const int fd : this->fds_) {
+    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+  }
+  return Status{};
+}
+
+void PerfSampleSession::Close() noexcept {
+  this->buffers_.clear();
+  for (const int fd : this->fds_) {
+    close(fd);
+  }
+  this->fds_.clear();
+}
+
+void PerfSampleSession::Reader() {
+  std::vector<struct pollfd> pfds;
+  std::vector<PerfSample> batch;
+
+  for (const auto &buffer : this->buffers_) {
+    pfds.push_back({buffer.GetFd(), POLLIN, 0});
+  }
+
+  auto handler = [&](const struct perf_event_header *header) {
+    if (PERF_RECORD_SAMPLE == header->type) {
+      auto record = reinterpret_cast<const SampleRecord *>(header);
+      batch.push_back(PerfSample{record->ip, record->pid, record->tid,
+                                 record->time, record->cpu});
+    } else if (PERF_RECORD_LOST == header->type) {
+      auto record = reinterpret_cast<const LostRecord *>(header);
+      this->lost_ += record->lost;
+    } else if (PERF_RECORD_THROTTLE == header->type) {
+      this->throttled_++;
+    }
+  };
+
+  uint64_t reported_lost = 0;
+  uint64_t control_wall = ClockNs(CLOCK_MONOTONIC);
+  uint64_t control_cpu = ClockNs(CLOCK_THREAD_CPUTIME_ID);
+  uint64_t control_lost = 0;
+  uint64_t control_throttled = 0;
+  while (this->running_.load()) {
+    poll(pfds.data(), pfds.size(), kPollTimeout);
+
+    /* The cost of the previous control window includes the subscribers */
+    const uint64_t wall = ClockNs(CLOCK_MONOTONIC);
+    if (wall - control_wall >= kControlPeriod) {
+      const uint64_t cpu = ClockNs(CLOCK_THREAD_CPUTIME_ID);
+      const uint64_t lost = this->lost_.load();
+      const uint64_t throttled = this->throttled_.load();
+      this->Control(cpu - control_cpu, wall - control_wall,
+                    lost - control_lost, throttled - control_throttled);
+      control_wall = wall;
+      control_cpu = cpu;
+      control_lost = lost;
+      control_throttled = throttled;
+    }
+
+    batch.clear();
+    for (uint i = 0; i < this->buffers_.size(); ++i) {
+      this->buffers_[i].Consume(handler);
+      /* The thread finished: stop polling it once it is drained */
+      if (pfds[i].revents & (POLLHUP | POLLERR)) {
+        pfds[i].fd = -1;
+      }
+    }
+
+    const uint64_t lost = this->lost_.load() - reported_lost;
+    reported_lost += lost;
+    if (batch.empty() && 0 == lost) continue;
+
+    this->samples_ += batch.size();
+    std::scoped_lock lock(this->sinks_mutex_);
+    for (auto sink : this->sinks_) {
+      sink->OnSamples(batch, lost);
+    }
+
+    /* Demultiplex per PID: a single lookup per sample */
+    if (this->routes_.empty()) continue;
+    for (const auto &sample : batch) {
+      auto rit = this->routes_.find(sample.pid);
+      if (this->routes_.end() == rit) continue;
+      for (auto sink : rit->second) {
+        this->routed_[sink].push_back(sample);
+      }
+    }
+    for (auto &routed : this->routed_) {
+      if (routed.second.empty() && 0 == lost) continue;
+      routed.first->OnSamples(routed.second, lost);
+      routed.second.clear();
+    }
+  }
+}
+
+void PerfSampleSession::Control(const uint64_t cpu_time,
+                                const uint64_t wall_time, const uint64_t lost,
+                                const uint64_t throttled) {
+  std::scoped_lock lock(this->control_mutex_);
+  uint64_t frequency =
+      this->governor_.Update(cpu_time, wall_time, lost, throttled);
+  if (frequency == this->frequency_.load()) return;
+
+  /*
+   * In frequency mode, the period ioctl takes the frequency. The CPU clock
+   * turns the frequency into a fixed period in ns when it is opened
+   */
+  uint64_t value = this->cpu_clock_ ? 1000000000ull / frequency : frequency;
+  for (const int fd : this->fds_) {
+    ioctl(fd, PERF_EVENT_IOC_PERIOD, &value);
+  }
+
+  const uint64_t now = GetUptime();
+  this->frequency_integral_ +=
+      this->frequency_.load() * (now - this->frequency_since_);
+  this->frequency_since_ = now;
+  this->frequency_.store(frequency);
+}
+
+Status PerfSampleSession::SetOverheadBudget(const float budget) {
+  if (0.f > budget || 1.f < budget) {
+    return Status{Status::INVALID_PARAMETER,
+                  "The budget must be a fraction of a core between 0 and 1"};
+  }
+  std::scoped_lock lock(this->control_mutex_);
+  this->governor_.SetBudget(budget);
+  return Status{};
+}
+
+float PerfSampleSession::GetOverheadBudget() {
+  std::scoped_lock lock(this->control_mutex_);
+  return this->governor_.GetBudget();
+}
+
+float PerfSampleSession::GetOverhead() {
+  std::scoped_lock lock(this->control_mutex_);
+  return this->governor_.GetOverhead();
+}
+
+uint64_t PerfSampleSession::GetFrequencyIntegral() {
+  std::scoped_lock lock(this->control_mutex_);
+  return this->frequency_integral_ +
+         this->frequency_.load() * (GetUptime() - this->frequency_since_);
+}
+
+uint64_t PerfSampleSession::GetNumThrottled() const noexcept {
+  return this->throttled_.load();
+}
+
+Status PerfSampleSession::Subscribe(PerfSampleSink *sink) {
+  if (!sink) {
+    return Status{Status::INVALID_PARAMETER, "The sink cannot be null"};
+  }
+  std::scoped_lock lock(this->sinks_mutex_);
+  if (this->sinks_.end() !=
+          std::find(this->sinks_.begin(), this->sinks_.end(), sink) ||
+      this->routed_.end() != this->routed_.find(sink)) {
+    return Status{Status::RESOURCE_BUSY, "The sink is already subscribed"};
+  }
+  this->sinks_.push_back(sink);
+  return Status{};
+}
+
+Status PerfSampleSession::Subscribe(PerfSampleSink *sink, const uint pid) {
+  if (!sink) {
+    return Status{Status::INVALID_PARAMETER, "The sink cannot be null"};
+  }
+  if (ObserverScope::SYSTEM != this->scope_) {
+    return Status{Status::INCOMPATIBLE_PARAMETER,
+                  "Only the system-wide session can be demultiplexed"};
+  }
+  std::scoped_lock lock(this->sinks_mutex_);
+  if (this->routed_.end() != this->routed_.find(sink) ||
+      this->sinks_.end() !=
+          std::find(this->sinks_.begin(), this->sinks_.end(), sink)) {
+    return Status{Status::RESOURCE_BUSY, "The sink is already subscribed"};
+  }
+  this->routes_[pid].push_back(sink);
+  this->routed_[sink] = {};
+  return Status{};
+}
+
+Status PerfSampleSession::Unsubscribe(PerfSampleSink *sink) {
+  std::scoped_lock lock(this->sinks_mutex_);
+  auto it = std::find(this->sinks_.begin(), this->sinks_.end(), sink);
+  if (this->sinks_.end() != it) {
+    this->sinks_.erase(it);
+    return Status{};
+  }
+
+  if (0 == this->routed_.erase(sink)) {
+    return Status{Status::NOT_FOUND, "The sink is not subscribed"};
+  }
+  for (auto rit = this->routes_.begin(); rit != this->routes_.end(); ++rit) {
+    auto &route = rit->second;
+    auto sit = std::find(route.begin(), route.end(), sink);
+    if (route.end() == sit) continue;
+    route.erase(sit);
+    if (route.empty()) this->routes_.erase(rit);
+    break;
+  }
+  return Status{};
+}
+
+uint PerfSampleSession::GetPID() const noexcept { return this->pid_; }
+
+ObserverScope PerfSampleSession::GetScope() const noexcept {
+  return this->scope_;
+}
+
+uint64_t PerfSampleSession::GetFrequency() const noexcept {
+  return this->frequency_.load();
+}
+
+uint64_t PerfSampleSession::GetNumSamples() const noexcept {
+  return this->samples_.load();
+}
+
+uint64_t PerfSampleSession::GetNumLost() const noexcept {
+  return this->lost_.load();
+}
+
+PerfSampleSession::~PerfSampleSession() {
+  this->running_.store(false);
+  if (this->reader_.joinable()) this->reader_.join();
+  for (const int fd : this->fds_) {
+    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+  }
+  this->Close();
+}
+
+std::shared_ptr<PerfSampleSession> PerfSessionManager::Acquire(
+    const uint pid, const ObserverScope scope, const uint64_t frequency) {
+  const int64_t key =
+      ObserverScope::SYSTEM == scope ? -1 : static_cast<int64_t>(pid);
+
+  std::scoped_lock lock(manager_mutex_);
+  auto it = sessions_.find(key);
+  if (sessions_.end() != it) {
+    auto session = it->second.lock();
+    if (session) return session;
+  }
+
+  /* Purge the sessions that are already gone */
+  for (auto sit = sessions_.begin(); sit != sessions_.end();) {
+    sit = sit->second.expired() ? sessions_.erase(sit) : std::next(sit);
+  }
+
+  auto session = std::make_shared<PerfSampleSession>(pid, scope, frequency);
+  sessions_[key] = session;
+  return session;
+}
+
+uint PerfSessionManager::GetNumSessions() {
+  std::scoped_lock lock(manager_mutex_);
+  return std::count_if(sessions_.begin(), sessions_.end(),
+                       [](const auto &s) { return !s.second.expired(); });
+}
+
+} /* namespace efimon */
@@ -0,0 +1,399 @@
+/**
+ * @file topdown.cpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Observer to compute the top-down microarchitecture breakdown through
+ * perf_event_open counting groups
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#include <linux/perf_event.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <efimon/perf/event-resolver.hpp>
+#include <efimon/perf/topdown.hpp>
+#include <efimon/proc/thread-tree.hpp>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace efimon {
+
+extern uint64_t GetUptime();
+
+/* Typical cost in cycles of recovering from a branch misprediction. Used to
+   approximate the bad speculation when there are no slot events */
+static constexpr double kMispredictPenalty = 20.;
+
+static float Clamp(const double value) {
+  return static_cast<float>(std::clamp(value, 0., 1.));
+}
+
+TopDownObserver::TopDownObserver(const uint pid, const ObserverScope scope,
+                                 const uint64_t interval)
+    : Observer{}, valid_{false}, scope_{scope}, source_{Source::NONE} {
+  uint64_t type = static_cast<uint64_t>(ObserverType::CPU) |
+                  static_cast<uint64_t>(ObserverType::PMU) |
+                  static_cast<uint64_t>(ObserverType::INTERVAL);
+
+  this->pid_ = pid;
+  this->interval_ = interval;
+
+  this->caps_.emplace_back();
+  this->caps_[0].type = type;
+  this->caps_[0].scope = scope;
+
+  this->Reset();
+  Status st = this->OpenGroups();
+  if (Status::OK != st.code) {
+    throw st;
+  }
+}
+
+bool TopDownObserver::ResolveEvents(const Source source) {
+  this->events_.clear();
+
+  auto add_named = [this](const char *name, const bool required) {
+    PerfEventResolver::Event event;
+    if (Status::OK != PerfEventResolver::Resolve(name, event).code) {
+      return !required;
+    }
+    this->events_.push_back(
+        Event{event.type, event.config, event.scale, required});
+    return true;
+  };
+
+  bool resolved = true;
+  switch (source) {
+    case Source::PERF_METRICS:
+      resolved = add_named("slots", true) &&
+                 add_named("topdown-retiring", true) &&
+                 add_named("topdown-bad-spec", true) &&
+                 add_named("topdown-fe-bound", true) &&
+                 add_named("topdown-be-bound", true);
+      /* Level 2: only on the PMUs that export it */
+      if (resolved) add_named("topdown-mem-bound", false);
+      break;
+    case Source::SLOTS:
+      resolved = add_named("topdown-total-slots", true) &&
+                 add_named("topdown-slots-issued", true) &&
+                 add_named("topdown-slots-retired", true) &&
+                 add_named("topdown-fetch-bubbles", true) &&
+                 add_named("topdown-recovery-bubbles", true);
+      break;
+    case Source::GENERIC:
+      this->events_.push_back(
+          Event{PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, 1., true});
+      this->events_.push_back(Event{PERF_TYPE_HARDWARE,
+                                    PERF_COUNT_HW_STALLED_CYCLES_FRONTEND, 1.,
+                                    false});
+      this->events_.push_back(Event{
+          PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_BACKEND, 1., false});
+      this->events_.push_back(
+          Event{PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, 1., false});
+      break;
+    default:
+      resolved = false;
+      break;
+  }
+
+  if (!resolved) this->events_.clear();
+  return resolved;
+}
+
+Status TopDownObserver::OpenGroups() {
+  std::vector<int> pids, cpus;
+
+  this->groups_.clear();
+  this->last_values_.clear();
+  this->source_ = Source::NONE;
+  this->valid_ = false;
+
+  if (ObserverScope::SYSTEM == this->scope_) {
+    const int num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    for (int cpu = 0; cpu < num_cpus; ++cpu) {
+      pids.push_back(-1);
+      cpus.push_back(cpu);
+    }
+  } else {
+    if (0 == this->pid_) {
+      return Status{Status::NOT_READY, "Invalid PID. Assign one"};
+    }
+    std::filesystem::path task_path =
+        std::filesystem::path("/proc") / std::to_string(this->pid_) / "task";
+    if (!std::filesystem::exists(task_path)) {
+      return Status{Status::NOT_FOUND, "Cannot check that PID is alive"};
+    }
+    ThreadTree tree{static_cast<int>(this->pid_)};
+    for (const int tid : tree.GetTree()) {
+      pids.push_back(tid);
+      cpus.push_back(-1);
+    }
+  }
+
+  for (const Source source :
+       {Source::PERF_METRICS, Source::SLOTS, Source::GENERIC}) {
+    if (!this->ResolveEvents(source)) continue;
+
+    Status st = this->OpenSource(pids, cpus);
+    if (Status::OK == st.code) {
+      this->source_ = source;
+      break;
+    }
+    /* Unsupported by the PMU: try the next source */
+    if (Status::CANNOT_OPEN != st.code) {
+      return st;
+    }
+  }
+
+  /* Not an error: the readings stay at -1 and GetStatus() reports it */
+  if (Source::NONE == this->source_) {
+    this->events_.clear();
+  }
+
+  this->readings_.timestamp = GetUptime();
+  return Status{};
+}
+
+Status TopDownObserver::OpenSource(const std::vector<int> &pids,
+                                   const std::vector<int> &cpus) {
+  const bool inherit = ObserverScope::PROCESS == this->scope_;
+  Status error{Status::CANNOT_OPEN, "Cannot open any counting group"};
+
+  this->groups_.clear();
+  for (uint i = 0; i < pids.size(); ++i) {
+    PerfEventGroup group;
+    for (const auto &event : this->events_) {
+      group.AddEvent(event.type, event.config, event.required);
+    }
+
+    Status st = group.Open(pids[i], cpus[i], inherit);
+    /* Threads may finish in between: skip them */
+    if (Status::OK != st.code && pids[i] > 0) {
+      error = st;
+      continue;
+    }
+    if (Status::OK != st.code) {
+      this->groups_.clear();
+      return st;
+    }
+    st = group.Enable();
+    if (Status::OK != st.code) {
+      this->groups_.clear();
+      return st;
+    }
+    this->groups_.emplace_back(std::move(group));
+  }
+
+  if (this->groups_.empty()) {
+    return error;
+  }
+
+  this->last_values_.resize(this->groups_.size());
+  for (uint i = 0; i < this->groups_.size(); ++i) {
+    Status st = this->groups_[i].Read(this->last_values_[i]);
+    if (Status::OK != st.code) {
+      this->groups_.clear();
+      this->last_values_.clear();
+      return st;
+    }
+  }
+  return Status{};
+}
+
+Status TopDownObserver::Trigger() {
+  const uint num_events = this->events_.size();
+  std::vector<double> counts(num_events, 0.);
+  std::vector<bool> counting(num_events, false);
+
+  if (Source::NONE != this->source_ && this->groups_.empty()) {
+    return Status{Status::NOT_READY, "The counting groups are not open"};
+  }
+
+  for (uint g = 0; g < this->groups_.size(); ++g) {
+    PerfEventGroup::Values values;
+    Status st = this->groups_[g].Read(values);
+    if (Status::OK != st.code) return st;
+
+    auto &last = this->last_values_[g];
+    const uint64_t delta_enabled = values.time_enabled - last.time_enabled;
+    const uint64_t delta_running = values.time_running - last.time_running;
+
+    /* Scale to compensate the multiplexing */
+    if (0 != delta_running) {
+      const double scale = static_cast<double>(delta_enabled) /
+                           static_cast<double>(delta_running);
+      for (uint e = 0; e < num_events; ++e) {
+        counts[e] += scale * this->events_[e].scale *
+                     (values.counters[e] - last.counters[e]);
+      }
+    }
+    last = std::move(values);
+  }
+  for (uint e = 0; e < num_events && !this->groups_.empty(); ++e) {
+    counting[e] = this->groups_[0].IsCounting(e);
+  }
+
+  /* Set readings common metadata */
+  auto time = GetUptime();
+  this->readings_.type = static_cast<uint64_t>(ObserverType::CPU) |
+                         static_cast<uint64_t>(ObserverType::PMU);
+  this->readings_.difference = time - this->readings_.timestamp;
+  this->readings_.timestamp = time;
+
+  this->ComputeMetrics(counts, counting);
+
+  this->valid_ = true;
+  return Status{};
+}
+
+void TopDownObserver::ComputeMetrics(const std::vector<double> &counts,
+                                     const std::vector<bool> &counting) {
+  auto &r = this->readings_;
+  r.retiring = -1.f;
+  r.bad_speculation = -1.f;
+  r.frontend_bound = -1.f;
+  r.backend_bound = -1.f;
+  r.memory_bound = -1.f;
+  r.core_bound = -1.f;
+  r.level = 0;
+  r.approximated = Source::GENERIC == this->source_;
+
+  switch (this->source_) {
+    case Source::PERF_METRICS: {
+      const double slots = counts[PM_SLOTS];
+      if (slots <= 0.) break;
+      r.retiring = Clamp(counts[PM_RETIRING] / slots);
+      r.bad_speculation = Clamp(counts[PM_BAD_SPEC] / slots);
+      r.frontend_bound = Clamp(counts[PM_FE] / slots);
+      r.backend_bound = Clamp(counts[PM_BE] / slots);
+      r.level = 1;
+      if (counting.size() > PM_MEM && counting[PM_MEM]) {
+        r.memory_bound = Clamp(counts[PM_MEM] / slots);
+        r.core_bound = Clamp(r.backend_bound - r.memory_bound);
+        r.level = 2;
+      }
+      break;
+    }
+    case Source::SLOTS: {
+      const double slots = counts[SL_TOTAL];
+      if (slots <= 0.) break;
+      const double fe = counts[SL_FETCH_BUBBLES] / slots;
+      const double bs = (counts[SL_ISSUED] - counts[SL_RETIRED] +
+                         counts[SL_RECOVERY_BUBBLES]) /
+                        slots;
+      const double ret = counts[SL_RETIRED] / slots;
+      r.frontend_bound = Clamp(fe);
+      r.bad_speculation = Clamp(bs);
+      r.retiring = Clamp(ret);
+      r.backend_bound = Clamp(1. - fe - bs - ret);
+      r.level = 1;
+      break;
+    }
+    case Source::GENERIC: {
+      const double cycles = counts[GN_CYCLES];
+      if (cycles <= 0.) break;
+      double fe = counting[GN_FE_STALLS] ? counts[GN_FE_STALLS] / cycles : -1.;
+      double be = counting[GN_BE_STALLS] ? counts[GN_BE_STALLS] / cycles : -1.;
+      double bs = counting[GN_BRANCH_MISSES]
+                      ? kMispredictPenalty * counts[GN_BRANCH_MISSES] / cycles
+                      : -1.;
+      if (fe >= 0. && be >= 0. && bs >= 0.) {
+        /* The stalls overlap: normalise if they exceed the cycles */
+        const double total = fe + be + bs;
+        if (total > 1.) {
+          fe /= total;
+          be /= total;
+          bs /= total;
+        }
+        r.retiring = Clamp(1. - fe - be - bs);
+        r.level = 1;
+      }
+      if (fe >= 0.) r.frontend_bound = Clamp(fe);
+      if (be >= 0.) r.backend_bound = Clamp(be);
+      if (bs >= 0.) r.bad_speculation = Clamp(bs);
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+std::vector<Readings*> TopDownObserver::GetReadings() {
+  return std::vector<Readings*>{static_cast<Readings*>(&(this->readings_))};
+}
+
+Status TopDownObserver::SelectDevice(const uint /* device */) {
+  return Status{Status::NOT_IMPLEMENTED, "Cannot select a device"};
+}
+
+Status TopDownObserver::SetScope(const ObserverScope scope) {
+  this->scope_ = scope;
+  this->caps_[0].scope = scope;
+  return this->OpenGroups();
+}
+
+Status TopDownObserver::SetPID(const uint pid) {
+  this->pid_ = pid;
+  if (ObserverScope::SYSTEM == this->scope_) return Status{};
+  return this->OpenGroups();
+}
+
+ObserverScope TopDownObserver::GetScope() const noexcept {
+  return this->scope_;
+}
+
+uint TopDownObserver::GetPID() const noexcept { return this->pid_; }
+
+const std::vector<ObserverCapabilities>& TopDownObserver::GetCapabilities()
+    const noexcept {
+  return this->caps_;
+}
+
+Status TopDownObserver::GetStatus() {
+  if (Source::NONE == this->source_) {
+    return Status{Status::NOT_IMPLEMENTED,
+                  "There are no PMU events for the top-down analysis"};
+  }
+  if (!this->valid_) {
+    return Status{Status::NOT_READY,
+                  "The internal trigger() has not been launched yet"};
+  }
+  return Status{};
+}
+
+Status TopDownObserver::SetInterval(const uint64_t interval) {
+  this->interval_ = interval;
+  return Status{};
+}
+
+Status TopDownObserver::ClearInterval() {
+  return Status{Status::NOT_IMPLEMENTED,
+                "The clear interval is not implemented yet"};
+}
+
+Status TopDownObserver::Reset() {
+  this->readings_.type = static_cast<uint>(ObserverType::NONE);
+  this->readings_.timestamp = 0;
+  this->readings_.difference = 0;
+  this->readings_.retiring = -1.f;
+  this->readings_.bad_speculation = -1.f;
+  this->readings_.frontend_bound = -1.f;
+  this->readings_.backend_bound = -1.f;
+  this->readings_.memory_bound = -1.f;
+  this->readings_.core_bound = -1.f;
+  this->readings_.level = 0;
+  this->readings_.approximated = false;
+  this->valid_ = false;
+  return Status{};
+}
+
+TopDownObserver::Source TopDownObserver::GetSource() const noexcept {
+  return this->source_;
+}
+
+TopDownObserver::~TopDownObserver() {}
+
+} /* namespace efimon */
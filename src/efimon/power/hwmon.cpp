@@ -0,0 +1,310 @@
+/**
+ * @file hwmon.cpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Hardware monitoring (hwmon) wrapper to read the fan, temperature,
+ * voltage, power and energy sensors exposed by the kernel drivers
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <efimon/power/hwmon.hpp>
+#include <efimon/status.hpp>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>  // NOLINT
+#include <utility>
+#include <vector>
+
+namespace efimon {
+
+extern uint64_t GetUptime();
+
+/* Prefixes of the input files, in the order of HwmonChannel::Type */
+static const char *const kChannelPrefixes[] = {"fan", "temp", "in", "power",
+                                               "energy"};
+static constexpr char kInputSuffix[] = "_input";
+
+static std::string ReadLine(const std::filesystem::path &path) {
+  std::ifstream file{path};
+  std::string line;
+  std::getline(file, line);
+  return line;
+}
+
+/* Reads a raw value from a descriptor kept open */
+static bool ReadValue(const int fd, int64_t &value) {  // NOLINT
+  char buffer[32];
+  ssize_t bytes = pread(fd, buffer, sizeof(buffer) - 1, 0);
+  if (bytes <= 0) return false;
+  buffer[bytes] = '\0';
+  char *end = nullptr;
+  value = std::strtoll(buffer, &end, 10);
+  return end != buffer;
+}
+
+HwmonMeterObserver::HwmonMeterObserver(const uint /* pid */,
+                                       const ObserverScope scope,
+                                       const uint64_t interval,
+                                       const std::string &root)
+    : Observer{}, valid_{false}, channels_{} {
+  uint64_t type = static_cast<uint64_t>(ObserverType::THERMAL) |
+                  static_cast<uint64_t>(ObserverType::POWER) |
+                  static_cast<uint64_t>(ObserverType::INTERVAL);
+
+  this->interval_ = interval;
+
+  if (ObserverScope::SYSTEM != scope) {
+    throw Status{Status::INVALID_PARAMETER, "Process-scope is not supported"};
+  }
+
+  this->caps_.emplace_back();
+  this->caps_[0].type = type;
+
+  /* Old drivers keep the attributes in the device directory */
+  std::error_code ec;
+  const std::filesystem::path path = root.empty() ? kHwmonPath : root;
+  for (const auto &entry : std::filesystem::directory_iterator(path, ec)) {
+    const std::filesystem::path hwmon = entry.path();
+    std::string name = ReadLine(hwmon / "name");
+    if (!name.empty()) {
+      this->DiscoverChip(hwmon.string(), name);
+      continue;
+    }
+    name = ReadLine(hwmon / "device" / "name");
+    if (!name.empty()) this->DiscoverChip((hwmon / "device").string(), name);
+  }
+
+  if (this->channels_.empty()) {
+    throw Status{Status::NOT_FOUND, "There are no hwmon sensors"};
+  }
+
+  std::stable_sort(this->channels_.begin(), this->channels_.end(),
+                   [](const HwmonChannel &a, const HwmonChannel &b) {
+                     if (a.type != b.type) return a.type < b.type;
+                     if (a.chip != b.chip) return a.chip < b.chip;
+                     return a.index < b.index;
+                   });
+
+  this->Reset();
+  this->Trigger();
+}
+
+void HwmonMeterObserver::DiscoverChip(const std::string &chip,
+                                      const std::string &name) {
+  std::error_code ec;
+  for (const auto &entry : std::filesystem::directory_iterator(chip, ec)) {
+    /* Inputs: <prefix><number>_input */
+    const std::string file = entry.path().filename().string();
+    const std::size_t suffix = file.rfind(kInputSuffix);
+    if (std::string::npos == suffix ||
+        suffix + sizeof(kInputSuffix) - 1 != file.size())
+      continue;
+
+    const std::string prefix = file.substr(0, suffix);
+    const std::size_t digits = prefix.find_first_of("0123456789");
+    if (std::string::npos == digits || 0 == digits) continue;
+    const std::string kind = prefix.substr(0, digits);
+    const auto *found =
+        std::find(std::begin(kChannelPrefixes), std::end(kChannelPrefixes),
+                  kind);
+    if (std::end(kChannelPrefixes) == found) continue;
+
+    HwmonChannel channel{};
+    channel.type = static_cast<HwmonChannel::Type>(
+        std::distance(std::begin(kChannelPrefixes), found));
+    channel.chip = name;
+    channel.index = std::strtoul(prefix.c_str() + digits, nullptr, 10);
+    channel.label = ReadLine(entry.path().parent_path() / (prefix + "_label"));
+    if (channel.label.empty()) channel.label = prefix;
+    channel.path = entry.path().string();
+    channel.fd = open(channel.path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (channel.fd < 0) continue;
+
+    /* Skip the channels whose driver cannot read them (i.e. no fan) */
+    int64_t value = 0;
+    if (!ReadValue(channel.fd, value)) {
+      close(channel.fd);
+      continue;
+    }
+    this->channels_.push_back(std::move(channel));
+  }
+}
+
+Status HwmonMeterObserver::Trigger() {
+  /* Set readings common metadata */
+  auto time = GetUptime();
+  const uint64_t difference = time - this->fan_readings_.timestamp;
+  const uint64_t type = static_cast<uint64_t>(ObserverType::THERMAL);
+  for (Readings *readings : this->GetReadings()) {
+    readings->type = type;
+    readings->difference = difference;
+    readings->timestamp = time;
+  }
+  this->electrical_readings_.type |= static_cast<uint64_t>(ObserverType::POWER);
+
+  /* All the channels in one pass. The channels that cannot be read keep
+     the previous value, so their energy does not change */
+  Status ret{};
+  this->before_values_ = this->after_values_;
+  for (std::size_t i = 0; i < this->channels_.size(); ++i) {
+    const bool read = ReadValue(this->channels_[i].fd, this->after_values_[i]);
+    this->failed_[i] = !read;
+    if (!read) {
+      ret = Status{Status::FILE_ERROR,
+                   "Cannot read the hwmon channel " + this->channels_[i].path};
+    }
+  }
+  if (!this->valid_) this->before_values_ = this->after_values_;
+
+  this->ParseResults();
+  this->valid_ = true;
+  return ret;
+}
+
+void HwmonMeterObserver::ParseResults() {
+  this->fan_readings_.fan_speeds.clear();
+  this->thermal_readings_.temperatures.clear();
+  this->electrical_readings_.voltages.clear();
+  this->electrical_readings_.power.clear();
+
+  /* The channels that cannot be read are -1 and left out of the overall */
+  const float unavailable = -1.f;
+  uint energy = 0, fans = 0, temperatures = 0;
+  float speed = 0.f, temperature = 0.f, max_temperature = 0.f;
+  for (std::size_t i = 0; i < this->channels_.size(); ++i) {
+    const int64_t value = this->after_values_[i];
+    const bool failed = this->failed_[i];
+    switch (this->channels_[i].type) {
+      case HwmonChannel::Type::FAN:
+        this->fan_readings_.fan_speeds.push_back(failed ? unavailable : value);
+        if (failed) break;
+        speed += value;
+        ++fans;
+        break;
+      case HwmonChannel::Type::TEMPERATURE: {
+        const float celsius = value * 1e-3f;
+        this->thermal_readings_.temperatures.push_back(failed ? unavailable
+                                                              : celsius);
+        if (failed) break;
+        temperature += celsius;
+        max_temperature =
+            temperatures++ ? std::max(max_temperature, celsius) : celsius;
+        break;
+      }
+      case HwmonChannel::Type::VOLTAGE:
+        this->electrical_readings_.voltages.push_back(
+            failed ? unavailable : value * 1e-3f);
+        break;
+      case HwmonChannel::Type::POWER:
+        this->electrical_readings_.power.push_back(
+            failed ? unavailable : value * 1e-6f);
+        break;
+      case HwmonChannel::Type::ENERGY: {
+        /* The counter restarts if the driver is reloaded. Its range is not
+           exported, so that sample is dropped */
+        const int64_t before = this->before_values_[i];
+        const int64_t delta = value >= before ? value - before : 0;
+        this->electrical_readings_.energy.at(energy++) += delta * 1e-6;
+        break;
+      }
+    }
+  }
+
+  this->fan_readings_.overall_speed = fans ? speed / fans : 0.f;
+  this->thermal_readings_.overall_temperature =
+      temperatures ? temperature / temperatures : 0.f;
+  this->thermal_readings_.max_temperature = max_temperature;
+}
+
+std::vector<Readings *> HwmonMeterObserver::GetReadings() {
+  return std::vector<Readings *>{
+      static_cast<Readings *>(&(this->fan_readings_)),
+      static_cast<Readings *>(&(this->thermal_readings_)),
+      static_cast<Readings *>(&(this->electrical_readings_))};
+}
+
+Status HwmonMeterObserver::SelectDevice(const uint /* device */) {
+  return Status{Status::NOT_IMPLEMENTED,
+                "All the hwmon channels are read at once"};
+}
+
+Status HwmonMeterObserver::SetScope(const ObserverScope scope) {
+  if (ObserverScope::SYSTEM == scope) return Status{};
+  return Status{Status::NOT_IMPLEMENTED, "The scope is only set to SYSTEM"};
+}
+
+Status HwmonMeterObserver::SetPID(const uint /* pid */) {
+  return Status{Status::NOT_IMPLEMENTED,
+                "It is not possible to set a PID in a SYSTEM wide Observer"};
+}
+
+ObserverScope HwmonMeterObserver::GetScope() const noexcept {
+  return ObserverScope::SYSTEM;
+}
+
+uint HwmonMeterObserver::GetPID() const noexcept { return 0; }
+
+const std::vector<ObserverCapabilities> &HwmonMeterObserver::GetCapabilities()
+    const noexcept {
+  return this->caps_;
+}
+
+Status HwmonMeterObserver::GetStatus() { return Status{}; }
+
+Status HwmonMeterObserver::SetInterval(const uint64_t interval) {
+  this->interval_ = interval;
+  return Status{};
+}
+
+Status HwmonMeterObserver::ClearInterval() {
+  return Status{Status::NOT_IMPLEMENTED,
+                "The clear interval is not implemented yet"};
+}
+
+Status HwmonMeterObserver::Reset() {
+  const std::size_t energy =
+      std::count_if(this->channels_.begin(), this->channels_.end(),
+                    [](const HwmonChannel &channel) {
+                      return HwmonChannel::Type::ENERGY == channel.type;
+                    });
+
+  for (Readings *readings : this->GetReadings()) {
+    readings->type = static_cast<uint>(ObserverType::NONE);
+    readings->timestamp = 0;
+    readings->difference = 0;
+  }
+  this->fan_readings_.overall_speed = 0.f;
+  this->fan_readings_.fan_speeds.clear();
+  this->thermal_readings_.overall_temperature = 0.f;
+  this->thermal_readings_.max_temperature = 0.f;
+  this->thermal_readings_.temperatures.clear();
+  this->electrical_readings_.voltages.clear();
+  this->electrical_readings_.power.clear();
+  this->electrical_readings_.energy.assign(energy, 0.);
+  this->before_values_.assign(this->channels_.size(), 0);
+  this->after_values_.assign(this->channels_.size(), 0);
+  this->failed_.assign(this->channels_.size(), false);
+  this->valid_ = false;
+  return Status{};
+}
+
+const std::vector<HwmonChannel> &HwmonMeterObserver::GetChannels()
+    const noexcept {
+  return this->channels_;
+}
+
+HwmonMeterObserver::~HwmonMeterObserver() {
+  for (auto &channel : this->channels_) {
+    if (channel.fd >= 0) close(channel.fd);
+    channel.fd = -1;
+  }
+}
+
+} /* namespace efimon */
@@ -9,63 +9,120 @@
  * @copyright Copyright (c) 2024. See License for Licensing
  */
 
+#include <chrono>  // NOLINT
+#include <condition_variable>  // NOLINT
 #include <cstdint>
 #include <efimon/power/intel.hpp>
 #include <efimon/status.hpp>
+#include <memory>
 #include <mutex>  // NOLINT
 #include <string>
 #include <third-party/pcm.hpp>
+#include <thread>  // NOLINT
+#include <utility>
 #include <vector>
 
 namespace efimon {
 
 extern uint64_t GetUptime();
 
+/* Period of the collector (ms) */
+static constexpr uint64_t kCollectorPeriod = 100;
+
+struct PCMSnapshot {
+  /** Sequence number given by the collector. 0: none */
+  uint64_t sequence;
+  /** Uptime in milliseconds */
+  uint64_t timestamp;
+  /** Steady time in nanoseconds */
+  uint64_t time;
+  /** System state */
+  pcm::SystemCounterState system;
+  /** State per socket */
+  std::vector<pcm::SocketCounterState> sockets;
+  /** State per core */
+  std::vector<pcm::CoreCounterState> cores;
+};
+
+/**
+ * @brief Takes the PCM snapshots at its own rate for all the instances
+ *
+ * The counters are only read here, one read at a time. The last snapshot is
+ * kept under a mutex, which is only held to copy it.
+ */
+class PCMCollector {
+ public:
+  /**
+   * @brief Get the collector, starting it if there is none
+   *
+   * It throws a Status if PCM cannot be programmed
+   *
+   * @return std::shared_ptr<PCMCollector> collector
+   */
+  static std::shared_ptr<PCMCollector> Get();
+
+  /**
+   * @brief Copies the last snapshot. If it is not newer than the sequence,
+   * it takes a new one
+   *
+   * @param snapshot output snapshot
+   * @param sequence sequence of the snapshot held by the caller
+   */
+  void GetLatest(PCMSnapshot& snapshot, const uint64_t sequence);  // NOLINT
+
+  /** PCM instance */
+  pcm::PCM* GetInstance() const noexcept { return this->instance_; }
+
+  /** Stops the thread */
+  ~PCMCollector();
+
+ private:
+  explicit PCMCollector(pcm::PCM* instance);
+
+  /** Body of the collector thread */
+  void Collector();
+  /** Reads the counters and publishes them as the last snapshot */
+  void Sample();
+
+  /** PCM instance */
+  pcm::PCM* instance_;
+  /** Serialises the reads of the counters */
+  std::mutex sample_mutex_;
+  /** Guards latest_ */
+  std::mutex latest_mutex_;
+  /** Last snapshot */
+  PCMSnapshot latest_;
+  /** Snapshot being read */
+  PCMSnapshot next_;
+  /** Mutex to wait for the next period */
+  std::mutex sleep_mutex_;
+  /** Wakes the thread up to stop */
+  std::condition_variable wake_;
+  /** The thread is running */
+  bool running_;
+  /** Collector thread */
+  std::thread collector_;
+};
+
 namespace priv {
-/** Mutex to guard the pcm_instance_ access */
+/** Mutex to guard the pcm_instance_ and collector_ access */
 static std::mutex pcm_mutex_;
-/** PCM Instance that must be only generated once */
+/** PCM Instance that must be only programmed once */
 static pcm::PCM* pcm_instance_ = nullptr;
-/** PCM socket 1 measurements are valid (0: invalid, 1: invalid, 2: valid) */
-static int pcm_valid_ = 0;
-/**
- * Core state variables: measurements.
- * The 1 is the prev and 2 is the current
- */
-static std::vector<pcm::CoreCounterState> core_state_1_, core_state_2_;
-/**
- * Socket state variables: measurements.
- * The 1 is the prev and 2 is the current
- */
-static std::vector<pcm::SocketCounterState> socket_state_1_, socket_state_2_;
-/**
- * System state variables: measurements.
- * The 1 is the prev and 2 is the current
- */
-static pcm::SystemCounterState system_state_1_, system_state_2_;
+/** Collector shared by the instances. It expires with the last of them */
+static std::weak_ptr<PCMCollector> collector_;
 } /* namespace priv */
 
-IntelMeterObserver::IntelMeterObserver(const uint pid,
-                                       const ObserverScope scope,
-                                       const uint64_t interval)
-    : Observer{}, valid_{false} {
-  uint64_t type = static_cast<uint64_t>(ObserverType::CPU) |
-                  static_cast<uint64_t>(ObserverType::INTERVAL);
-
-  this->pid_ = pid;
-  this->interval_ = interval;
-
-  if (ObserverScope::SYSTEM != scope) {
-    throw Status{Status::INVALID_PARAMETER, "Process-scope is not supported"};
-  }
+std::shared_ptr<PCMCollector> PCMCollector::Get() {
+  std::scoped_lock<std::mutex> lock(priv::pcm_mutex_);
+  std::shared_ptr<PCMCollector> collector = priv::collector_.lock();
+  if (collector) return collector;
 
-  /* Lock access to pcm_instance_ */
-  priv::pcm_mutex_.lock();
   if (!priv::pcm_instance_) {
-    priv::pcm_instance_ = pcm::PCM::getInstance();
+    pcm::PCM* instance = pcm::PCM::getInstance();
 
-    const pcm::PCM::ErrorCode status = priv::pcm_instance_->program(
-        pcm::PCM::DEFAULT_EVENTS, nullptr, false, -1);
+    const pcm::PCM::ErrorCode status =
+        instance->program(pcm::PCM::DEFAULT_EVENTS, nullptr, false, -1);
 
     std::string msg;
     switch (status) {
@@ -89,58 +146,125 @@ IntelMeterObserver::IntelMeterObserver(const uint pid,
             "(Unknown error).\n";
         throw Status{Status::ACCESS_DENIED, msg};
     }
+    priv::pcm_instance_ = instance;
+  }
+
+  collector.reset(new PCMCollector(priv::pcm_instance_));
+  priv::collector_ = collector;
+  return collector;
+}
+
+PCMCollector::PCMCollector(pcm::PCM* instance)
+    : instance_{instance}, latest_{}, next_{}, running_{true} {
+  /* There is always a snapshot to start from */
+  this->Sample();
+  this->collector_ = std::thread(&PCMCollector::Collector, this);
+}
+
+void PCMCollector::Sample() {
+  std::scoped_lock<std::mutex> slock(this->sample_mutex_);
+  this->instance_->getAllCounterStates(this->next_.system, this->next_.sockets,
+                                       this->next_.cores);
+  this->next_.timestamp = GetUptime();
+  this->next_.time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         std::chrono::steady_clock::now().time_since_epoch())
+                         .count();
+
+  std::scoped_lock<std::mutex> llock(this->latest_mutex_);
+  this->next_.sequence = this->latest_.sequence + 1;
+  std::swap(this->latest_, this->next_);
+}
 
-    priv::pcm_mutex_.unlock();
-    this->Reset();
-    this->Trigger();
+void PCMCollector::GetLatest(PCMSnapshot& snapshot, const uint64_t sequence) {
+  {
+    std::scoped_lock<std::mutex> llock(this->latest_mutex_);
+    if (this->latest_.sequence > sequence) {
+      snapshot = this->latest_;
+      return;
+    }
+  }
+
+  /* The caller is ahead of the collector: a window needs a new snapshot */
+  this->Sample();
+  std::scoped_lock<std::mutex> llock(this->latest_mutex_);
+  snapshot = this->latest_;
+}
+
+void PCMCollector::Collector() {
+  const auto period = std::chrono::milliseconds(kCollectorPeriod);
+  std::unique_lock<std::mutex> ulock(this->sleep_mutex_);
+  while (!this->wake_.wait_for(ulock, period,
+                               [this] { return !this->running_; })) {
+    ulock.unlock();
+    this->Sample();
+    ulock.lock();
+  }
+}
+
+PCMCollector::~PCMCollector() {
+  {
+    std::scoped_lock<std::mutex> slock(this->sleep_mutex_);
+    this->running_ = false;
+  }
+  this->wake_.notify_all();
+  if (this->collector_.joinable()) this->collector_.join();
+}
+
+IntelMeterObserver::IntelMeterObserver(const uint pid,
+                                       const ObserverScope scope,
+                                       const uint64_t interval)
+    : Observer{},
+      valid_{false},
+      before_{std::make_unique<PCMSnapshot>()},
+      after_{std::make_unique<PCMSnapshot>()} {
+  uint64_t type = static_cast<uint64_t>(ObserverType::CPU) |
+                  static_cast<uint64_t>(ObserverType::INTERVAL);
+
+  this->pid_ = pid;
+  this->interval_ = interval;
+
+  if (ObserverScope::SYSTEM != scope) {
+    throw Status{Status::INVALID_PARAMETER, "Process-scope is not supported"};
   }
 
-  if (priv::pcm_instance_->packageEnergyMetricsAvailable()) {
+  this->collector_ = PCMCollector::Get();
+  if (this->collector_->GetInstance()->packageEnergyMetricsAvailable()) {
     type |= static_cast<uint64_t>(ObserverType::POWER);
   }
 
   this->caps_.emplace_back();
   this->caps_[0].type = type;
+
+  this->Reset();
 }
 
 Status IntelMeterObserver::Trigger() {
-  /* Get the data */
-  std::scoped_lock<std::mutex> lock(priv::pcm_mutex_);
-  if (priv::pcm_valid_ > 0) {
-    priv::pcm_instance_->getAllCounterStates(
-        priv::system_state_2_, priv::socket_state_2_, priv::core_state_2_);
-  } else {
-    priv::pcm_instance_->getAllCounterStates(
-        priv::system_state_1_, priv::socket_state_1_, priv::core_state_1_);
-    priv::pcm_valid_++;
-    return Status{};
-  }
-
-  priv::pcm_valid_ =
-      priv::pcm_valid_ == 2 ? priv::pcm_valid_ : priv::pcm_valid_ + 1;
+  /* Get the data: the window goes from the previous snapshot of this one */
+  this->collector_->GetLatest(*this->after_, this->before_->sequence);
 
   /* Set readings common metadata */
-  auto time = GetUptime();
   this->readings_.type = static_cast<uint64_t>(ObserverType::CPU) |
                          static_cast<uint64_t>(ObserverType::POWER);
-  this->readings_.difference = time - this->readings_.timestamp;
-  this->readings_.timestamp = time;
+  this->readings_.difference =
+      this->after_->timestamp - this->before_->timestamp;
+  this->readings_.timestamp = this->after_->timestamp;
 
   /* Parse the readings */
   this->ParseResults();
 
   this->valid_ = true;
 
-  std::swap(priv::system_state_1_, priv::system_state_2_);
-  std::swap(priv::socket_state_1_, priv::socket_state_2_);
-  std::swap(priv::core_state_1_, priv::core_state_2_);
+  std::swap(this->before_, this->after_);
   return Status{};
 }
 
 void IntelMeterObserver::ParseResults() {
+  pcm::PCM* instance = this->collector_->GetInstance();
+  const PCMSnapshot& before = *this->before_;
+  const PCMSnapshot& after = *this->after_;
   this->readings_.overall_power = 0.f;
   this->readings_.socket_power.clear();
-  uint num_sockets = priv::pcm_instance_->getNumSockets();
+  uint num_sockets = instance->getNumSockets();
 
   /* Get usage in terms of IPC */
   std::vector<uint> socket_core_count;
@@ -150,22 +274,22 @@ void IntelMeterObserver::ParseResults() {
   socket_core_count.resize(num_sockets, 0);
   this->readings_.core_usage.clear();
 
-  for (uint i = 0; i < priv::pcm_instance_->getNumCores(); ++i) {
-    uint socket_id = priv::pcm_instance_->getSocketId(i);
+  for (uint i = 0; i < instance->getNumCores(); ++i) {
+    uint socket_id = instance->getSocketId(i);
     socket_core_count[socket_id]++;
-    double ipc = getIPC(priv::core_state_1_[i], priv::core_state_2_[i]);
+    double ipc = getIPC(before.cores[i], after.cores[i]);
     this->readings_.overall_usage += ipc;
     this->readings_.socket_usage[socket_id] += ipc;
     this->readings_.core_usage.push_back(ipc);
   }
 
-  this->readings_.overall_usage /= priv::pcm_instance_->getNumCores();
+  this->readings_.overall_usage /= instance->getNumCores();
 
   /* Add energy overall all sockets */
+  const double seconds = (after.time - before.time) * 1e-9;
   for (uint i = 0; i < num_sockets; ++i) {
-    float energy = pcm::getConsumedJoules(priv::socket_state_1_[i],
-                                          priv::socket_state_2_[i]);
-    float pwr = energy * 1000 / this->readings_.difference;
+    double energy = pcm::getConsumedJoules(before.sockets[i], after.sockets[i]);
+    float pwr = seconds > 0. ? energy / seconds : 0.f;
     this->readings_.overall_power += pwr;
     this->readings_.overall_energy += energy;
     this->readings_.socket_power.push_back(pwr);
@@ -204,11 +328,7 @@ const std::vector<ObserverCapabilities>& IntelMeterObserver::GetCapabilities()
 }
 
 Status IntelMeterObserver::GetStatus() {
-  std::scoped_lock<std::mutex> lock(priv::pcm_mutex_);
-  if (priv::pcm_valid_ < 2) {
-    return Status{Status::NOT_READY,
-                  "The Intel PCM does not have taken enough samples"};
-  } else if (!this->valid_) {
+  if (!this->valid_) {
     return Status{Status::NOT_READY,
                   "The internal trigger() has not been launched yet"};
   }
@@ -226,8 +346,7 @@ Status IntelMeterObserver::ClearInterval() {
 }
 
 Status IntelMeterObserver::Reset() {
-  std::scoped_lock<std::mutex> lock(priv::pcm_mutex_);
-  uint num_sockets = priv::pcm_instance_->getNumSockets();
+  uint num_sockets = this->collector_->GetInstance()->getNumSockets();
   this->readings_.type = static_cast<uint>(ObserverType::NONE);
   this->readings_.timestamp = 0;
   this->readings_.difference = 0;
@@ -238,7 +357,11 @@ Status IntelMeterObserver::Reset() {
   this->readings_.core_energy.clear();
   this->readings_.core_usage.clear();
   this->readings_.socket_usage.clear();
-  this->readings_.socket_energy.resize(num_sockets, 0.f);
+  this->readings_.socket_energy.assign(num_sockets, 0.);
+
+  /* The next window starts now */
+  this->collector_->GetLatest(*this->before_, 0);
+  this->valid_ = false;
   return Status{};
 }
 
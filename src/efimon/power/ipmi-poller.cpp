@@ -0,0 +1,207 @@
+/**
+ * @file ipmi-poller.cpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Asynchronous poller of the IPMI observer. A thread triggers it at
+ * its own rate and publishes the last PSU and fan readings in a lock-free
+ * snapshot
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <efimon/power/ipmi-poller.hpp>
+#include <utility>
+
+namespace efimon {
+
+extern uint64_t GetUptime();
+
+/* The readers retry while the poller writes: it takes a few microseconds */
+static constexpr int kMaxRetries = 1000;
+
+IPMIPoller::IPMIPoller(std::shared_ptr<Observer> meter, const uint64_t period)
+    : meter_{std::move(meter)},
+      period_{period},
+      sequence_{0},
+      timestamp_{0},
+      difference_{0},
+      latency_{0},
+      code_{Status::OK},
+      num_psus_{0},
+      overall_power_{0.f},
+      overall_energy_{0.f},
+      platform_window_{0},
+      num_fans_{0},
+      overall_speed_{0.f},
+      running_{false} {
+  if (!this->meter_) {
+    throw Status{Status::INVALID_PARAMETER, "The IPMI observer is not valid"};
+  }
+
+  /* The observer is triggered on construction: the consumers get those
+     readings until the thread publishes its first acquisition */
+  this->Publish(this->meter_->GetStatus(), 0);
+}
+
+Status IPMIPoller::Start() {
+  if (this->poller_.joinable()) {
+    return Status{Status::RESOURCE_BUSY, "The poller has already started"};
+  }
+  this->running_.store(true);
+  this->poller_ = std::thread(&IPMIPoller::Poller, this);
+  return Status{};
+}
+
+Status IPMIPoller::Stop() {
+  if (!this->poller_.joinable()) {
+    return Status{Status::NOT_FOUND, "The poller was not running"};
+  }
+  {
+    std::scoped_lock slock(this->sleep_mutex_);
+    this->running_.store(false);
+  }
+  this->wake_.notify_all();
+  this->poller_.join();
+  return Status{};
+}
+
+void IPMIPoller::Poller() {
+  while (this->running_.load()) {
+    const uint64_t start = GetUptime();
+    Status st = this->meter_->Trigger();
+    const uint64_t latency = GetUptime() - start;
+    this->Publish(st, latency);
+
+    /* One acquisition at a time: a slow BMC just lowers the rate */
+    const uint64_t wait = latency < this->period_ ? this->period_ - latency : 0;
+    std::unique_lock<std::mutex> ulock(this->sleep_mutex_);
+    this->wake_.wait_for(ulock, std::chrono::milliseconds(wait),
+                         [this] { return !this->running_.load(); });
+  }
+}
+
+void IPMIPoller::Publish(const Status &status, const uint64_t latency) {
+  auto readings = this->meter_->GetReadings();
+  auto psu = dynamic_cast<PSUReadings *>(readings.at(0));
+  auto fan = dynamic_cast<FanReadings *>(readings.at(1));
+  if (!psu || !fan) return;
+
+  const uint64_t sequence = this->sequence_.load(std::memory_order_relaxed);
+  this->sequence_.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  this->timestamp_.store(psu->timestamp, std::memory_order_relaxed);
+  this->difference_.store(psu->difference, std::memory_order_relaxed);
+  this->latency_.store(latency, std::memory_order_relaxed);
+  this->code_.store(status.code, std::memory_order_relaxed);
+
+  const uint num_psus = std::min<std::size_t>(psu->psu_power.size(), kMaxPSUs);
+  this->num_psus_.store(num_psus, std::memory_order_relaxed);
+  this->overall_power_.store(psu->overall_power, std::memory_order_relaxed);
+  this->overall_energy_.store(psu->overall_energy, std::memory_order_relaxed);
+  for (uint i = 0; i < num_psus; ++i) {
+    this->psu_power_[i].store(psu->psu_power.at(i), std::memory_order_relaxed);
+    this->psu_energy_[i].store(psu->psu_energy.at(i),
+                               std::memory_order_relaxed);
+    this->psu_max_power_[i].store(
+        i < psu->psu_max_power.size() ? psu->psu_max_power[i] : -1.f,
+        std::memory_order_relaxed);
+  }
+
+  this->platform_power_[0].store(psu->platform_power,
+                                 std::memory_order_relaxed);
+  this->platform_power_[1].store(psu->platform_min_power,
+                                 std::memory_order_relaxed);
+  this->platform_power_[2].store(psu->platform_max_power,
+                                 std::memory_order_relaxed);
+  this->platform_power_[3].store(psu->platform_avg_power,
+                                 std::memory_order_relaxed);
+  this->platform_window_.store(psu->platform_window,
+                               std::memory_order_relaxed);
+
+  const uint num_fans = std::min<std::size_t>(fan->fan_speeds.size(), kMaxFans);
+  this->num_fans_.store(num_fans, std::memory_order_relaxed);
+  this->overall_speed_.store(fan->overall_speed, std::memory_order_relaxed);
+  for (uint i = 0; i < num_fans; ++i) {
+    this->fan_speeds_[i].store(fan->fan_speeds[i], std::memory_order_relaxed);
+  }
+
+  this->sequence_.store(sequence + 2, std::memory_order_release);
+}
+
+Status IPMIPoller::GetReadings(PSUReadings &psu, FanReadings &fan) const {
+  for (int retry = 0; retry < kMaxRetries; ++retry) {
+    const uint64_t sequence = this->sequence_.load(std::memory_order_acquire);
+    if (0 == sequence) {
+      return Status{Status::NOT_READY, "There are no IPMI readings yet"};
+    }
+    if (sequence & 1) continue;
+
+    const uint64_t type = static_cast<uint64_t>(ObserverType::PSU) |
+                          static_cast<uint64_t>(ObserverType::POWER);
+    psu.type = type;
+    psu.timestamp = this->timestamp_.load(std::memory_order_relaxed);
+    psu.difference = this->difference_.load(std::memory_order_relaxed);
+    psu.overall_power = this->overall_power_.load(std::memory_order_relaxed);
+    psu.overall_energy = this->overall_energy_.load(std::memory_order_relaxed);
+    const uint num_psus = this->num_psus_.load(std::memory_order_relaxed);
+    psu.psu_power.resize(num_psus);
+    psu.psu_energy.resize(num_psus);
+    psu.psu_max_power.resize(num_psus);
+    for (uint i = 0; i < num_psus; ++i) {
+      psu.psu_power[i] = this->psu_power_[i].load(std::memory_order_relaxed);
+      psu.psu_energy[i] = this->psu_energy_[i].load(std::memory_order_relaxed);
+      psu.psu_max_power[i] =
+          this->psu_max_power_[i].load(std::memory_order_relaxed);
+    }
+
+    psu.platform_power =
+        this->platform_power_[0].load(std::memory_order_relaxed);
+    psu.platform_min_power =
+        this->platform_power_[1].load(std::memory_order_relaxed);
+    psu.platform_max_power =
+        this->platform_power_[2].load(std::memory_order_relaxed);
+    psu.platform_avg_power =
+        this->platform_power_[3].load(std::memory_order_relaxed);
+    psu.platform_window =
+        this->platform_window_.load(std::memory_order_relaxed);
+
+    fan.type = type;
+    fan.timestamp = psu.timestamp;
+    fan.difference = psu.difference;
+    fan.overall_speed = this->overall_speed_.load(std::memory_order_relaxed);
+    const uint num_fans = this->num_fans_.load(std::memory_order_relaxed);
+    fan.fan_speeds.resize(num_fans);
+    for (uint i = 0; i < num_fans; ++i) {
+      fan.fan_speeds[i] = this->fan_speeds_[i].load(std::memory_order_relaxed);
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (sequence == this->sequence_.load(std::memory_order_relaxed)) {
+      return Status{};
+    }
+  }
+  return Status{Status::RESOURCE_BUSY, "The IPMI readings keep changing"};
+}
+
+uint64_t IPMIPoller::GetAge() const noexcept {
+  if (0 == this->sequence_.load(std::memory_order_acquire)) return UINT64_MAX;
+  const uint64_t timestamp = this->timestamp_.load(std::memory_order_relaxed);
+  const uint64_t now = GetUptime();
+  return now > timestamp ? now - timestamp : 0;
+}
+
+uint64_t IPMIPoller::GetLatency() const noexcept {
+  return this->latency_.load(std::memory_order_relaxed);
+}
+
+int IPMIPoller::GetLastCode() const noexcept {
+  return this->code_.load(std::memory_order_relaxed);
+}
+
+IPMIPoller::~IPMIPoller() {
+  if (this->poller_.joinable()) this->Stop();
+}
+
+} /* namespace efimon */
@@ -0,0 +1,292 @@
+/**
+ * @file ipmi-session.cpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief In-band IPMI session based on libfreeipmi. It keeps the session
+ * and the SDR records open to read the power and fan sensors, and the DCMI
+ * platform power, without launching the FreeIPMI tools
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#include <unistd.h>
+
+#include <cstdlib>
+#include <efimon/power/ipmi-session.hpp>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef ENABLE_FREEIPMI
+#include <freeipmi/freeipmi.h>
+#endif /* ENABLE_FREEIPMI */
+
+namespace efimon {
+
+#ifdef ENABLE_FREEIPMI
+
+/* Largest SDR record: header + 255 bytes of body */
+static constexpr unsigned int kMaxRecordLength = 512;
+/* Length of the SDR ID strings */
+static constexpr unsigned int kMaxIdLength = 64;
+
+IPMISession::IPMISession(const std::string &cache)
+    : ipmi_{nullptr},
+      sdr_{nullptr},
+      sensor_read_{nullptr},
+      sensors_{},
+      dcmi_{false} {
+  this->ipmi_ = ipmi_ctx_create();
+  if (!this->ipmi_) {
+    throw Status{Status::RESOURCE_BUSY, "Cannot create the IPMI context"};
+  }
+
+  /* Probe the in-band drivers: OpenIPMI, KCS, SSIF... */
+  int found = ipmi_ctx_find_inband(this->ipmi_, nullptr, 0, 0, 0, nullptr, 0,
+                                   IPMI_FLAGS_DEFAULT);
+  if (found <= 0) {
+    std::string msg = found < 0 ? ipmi_ctx_errormsg(this->ipmi_)
+                                : "There is no in-band IPMI driver";
+    this->Close();
+    throw Status{0 == geteuid() ? Status::NOT_FOUND : Status::ACCESS_DENIED,
+                 "Cannot open the BMC: " + msg};
+  }
+
+  std::string path = cache;
+  if (path.empty()) {
+    path = (std::filesystem::temp_directory_path() /
+            ("efimon-sdr-" + std::to_string(geteuid()) + ".cache"))
+               .string();
+  }
+  Status st = this->OpenCache(path);
+  if (Status::OK == st.code) st = this->ScanSensors();
+  if (Status::OK != st.code && Status::NOT_FOUND != st.code) {
+    this->Close();
+    throw st;
+  }
+
+  this->sensor_read_ = ipmi_sensor_read_ctx_create(this->ipmi_);
+  if (!this->sensor_read_) {
+    this->Close();
+    throw Status{Status::RESOURCE_BUSY,
+                 "Cannot create the IPMI sensor reading context"};
+  }
+
+  /* The platform power in a single command, if the BMC supports DCMI */
+  DCMIPower power{};
+  this->dcmi_ = Status::NOT_IMPLEMENTED != this->ReadDCMI(power).code;
+  if (this->sensors_.empty() && !this->dcmi_) {
+    this->Close();
+    throw st;
+  }
+}
+
+Status IPMISession::OpenCache(const std::string &cache) {
+  this->sdr_ = ipmi_sdr_ctx_create();
+  if (!this->sdr_) {
+    return Status{Status::RESOURCE_BUSY, "Cannot create the SDR context"};
+  }
+
+  /* Missing or out of date: rebuild it from the BMC (it takes a while) */
+  if (ipmi_sdr_cache_open(this->sdr_, this->ipmi_, cache.c_str()) < 0) {
+    ipmi_sdr_cache_delete(this->sdr_, cache.c_str());
+    if (ipmi_sdr_cache_create(this->sdr_, this->ipmi_, cache.c_str(),
+                              IPMI_SDR_CACHE_CREATE_FLAGS_OVERWRITE, nullptr,
+                              nullptr) < 0 ||
+        ipmi_sdr_cache_open(this->sdr_, this->ipmi_, cache.c_str()) < 0) {
+      return Status{Status::FILE_ERROR,
+                    std::string("Cannot build the SDR cache: ") +
+                        ipmi_sdr_ctx_errormsg(this->sdr_)};
+    }
+  }
+  return Status{};
+}
+
+Status IPMISession::ScanSensors() {
+  uint16_t count = 0;
+  if (ipmi_sdr_cache_record_count(this->sdr_, &count) < 0) {
+    return Status{Status::FILE_ERROR, "Cannot read the SDR cache"};
+  }
+
+  uint8_t record[kMaxRecordLength];
+  char name[kMaxIdLength + 1];
+  ipmi_sdr_cache_first(this->sdr_);
+  for (uint16_t i = 0; i < count; ++i, ipmi_sdr_cache_next(this->sdr_)) {
+    const int length =
+        ipmi_sdr_cache_record_read(this->sdr_, record, sizeof(record));
+    if (length <= 0) continue;
+
+    /* Only the full records have units */
+    uint16_t record_id = 0;
+    uint8_t record_type = 0;
+    if (ipmi_sdr_parse_record_id_and_type(this->sdr_, record, length,
+                                          &record_id, &record_type) < 0 ||
+        IPMI_SDR_FORMAT_FULL_SENSOR_RECORD != record_type)
+      continue;
+
+    uint8_t percentage = 0, modifier = 0, rate = 0, base = 0, modifier_unit = 0;
+    if (ipmi_sdr_parse_sensor_units(this->sdr_, record, length, &percentage,
+                                    &modifier, &rate, &base,
+                                    &modifier_unit) < 0)
+      continue;
+
+    Sensor sensor{};
+    uint8_t instance_type = 0;
+    if (ipmi_sdr_parse_entity_id_instance_type(this->sdr_, record, length,
+                                               &sensor.entity,
+                                               &sensor.instance,
+                                               &instance_type) < 0)
+      continue;
+
+    /* Only the power supplies are PSUs: the rest of the sensors in Watts
+       may measure the system or a component within it */
+    if (IPMI_SENSOR_UNIT_RPM == base) {
+      sensor.type = Sensor::Type::FAN;
+    } else if (IPMI_SENSOR_UNIT_WATTS != base) {
+      continue;
+    } else if (IPMI_ENTITY_ID_POWER_SUPPLY == sensor.entity) {
+      sensor.type = Sensor::Type::PSU;
+    } else if (IPMI_ENTITY_ID_SYSTEM_BOARD == sensor.entity ||
+               IPMI_ENTITY_ID_POWER_UNIT_POWER_DOMAIN == sensor.entity ||
+               IPMI_ENTITY_ID_SYSTEM_CHASSIS == sensor.entity) {
+      sensor.type = Sensor::Type::SYSTEM;
+    } else {
+      sensor.type = Sensor::Type::POWER;
+    }
+
+    name[0] = '\0';
+    ipmi_sdr_parse_id_string(this->sdr_, record, length, name, kMaxIdLength);
+    sensor.name = name;
+
+    double *nominal = nullptr, *normal_max = nullptr, *normal_min = nullptr;
+    double *max_reading = nullptr, *min_reading = nullptr;
+    sensor.max_reading = -1.;
+    if (ipmi_sdr_parse_sensor_reading_ranges(
+            this->sdr_, record, length, &nominal, &normal_max, &normal_min,
+            &max_reading, &min_reading) >= 0 &&
+        max_reading) {
+      sensor.max_reading = *max_reading;
+    }
+    for (double *range :
+         {nominal, normal_max, normal_min, max_reading, min_reading}) {
+      std::free(range);
+    }
+
+    sensor.record.assign(record, record + length);
+    this->sensors_.push_back(std::move(sensor));
+  }
+
+  if (this->sensors_.empty()) {
+    return Status{Status::NOT_FOUND, "There are no power nor fan sensors"};
+  }
+  return Status{};
+}
+
+Status IPMISession::Read(std::vector<double> &readings) {
+  Status ret{};
+  readings.assign(this->sensors_.size(), -1.);
+  for (std::size_t i = 0; i < this->sensors_.size(); ++i) {
+    const auto &record = this->sensors_[i].record;
+    uint8_t raw = 0;
+    uint16_t events = 0;
+    double *reading = nullptr;
+    int got = ipmi_sensor_read(this->sensor_read_, record.data(), record.size(),
+                               0, &raw, &reading, &events);
+    if (got > 0 && reading) {
+      readings[i] = *reading;
+    } else if (got < 0) {
+      ret = Status{Status::FILE_ERROR,
+                   "Cannot read the IPMI sensor " + this->sensors_[i].name};
+    }
+    std::free(reading);
+  }
+  return ret;
+}
+
+Status IPMISession::ReadDCMI(DCMIPower &power) {
+  fiid_obj_t response = fiid_obj_create(tmpl_cmd_dcmi_get_power_reading_rs);
+  if (!response) {
+    return Status{Status::RESOURCE_BUSY, "Cannot create the DCMI response"};
+  }
+
+  Status ret{};
+  if (ipmi_cmd_dcmi_get_power_reading(
+          this->ipmi_, IPMI_DCMI_POWER_READING_MODE_SYSTEM_POWER_STATISTICS,
+          0, response) < 0) {
+    ret = Status{Status::NOT_IMPLEMENTED,
+                 std::string("Cannot get the DCMI power reading: ") +
+                     ipmi_ctx_errormsg(this->ipmi_)};
+  } else {
+    uint64_t current = 0, minimum = 0, maximum = 0, average = 0;
+    uint64_t window = 0, active = 0;
+    fiid_obj_get(response, "current_power", &current);
+    fiid_obj_get(response, "minimum_power_over_sampling_duration", &minimum);
+    fiid_obj_get(response, "maximum_power_over_sampling_duration", &maximum);
+    fiid_obj_get(response, "average_power_over_sampling_duration", &average);
+    fiid_obj_get(response, "statistics_reporting_time_period", &window);
+    fiid_obj_get(response, "power_reading_state.power_measurement", &active);
+    power.current = static_cast<float>(current);
+    power.minimum = static_cast<float>(minimum);
+    power.maximum = static_cast<float>(maximum);
+    power.average = static_cast<float>(average);
+    power.window = window;
+    if (!active) {
+      ret = Status{Status::NOT_READY, "The DCMI power measurement is off"};
+    }
+  }
+
+  fiid_obj_destroy(response);
+  return ret;
+}
+
+void IPMISession::Close() noexcept {
+  if (this->sensor_read_) ipmi_sensor_read_ctx_destroy(this->sensor_read_);
+  if (this->sdr_) {
+    ipmi_sdr_cache_close(this->sdr_);
+    ipmi_sdr_ctx_destroy(this->sdr_);
+  }
+  if (this->ipmi_) {
+    ipmi_ctx_close(this->ipmi_);
+    ipmi_ctx_destroy(this->ipmi_);
+  }
+  this->sensor_read_ = nullptr;
+  this->sdr_ = nullptr;
+  this->ipmi_ = nullptr;
+}
+
+#else
+
+IPMISession::IPMISession(const std::string & /* cache */)
+    : ipmi_{nullptr},
+      sdr_{nullptr},
+      sensor_read_{nullptr},
+      sensors_{},
+      dcmi_{false} {
+  throw Status{Status::NOT_IMPLEMENTED,
+               "EfiMon was built without libfreeipmi"};
+}
+
+Status IPMISession::Read(std::vector<double> & /* readings */) {
+  return Status{Status::NOT_IMPLEMENTED,
+                "EfiMon was built without libfreeipmi"};
+}
+
+Status IPMISession::ReadDCMI(DCMIPower & /* power */) {
+  return Status{Status::NOT_IMPLEMENTED,
+                "EfiMon was built without libfreeipmi"};
+}
+
+void IPMISession::Close() noexcept {}
+
+#endif /* ENABLE_FREEIPMI */
+
+const std::vector<IPMISession::Sensor> &IPMISession::GetSensors()
+    const noexcept {
+  return this->sensors_;
+}
+
+bool IPMISession::HasDCMI() const noexcept { return this->dcmi_; }
+
+IPMISession::~IPMISession() { this->Close(); }
+
+} /* namespace efimon */
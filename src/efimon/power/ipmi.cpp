@@ -7,10 +7,12 @@
  * @copyright Copyright (c) 2024. See License for Licensing
  */
 
+#include <algorithm>
 #include <cstdint>
 #include <efimon/power/ipmi.hpp>
 #include <efimon/status.hpp>
 #include <fstream>
+#include <memory>
 #include <string>
 #include <third-party/pstream.hpp>
 #include <vector>
@@ -26,11 +28,20 @@ static constexpr char kIPMIInfoCmd[] = "ipmi-oem dell power-supply-info";
 static constexpr char kIPMIPwrCmd[] =
     "ipmi-oem dell get-instantaneous-power-consumption-data";
 static constexpr char kIPMISensorCmd[] = "ipmi-sensors | grep Fan";
+static constexpr char kIPMIDCMICmd[] =
+    "ipmi-dcmi --get-system-power-statistics";
 
 IPMIMeterObserver::IPMIMeterObserver(const uint /* pid */,
                                      const ObserverScope scope,
                                      const uint64_t interval)
-    : Observer{}, valid_{false}, psu_id_{kMaxPSU}, num_psus_{0}, max_power_{} {
+    : Observer{},
+      valid_{false},
+      psu_id_{kMaxPSU},
+      num_psus_{0},
+      max_power_{},
+      psu_sensors_{},
+      system_sensor_{-1},
+      dcmi_{false} {
   uint64_t type = static_cast<uint64_t>(ObserverType::PSU) |
                   static_cast<uint64_t>(ObserverType::POWER) |
                   static_cast<uint64_t>(ObserverType::INTERVAL);
@@ -45,12 +56,22 @@ IPMIMeterObserver::IPMIMeterObserver(const uint /* pid */,
   this->caps_.emplace_back();
   this->caps_[0].type = type;
 
-  Status st = this->GetInfo();
+  /* Persistent session first. The FreeIPMI tools otherwise */
+  Status st{};
+  try {
+    this->session_ = std::make_unique<IPMISession>();
+    st = this->GetSessionInfo();
+  } catch (const Status &error) {
+    st = error;
+  }
+  if (Status::OK != st.code) {
+    this->session_.reset();
+    st = this->GetInfo();
+  }
   if (Status::OK != st.code) {
     throw Status{Status::ACCESS_DENIED, "Cannot get info from IPMI"};
   }
 
-  this->GetInfo();
   this->Reset();
   this->Trigger();
 
@@ -70,6 +91,10 @@ Status IPMIMeterObserver::GetInfo() {
   this->max_power_.clear();
   this->num_psus_ = 0;
 
+  /* The platform power is vendor-neutral (DCMI) */
+  IPMISession::DCMIPower power{};
+  this->dcmi_ = Status::NOT_IMPLEMENTED != this->GetDCMIPower(power).code;
+
   std::string payload;
   while (std::getline(ip, payload)) {
     std::string::size_type idx_word, idx_colon, idx_watts;
@@ -86,9 +111,9 @@ Status IPMIMeterObserver::GetInfo() {
     }
   }
 
-  /* Remove after use */
-  if (!this->num_psus_) {
-    return Status{Status::NOT_FOUND, "Cannot find compatible PSUs"};
+  /* The Dell PSUs are optional when there is DCMI */
+  if (!this->num_psus_ && !this->dcmi_) {
+    return Status{Status::NOT_FOUND, "Cannot find compatible PSUs nor DCMI"};
   }
 
   return Status{};
@@ -104,6 +129,12 @@ Status IPMIMeterObserver::Trigger() {
   this->readings_.timestamp = time;
   this->readings_.overall_power = 0;
 
+  if (this->session_) {
+    st = this->ReadSession();
+    this->valid_ = true;
+    return st;
+  }
+
   /* Get fan speed */
 #ifdef ENABLE_IPMI_SENSORS
   st = this->GetFanSpeed();
@@ -112,20 +143,35 @@ Status IPMIMeterObserver::Trigger() {
   }
 #endif /* ENABLE_IPMI_SENSORS */
 
+  /* Platform power: a single command for the whole system */
+  float platform = -1.f;
+  if (this->dcmi_) {
+    IPMISession::DCMIPower power{};
+    st = this->GetDCMIPower(power);
+    if (Status::OK == st.code) {
+      this->ParseDCMI(power);
+      platform = power.current;
+    }
+  }
+
   /* Check if the parse is for a single PSU */
   if (this->psu_id_ < this->num_psus_) {
     st = this->GetPower(this->psu_id_);
     this->ParseResults(this->psu_id_);
+    this->ParseOverall(this->readings_.psu_power.at(this->psu_id_));
     this->valid_ = true;
     return st;
   }
 
   /* Get for all PSUs */
+  float total = 0.f;
   for (uint i = 0; i < this->num_psus_; ++i) {
     st = this->GetPower(i);
     this->ParseResults(i);
+    total += this->readings_.psu_power.at(i);
   }
 
+  this->ParseOverall(platform >= 0.f ? platform : total);
   this->valid_ = true;
   return st;
 }
@@ -155,7 +201,6 @@ Status IPMIMeterObserver::GetPower(const uint psu_id) {
       std::string::size_type payload_size = idx_watts - 1 - start_offset;
       float val = std::stof(payload.substr(idx_colon + 2, payload_size));
       this->readings_.psu_power.at(psu_id) = val;
-      this->readings_.overall_power += val;
       ++occurrences;
     }
   }
@@ -215,14 +260,162 @@ Status IPMIMeterObserver::GetFanSpeed() {
   return ret;
 }
 
+Status IPMIMeterObserver::GetSessionInfo() {
+  this->max_power_.clear();
+  this->psu_sensors_.clear();
+  this->system_sensor_ = -1;
+  this->dcmi_ = this->session_->HasDCMI();
+
+  /* A PSU may report both its input and output power: take the first
+     sensor of each power supply instance */
+  const auto &sensors = this->session_->GetSensors();
+  std::vector<uint8_t> instances;
+  for (std::size_t i = 0; i < sensors.size(); ++i) {
+    const auto &sensor = sensors[i];
+    if (IPMISession::Sensor::Type::SYSTEM == sensor.type &&
+        this->system_sensor_ < 0) {
+      this->system_sensor_ = static_cast<int>(i);
+    }
+    if (IPMISession::Sensor::Type::PSU != sensor.type ||
+        instances.end() !=
+            std::find(instances.begin(), instances.end(), sensor.instance))
+      continue;
+    instances.push_back(sensor.instance);
+    this->psu_sensors_.push_back(i);
+    this->max_power_.push_back(sensor.max_reading);
+  }
+  this->num_psus_ = this->psu_sensors_.size();
+
+  if (!this->num_psus_ && this->system_sensor_ < 0 && !this->dcmi_) {
+    return Status{Status::NOT_FOUND, "Cannot find power sensors nor DCMI"};
+  }
+  return Status{};
+}
+
+Status IPMIMeterObserver::ReadSession() {
+  Status st = this->session_->Read(this->session_values_);
+
+  const auto &sensors = this->session_->GetSensors();
+  this->fan_readings_.fan_speeds.clear();
+  float speed = 0.f;
+  for (std::size_t i = 0; i < sensors.size(); ++i) {
+    const float value = this->session_values_.at(i);
+    if (IPMISession::Sensor::Type::FAN != sensors[i].type || value < 0.f) {
+      continue;
+    }
+    speed += value;
+    this->fan_readings_.fan_speeds.emplace_back(value);
+  }
+
+  const std::size_t fans = this->fan_readings_.fan_speeds.size();
+  this->fan_readings_.overall_speed = fans ? speed / fans : 0.f;
+
+  const bool single = this->psu_id_ < this->num_psus_;
+  float total = 0.f;
+  for (uint psu = 0; psu < this->num_psus_; ++psu) {
+    /* Check if the parse is for a single PSU */
+    if (single && this->psu_id_ != psu) continue;
+    const float value = this->session_values_.at(this->psu_sensors_[psu]);
+    if (value < 0.f) continue;
+    this->readings_.psu_power.at(psu) = value;
+    total += value;
+    this->ParseResults(psu);
+  }
+
+  /* The overall power is the platform one, not the sum of the sensors */
+  float overall = total;
+  if (!single && this->system_sensor_ >= 0 &&
+      this->session_values_.at(this->system_sensor_) >= 0.) {
+    overall = this->session_values_.at(this->system_sensor_);
+  }
+  if (this->dcmi_) {
+    IPMISession::DCMIPower power{};
+    Status dcmi_st = this->session_->ReadDCMI(power);
+    if (Status::OK == dcmi_st.code) {
+      this->ParseDCMI(power);
+      if (!single) overall = power.current;
+    } else if (Status::OK == st.code) {
+      st = dcmi_st;
+    }
+  }
+  this->ParseOverall(overall);
+  return st;
+}
+
+Status IPMIMeterObserver::GetDCMIPower(IPMISession::DCMIPower &power) {
+  /* Execute the command */
+  redi::ipstream ip(kIPMIDCMICmd, redi::pstreambuf::pstdout);
+  if (!ip.is_open()) {
+    return Status{Status::NOT_IMPLEMENTED, "Cannot execute the DCMI command"};
+  }
+
+  /* Lines like "Current Power : 120 Watts" */
+  uint found = 0;
+  bool active = false;
+  std::string payload;
+  while (std::getline(ip, payload)) {
+    std::string::size_type idx_colon = payload.find(": ");
+    if (std::string::npos == idx_colon) continue;
+    std::string value = payload.substr(idx_colon + 2);
+
+    if (std::string::npos != payload.find("Power Measurement")) {
+      active = std::string::npos != value.find("Active");
+      continue;
+    }
+
+    float *field = nullptr;
+    if (0 == payload.find("Current Power")) {
+      field = &power.current;
+    } else if (0 == payload.find("Minimum Power")) {
+      field = &power.minimum;
+    } else if (0 == payload.find("Maximum Power")) {
+      field = &power.maximum;
+    } else if (0 == payload.find("Average Power")) {
+      field = &power.average;
+    }
+
+    try {
+      if (field) {
+        *field = std::stof(value);
+        ++found;
+      } else if (std::string::npos != payload.find("time period")) {
+        power.window = std::stoull(value);
+      }
+    } catch (const std::exception &) {
+      continue;
+    }
+  }
+
+  if (!found) {
+    return Status{Status::NOT_IMPLEMENTED, "The BMC does not support DCMI"};
+  }
+  if (!active) {
+    return Status{Status::NOT_READY, "The DCMI power measurement is off"};
+  }
+  return Status{};
+}
+
+void IPMIMeterObserver::ParseDCMI(const IPMISession::DCMIPower &power) {
+  this->readings_.platform_power = power.current;
+  this->readings_.platform_min_power = power.minimum;
+  this->readings_.platform_max_power = power.maximum;
+  this->readings_.platform_avg_power = power.average;
+  this->readings_.platform_window = power.window;
+}
+
 void IPMIMeterObserver::ParseResults(const uint psu_id) {
   if (!this->valid_) return;
   float energy =
       this->readings_.psu_power.at(psu_id) * this->readings_.difference * 1e-3;
-  this->readings_.overall_energy += energy;
   this->readings_.psu_energy.at(psu_id) += energy;
 }
 
+void IPMIMeterObserver::ParseOverall(const float power) {
+  this->readings_.overall_power = power;
+  if (!this->valid_) return;
+  this->readings_.overall_energy += power * this->readings_.difference * 1e-3;
+}
+
 std::vector<Readings*> IPMIMeterObserver::GetReadings() {
   return std::vector<Readings*>{static_cast<Readings*>(&(this->readings_)),
                                 static_cast<Readings*>(&(this->fan_readings_))};
@@ -277,11 +470,22 @@ Status IPMIMeterObserver::Reset() {
   this->readings_.psu_power.resize(this->num_psus_, 0.f);
   this->readings_.psu_energy.resize(this->num_psus_, 0.f);
   this->readings_.psu_max_power = this->max_power_;
+  this->readings_.platform_power = -1.f;
+  this->readings_.platform_min_power = -1.f;
+  this->readings_.platform_max_power = -1.f;
+  this->readings_.platform_avg_power = -1.f;
+  this->readings_.platform_window = 0;
   this->fan_readings_.overall_speed = 0.f;
   this->fan_readings_.fan_speeds.clear();
   return Status{};
 }
 
+bool IPMIMeterObserver::HasSession() const noexcept {
+  return static_cast<bool>(this->session_);
+}
+
+bool IPMIMeterObserver::HasDCMI() const noexcept { return this->dcmi_; }
+
 IPMIMeterObserver::~IPMIMeterObserver() {}
 
 } /* namespace efimon */
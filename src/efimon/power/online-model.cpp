@@ -0,0 +1,154 @@
+/**
+ * @file online-model.cpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Linear power model fitted online through recursive least squares.
+ * It relates the instruction-class mix of the processes with the measured
+ * power
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <efimon/asm-classifier.hpp>
+#include <efimon/power/online-model.hpp>
+#include <string>
+#include <vector>
+
+namespace efimon {
+
+static constexpr uint kNumTypes =
+    static_cast<uint>(assembly::InstructionType::UNCLASSIFIED) + 1;
+static constexpr uint kNumFamilies =
+    static_cast<uint>(assembly::InstructionFamily::OTHER);
+
+OnlinePowerModel::OnlinePowerModel(const uint num_features,
+                                   const double forgetting,
+                                   const double covariance)
+    : num_features_{num_features},
+      forgetting_{forgetting},
+      covariance_{covariance} {
+  if (0 == num_features) {
+    throw Status{Status::INVALID_PARAMETER, "The model requires features"};
+  }
+  if (forgetting <= 0. || forgetting > 1.) {
+    throw Status{Status::INVALID_PARAMETER,
+                 "The forgetting factor must be in (0, 1]"};
+  }
+  this->Reset();
+}
+
+Status OnlinePowerModel::Update(const std::vector<double> &features,
+                                const double power) {
+  const uint n = this->num_features_;
+  if (features.size() != n) {
+    return Status{Status::INVALID_PARAMETER, "Wrong number of features"};
+  }
+  if (!std::isfinite(power) ||
+      std::any_of(features.begin(), features.end(),
+                  [](const double x) { return !std::isfinite(x); })) {
+    return Status{Status::INVALID_PARAMETER, "The observation is not finite"};
+  }
+
+  /* px = P x and denominator = lambda + x' P x */
+  double denominator = this->forgetting_;
+  for (uint i = 0; i < n; ++i) {
+    double acc = 0.;
+    for (uint j = 0; j < n; ++j) acc += this->p_[i * n + j] * features[j];
+    this->px_[i] = acc;
+    denominator += features[i] * acc;
+  }
+
+  /* A priori error */
+  double error = power;
+  for (uint i = 0; i < n; ++i) error -= this->theta_[i] * features[i];
+
+  /* theta += k e, with k = P x / denominator */
+  for (uint i = 0; i < n; ++i) {
+    this->theta_[i] += this->px_[i] / denominator * error;
+  }
+
+  /* P = (P - k x' P) / lambda. P is symmetric, so x' P = (P x)' */
+  for (uint i = 0; i < n; ++i) {
+    for (uint j = 0; j < n; ++j) {
+      this->p_[i * n + j] =
+          (this->p_[i * n + j] - this->px_[i] * this->px_[j] / denominator) /
+          this->forgetting_;
+    }
+  }
+
+  this->updates_++;
+  return Status{};
+}
+
+Status OnlinePowerModel::Predict(const std::vector<double> &features,
+                                 double &power) const {
+  if (features.size() != this->num_features_) {
+    return Status{Status::INVALID_PARAMETER, "Wrong number of features"};
+  }
+  if (0 == this->updates_) {
+    return Status{Status::NOT_READY, "The model has not been fitted yet"};
+  }
+
+  power = 0.;
+  for (uint i = 0; i < this->num_features_; ++i) {
+    power += this->theta_[i] * features[i];
+  }
+  return Status{};
+}
+
+const std::vector<double> &OnlinePowerModel::GetCoefficients() const noexcept {
+  return this->theta_;
+}
+
+uint64_t OnlinePowerModel::GetNumUpdates() const noexcept {
+  return this->updates_;
+}
+
+uint OnlinePowerModel::GetNumFeatures() const noexcept {
+  return this->num_features_;
+}
+
+void OnlinePowerModel::Reset() noexcept {
+  const uint n = this->num_features_;
+  this->updates_ = 0;
+  this->theta_.assign(n, 0.);
+  this->px_.assign(n, 0.);
+  this->p_.assign(n * n, 0.);
+  for (uint i = 0; i < n; ++i) this->p_[i * n + i] = this->covariance_;
+}
+
+uint OnlinePowerModel::NumClasses() noexcept {
+  return kNumTypes * kNumFamilies;
+}
+
+std::string OnlinePowerModel::ClassName(const uint index) {
+  auto type = static_cast<assembly::InstructionType>(index / kNumFamilies);
+  auto family = static_cast<assembly::InstructionFamily>(index % kNumFamilies);
+  return AsmClassifier::TypeString(type) + AsmClassifier::FamilyString(family);
+}
+
+std::vector<double> OnlinePowerModel::ClassMix(
+    const InstructionReadings &readings) {
+  std::vector<double> mix(OnlinePowerModel::NumClasses(), 0.);
+  double total = 0.;
+
+  for (const auto &type : readings.classification) {
+    const uint itype = static_cast<uint>(type.first);
+    for (const auto &family : type.second) {
+      const uint ifamily = static_cast<uint>(family.first);
+      if (itype >= kNumTypes || ifamily >= kNumFamilies) continue;
+      for (const auto &origin : family.second) {
+        mix[itype * kNumFamilies + ifamily] += origin.second;
+        total += origin.second;
+      }
+    }
+  }
+
+  if (total > 0.) {
+    for (auto &val : mix) val /= total;
+  }
+  return mix;
+}
+
+} /* namespace efimon */
@@ -0,0 +1,455 @@
+/**
+ * @file process-power.cpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Per-process power estimation. It attributes the power of the
+ * processor to the monitored processes according to the CPU time of their
+ * threads on each core
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <efimon/power/process-power.hpp>
+#include <efimon/proc/cpuinfo.hpp>
+#include <efimon/status.hpp>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <system_error>  // NOLINT
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace efimon {
+
+extern uint64_t GetUptime();
+
+/* Fields of /proc/pid/task/tid/stat (1-based, see proc(5)) */
+static constexpr int kUtimeField = 14;
+static constexpr int kStimeField = 15;
+static constexpr int kProcessorField = 39;
+
+ProcessPowerObserver::ProcessPowerObserver(std::shared_ptr<Observer> meter,
+                                           const uint pid,
+                                           const IdleModel &idle,
+                                           const uint64_t interval)
+    : Observer{},
+      meter_{std::move(meter)},
+      idle_{idle},
+      cpus_{0},
+      sockets_{0},
+      timestamp_{0},
+      valid_{false} {
+  uint64_t type = static_cast<uint64_t>(ObserverType::CPU) |
+                  static_cast<uint64_t>(ObserverType::POWER) |
+                  static_cast<uint64_t>(ObserverType::INTERVAL);
+
+  if (!this->meter_) {
+    throw Status{Status::INVALID_PARAMETER, "The power meter is not valid"};
+  }
+
+  this->pid_ = pid;
+  this->interval_ = interval;
+  this->caps_.emplace_back();
+  this->caps_[0].type = type;
+  this->caps_[0].scope = ObserverScope::PROCESS;
+
+  this->ReadTopology();
+  if (0 != pid) this->AddPID(pid);
+  this->Reset();
+}
+
+void ProcessPowerObserver::ReadTopology() {
+  CPUInfo info{};
+  const long configured = sysconf(_SC_NPROCESSORS_CONF);  // NOLINT
+  this->cpus_ = std::max<long>(info.GetLogicalCores(), configured);  // NOLINT
+  this->sockets_ = std::max(info.GetNumSockets(), 1);
+
+  /* Without topology, each CPU is a core of the first socket */
+  this->cpu_socket_.assign(this->cpus_, 0);
+  this->cpu_core_.resize(this->cpus_);
+  for (uint cpu = 0; cpu < this->cpus_; ++cpu) this->cpu_core_[cpu] = cpu;
+
+  /* The siblings share the first CPU found as their core */
+  std::map<std::pair<int, int>, uint> cores;
+  for (const auto &socket : info.GetAssignation()) {
+    for (const auto &pair : socket.second) {
+      const int cpu = std::get<0>(pair);
+      if (cpu < 0 || static_cast<uint>(cpu) >= this->cpus_ ||
+          socket.first < 0 || static_cast<uint>(socket.first) >= this->sockets_)
+        continue;
+      auto core = cores.emplace(std::make_pair(socket.first, std::get<1>(pair)),
+                                static_cast<uint>(cpu));
+      this->cpu_socket_[cpu] = socket.first;
+      this->cpu_core_[cpu] = core.first->second;
+    }
+  }
+
+  this->socket_cpus_.assign(this->sockets_, 0);
+  for (uint cpu = 0; cpu < this->cpus_; ++cpu) {
+    ++this->socket_cpus_[this->cpu_socket_[cpu]];
+  }
+}
+
+Status ProcessPowerObserver::Trigger() {
+  /* Set readings common metadata */
+  const uint64_t time = GetUptime();
+  const uint64_t window = this->valid_ ? time - this->timestamp_ : 0;
+  this->timestamp_ = time;
+
+  /* System-wide: once for all the processes */
+  Status ret = this->ReadBusy();
+  if (Status::OK != ret.code) return ret;
+  if (this->valid_) {
+    ret = this->SplitPower();
+    if (Status::OK != ret.code) return ret;
+  }
+
+  for (auto &entry : this->processes_) {
+    Process &process = entry.second;
+    Status st = this->ReadProcess(entry.first, process);
+    if (Status::OK != st.code) {
+      ret = st;
+      continue;
+    }
+
+    process.readings.type = static_cast<uint64_t>(ObserverType::CPU) |
+                            static_cast<uint64_t>(ObserverType::POWER);
+    process.readings.difference = window;
+    process.readings.timestamp = time;
+    if (this->valid_ && process.valid && 0 != window) {
+      this->Attribute(process, window);
+    }
+    process.valid = true;
+  }
+
+  this->valid_ = true;
+  return ret;
+}
+
+Status ProcessPowerObserver::ReadBusy() {
+  std::ifstream file{"/proc/stat"};
+  if (!file.is_open()) {
+    return Status{Status::FILE_ERROR, "Cannot open /proc/stat"};
+  }
+
+  /* Lines like: cpuN user nice system idle iowait irq softirq ...
+     The steal time runs other guests, so it is not busy time here. The
+     offline CPUs are not listed: they keep their value */
+  this->before_busy_ = this->after_busy_;
+  std::string line;
+  while (std::getline(file, line)) {
+    if (0 != line.rfind("cpu", 0)) break;
+    uint cpu = 0;
+    uint64_t user = 0, nice = 0, system = 0, idle = 0, iowait = 0, irq = 0;
+    uint64_t softirq = 0;
+    if (sscanf(line.c_str(), "cpu%u %lu %lu %lu %lu %lu %lu %lu", &cpu, &user,
+               &nice, &system, &idle, &iowait, &irq, &softirq) < 5 ||
+        cpu >= this->cpus_)
+      continue;
+    this->after_busy_[cpu] = user + nice + system + irq + softirq;
+  }
+
+  if (!this->valid_) this->before_busy_ = this->after_busy_;
+  for (uint cpu = 0; cpu < this->cpus_; ++cpu) {
+    const uint64_t before = this->before_busy_[cpu];
+    const uint64_t after = this->after_busy_[cpu];
+    this->busy_[cpu] = after > before ? after - before : 0;
+  }
+  return Status{};
+}
+
+Status ProcessPowerObserver::SplitPower() {
+  auto readings = this->meter_->GetReadings();
+  CPUReadings *meter =
+      readings.empty() ? nullptr : dynamic_cast<CPUReadings *>(readings[0]);
+  if (!meter) {
+    return Status{Status::INVALID_PARAMETER,
+                  "The power meter does not report CPUReadings"};
+  }
+
+  std::vector<double> core_power(this->cpus_, 0.);
+  std::vector<uint64_t> core_busy(this->cpus_, 0);
+  std::vector<double> socket_cores(this->sockets_, 0.);
+  this->socket_busy_.assign(this->sockets_, 0);
+  for (uint cpu = 0; cpu < this->cpus_; ++cpu) {
+    this->socket_busy_[this->cpu_socket_[cpu]] += this->busy_[cpu];
+    core_busy[this->cpu_core_[cpu]] += this->busy_[cpu];
+    /* Per-core counters: reported on any CPU of the core */
+    const float power =
+        cpu < meter->core_power.size() ? meter->core_power[cpu] : 0.f;
+    if (power <= 0.f) continue;
+    core_power[this->cpu_core_[cpu]] += power;
+    socket_cores[this->cpu_socket_[cpu]] += power;
+  }
+
+  /* The rest of the socket (uncore or all of it) and its idle share */
+  std::vector<double> residual(this->sockets_, 0.);
+  std::vector<double> scale(this->sockets_, 0.);
+  this->idle_power_.assign(this->sockets_, 0.);
+  for (uint socket = 0; socket < this->sockets_; ++socket) {
+    const double power = socket < meter->socket_power.size()
+                             ? meter->socket_power[socket]
+                             : -1.;
+    const double total = std::max(power, socket_cores[socket]);
+    if (total <= 0.) continue;
+    residual[socket] = total - socket_cores[socket];
+    this->idle_power_[socket] = std::min<double>(
+        std::max(this->idle_.socket_power, 0.f), total);
+    scale[socket] = (total - this->idle_power_[socket]) / total;
+  }
+
+  for (uint cpu = 0; cpu < this->cpus_; ++cpu) {
+    const uint socket = this->cpu_socket_[cpu];
+    const uint core = this->cpu_core_[cpu];
+    const double busy = this->busy_[cpu];
+    double power = 0.;
+    if (core_busy[core]) power += core_power[core] * busy / core_busy[core];
+    if (this->socket_busy_[socket]) {
+      power += residual[socket] * busy / this->socket_busy_[socket];
+    }
+    this->cpu_power_[cpu] = power * scale[socket];
+  }
+  return Status{};
+}
+
+Status ProcessPowerObserver::ReadProcess(const uint pid, Process &process) {
+  const std::string path = "/proc/" + std::to_string(pid) + "/task";
+  std::error_code ec;
+  std::filesystem::directory_iterator tasks{path, ec};
+  if (ec) {
+    return Status{Status::NOT_FOUND,
+                  "The process is not available: " + std::to_string(pid)};
+  }
+
+  std::fill(process.ticks.begin(), process.ticks.end(), 0);
+  std::unordered_map<int, uint64_t> threads;
+  threads.reserve(process.threads.size());
+  std::string line;
+  for (const auto &task : tasks) {
+    std::ifstream file{task.path() / "stat"};
+    if (!std::getline(file, line)) continue;
+
+    /* The name may have spaces: the fields start after the last ')' */
+    const std::size_t name_end = line.rfind(')');
+    if (std::string::npos == name_end) continue;
+    const char *field_start = line.c_str() + name_end + 1;
+    uint64_t ticks = 0;
+    long processor = -1;  // NOLINT
+    for (int field = 3; field <= kProcessorField && *field_start; ++field) {
+      while (' ' == *field_start) ++field_start;
+      if (kUtimeField == field || kStimeField == field) {
+        ticks += std::strtoull(field_start, nullptr, 10);
+      } else if (kProcessorField == field) {
+        processor = std::strtol(field_start, nullptr, 10);
+      }
+      while (*field_start && ' ' != *field_start) ++field_start;
+    }
+
+    /* The threads spawned within the window count since their creation */
+    const int tid = std::atoi(task.path().filename().c_str());
+    auto previous = process.threads.find(tid);
+    uint64_t before = process.valid ? 0 : ticks;
+    if (process.threads.end() != previous) before = previous->second;
+    threads[tid] = ticks;
+
+    if (processor < 0 || static_cast<uint>(processor) >= this->cpus_ ||
+        ticks < before)
+      continue;
+    process.ticks[processor] += ticks - before;
+  }
+
+  process.threads = std::move(threads);
+  return Status{};
+}
+
+void ProcessPowerObserver::Attribute(Process &process, const uint64_t window) {
+  CPUReadings &readings = process.readings;
+  const double window_ticks = window * sysconf(_SC_CLK_TCK) * 1e-3;
+  const double seconds = window * 1e-3;
+
+  std::vector<uint64_t> socket_ticks(this->sockets_, 0);
+  uint64_t ticks = 0;
+  for (uint cpu = 0; cpu < this->cpus_; ++cpu) {
+    const uint64_t cpu_ticks = process.ticks[cpu];
+    const uint64_t busy = this->busy_[cpu];
+    /* The process cannot take more than the busy time of the CPU */
+    const double share =
+        busy ? std::min(1., static_cast<double>(cpu_ticks) / busy) : 0.;
+    readings.core_power[cpu] = this->cpu_power_[cpu] * share;
+    readings.core_usage[cpu] = 100. * cpu_ticks / window_ticks;
+    socket_ticks[this->cpu_socket_[cpu]] += cpu_ticks;
+    ticks += cpu_ticks;
+  }
+
+  readings.overall_power = 0.f;
+  for (uint socket = 0; socket < this->sockets_; ++socket) {
+    double power = 0.;
+    for (uint cpu = 0; cpu < this->cpus_; ++cpu) {
+      if (socket == this->cpu_socket_[cpu]) power += readings.core_power[cpu];
+    }
+
+    double idle_share = 0.;
+    const double capacity = this->socket_cpus_[socket] * window_ticks;
+    const double busy = this->socket_busy_[socket];
+    switch (this->idle_.policy) {
+      case IdleModel::Policy::BY_CAPACITY:
+        idle_share = capacity > 0. ? socket_ticks[socket] / capacity : 0.;
+        break;
+      case IdleModel::Policy::BY_USAGE:
+        idle_share = busy > 0. ? socket_ticks[socket] / busy : 0.;
+        break;
+      default:
+        break;
+    }
+    power += this->idle_power_[socket] * std::min(1., idle_share);
+
+    readings.socket_power[socket] = power;
+    readings.socket_energy[socket] += power * seconds;
+    readings.overall_power += power;
+  }
+
+  readings.overall_energy += readings.overall_power * seconds;
+  readings.overall_usage = 100. * ticks / (window_ticks * this->cpus_);
+}
+
+std::vector<Readings *> ProcessPowerObserver::GetReadings() {
+  std::vector<Readings *> readings{};
+  readings.reserve(this->processes_.size());
+  for (auto &entry : this->processes_) {
+    readings.push_back(&entry.second.readings);
+  }
+  return readings;
+}
+
+Status ProcessPowerObserver::SelectDevice(const uint /* device */) {
+  return Status{Status::NOT_IMPLEMENTED,
+                "Cannot select a device since it is not implemented"};
+}
+
+Status ProcessPowerObserver::SetScope(const ObserverScope scope) {
+  if (ObserverScope::PROCESS == scope) return Status{};
+  return Status{Status::NOT_IMPLEMENTED, "The scope is only set to PROCESS"};
+}
+
+Status ProcessPowerObserver::SetPID(const uint pid) {
+  this->processes_.clear();
+  this->pid_ = pid;
+  if (0 == pid) return Status{};
+  return this->AddPID(pid);
+}
+
+ObserverScope ProcessPowerObserver::GetScope() const noexcept {
+  return ObserverScope::PROCESS;
+}
+
+uint ProcessPowerObserver::GetPID() const noexcept {
+  return this->processes_.empty() ? 0 : this->processes_.begin()->first;
+}
+
+const std::vector<ObserverCapabilities>
+    &ProcessPowerObserver::GetCapabilities() const noexcept {
+  return this->caps_;
+}
+
+Status ProcessPowerObserver::GetStatus() { return Status{}; }
+
+Status ProcessPowerObserver::SetInterval(const uint64_t interval) {
+  this->interval_ = interval;
+  return Status{};
+}
+
+Status ProcessPowerObserver::ClearInterval() {
+  return Status{Status::NOT_IMPLEMENTED,
+                "The clear interval is not implemented yet"};
+}
+
+Status ProcessPowerObserver::Reset() {
+  this->before_busy_.assign(this->cpus_, 0);
+  this->after_busy_.assign(this->cpus_, 0);
+  this->busy_.assign(this->cpus_, 0);
+  this->socket_busy_.assign(this->sockets_, 0);
+  this->cpu_power_.assign(this->cpus_, 0.);
+  this->idle_power_.assign(this->sockets_, 0.);
+  for (auto &entry : this->processes_) this->ResetProcess(entry.second);
+  this->valid_ = false;
+  return Status{};
+}
+
+Status ProcessPowerObserver::AddPID(const uint pid) {
+  if (0 == pid) {
+    return Status{Status::INVALID_PARAMETER, "Invalid PID"};
+  }
+  auto inserted = this->processes_.emplace(pid, Process{});
+  if (!inserted.second) {
+    return Status{Status::RESOURCE_BUSY,
+                  "The process is already monitored: " + std::to_string(pid)};
+  }
+  this->ResetProcess(inserted.first->second);
+  return Status{};
+}
+
+Status ProcessPowerObserver::RemovePID(const uint pid) {
+  if (0 == this->processes_.erase(pid)) {
+    return Status{Status::NOT_FOUND,
+                  "The process is not monitored: " + std::to_string(pid)};
+  }
+  return Status{};
+}
+
+std::vector<uint> ProcessPowerObserver::GetPIDs() const {
+  std::vector<uint> pids{};
+  pids.reserve(this->processes_.size());
+  for (const auto &entry : this->processes_) pids.push_back(entry.first);
+  return pids;
+}
+
+Status ProcessPowerObserver::GetProcessReadings(const uint pid,
+                                                CPUReadings &readings) const {
+  auto it = this->processes_.find(pid);
+  if (this->processes_.end() == it) {
+    return Status{Status::NOT_FOUND,
+                  "The process is not monitored: " + std::to_string(pid)};
+  }
+  readings = it->second.readings;
+  return Status{};
+}
+
+Status ProcessPowerObserver::SetIdleModel(const IdleModel &idle) {
+  if (idle.socket_power < 0.f) {
+    return Status{Status::INVALID_PARAMETER, "The idle power is negative"};
+  }
+  this->idle_ = idle;
+  return Status{};
+}
+
+const ProcessPowerObserver::IdleModel &ProcessPowerObserver::GetIdleModel()
+    const noexcept {
+  return this->idle_;
+}
+
+void ProcessPowerObserver::ResetProcess(Process &process) {
+  CPUReadings &readings = process.readings;
+  readings.type = static_cast<uint>(ObserverType::NONE);
+  readings.timestamp = 0;
+  readings.difference = 0;
+  readings.overall_usage = 0.f;
+  readings.overall_power = 0.f;
+  readings.overall_energy = 0.;
+  readings.core_usage.assign(this->cpus_, 0.f);
+  readings.core_power.assign(this->cpus_, 0.f);
+  readings.socket_usage.clear();
+  readings.socket_power.assign(this->sockets_, 0.f);
+  readings.socket_energy.assign(this->sockets_, 0.);
+  process.threads.clear();
+  process.ticks.assign(this->cpus_, 0);
+  process.valid = false;
+}
+
+} /* namespace efimon */
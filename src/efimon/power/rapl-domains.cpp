@@ -0,0 +1,337 @@
+/**
+ * @file rapl-domains.cpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Tree of RAPL domains exposed by the powercap interface, the
+ * amd_energy hwmon driver or the energy MSRs. It keeps the energy counters
+ * open to read them without reopening the files
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <efimon/power/rapl-domains.hpp>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>  // NOLINT
+#include <vector>
+
+namespace efimon {
+
+/* Zones of the MSR interface. intel-rapl-mmio duplicates the packages */
+static constexpr char kZonePrefix[] = "intel-rapl:";
+/* Topology of the logical CPUs */
+static constexpr char kCpuPath[] = "/sys/devices/system/cpu";
+/* AMD energy MSRs (Family 17h onwards) */
+static constexpr uint32_t kMsrRaplPowerUnit = 0xC0010299;
+static constexpr uint32_t kMsrCoreEnergyStat = 0xC001029A;
+static constexpr uint32_t kMsrPkgEnergyStat = 0xC001029B;
+/* The energy status MSRs are 32-bit counters */
+static constexpr uint64_t kMsrEnergyRange = 1ull << 32;
+
+/* Reads a counter from a descriptor kept open */
+static bool ReadCounter(const RAPLDomain &domain, uint64_t &value) {
+  if (0 != domain.msr) {
+    uint64_t raw = 0;
+    if (sizeof(raw) != pread(domain.fd, &raw, sizeof(raw), domain.msr)) {
+      return false;
+    }
+    value = static_cast<uint64_t>((raw & (kMsrEnergyRange - 1)) * domain.unit);
+    return true;
+  }
+
+  char buffer[32];
+  ssize_t bytes = pread(domain.fd, buffer, sizeof(buffer) - 1, 0);
+  if (bytes <= 0) return false;
+  buffer[bytes] = '\0';
+  char *end = nullptr;
+  value = std::strtoull(buffer, &end, 10);
+  return end != buffer;
+}
+
+static std::string ReadLine(const std::filesystem::path &path) {
+  std::ifstream file{path};
+  std::string line;
+  std::getline(file, line);
+  return line;
+}
+
+/* Socket of a logical CPU */
+static uint ReadSocket(const uint cpu) {
+  const std::filesystem::path topology = std::filesystem::path{kCpuPath} /
+                                         ("cpu" + std::to_string(cpu)) /
+                                         "topology";
+  return std::strtoul(ReadLine(topology / "physical_package_id").c_str(),
+                      nullptr, 10);
+}
+
+/* First thread of the core of a logical CPU */
+static uint ReadFirstSibling(const uint cpu) {
+  const std::filesystem::path topology = std::filesystem::path{kCpuPath} /
+                                         ("cpu" + std::to_string(cpu)) /
+                                         "topology";
+  const std::string siblings = ReadLine(topology / "thread_siblings_list");
+  if (siblings.empty()) return cpu;
+  return std::strtoul(siblings.c_str(), nullptr, 10);
+}
+
+RAPLDomainTree::RAPLDomainTree(const Backend backend, const std::string &root)
+    : domains_{}, sockets_{0}, backend_{Backend::NONE} {
+  const bool automatic = Backend::AUTO == backend;
+  if (automatic || Backend::POWERCAP == backend) {
+    this->DiscoverPowercap(automatic || root.empty() ? kPowercapPath : root);
+    if (!this->domains_.empty()) this->backend_ = Backend::POWERCAP;
+  }
+  if (this->domains_.empty() && (automatic || Backend::AMD_ENERGY == backend)) {
+    this->DiscoverAmdEnergy(automatic || root.empty() ? kHwmonPath : root);
+    if (!this->domains_.empty()) this->backend_ = Backend::AMD_ENERGY;
+  }
+  if (this->domains_.empty() && (automatic || Backend::MSR == backend)) {
+    this->DiscoverMsr(automatic || root.empty() ? kMsrPath : root);
+    if (!this->domains_.empty()) this->backend_ = Backend::MSR;
+  }
+
+  std::sort(this->domains_.begin(), this->domains_.end(),
+            [](const RAPLDomain &a, const RAPLDomain &b) {
+              if (a.socket != b.socket) return a.socket < b.socket;
+              if (a.type != b.type) return a.type < b.type;
+              return a.cpu < b.cpu;
+            });
+}
+
+void RAPLDomainTree::DiscoverPowercap(const std::string &root) {
+  std::error_code ec;
+  for (const auto &entry : std::filesystem::directory_iterator(root, ec)) {
+    const std::string zone = entry.path().filename().string();
+    /* Top zones: intel-rapl:N */
+    if (0 != zone.rfind(kZonePrefix, 0) ||
+        std::string::npos != zone.find(':', sizeof(kZonePrefix) - 1))
+      continue;
+    this->AddZone(entry.path().string(), true, 0);
+  }
+}
+
+void RAPLDomainTree::DiscoverAmdEnergy(const std::string &root) {
+  std::error_code ec;
+  for (const auto &entry : std::filesystem::directory_iterator(root, ec)) {
+    const std::filesystem::path hwmon = entry.path();
+    if ("amd_energy" != ReadLine(hwmon / "name")) continue;
+
+    /* Channels: energyN_input labelled as EcoreNNN or EsocketN */
+    for (uint channel = 1;; ++channel) {
+      const std::string prefix = "energy" + std::to_string(channel);
+      const std::string label = ReadLine(hwmon / (prefix + "_label"));
+      if (label.empty()) break;
+
+      RAPLDomain domain{};
+      domain.cpu = -1;
+      domain.path = (hwmon / (prefix + "_input")).string();
+      /* The driver accumulates the counters in 64 bits */
+      domain.max_energy = UINT64_MAX;
+      domain.msr = 0;
+      if (0 == label.rfind("Esocket", 0)) {
+        domain.type = RAPLDomain::Type::PACKAGE;
+        domain.socket = std::strtoul(label.c_str() + 7, nullptr, 10);
+      } else if (0 == label.rfind("Ecore", 0)) {
+        domain.type = RAPLDomain::Type::CORE;
+        domain.cpu = std::strtol(label.c_str() + 5, nullptr, 10);
+        domain.socket = ReadSocket(domain.cpu);
+      } else {
+        continue;
+      }
+      domain.fd = open(domain.path.c_str(), O_RDONLY | O_CLOEXEC);
+      this->AddDomain(domain);
+    }
+  }
+}
+
+void RAPLDomainTree::DiscoverMsr(const std::string &root) {
+  std::vector<uint> cpus;
+  std::error_code ec;
+  for (const auto &entry : std::filesystem::directory_iterator(root, ec)) {
+    const std::string name = entry.path().filename().string();
+    if (name.empty() ||
+        name.find_first_not_of("0123456789") != std::string::npos)
+      continue;
+    cpus.push_back(std::strtoul(name.c_str(), nullptr, 10));
+  }
+  std::sort(cpus.begin(), cpus.end());
+
+  /* The package counter is read from the first CPU of each socket, and the
+     core counter from the first thread of each core */
+  std::vector<bool> sockets;
+  for (const uint cpu : cpus) {
+    const std::string path =
+        (std::filesystem::path{root} / std::to_string(cpu) / "msr").string();
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) continue;
+
+    /* Energy status units: bits 12:8, in 1/2^ESU Joules */
+    uint64_t units = 0;
+    if (sizeof(units) != pread(fd, &units, sizeof(units), kMsrRaplPowerUnit)) {
+      close(fd);
+      continue;
+    }
+    close(fd);
+
+    RAPLDomain domain{};
+    domain.socket = ReadSocket(cpu);
+    domain.path = path;
+    domain.unit = 1e6 / static_cast<double>(1ull << ((units >> 8) & 0x1F));
+    domain.max_energy = static_cast<uint64_t>(kMsrEnergyRange * domain.unit);
+
+    if (sockets.size() <= domain.socket) sockets.resize(domain.socket + 1);
+    if (!sockets[domain.socket]) {
+      sockets[domain.socket] = true;
+      domain.type = RAPLDomain::Type::PACKAGE;
+      domain.cpu = -1;
+      domain.msr = kMsrPkgEnergyStat;
+      domain.fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+      this->AddDomain(domain);
+    }
+    if (ReadFirstSibling(cpu) == cpu) {
+      domain.type = RAPLDomain::Type::CORE;
+      domain.cpu = cpu;
+      domain.msr = kMsrCoreEnergyStat;
+      domain.fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+      this->AddDomain(domain);
+    }
+  }
+}
+
+void RAPLDomainTree::AddDomain(RAPLDomain &domain) {
+  uint64_t energy = 0;
+  if (domain.fd < 0 || !ReadCounter(domain, energy)) {
+    /* Since Linux 5.10, energy_uj is only readable by root. The msr driver
+       also requires root */
+    if (domain.fd >= 0) close(domain.fd);
+    return;
+  }
+
+  if (RAPLDomain::Type::PACKAGE == domain.type) {
+    this->sockets_ = std::max(this->sockets_, domain.socket + 1);
+  }
+  this->domains_.push_back(domain);
+}
+
+void RAPLDomainTree::AddZone(const std::string &path, const bool top,
+                             const uint socket) {
+  const std::filesystem::path zone{path};
+  const std::string name = ReadLine(zone / "name");
+
+  RAPLDomain domain{};
+  domain.socket = socket;
+  domain.cpu = -1;
+  domain.path = path;
+  domain.msr = 0;
+  domain.fd = -1;
+  if (0 == name.rfind("package-", 0)) {
+    /* package-N or package-N-die-M: the dies are added to the socket */
+    domain.type = RAPLDomain::Type::PACKAGE;
+    domain.socket = std::strtoul(name.c_str() + 8, nullptr, 10);
+  } else if ("psys" == name) {
+    domain.type = RAPLDomain::Type::PSYS;
+  } else if ("core" == name) {
+    domain.type = RAPLDomain::Type::CORE;
+  } else if ("uncore" == name) {
+    domain.type = RAPLDomain::Type::UNCORE;
+  } else if ("dram" == name) {
+    domain.type = RAPLDomain::Type::DRAM;
+  } else {
+    return;
+  }
+
+  /* The subzones belong to the socket of their package */
+  if (top) {
+    std::error_code ec;
+    for (const auto &entry : std::filesystem::directory_iterator(zone, ec)) {
+      const std::string child = entry.path().filename().string();
+      if (0 == child.rfind(kZonePrefix, 0)) {
+        this->AddZone(entry.path().string(), false, domain.socket);
+      }
+    }
+  }
+
+  domain.max_energy =
+      std::strtoull(ReadLine(zone / "max_energy_range_uj").c_str(), nullptr,
+                    10);
+  domain.fd = open((zone / "energy_uj").c_str(), O_RDONLY | O_CLOEXEC);
+  this->AddDomain(domain);
+}
+
+Status RAPLDomainTree::Read(const std::size_t domain, uint64_t &energy) const {
+  if (domain >= this->domains_.size()) {
+    return Status{Status::INVALID_PARAMETER, "Invalid RAPL domain"};
+  }
+  if (!ReadCounter(this->domains_[domain], energy)) {
+    return Status{Status::FILE_ERROR, "Cannot read the RAPL domain " +
+                                          this->domains_[domain].path};
+  }
+  return Status{};
+}
+
+Status RAPLDomainTree::Read(std::vector<uint64_t> &energies) const {
+  Status ret{};
+  energies.resize(this->domains_.size(), 0);
+  for (std::size_t i = 0; i < this->domains_.size(); ++i) {
+    if (!ReadCounter(this->domains_[i], energies[i])) {
+      ret = Status{Status::FILE_ERROR,
+                   "Cannot read the RAPL domain " + this->domains_[i].path};
+    }
+  }
+  return ret;
+}
+
+const std::vector<RAPLDomain> &RAPLDomainTree::GetDomains() const noexcept {
+  return this->domains_;
+}
+
+uint RAPLDomainTree::GetNumSockets() const noexcept { return this->sockets_; }
+
+RAPLDomainTree::Backend RAPLDomainTree::GetBackend() const noexcept {
+  return this->backend_;
+}
+
+std::string RAPLDomainTree::BackendString(const Backend backend) {
+  switch (backend) {
+    case Backend::AUTO:
+      return "Auto";
+    case Backend::POWERCAP:
+      return "Powercap";
+    case Backend::AMD_ENERGY:
+      return "AMD Energy";
+    case Backend::MSR:
+      return "MSR";
+    default:
+      return "None";
+  }
+}
+
+std::string RAPLDomainTree::TypeString(const RAPLDomain::Type type) {
+  switch (type) {
+    case RAPLDomain::Type::PACKAGE:
+      return "Package";
+    case RAPLDomain::Type::CORE:
+      return "Core";
+    case RAPLDomain::Type::UNCORE:
+      return "Uncore";
+    case RAPLDomain::Type::DRAM:
+      return "DRAM";
+    case RAPLDomain::Type::PSYS:
+      return "Psys";
+    default:
+      return "Unknown";
+  }
+}
+
+RAPLDomainTree::~RAPLDomainTree() {
+  for (const auto &domain : this->domains_) {
+    if (domain.fd >= 0) close(domain.fd);
+  }
+}
+
+} /* namespace efimon */
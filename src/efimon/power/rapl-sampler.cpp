@@ -0,0 +1,247 @@
+/**
+ * @file rapl-sampler.cpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief High-frequency sampler of the RAPL domains. A thread reads the
+ * energy counters every few milliseconds and publishes them into a
+ * lock-free ring buffer
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#include <time.h>
+
+#include <efimon/power/rapl-sampler.hpp>
+#include <string>
+#include <vector>
+
+namespace efimon {
+
+static constexpr uint64_t kNsPerMs = 1000000ull;
+static constexpr uint64_t kNsPerSecond = 1000000000ull;
+
+static std::size_t RoundUpPow2(std::size_t value) {
+  std::size_t pow2 = 2;
+  while (pow2 < value) pow2 <<= 1;
+  return pow2;
+}
+
+RAPLSampler::RAPLSampler(const uint64_t period, const std::size_t capacity,
+                         const RAPLDomainTree::Backend backend,
+                         const std::string &root)
+    : tree_{backend, root},
+      period_{period * kNsPerMs},
+      capacity_{RoundUpPow2(capacity)},
+      domains_{0},
+      sequences_{nullptr},
+      times_{nullptr},
+      energies_{nullptr},
+      head_{0},
+      running_{false} {
+  if (period < kMinPeriod || period > kMaxPeriod) {
+    throw Status{Status::INVALID_PARAMETER,
+                 "The RAPL sampling period must be within 1 and 10 ms"};
+  }
+  this->domains_ = this->tree_.GetDomains().size();
+  if (0 == this->domains_) {
+    throw Status{Status::NOT_FOUND, "The RAPL Interface cannot be opened"};
+  }
+
+  this->sequences_ = std::make_unique<std::atomic<uint64_t>[]>(capacity_);
+  this->times_ = std::make_unique<std::atomic<uint64_t>[]>(capacity_);
+  this->energies_ =
+      std::make_unique<std::atomic<uint64_t>[]>(capacity_ * domains_);
+  for (std::size_t i = 0; i < this->capacity_; ++i) {
+    this->sequences_[i].store(0, std::memory_order_relaxed);
+  }
+
+  this->running_.store(true);
+  this->sampler_ = std::thread(&RAPLSampler::Sampler, this);
+}
+
+uint64_t RAPLSampler::Now() noexcept {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * kNsPerSecond + ts.tv_nsec;
+}
+
+void RAPLSampler::Sampler() {
+  const auto &domains = this->tree_.GetDomains();
+  std::vector<uint64_t> previous(this->domains_, 0);
+  std::vector<uint64_t> accumulated(this->domains_, 0);
+  std::vector<bool> ready(this->domains_, false);
+
+  /* A domain accounts energy from its first successful read on */
+  for (std::size_t i = 0; i < this->domains_; ++i) {
+    ready[i] = Status::OK == this->tree_.Read(i, previous[i]).code;
+  }
+  this->Publish(Now(), accumulated);
+
+  uint64_t next = Now();
+  while (this->running_.load(std::memory_order_relaxed)) {
+    next += this->period_;
+    struct timespec ts;
+    ts.tv_sec = next / kNsPerSecond;
+    ts.tv_nsec = next % kNsPerSecond;
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr);
+
+    /* The domains that cannot be read keep their previous value, so they
+       account no energy in this period */
+    for (std::size_t i = 0; i < this->domains_; ++i) {
+      uint64_t current = 0;
+      if (Status::OK != this->tree_.Read(i, current).code) continue;
+      if (ready[i]) {
+        accumulated[i] += current >= previous[i]
+                              ? current - previous[i]
+                              : domains[i].max_energy - previous[i] + current;
+      }
+      previous[i] = current;
+      ready[i] = true;
+    }
+    const uint64_t time = Now();
+    this->Publish(time, accumulated);
+
+    /* Do not burst to catch up after a long preemption */
+    if (time > next + this->period_) next = time;
+  }
+}
+
+void RAPLSampler::Publish(const uint64_t time,
+                          const std::vector<uint64_t> &energy) {
+  const uint64_t index = this->head_.load(std::memory_order_relaxed);
+  const std::size_t slot = index & (this->capacity_ - 1);
+
+  /* Odd sequence: the slot is being written */
+  this->sequences_[slot].store(2 * index + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  this->times_[slot].store(time, std::memory_order_relaxed);
+  for (std::size_t i = 0; i < this->domains_; ++i) {
+    this->energies_[slot * this->domains_ + i].store(
+        energy[i], std::memory_order_relaxed);
+  }
+  this->sequences_[slot].store(2 * index + 2, std::memory_order_release);
+  this->head_.store(index + 1, std::memory_order_release);
+}
+
+uint64_t RAPLSampler::GetHead() const noexcept {
+  return this->head_.load(std::memory_order_acquire);
+}
+
+bool RAPLSampler::GetTime(const uint64_t index, uint64_t &time) const {
+  const std::size_t slot = index & (this->capacity_ - 1);
+  const uint64_t sequence =
+      this->sequences_[slot].load(std::memory_order_acquire);
+  if (2 * index + 2 != sequence) return false;
+  time = this->times_[slot].load(std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return sequence == this->sequences_[slot].load(std::memory_order_relaxed);
+}
+
+bool RAPLSampler::GetSample(const uint64_t index, Sample &sample) const {
+  if (index >= this->GetHead()) return false;
+
+  const std::size_t slot = index & (this->capacity_ - 1);
+  const uint64_t sequence =
+      this->sequences_[slot].load(std::memory_order_acquire);
+  if (2 * index + 2 != sequence) return false;
+  sample.time = this->times_[slot].load(std::memory_order_relaxed);
+  sample.energy.resize(this->domains_);
+  for (std::size_t i = 0; i < this->domains_; ++i) {
+    sample.energy[i] = this->energies_[slot * this->domains_ + i].load(
+        std::memory_order_relaxed);
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return sequence == this->sequences_[slot].load(std::memory_order_relaxed);
+}
+
+Status RAPLSampler::GetLatest(Sample &sample) const {
+  const uint64_t head = this->GetHead();
+  if (0 == head || !this->GetSample(head - 1, sample)) {
+    return Status{Status::NOT_READY, "There are no RAPL samples yet"};
+  }
+  return Status{};
+}
+
+bool RAPLSampler::Find(const uint64_t t, uint64_t &index) const {
+  const uint64_t head = this->GetHead();
+  if (0 == head) return false;
+
+  /* The oldest slot may be being overwritten: skip it */
+  uint64_t low = head > this->capacity_ - 1 ? head - this->capacity_ + 1 : 0;
+  uint64_t high = head - 1;
+  uint64_t time = 0;
+  if (!this->GetTime(low, time) || time > t) return false;
+
+  while (low < high) {
+    const uint64_t middle = low + (high - low + 1) / 2;
+    if (!this->GetTime(middle, time)) return false;
+    if (time <= t) {
+      low = middle;
+    } else {
+      high = middle - 1;
+    }
+  }
+  index = low;
+  return true;
+}
+
+Status RAPLSampler::GetEnergy(const uint64_t t0, const uint64_t t1,
+                              std::vector<double> &energy) const {
+  if (t1 < t0) {
+    return Status{Status::INVALID_PARAMETER, "The interval is reversed"};
+  }
+  Sample latest;
+  Status st = this->GetLatest(latest);
+  if (Status::OK != st.code) return st;
+  if (t1 > latest.time) {
+    return Status{Status::NOT_READY, "The interval is not sampled yet"};
+  }
+
+  /* Accumulated energy at t, interpolated between the samples around it */
+  auto accumulated = [this](const uint64_t t, std::vector<double> &acc) {
+    uint64_t index = 0;
+    Sample before, after;
+    if (!this->Find(t, index) || !this->GetSample(index, before)) {
+      return false;
+    }
+    acc.assign(before.energy.begin(), before.energy.end());
+    if (before.time == t) return true;
+    if (!this->GetSample(index + 1, after)) return false;
+
+    const double fraction = static_cast<double>(t - before.time) /
+                            static_cast<double>(after.time - before.time);
+    for (std::size_t i = 0; i < acc.size(); ++i) {
+      acc[i] += fraction * (after.energy[i] - before.energy[i]);
+    }
+    return true;
+  };
+
+  std::vector<double> start, end;
+  if (!accumulated(t0, start) || !accumulated(t1, end)) {
+    return Status{Status::NOT_FOUND,
+                  "The interval is no longer held by the RAPL sampler"};
+  }
+  energy.resize(this->domains_);
+  for (std::size_t i = 0; i < this->domains_; ++i) {
+    energy[i] = (end[i] - start[i]) * 1e-6;
+  }
+  return Status{};
+}
+
+const std::vector<RAPLDomain> &RAPLSampler::GetDomains() const noexcept {
+  return this->tree_.GetDomains();
+}
+
+uint RAPLSampler::GetNumSockets() const noexcept {
+  return this->tree_.GetNumSockets();
+}
+
+uint64_t RAPLSampler::GetPeriod() const noexcept {
+  return this->period_ / kNsPerMs;
+}
+
+RAPLSampler::~RAPLSampler() {
+  this->running_.store(false);
+  if (this->sampler_.joinable()) this->sampler_.join();
+}
+
+} /* namespace efimon */
@@ -8,11 +8,12 @@
  * @copyright Copyright (c) 2024. See License for Licensing
  */
 
+#include <algorithm>
 #include <cstdint>
 #include <efimon/power/rapl.hpp>
 #include <efimon/status.hpp>
-#include <fstream>
-#include <string>
+#include <memory>
+#include <utility>
 #include <vector>
 
 namespace efimon {
@@ -22,13 +23,16 @@ extern uint64_t GetUptime();
 RAPLMeterObserver::RAPLMeterObserver(const uint /* pid */,
                                      const ObserverScope scope,
                                      const uint64_t interval)
-    : Observer{}, info_{}, valid_{false} {
+    : Observer{}, info_{}, valid_{false}, tree_{} {
   uint64_t type = static_cast<uint64_t>(ObserverType::CPU) |
+                  static_cast<uint64_t>(ObserverType::RAM) |
                   static_cast<uint64_t>(ObserverType::POWER) |
                   static_cast<uint64_t>(ObserverType::INTERVAL);
 
   this->interval_ = interval;
-  this->device_ = info_.GetNumSockets();
+  this->sockets_ = std::max<uint>(info_.GetNumSockets(),
+                                  this->tree_.GetNumSockets());
+  this->device_ = this->sockets_;
 
   if (ObserverScope::SYSTEM != scope) {
     throw Status{Status::INVALID_PARAMETER, "Process-scope is not supported"};
@@ -41,43 +45,6 @@ RAPLMeterObserver::RAPLMeterObserver(const uint /* pid */,
   this->Trigger();
 }
 
-Status RAPLMeterObserver::GetSocketConsumption(const uint socket_id) {
-  /* Make the powercap file */
-  std::string path_file_name = "/sys/class/powercap/intel-rapl:";
-  path_file_name += std::to_string(socket_id);
-
-  std::string energy_file_name = path_file_name;
-  energy_file_name += "/energy_uj";
-
-  std::string max_energy_file_name = path_file_name;
-  max_energy_file_name += "/max_energy_range_uj";
-
-  /* Open file */
-  std::ifstream energy_file, max_energy_file;
-  energy_file.open(energy_file_name);
-  max_energy_file.open(max_energy_file_name);
-  if (!energy_file.is_open() || !max_energy_file.is_open()) {
-    return Status{Status::NOT_FOUND, "The RAPL Interface cannot be opened"};
-  }
-
-  std::string payload_uj, payload_maxuj;
-  std::getline(energy_file, payload_uj);
-  std::getline(max_energy_file, payload_maxuj);
-
-  max_socket_meters_.at(socket_id) = std::stod(payload_maxuj) * 1e-06;
-  if (!valid_) {
-    /* Read two times */
-    before_socket_meters_.at(socket_id) = std::stod(payload_uj) * 1e-06;
-    after_socket_meters_.at(socket_id) = std::stod(payload_uj) * 1e-06;
-  } else {
-    std::swap(this->before_socket_meters_.at(socket_id),
-              this->after_socket_meters_.at(socket_id));
-    after_socket_meters_.at(socket_id) = std::stod(payload_uj) * 1e-06;
-  }
-
-  return Status{};
-}
-
 Status RAPLMeterObserver::Trigger() {
   /* Set readings common metadata */
   auto time = GetUptime();
@@ -85,45 +52,161 @@ Status RAPLMeterObserver::Trigger() {
                          static_cast<uint64_t>(ObserverType::POWER);
   this->readings_.difference = time - this->readings_.timestamp;
   this->readings_.timestamp = time;
-  this->readings_.overall_power = 0;
+  this->ram_readings_.type = static_cast<uint64_t>(ObserverType::RAM) |
+                             static_cast<uint64_t>(ObserverType::POWER);
+  this->ram_readings_.difference = this->readings_.difference;
+  this->ram_readings_.timestamp = time;
+  this->rapl_readings_.type = this->readings_.type;
+  this->rapl_readings_.difference = this->readings_.difference;
+  this->rapl_readings_.timestamp = time;
+
+  if (this->tree_.GetDomains().empty()) {
+    return Status{Status::NOT_FOUND, "The RAPL Interface cannot be opened"};
+  }
 
-  /* Check if the parse is for a single socket */
-  if (this->device_ < static_cast<uint>(info_.GetNumSockets())) {
-    this->GetSocketConsumption(this->device_);
-    this->ParseResults(this->device_);
+  /* The sampler windows are exact: they start at the previous sample */
+  if (this->sampler_) {
+    RAPLSampler::Sample latest;
+    Status st = this->sampler_->GetLatest(latest);
+    if (Status::OK != st.code) return st;
+    if (!this->valid_) this->last_sample_ = latest;
+
+    std::vector<double> energy(latest.energy.size());
+    for (std::size_t i = 0; i < energy.size(); ++i) {
+      energy[i] = (latest.energy[i] - this->last_sample_.energy[i]) * 1e-6;
+    }
+    const double interval = (latest.time - this->last_sample_.time) * 1e-6;
+    this->last_sample_ = std::move(latest);
+    this->ParseResults(energy, interval);
     this->valid_ = true;
     return Status{};
   }
 
-  /* Get for all sockets */
-  for (int i = 0; i < info_.GetNumSockets(); ++i) {
-    this->GetSocketConsumption(i);
-    this->ParseResults(i);
+  /* All the domains in one pass. The domains that cannot be read keep the
+     previous value, so they account no energy instead of a stale delta */
+  this->before_meters_ = this->after_meters_;
+  Status ret = this->tree_.Read(this->after_meters_);
+  if (!this->valid_) this->before_meters_ = this->after_meters_;
+
+  const auto &domains = this->tree_.GetDomains();
+  std::vector<double> energy(domains.size());
+  for (std::size_t i = 0; i < domains.size(); ++i) {
+    const uint64_t before = this->before_meters_.at(i);
+    const uint64_t after = this->after_meters_.at(i);
+    const uint64_t delta = after >= before
+                               ? after - before
+                               : domains[i].max_energy - before + after;
+    energy[i] = delta * 1e-6;
   }
 
-  /* Get for all the sockets */
+  this->ParseResults(energy, this->readings_.difference);
   this->valid_ = true;
+  return ret;
+}
+
+Status RAPLMeterObserver::EnableSampler(const uint64_t period) {
+  this->sampler_.reset();
+  this->valid_ = false;
+  if (0 == period) return Status{};
+  try {
+    /* The same backend keeps the domains in the same order */
+    this->sampler_ = std::make_unique<RAPLSampler>(
+        period, RAPLSampler::kDefaultCapacity, this->tree_.GetBackend());
+  } catch (const Status &st) {
+    return st;
+  }
   return Status{};
 }
 
-void RAPLMeterObserver::ParseResults(const uint socket_id) {
-  double before = this->before_socket_meters_.at(socket_id);
-  double after = this->after_socket_meters_.at(socket_id);
-  double maxrange = this->max_socket_meters_.at(socket_id);
+RAPLDomainTree::Backend RAPLMeterObserver::GetBackend() const noexcept {
+  return this->tree_.GetBackend();
+}
+
+const RAPLSampler *RAPLMeterObserver::GetSampler() const noexcept {
+  return this->sampler_.get();
+}
+
+void RAPLMeterObserver::ParseResults(const std::vector<double> &energies,
+                                     const double interval) {
+  auto &rapl = this->rapl_readings_;
+  const auto &domains = this->tree_.GetDomains();
+  const float unavailable = -1.f;
+  for (auto *power : {&rapl.package_power, &rapl.core_power,
+                      &rapl.uncore_power, &rapl.dram_power}) {
+    power->assign(this->sockets_, unavailable);
+  }
+  rapl.psys_power = unavailable;
+
+  for (std::size_t i = 0; i < domains.size(); ++i) {
+    const RAPLDomain &domain = domains[i];
+    /* Check if the parse is for a single socket */
+    if (this->device_ < this->sockets_ && this->device_ != domain.socket &&
+        RAPLDomain::Type::PSYS != domain.type)
+      continue;
+
+    const double energy = energies.at(i);
+    const double power = 0 == interval ? 0. : energy * 1000. / interval;
+
+    float *power_slot = &rapl.psys_power;
+    double *energy_slot = &rapl.psys_energy;
+    switch (domain.type) {
+      case RAPLDomain::Type::PACKAGE:
+        power_slot = &rapl.package_power.at(domain.socket);
+        energy_slot = &rapl.package_energy.at(domain.socket);
+        break;
+      case RAPLDomain::Type::CORE:
+        power_slot = &rapl.core_power.at(domain.socket);
+        energy_slot = &rapl.core_energy.at(domain.socket);
+        /* Per-core counters (AMD) are also reported per logical CPU */
+        if (domain.cpu >= 0 &&
+            static_cast<std::size_t>(domain.cpu) <
+                this->readings_.core_power.size()) {
+          this->readings_.core_power.at(domain.cpu) = power;
+        }
+        break;
+      case RAPLDomain::Type::UNCORE:
+        power_slot = &rapl.uncore_power.at(domain.socket);
+        energy_slot = &rapl.uncore_energy.at(domain.socket);
+        break;
+      case RAPLDomain::Type::DRAM:
+        power_slot = &rapl.dram_power.at(domain.socket);
+        energy_slot = &rapl.dram_energy.at(domain.socket);
+        break;
+      default:
+        break;
+    }
+    /* Several dies or cores may be reported per socket */
+    if (unavailable == *power_slot) *power_slot = 0.f;
+    *power_slot += power;
+    *energy_slot += energy;
+  }
 
-  double energy = after >= before ? after - before : maxrange - before + after;
-  double power = energy * 1000. / this->readings_.difference;
+  /* The CPU readings report the packages */
+  this->readings_.overall_power = 0;
+  this->readings_.overall_energy = 0;
+  for (uint i = 0; i < this->sockets_; ++i) {
+    if (unavailable == rapl.package_power.at(i)) continue;
+    this->readings_.socket_power.at(i) = rapl.package_power.at(i);
+    this->readings_.socket_energy.at(i) = rapl.package_energy.at(i);
+    this->readings_.overall_power += rapl.package_power.at(i);
+    this->readings_.overall_energy += rapl.package_energy.at(i);
+  }
 
-  this->readings_.socket_power.at(socket_id) = power;
-  this->readings_.overall_power += power;
-  if (this->valid_) {
-    this->readings_.socket_energy.at(socket_id) += energy;
-    this->readings_.overall_energy += energy;
+  this->ram_readings_.overall_power = unavailable;
+  for (const float power : rapl.dram_power) {
+    if (unavailable == power) continue;
+    if (unavailable == this->ram_readings_.overall_power) {
+      this->ram_readings_.overall_power = 0.f;
+    }
+    this->ram_readings_.overall_power += power;
   }
 }
 
 std::vector<Readings*> RAPLMeterObserver::GetReadings() {
-  return std::vector<Readings*>{static_cast<Readings*>(&(this->readings_))};
+  return std::vector<Readings*>{
+      static_cast<Readings*>(&(this->readings_)),
+      static_cast<Readings*>(&(this->ram_readings_)),
+      static_cast<Readings*>(&(this->rapl_readings_))};
 }
 
 Status RAPLMeterObserver::SelectDevice(const uint device) {
@@ -176,12 +259,33 @@ Status RAPLMeterObserver::Reset() {
 
   this->readings_.overall_power = 0;
   this->readings_.overall_energy = 0;
-  this->readings_.socket_power.resize(info_.GetNumSockets(), 0.f);
-  this->readings_.socket_energy.resize(info_.GetNumSockets(), 0.f);
-  this->before_socket_meters_.resize(info_.GetNumSockets(), 0.f);
-  this->after_socket_meters_.resize(info_.GetNumSockets(), 0.f);
-  this->max_socket_meters_.resize(info_.GetNumSockets(), 0.f);
+  this->readings_.socket_power.resize(this->sockets_, 0.f);
+  this->readings_.socket_energy.assign(this->sockets_, 0.);
   this->readings_.core_power.resize(info_.GetLogicalCores(), 0.f);
+
+  this->ram_readings_.type = static_cast<uint>(ObserverType::NONE);
+  this->ram_readings_.timestamp = 0;
+  this->ram_readings_.difference = 0;
+  this->ram_readings_.overall_usage = -1;
+  this->ram_readings_.total_memory_usage = -1;
+  this->ram_readings_.swap_usage = -1;
+  this->ram_readings_.overall_bw = -1;
+  this->ram_readings_.overall_power = -1;
+
+  this->rapl_readings_.type = static_cast<uint>(ObserverType::NONE);
+  this->rapl_readings_.timestamp = 0;
+  this->rapl_readings_.difference = 0;
+  for (auto *energy : {&rapl_readings_.package_energy,
+                       &rapl_readings_.core_energy,
+                       &rapl_readings_.uncore_energy,
+                       &rapl_readings_.dram_energy}) {
+    energy->assign(this->sockets_, 0.);
+  }
+  this->rapl_readings_.psys_energy = 0.;
+
+  this->before_meters_.assign(this->tree_.GetDomains().size(), 0);
+  this->after_meters_.assign(this->tree_.GetDomains().size(), 0);
+  this->valid_ = false;
   return Status{};
 }
 
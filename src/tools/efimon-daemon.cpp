@@ -40,6 +40,7 @@ int main(int argc, char **argv) {
   uint delaytime = kDelay;
   std::string outputpath = kDefaultOutputPath;
   uint port = kPort;
+  uint rapl_sampler = kDefRAPLSampler;
 
   // ------------ Arguments ------------
   ArgParser argparser(argc, argv);
@@ -54,6 +55,8 @@ int main(int argc, char **argv) {
   bool check_port = argparser.Exists("-p") || argparser.Exists("--port");
   bool debug_mode =
       argparser.Exists("-g") || argparser.Exists("--enable-debug");
+  bool check_rapl_sampler =
+      argparser.Exists("-r") || argparser.Exists("--rapl-sampler");
 
   if (check_help) {
     std::string msg =
@@ -76,6 +79,9 @@ int main(int argc, char **argv) {
     msg +=
         " -p,--port PORT (default: 5550 Secs). EfiMon Socket Port for "
         "IPC\n\t\t";
+    msg +=
+        " -r,--rapl-sampler PERIOD_MS (default: disabled). Period of the "
+        "RAPL sampler (1 to 10 ms)\n\t\t";
     msg += " -h,--help: prints this message\n\n";
     msg +=
         " \tBy default, the outputs will be saved into the folder with the "
@@ -107,6 +113,16 @@ int main(int argc, char **argv) {
                                             : argparser.GetOption("--port"));
   }
 
+  if (check_rapl_sampler) {
+    rapl_sampler = std::stoi(argparser.Exists("-r")
+                                 ? argparser.GetOption("-r")
+                                 : argparser.GetOption("--rapl-sampler"));
+    if (rapl_sampler < RAPLSampler::kMinPeriod ||
+        rapl_sampler > RAPLSampler::kMaxPeriod) {
+      EFM_ERROR("The RAPL sampler period must be within 1 and 10 ms");
+    }
+  }
+
   if (check_output) {
     outputpath = argparser.Exists("-o")
                      ? argparser.GetOption("-o")
@@ -119,6 +135,7 @@ int main(int argc, char **argv) {
   EFM_INFO(std::string("Output folder: ") + outputpath);
   EFM_INFO(std::string("IPC TCP Port: ") + std::to_string(port));
   EFM_INFO(std::string("Debug Mode: ") + std::to_string(debug_mode));
+  EFM_INFO(std::string("RAPL sampler [ms]: ") + std::to_string(rapl_sampler));
 
   // ---------- Initialise ZeroMQ ------------
   std::string endpoint = "tcp://*:" + std::to_string(port);
@@ -130,6 +147,9 @@ int main(int argc, char **argv) {
   // ----------- Start the thread -----------
   EfimonAnalyser analyser{};
   EFM_SOFT_CHECK_AND_EXECUTE(debug_mode, analyser.EnableDebug());
+  if (check_rapl_sampler) {
+    EFM_CHECK(analyser.EnableRAPLSampler(rapl_sampler), EFM_WARN);
+  }
   analyser.StartSystemThread(delaytime);
 
   // ----------- Listen forever -----------
@@ -205,6 +225,21 @@ int main(int argc, char **argv) {
       } else if ("poll" == transaction && root.isMember("pid")) {
         uint pid = root["pid"].asUInt();
         status = analyser.CheckWorkerThread(pid);
+      } else if ("model" == transaction) {
+        std::vector<std::string> names;
+        std::vector<double> coefficients;
+        uint64_t updates = 0;
+        status = analyser.GetPowerModel(names, coefficients, updates);
+        for (uint i = 0; i < names.size() && i < coefficients.size(); ++i) {
+          response["coefficients"][names[i]] = coefficients[i];
+        }
+        response["updates"] = static_cast<Json::UInt64>(updates);
+        if (Status::OK == status.code && root.isMember("pid")) {
+          double power = 0.;
+          uint pid = root["pid"].asUInt();
+          status = analyser.EstimateProcessPower(pid, power);
+          response["power"] = power;
+        }
       } else {
         status = Status{Status::INVALID_PARAMETER, "Invalid set of params"};
       }
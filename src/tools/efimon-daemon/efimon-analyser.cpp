@@ -8,6 +8,7 @@
 
 #include "efimon-daemon/efimon-analyser.hpp"  // NOLINT
 
+#include <algorithm>
 #include <efimon/proc/cpuinfo.hpp>
 
 #include "efimon-daemon/efimon-worker.hpp"  // NOLINT
@@ -48,15 +49,40 @@ class SocketInfo {
 /* SocketInfo must be a singleton */
 static SocketInfo socket_info_{};
 
+/* Minimum time between IPMI acquisitions (ms). The BMC may be slower */
+static constexpr uint64_t kIPMIPeriod = 1000;
+
+/* Power model features: bias + instruction classes + untracked usage */
+static const uint kModelBias = 0;
+static const uint kModelClasses = 1;
+static const uint kModelOther = kModelClasses + OnlinePowerModel::NumClasses();
+static const uint kModelFeatures = kModelOther + 1;
+
 EfimonAnalyser::EfimonAnalyser() : sys_running_{false} {
   this->ipmi_meter_ = CreateIfEnabled<IPMIMeterObserver, kEnableIpmi>();
   this->rapl_meter_ = CreateIfEnabled<RAPLMeterObserver, kEnableRapl>();
   this->proc_sys_meter_ = CreateIfEnabled<ProcStatObserver, true>(
       0, efimon::ObserverScope::SYSTEM, 1);
+  try {
+    this->hwmon_meter_ = CreateIfEnabled<HwmonMeterObserver, true>();
+  } catch (const Status &st) {
+    EFM_WARN("Cannot open the hwmon sensors: " + st.msg);
+  }
+  if (this->rapl_meter_) {
+    this->process_power_ =
+        std::make_shared<ProcessPowerObserver>(this->rapl_meter_);
+  }
+  if (this->ipmi_meter_) {
+    this->ipmi_poller_ =
+        std::make_unique<IPMIPoller>(this->ipmi_meter_, kIPMIPeriod);
+  }
 
   // Reserve space and clean up results
   this->readings_.resize(EfimonAnalyser::LAST_READINGS, nullptr);
 
+  // Power model
+  this->power_model_ = std::make_unique<OnlinePowerModel>(kModelFeatures);
+
   // Disable debug by default
   this->enable_debug_ = false;
 }
@@ -71,6 +97,9 @@ Status EfimonAnalyser::StartSystemThread(const uint delay) {
   this->sys_running_.store(true);
   this->sys_thread_ = std::make_unique<std::thread>(
       &EfimonAnalyser::SystemStatsWorker, this, delay);
+  if (this->ipmi_poller_) {
+    EFM_CHECK(this->ipmi_poller_->Start(), EFM_WARN);
+  }
   return Status{};
 }
 
@@ -95,6 +124,11 @@ Status EfimonAnalyser::StartWorkerThread(const std::string &name,
         "Cannot create the monitor for the given PID: " + std::to_string(pid)};
   }
 
+  if (this->process_power_) {
+    std::scoped_lock slock(this->sys_mutex_);
+    EFM_CHECK(this->process_power_->AddPID(pid), EFM_WARN);
+  }
+
   EFM_INFO("Starting Process Monitor for PID: " + std::to_string(pid));
   return this->proc_workers_[pid]->Start(delay, samples, enable_perf, freq);
 }
@@ -118,6 +152,9 @@ Status EfimonAnalyser::StopSystemThread() {
   this->sys_running_.store(false);
   this->sys_thread_->join();
   this->sys_thread_.reset();
+  if (this->ipmi_poller_) {
+    EFM_CHECK(this->ipmi_poller_->Stop(), EFM_WARN);
+  }
   return Status{};
 }
 
@@ -132,6 +169,75 @@ Status EfimonAnalyser::StopWorkerThread(const uint pid) {
 
   it->second->Stop();
   this->proc_workers_.erase(it);
+
+  if (this->process_power_) {
+    std::scoped_lock slock(this->sys_mutex_);
+    this->process_power_->RemovePID(pid);
+  }
+
+  std::scoped_lock mlock(this->model_mutex_);
+  this->model_samples_.erase(pid);
+  return Status{};
+}
+
+Status EfimonAnalyser::SubmitModelSample(const uint pid, const float usage,
+                                         const std::vector<double> &mix) {
+  if (mix.size() != OnlinePowerModel::NumClasses()) {
+    return Status{Status::INVALID_PARAMETER, "Invalid instruction mix"};
+  }
+  std::scoped_lock mlock(this->model_mutex_);
+  this->model_samples_[pid] = ModelSample{usage, mix};
+  return Status{};
+}
+
+Status EfimonAnalyser::EstimateProcessPower(const uint pid, double &power) {
+  std::scoped_lock mlock(this->model_mutex_);
+  auto it = this->model_samples_.find(pid);
+  if (this->model_samples_.end() == it) {
+    return Status{Status::NOT_FOUND,
+                  "No instruction mix for the PID: " + std::to_string(pid)};
+  }
+
+  /* Only the process contribution: no bias, no untracked usage */
+  std::vector<double> features(kModelFeatures, 0.);
+  const double usage = it->second.usage / 100.;
+  for (uint i = 0; i < it->second.mix.size(); ++i) {
+    features[kModelClasses + i] = usage * it->second.mix[i];
+  }
+  return this->power_model_->Predict(features, power);
+}
+
+Status EfimonAnalyser::GetProcessPower(const uint pid,
+                                       CPUReadings &readings) {
+  if (!this->process_power_) {
+    return Status{Status::NOT_FOUND, "RAPL is not enabled"};
+  }
+  std::scoped_lock slock(this->sys_mutex_);
+  return this->process_power_->GetProcessReadings(pid, readings);
+}
+
+Status EfimonAnalyser::EnableRAPLSampler(const uint64_t period) {
+  auto rapl = std::dynamic_pointer_cast<RAPLMeterObserver>(this->rapl_meter_);
+  if (!rapl) {
+    return Status{Status::NOT_FOUND, "RAPL is not enabled"};
+  }
+  std::scoped_lock slock(this->sys_mutex_);
+  return rapl->EnableSampler(period);
+}
+
+Status EfimonAnalyser::GetPowerModel(std::vector<std::string> &names,
+                                     std::vector<double> &coefficients,
+                                     uint64_t &updates) {
+  names.resize(kModelFeatures);
+  names[kModelBias] = "Idle";
+  for (uint i = 0; i < OnlinePowerModel::NumClasses(); ++i) {
+    names[kModelClasses + i] = OnlinePowerModel::ClassName(i);
+  }
+  names[kModelOther] = "Untracked";
+
+  std::scoped_lock mlock(this->model_mutex_);
+  coefficients = this->power_model_->GetCoefficients();
+  updates = this->power_model_->GetNumUpdates();
   return Status{};
 }
 
@@ -139,14 +245,30 @@ void EfimonAnalyser::EnableDebug() { this->enable_debug_ = true; }
 
 bool EfimonAnalyser::IsDebugged() { return this->enable_debug_; }
 
-Status EfimonAnalyser::RefreshIPMI() {
-  std::scoped_lock slock(this->sys_mutex_);
-  return TriggerIfEnabled(this->ipmi_meter_);
+Status EfimonAnalyser::GetIPMIReadings(const int index, Readings *&out,
+                                       PSUReadings &psu, FanReadings &fan) {
+  if (!this->ipmi_poller_) {
+    return Status{Status::NOT_FOUND, "IPMI is not enabled"};
+  }
+  Status st = this->ipmi_poller_->GetReadings(psu, fan);
+  if (Status::OK != st.code) return st;
+  out = PSU_ENERGY_READINGS == index ? static_cast<Readings *>(&psu)
+                                     : static_cast<Readings *>(&fan);
+  return Status{};
 }
 
 Status EfimonAnalyser::RefreshRAPL() {
   std::scoped_lock slock(this->sys_mutex_);
-  return TriggerIfEnabled(this->rapl_meter_);
+  Status status = TriggerIfEnabled(this->rapl_meter_);
+  if (Status::OK != status.code || !this->process_power_) return status;
+
+  /* Same window as the meter for all the processes */
+  return this->process_power_->Trigger();
+}
+
+Status EfimonAnalyser::RefreshHwmon() {
+  std::scoped_lock slock(this->sys_mutex_);
+  return TriggerIfEnabled(this->hwmon_meter_);
 }
 
 Status EfimonAnalyser::RefreshProcSys() {
@@ -164,24 +286,71 @@ Status EfimonAnalyser::RefreshProcSys() {
   return status;
 }
 
+Status EfimonAnalyser::RefreshPowerModel() {
+  double power = 0.;
+  CPUReadings usage_readings{};
+  EFM_CHECK_STATUS(this->GetReadings(CPU_USAGE_READINGS, usage_readings));
+
+  /* Prefer the socket power: the instructions barely affect the rest */
+  if (kEnableRapl) {
+    CPUReadings rapl_readings{};
+    EFM_CHECK_STATUS(this->GetReadings(CPU_ENERGY_READINGS, rapl_readings));
+    for (const auto socket_power : rapl_readings.socket_power) {
+      power += socket_power;
+    }
+  } else if (kEnableIpmi) {
+    PSUReadings psu_readings{};
+    EFM_CHECK_STATUS(this->GetReadings(PSU_ENERGY_READINGS, psu_readings));
+    for (const auto psu_power : psu_readings.psu_power) {
+      power += psu_power;
+    }
+  } else {
+    /* Nothing to fit against */
+    return Status{};
+  }
+
+  /* The meters need a window to warm up */
+  if (power <= 0.) return Status{};
+
+  /* Aggregate the processes: the power is additive */
+  std::vector<double> features(kModelFeatures, 0.);
+  double tracked = 0.;
+  features[kModelBias] = 1.;
+
+  std::scoped_lock mlock(this->model_mutex_);
+  for (const auto &sample : this->model_samples_) {
+    const double usage = sample.second.usage / 100.;
+    tracked += usage;
+    for (uint i = 0; i < sample.second.mix.size(); ++i) {
+      features[kModelClasses + i] += usage * sample.second.mix[i];
+    }
+  }
+  features[kModelOther] =
+      std::max(0., usage_readings.overall_usage / 100. - tracked);
+
+  return this->power_model_->Update(features, power);
+}
+
 void EfimonAnalyser::SystemStatsWorker(const int delay) {
   sys_running_.store(true);
 
+  /* The IPMI readings are published by the poller */
   this->sys_mutex_.lock();
-  this->readings_[PSU_ENERGY_READINGS] =
-      GetReadingsIfEnabled<PSUReadings, kEnableIpmi>(this->ipmi_meter_, 0);
-  this->readings_[FAN_READINGS] =
-      GetReadingsIfEnabled<FanReadings, kEnableIpmi>(this->ipmi_meter_, 1);
   this->readings_[CPU_ENERGY_READINGS] =
       GetReadingsIfEnabled<CPUReadings, kEnableRapl>(this->rapl_meter_, 0);
   this->readings_[CPU_USAGE_READINGS] =
       GetReadingsIfEnabled<CPUReadings, true>(this->proc_sys_meter_, 0);
+  if (this->hwmon_meter_) {
+    this->readings_[THERMAL_READINGS] =
+        GetReadingsIfEnabled<ThermalReadings, true>(this->hwmon_meter_, 1);
+  }
   this->sys_mutex_.unlock();
 
   while (sys_running_.load()) {
     EFM_CHECK(RefreshProcSys(), EFM_WARN);
-    EFM_CHECK(RefreshIPMI(), EFM_WARN);
     EFM_CHECK(RefreshRAPL(), EFM_WARN);
+    EFM_CHECK(RefreshHwmon(), EFM_WARN);
+    EFM_CHECK(RefreshPowerModel(), EFM_WARN);
 
     /* Wait for the next sample */
     std::this_thread::sleep_for(std::chrono::seconds(delay));
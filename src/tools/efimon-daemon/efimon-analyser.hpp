@@ -11,7 +11,11 @@
 
 #include <atomic>
 #include <efimon/logger/macros.hpp>
+#include <efimon/power/hwmon.hpp>
+#include <efimon/power/online-model.hpp>
+#include <efimon/power/ipmi-poller.hpp>
 #include <efimon/power/ipmi.hpp>
+#include <efimon/power/process-power.hpp>
 #include <efimon/power/rapl.hpp>
 #include <efimon/proc/stat.hpp>
 #include <efimon/status.hpp>
@@ -47,6 +51,8 @@ class EfimonAnalyser {
     CPU_ENERGY_READINGS,
     /** CPU usage readings selector */
     CPU_USAGE_READINGS,
+    /** Temperature readings selector */
+    THERMAL_READINGS,
     /** Last element (which is actually a last selector) */
     LAST_READINGS
   };
@@ -137,6 +143,67 @@ class EfimonAnalyser {
   template <class T>
   Status GetReadings(const int index, T &out);  // NOLINT
 
+  /**
+   * @brief Submits the last instruction-class mix of a process
+   *
+   * The workers with perf enabled submit their windows here. The latest mix
+   * of each process is used by the system thread to fit the power model.
+   *
+   * @param pid PID of the process
+   * @param usage CPU usage of the process in percentage of the machine
+   * @param mix instruction-class mix (see OnlinePowerModel::ClassMix)
+   * @return Status
+   */
+  Status SubmitModelSample(const uint pid, const float usage,
+                           const std::vector<double> &mix);
+
+  /**
+   * @brief Estimates the dynamic power of a process from the fitted model
+   *
+   * It is the contribution of the process to the socket power according
+   * to its last instruction-class mix and CPU usage
+   *
+   * @param pid PID of the process (its worker must have perf enabled)
+   * @param power estimated power in watts
+   * @return Status
+   */
+  Status EstimateProcessPower(const uint pid, double &power);  // NOLINT
+
+  /**
+   * @brief Get the power attributed to a process from the RAPL counters
+   *
+   * The processes with a worker are attributed in a single pass by the system
+   * thread, right after refreshing RAPL (see ProcessPowerObserver)
+   *
+   * @param pid PID of the process
+   * @param readings power and energy of the process (overall and per socket)
+   * @return Status
+   */
+  Status GetProcessPower(const uint pid, CPUReadings &readings);  // NOLINT
+
+  /**
+   * @brief Enables the high-frequency sampler of the RAPL observer
+   *
+   * The system windows then take the exact energy between the samples
+   * instead of the counters read at each trigger
+   *
+   * @param period sampling period in milliseconds (1 to 10). 0 disables it
+   * @return Status
+   */
+  Status EnableRAPLSampler(const uint64_t period);
+
+  /**
+   * @brief Get the fitted power model
+   *
+   * @param names name of each coefficient
+   * @param coefficients coefficients in watts per unit of feature
+   * @param updates number of windows used in the fitting
+   * @return Status
+   */
+  Status GetPowerModel(std::vector<std::string> &names,      // NOLINT
+                       std::vector<double> &coefficients,    // NOLINT
+                       uint64_t &updates);                   // NOLINT
+
   /**
    * @brief Enables the debug messages
    */
@@ -163,6 +230,12 @@ class EfimonAnalyser {
   std::shared_ptr<Observer> ipmi_meter_;
   /** RAPL observer instance */
   std::shared_ptr<Observer> rapl_meter_;
+  /** hwmon observer instance. nullptr if there are no sensors */
+  std::shared_ptr<Observer> hwmon_meter_;
+  /** Per-process power on top of the RAPL observer. nullptr without RAPL */
+  std::shared_ptr<ProcessPowerObserver> process_power_;
+  /** Poller of the IPMI observer: the BMC is slow and runs apart */
+  std::unique_ptr<IPMIPoller> ipmi_poller_;
 
   // Result instances
   /** System-wide readings */
@@ -171,10 +244,15 @@ class EfimonAnalyser {
   // Refresh functions
   /** Perform the triggering of the procstat observer*/
   Status RefreshProcSys();
-  /** Perform the triggering of the IPMI observer*/
-  Status RefreshIPMI();
-  /** Perform the triggering of the RAPL observer*/
+  /** Perform the triggering of the RAPL and the process power observers*/
   Status RefreshRAPL();
+  /** Perform the triggering of the hwmon observer*/
+  Status RefreshHwmon();
+  /** Update the power model with the last system window */
+  Status RefreshPowerModel();
+  /** Copies the last IPMI readings without locking */
+  Status GetIPMIReadings(const int index, Readings *&out,  // NOLINT
+                         PSUReadings &psu, FanReadings &fan);  // NOLINT
 
   // Workers
   /** Worker function */
@@ -188,6 +266,21 @@ class EfimonAnalyser {
   /** Map that links the workers with the PID */
   std::unordered_map<uint, std::shared_ptr<EfimonWorker>> proc_workers_;
 
+  // Power model
+  /** Last window submitted by a worker */
+  struct ModelSample {
+    /** CPU usage in percentage of the machine */
+    float usage;
+    /** Instruction-class mix */
+    std::vector<double> mix;
+  };
+  /** Online power model: bias, instruction classes and untracked usage */
+  std::unique_ptr<OnlinePowerModel> power_model_;
+  /** Last window per PID */
+  std::unordered_map<uint, ModelSample> model_samples_;
+  /** Mutex to access to the power model and its samples */
+  std::mutex model_mutex_;
+
   // Options
   /** Enable debug */
   bool enable_debug_;
@@ -195,11 +288,24 @@ class EfimonAnalyser {
 
 template <class T>
 Status EfimonAnalyser::GetReadings(const int index, T &out) {  // NOLINT
-  std::scoped_lock slock(this->sys_mutex_);
   if (index >= EfimonAnalyser::LAST_READINGS || index < 0) {
     return Status{Status::INVALID_PARAMETER, "The index is out of bound"};
   }
 
+  /* The IPMI readings come from the poller snapshot: no lock */
+  if (PSU_ENERGY_READINGS == index || FAN_READINGS == index) {
+    PSUReadings psu{};
+    FanReadings fan{};
+    Readings *readings = nullptr;
+    Status st = this->GetIPMIReadings(index, readings, psu, fan);
+    if (Status::OK != st.code) return st;
+    T *val = dynamic_cast<T *>(readings);
+    if (!val) return Status{Status::NOT_FOUND, "Cannot cast the result"};
+    out = *val;
+    return Status{};
+  }
+
+  std::scoped_lock slock(this->sys_mutex_);
   T *val = dynamic_cast<T *>(this->readings_[index]);
   if (val) {
     out = *val;
@@ -13,6 +13,8 @@
 #include <efimon/logger/macros.hpp>
 #include <efimon/perf/annotate.hpp>
 #include <efimon/perf/record.hpp>
+#include <efimon/perf/sample.hpp>
+#include <efimon/perf/topdown.hpp>
 #include <efimon/proc/stat.hpp>
 #include <unordered_map>
 
@@ -30,7 +32,9 @@ EfimonWorker::EfimonWorker()
       thread_{nullptr},
       proc_meter_{nullptr},
       perf_record_meter_{nullptr},
-      perf_annotate_meter_{nullptr} {}
+      perf_annotate_meter_{nullptr},
+      perf_sample_meter_{nullptr},
+      topdown_meter_{nullptr} {}
 
 EfimonWorker::EfimonWorker(const std::string &name, const uint pid,
                            EfimonAnalyser *analyser)
@@ -42,7 +46,9 @@ EfimonWorker::EfimonWorker(const std::string &name, const uint pid,
       thread_{nullptr},
       proc_meter_{nullptr},
       perf_record_meter_{nullptr},
-      perf_annotate_meter_{nullptr} {}
+      perf_annotate_meter_{nullptr},
+      perf_sample_meter_{nullptr},
+      topdown_meter_{nullptr} {}
 
 EfimonWorker::EfimonWorker(EfimonWorker &&worker)
     : name_{std::move(worker.name_)},
@@ -53,7 +59,9 @@ EfimonWorker::EfimonWorker(EfimonWorker &&worker)
       thread_{nullptr},
       proc_meter_{std::move(worker.proc_meter_)},
       perf_record_meter_{std::move(worker.perf_record_meter_)},
-      perf_annotate_meter_{std::move(worker.perf_annotate_meter_)} {
+      perf_annotate_meter_{std::move(worker.perf_annotate_meter_)},
+      perf_sample_meter_{std::move(worker.perf_sample_meter_)},
+      topdown_meter_{std::move(worker.topdown_meter_)} {
   this->running_.store(worker.running_.load());
   this->thread_.swap(worker.thread_);
 }
@@ -76,15 +84,42 @@ Status EfimonWorker::Start(const uint delay, const uint samples,
   this->proc_meter_ = CreateIfEnabled<ProcStatObserver, true>(
       this->pid_, efimon::ObserverScope::PROCESS, delay);
   if (enable_perf) {
+#ifdef ENABLE_PERF_EVENTS
+    /* All the workers share the system-wide sampling stream */
+    try {
+      auto perf_sample_meter_iface = std::make_shared<PerfSampleObserver>(
+          this->pid_, efimon::ObserverScope::PROCESS, delay, freq, true);
+      Status st = perf_sample_meter_iface->EnableClassification(true);
+      if (Status::OK == st.code) {
+        this->perf_sample_meter_ = perf_sample_meter_iface;
+      }
+    } catch (const Status &st) {
+      EFM_WARN("Cannot join the shared sampling session: " +
+               std::string(st.what()));
+    }
+#endif
 #ifdef ENABLE_PERF
-    auto perf_record_meter_iface = std::make_shared<PerfRecordObserver>(
-        this->pid_, efimon::ObserverScope::PROCESS, delay, freq, true);
-    this->perf_record_meter_ = perf_record_meter_iface;
-    this->perf_annotate_meter_ =
-        std::make_shared<PerfAnnotateObserver>(*perf_record_meter_iface);
-#else
-    this->perf_record_meter_ = nullptr;
-    this->perf_annotate_meter_ = nullptr;
+    /* Fallback: one perf record per process (i.e. not x86-64) */
+    if (!this->perf_sample_meter_) {
+      auto perf_record_meter_iface = std::make_shared<PerfRecordObserver>(
+          this->pid_, efimon::ObserverScope::PROCESS, delay, freq, true);
+      this->perf_record_meter_ = perf_record_meter_iface;
+      this->perf_annotate_meter_ =
+          std::make_shared<PerfAnnotateObserver>(*perf_record_meter_iface);
+    }
+#endif
+#ifdef ENABLE_PERF_EVENTS
+    try {
+      this->topdown_meter_ = std::make_shared<TopDownObserver>(
+          this->pid_, efimon::ObserverScope::PROCESS, delay);
+      /* It still runs: the metrics are logged as -1 */
+      Status st = this->topdown_meter_->GetStatus();
+      if (Status::NOT_IMPLEMENTED == st.code) EFM_WARN(st.msg);
+    } catch (const Status &st) {
+      EFM_WARN("Cannot start the top-down analysis: " +
+               std::string(st.what()));
+      this->topdown_meter_ = nullptr;
+    }
 #endif
   }
 
@@ -111,8 +146,11 @@ Status EfimonWorker::Stop() {
   this->proc_meter_.reset();
   this->perf_record_meter_.reset();
   this->perf_annotate_meter_.reset();
+  this->perf_sample_meter_.reset();
+  this->topdown_meter_.reset();
   this->cpu_usage_ = nullptr;
   this->instructions_samples_ = nullptr;
+  this->topdown_ = nullptr;
 
   return Status{};
 }
@@ -125,6 +163,7 @@ Status EfimonWorker::State() {
 void EfimonWorker::ProcStatsWorker(const uint delay) {
   bool first_sample = true;
   bool enabled_perf = false;
+  bool blocking_perf = false;
   bool enabled_samples = false;
   this->running_.store(true);
 
@@ -133,12 +172,24 @@ void EfimonWorker::ProcStatsWorker(const uint delay) {
       GetReadingsIfEnabled<CPUReadings, true>(this->proc_meter_, 0);
   this->log_table_.clear();
 
-  enabled_perf = this->perf_annotate_meter_ != nullptr;
-  if (enabled_perf) {
+  /* perf record blocks for the whole window: no need to sleep */
+  blocking_perf = this->perf_record_meter_ != nullptr;
+  this->instructions_samples_ = nullptr;
+  if (this->perf_sample_meter_) {
+    this->instructions_samples_ =
+        GetReadingsIfEnabled<InstructionReadings, true>(
+            this->perf_sample_meter_, 1);
+  } else if (this->perf_annotate_meter_) {
     this->instructions_samples_ =
         GetReadingsIfEnabled<InstructionReadings, true>(
             this->perf_annotate_meter_, 0);
   }
+  enabled_perf = this->instructions_samples_ != nullptr;
+  this->topdown_ = nullptr;
+  if (this->topdown_meter_) {
+    this->topdown_ = GetReadingsIfEnabled<TopDownReadings, true>(
+        this->topdown_meter_, 0);
+  }
   enabled_samples = this->samples_ != 0;
   this->mutex_.unlock();
 
@@ -150,6 +201,11 @@ void EfimonWorker::ProcStatsWorker(const uint delay) {
   while (running_.load()) {
     EFM_CHECK(RefreshProcStat(), EFM_WARN_AND_BREAK);
 
+    // Feed the power model with the last instruction mix
+    if (enabled_perf) {
+      EFM_CHECK(SubmitModelSample(), EFM_WARN);
+    }
+
     // Log results
     if (first_sample) {
       first_sample = false;
@@ -158,7 +214,7 @@ void EfimonWorker::ProcStatsWorker(const uint delay) {
     }
 
     // Wait for the next sample. Perf is a blocking call
-    if (!enabled_perf) {
+    if (!blocking_perf) {
       std::this_thread::sleep_for(std::chrono::seconds(delay));
     }
 
@@ -178,9 +234,21 @@ Status EfimonWorker::RefreshProcStat() {
   EFM_CHECK_STATUS(TriggerIfEnabled(this->proc_meter_));
   EFM_CHECK_STATUS(TriggerIfEnabled(this->perf_record_meter_));
   EFM_CHECK_STATUS(TriggerIfEnabled(this->perf_annotate_meter_));
+  EFM_CHECK_STATUS(TriggerIfEnabled(this->perf_sample_meter_));
+  EFM_CHECK_STATUS(TriggerIfEnabled(this->topdown_meter_));
   return Status{};
 }
 
+Status EfimonWorker::SubmitModelSample() {
+  std::scoped_lock slock(this->mutex_);
+  if (!this->cpu_usage_ || !this->instructions_samples_) {
+    return Status{Status::NOT_FOUND, "Cannot find the instruction samples"};
+  }
+  return this->analyser_->SubmitModelSample(
+      this->pid_, this->cpu_usage_->overall_usage,
+      OnlinePowerModel::ClassMix(*this->instructions_samples_));
+}
+
 Status EfimonWorker::CreateLogTable() {
   std::scoped_lock slock(this->mutex_);
   // Timestamping
@@ -217,6 +285,16 @@ Status EfimonWorker::CreateLogTable() {
     this->log_table_.push_back({name, Logger::FieldType::FLOAT});
   }
 #endif
+  // Add the hwmon temperatures
+  ThermalReadings thermal_readings;
+  this->analyser_->GetReadings(EfimonAnalyser::THERMAL_READINGS,
+                               thermal_readings);
+  uint temp_num = thermal_readings.temperatures.size();
+  for (uint i = 0; i < temp_num; ++i) {
+    std::string name = "Temperature";
+    name += std::to_string(i);
+    this->log_table_.push_back({name, Logger::FieldType::FLOAT});
+  }
   // Add the RAPL values
 #ifdef ENABLE_RAPL
   CPUReadings rapl_readings;
@@ -226,11 +304,16 @@ Status EfimonWorker::CreateLogTable() {
     std::string name = "SocketPower";
     name += std::to_string(i);
     this->log_table_.push_back({name, Logger::FieldType::FLOAT});
+    name = "SocketEnergy";
+    name += std::to_string(i);
+    this->log_table_.push_back({name, Logger::FieldType::FLOAT});
   }
+  this->log_table_.push_back({"ProcessPower", Logger::FieldType::FLOAT});
+  this->log_table_.push_back({"ProcessEnergy", Logger::FieldType::FLOAT});
 #endif
 
-#ifdef ENABLE_PERF
-  if (this->perf_record_meter_ && this->perf_annotate_meter_) {
+#if defined(ENABLE_PERF) || defined(ENABLE_PERF_EVENTS)
+  if (this->instructions_samples_) {
     for (uint itype = 0;
          itype <= static_cast<uint>(assembly::InstructionType::UNCLASSIFIED);
          ++itype) {
@@ -263,6 +346,41 @@ Status EfimonWorker::CreateLogTable() {
         }
       }
     }
+    // SIMD taxonomy: register width, element type and packing
+    for (uint iwidth = static_cast<uint>(assembly::VectorWidth::MMX);
+         iwidth <= static_cast<uint>(assembly::VectorWidth::SCALABLE);
+         ++iwidth) {
+      std::string name = "ProbabilityWidth";
+      name += AsmClassifier::WidthString(
+          static_cast<assembly::VectorWidth>(iwidth));
+      this->log_table_.push_back({name, Logger::FieldType::FLOAT});
+    }
+    for (uint ielem = 0;
+         ielem <= static_cast<uint>(assembly::ElementType::FP64); ++ielem) {
+      std::string name = "ProbabilityElement";
+      name += AsmClassifier::ElementString(
+          static_cast<assembly::ElementType>(ielem));
+      this->log_table_.push_back({name, Logger::FieldType::FLOAT});
+    }
+    for (uint ipack = static_cast<uint>(assembly::VectorPacking::SCALAR);
+         ipack <= static_cast<uint>(assembly::VectorPacking::PACKED); ++ipack) {
+      std::string name = "ProbabilityPacking";
+      name += AsmClassifier::PackingString(
+          static_cast<assembly::VectorPacking>(ipack));
+      this->log_table_.push_back({name, Logger::FieldType::FLOAT});
+    }
+    this->log_table_.push_back(
+        {"EstimatedProcessPower", Logger::FieldType::FLOAT});
+  }
+#endif
+
+#ifdef ENABLE_PERF_EVENTS
+  if (this->topdown_meter_) {
+    for (const char *name :
+         {"TopDownRetiring", "TopDownBadSpeculation", "TopDownFrontendBound",
+          "TopDownBackendBound", "TopDownMemoryBound", "TopDownCoreBound"}) {
+      this->log_table_.push_back({name, Logger::FieldType::FLOAT});
+    }
   }
 #endif
 
@@ -316,6 +434,17 @@ Status EfimonWorker::LogReadings(CSVLogger &logger) {  // NOLINT
   }
 #endif
 
+  /* No sensors: no columns */
+  ThermalReadings thermal_readings{};
+  this->analyser_->GetReadings(EfimonAnalyser::THERMAL_READINGS,
+                               thermal_readings);
+  uint temp_num = thermal_readings.temperatures.size();
+  for (uint i = 0; i < temp_num; ++i) {
+    std::string name = "Temperature";
+    name += std::to_string(i);
+    LOG_VAL(values, name, thermal_readings.temperatures.at(i));
+  }
+
 #ifdef ENABLE_RAPL
   CPUReadings rapl_readings{};
   EFM_CHECK(this->analyser_->GetReadings(2, rapl_readings), EFM_WARN);
@@ -324,11 +453,24 @@ Status EfimonWorker::LogReadings(CSVLogger &logger) {  // NOLINT
     std::string name = "SocketPower";
     name += std::to_string(i);
     LOG_VAL(values, name, rapl_readings.socket_power.at(i));
+    name = "SocketEnergy";
+    name += std::to_string(i);
+    LOG_VAL(values, name, rapl_readings.socket_energy.at(i));
   }
+
+  // Power attributed from the RAPL counters: -1 if not available
+  CPUReadings process_readings{};
+  Status power_st =
+      this->analyser_->GetProcessPower(this->pid_, process_readings);
+  const bool attributed = Status::OK == power_st.code;
+  LOG_VAL(values, "ProcessPower",
+          attributed ? process_readings.overall_power : -1.f);
+  LOG_VAL(values, "ProcessEnergy",
+          attributed ? process_readings.overall_energy : -1.);
 #endif
 
-#ifdef ENABLE_PERF
-  if (this->perf_record_meter_ && this->perf_annotate_meter_) {
+#if defined(ENABLE_PERF) || defined(ENABLE_PERF_EVENTS)
+  if (this->instructions_samples_) {
     for (uint itype = 0;
          itype <= static_cast<uint>(assembly::InstructionType::UNCLASSIFIED);
          ++itype) {
@@ -388,6 +530,61 @@ Status EfimonWorker::LogReadings(CSVLogger &logger) {  // NOLINT
         }
       }
     }
+
+    // SIMD taxonomy: 0 if there are no instructions of the kind
+    for (uint iwidth = static_cast<uint>(assembly::VectorWidth::MMX);
+         iwidth <= static_cast<uint>(assembly::VectorWidth::SCALABLE);
+         ++iwidth) {
+      auto width = static_cast<assembly::VectorWidth>(iwidth);
+      auto wit = instructions_samples_->vector_width.find(width);
+      float prob =
+          instructions_samples_->vector_width.end() == wit ? 0.f : wit->second;
+      std::string name = "ProbabilityWidth";
+      name += AsmClassifier::WidthString(width);
+      LOG_VAL(values, name, prob);
+    }
+    for (uint ielem = 0;
+         ielem <= static_cast<uint>(assembly::ElementType::FP64); ++ielem) {
+      auto element = static_cast<assembly::ElementType>(ielem);
+      auto eit = instructions_samples_->element_type.find(element);
+      float prob =
+          instructions_samples_->element_type.end() == eit ? 0.f : eit->second;
+      std::string name = "ProbabilityElement";
+      name += AsmClassifier::ElementString(element);
+      LOG_VAL(values, name, prob);
+    }
+    for (uint ipack = static_cast<uint>(assembly::VectorPacking::SCALAR);
+         ipack <= static_cast<uint>(assembly::VectorPacking::PACKED); ++ipack) {
+      auto packing = static_cast<assembly::VectorPacking>(ipack);
+      auto pit = instructions_samples_->vector_packing.find(packing);
+      float prob = instructions_samples_->vector_packing.end() == pit
+                       ? 0.f
+                       : pit->second;
+      std::string name = "ProbabilityPacking";
+      name += AsmClassifier::PackingString(packing);
+      LOG_VAL(values, name, prob);
+    }
+
+    // Power model estimation: -1 if the model is not ready yet
+    double estimated_power = 0.;
+    Status model_st =
+        this->analyser_->EstimateProcessPower(this->pid_, estimated_power);
+    float model_power = Status::OK == model_st.code
+                            ? static_cast<float>(estimated_power)
+                            : -1.f;
+    LOG_VAL(values, "EstimatedProcessPower", model_power);
+  }
+#endif
+
+#ifdef ENABLE_PERF_EVENTS
+  // Top-down metrics: -1 if the PMU cannot provide them
+  if (this->topdown_meter_ && this->topdown_) {
+    LOG_VAL(values, "TopDownRetiring", this->topdown_->retiring);
+    LOG_VAL(values, "TopDownBadSpeculation", this->topdown_->bad_speculation);
+    LOG_VAL(values, "TopDownFrontendBound", this->topdown_->frontend_bound);
+    LOG_VAL(values, "TopDownBackendBound", this->topdown_->backend_bound);
+    LOG_VAL(values, "TopDownMemoryBound", this->topdown_->memory_bound);
+    LOG_VAL(values, "TopDownCoreBound", this->topdown_->core_bound);
   }
 #endif
   return logger.InsertRow(values);
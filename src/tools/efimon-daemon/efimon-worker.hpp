@@ -17,6 +17,7 @@
 #include <efimon/observer.hpp>
 #include <efimon/readings/cpu-readings.hpp>
 #include <efimon/readings/instruction-readings.hpp>
+#include <efimon/readings/topdown-readings.hpp>
 #include <efimon/status.hpp>
 #include <memory>
 #include <mutex>  // NOLINT
@@ -140,6 +141,10 @@ class EfimonWorker {
   std::shared_ptr<Observer> perf_record_meter_;
   /** Observer for perf annotate */
   std::shared_ptr<Observer> perf_annotate_meter_;
+  /** Observer of the shared sampling session (replaces record/annotate) */
+  std::shared_ptr<Observer> perf_sample_meter_;
+  /** Observer for the top-down breakdown */
+  std::shared_ptr<Observer> topdown_meter_;
 
   /** Mutex for thread-safety */
   std::mutex mutex_;
@@ -149,10 +154,14 @@ class EfimonWorker {
   CPUReadings *cpu_usage_;
   /** Instructions readings instance for perf */
   InstructionReadings *instructions_samples_;
+  /** Top-down readings instance for the PMU */
+  TopDownReadings *topdown_;
 
   // Refresh functions
   /** Refresh the procstat measurements */
   Status RefreshProcStat();
+  /** Submit the last instruction mix to the power model of the analyser */
+  Status SubmitModelSample();
 
   // Auxiliary logging functions
   /** Log table with all fields required by a log line */
@@ -0,0 +1,89 @@
+/**
+ * @file efimon-index.cpp
+ * @author Luis G. Leon-Vega (luis.leon@ieee.org)
+ * @brief Tool for building the classification indices of ELF binaries, so
+ * the sampled instructions are classified without disassembling them
+ *
+ * @copyright Copyright (c) 2024. See License for Licensing
+ */
+
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <efimon/arg-parser.hpp>
+#include <efimon/asm-classifier/elf-index.hpp>
+#include <efimon/logger/macros.hpp>
+#include <efimon/status.hpp>
+
+#ifndef EFIMON_INDEX_DIRECTORY
+#define EFIMON_INDEX_DIRECTORY "/var/cache/efimon"
+#endif /* EFIMON_INDEX_DIRECTORY */
+
+std::string get_help(char **argv) {
+  std::string msg =
+      "This application pre-classifies the instructions of ELF binaries: "
+      "EfiMon Index\n\tUsage: "
+      "\n\t";
+  msg += std::string(argv[0]);
+  msg +=
+      " -o,--output DIR (default: " EFIMON_INDEX_DIRECTORY
+      "). Directory of the indices\n\t\t";
+  msg +=
+      " -b,--binaries BINARY... Binaries to index. This option must be at "
+      "the end of the command\n\t\t";
+  msg += " -h,--help: prints this message\n\n";
+  msg +=
+      " \tEach index is named after the build-id of its binary: "
+      "BUILD_ID.efidx\n";
+  return msg;
+}
+
+int main(int argc, char **argv) {
+  auto argparser = efimon::ArgParser{argc, argv};
+
+  bool check_help = argparser.Exists("-h") || argparser.Exists("--help");
+  bool check_output = argparser.Exists("-o") || argparser.Exists("--output");
+  bool check_binaries =
+      argparser.Exists("-b") || argparser.Exists("--binaries");
+
+  if (check_help || !check_binaries) {
+    std::string msg = get_help(argv);
+    EFM_ERROR(msg);
+  }
+
+  std::string directory = EFIMON_INDEX_DIRECTORY;
+  if (check_output) {
+    directory = argparser.Exists("-o") ? argparser.GetOption("-o")
+                                       : argparser.GetOption("--output");
+  }
+  std::error_code ec;
+  std::filesystem::create_directories(directory, ec);
+  if (ec) {
+    EFM_ERROR("Cannot create the directory " + directory + ": " +
+              ec.message());
+  }
+
+  auto bit = argparser.GetBegin(argparser.Exists("-b") ? "-b" : "--binaries");
+  auto eit = argparser.GetEnd();
+  std::vector<std::string> binaries(bit, eit);
+
+  int failed = 0;
+  for (const auto &binary : binaries) {
+    std::string path;
+    uint64_t entries = 0;
+    efimon::Status st =
+        efimon::ElfIndex::Build(binary, directory, path, entries);
+    if (efimon::Status::OK != st.code) {
+      EFM_WARN(binary << ": " << st.msg);
+      ++failed;
+      continue;
+    }
+    EFM_INFO(binary << ": " << entries << " instructions indexed in "
+                    << path);
+  }
+
+  return 0 == failed ? 0 : -1;
+}
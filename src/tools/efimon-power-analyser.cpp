@@ -30,13 +30,17 @@
 #include <efimon/logger/csv.hpp>
 #include <efimon/logger/macros.hpp>
 #include <efimon/perf/annotate.hpp>
+#include <efimon/perf/callgraph.hpp>
+#include <efimon/perf/energy-profile.hpp>
 #include <efimon/perf/record.hpp>
+#include <efimon/perf/topdown.hpp>
 #include <efimon/power/ipmi.hpp>
 #include <efimon/power/rapl.hpp>
 #include <efimon/proc/cpuinfo.hpp>
 #include <efimon/proc/stat.hpp>
 #include <efimon/process-manager.hpp>
 #include <iostream>
+#include <memory>
 #include <mutex>  // NOLINT
 #include <string>
 #include <third-party/pstream.hpp>
@@ -49,6 +53,7 @@ static constexpr uint kDefFrequency = 100;      // 100 Hz
 static constexpr int kThreadCheckTime = 10;     // 10 millis
 static constexpr uint kDefaultTimelimit = 100;  // 100 samples
 static constexpr char kDefaultOutputFilename[] = "measurements.csv";
+static constexpr uint kTopFunctions = 10;     // Top-10 functions
 
 void launch_command(ProcessManager &proc,                        // NOLINT
                     const std::vector<std::string> &args,        // NOLINT
@@ -104,6 +109,7 @@ int main(int argc, char **argv) {
   uint timelimit = kDefaultTimelimit;
   uint pid = 0;
   std::string log_filename = kDefaultOutputFilename;
+  std::string profile_filename = "";
   std::vector<Logger::MapTuple> log_table;
 
   // Process management
@@ -138,6 +144,7 @@ int main(int argc, char **argv) {
     msg += " -s,--samples SAMPLES (default: 100)\n\t\t";
     msg += " -o,--output FILENAME (default: measurements.csv)\n\t\t";
     msg += " -f,--frequency FREQUENCY_HZ (default: 100 Hz)\n\t\t";
+    msg += " -g,--energy-profile FILENAME (folded stacks in uJ)\n\t\t";
     msg += " -c [COMMAND]\n\t\t";
     msg += " -p and -c are mutually exclusive. -c goes to the end always!";
     EFM_ERROR(msg);
@@ -217,10 +224,21 @@ int main(int argc, char **argv) {
                                           : argparser.GetOption("--output");
   }
 
+  // Extract the energy profile filename
+  if (argparser.Exists("-g") || argparser.Exists("--energy-profile")) {
+    profile_filename = argparser.Exists("-g")
+                           ? argparser.GetOption("-g")
+                           : argparser.GetOption("--energy-profile");
+  }
+  bool check_profile = !profile_filename.empty();
+
   EFM_INFO(std::string("Analysing PID ") + std::to_string(pid));
   EFM_INFO(std::string("Frequency: ") + std::to_string(frequency));
   EFM_INFO(std::string("Samples: ") + std::to_string(timelimit));
   EFM_INFO(std::string("Output file: ") + log_filename);
+  if (check_profile) {
+    EFM_INFO(std::string("Energy profile file: ") + profile_filename);
+  }
 
   // ------------ Configure all tools ------------
 #ifdef ENABLE_IPMI
@@ -253,6 +271,28 @@ int main(int argc, char **argv) {
   PerfRecordObserver perf_record{pid, ObserverScope::PROCESS, kDelay, frequency,
                                  true};
   PerfAnnotateObserver perf_annotate{perf_record};
+  PerfCallgraphObserver perf_callgraph{perf_record};
+  EnergyProfile energy_profile{};
+#ifndef ENABLE_RAPL
+  if (check_profile) {
+    EFM_WARN("RAPL not found. The energy profile will be empty");
+  }
+#endif
+#else
+  if (check_profile) {
+    EFM_WARN("PERF not found. The energy profile will not be generated");
+  }
+#endif
+#ifdef ENABLE_PERF_EVENTS
+  std::unique_ptr<TopDownObserver> topdown;
+  try {
+    topdown = std::make_unique<TopDownObserver>(pid, ObserverScope::PROCESS,
+                                                kDelay);
+    Status st = topdown->GetStatus();
+    if (Status::NOT_IMPLEMENTED == st.code) EFM_WARN(st.msg);
+  } catch (const Status &st) {
+    EFM_WARN("Cannot start the top-down analysis: " + std::string(st.what()));
+  }
 #endif
   ProcStatObserver proc_stat{pid, efimon::ObserverScope::PROCESS, 1};
   ProcStatObserver sys_stat{0, efimon::ObserverScope::SYSTEM, 1};
@@ -306,6 +346,38 @@ int main(int argc, char **argv) {
       }
     }
   }
+  // SIMD taxonomy: register width, element type and packing
+  for (uint iwidth = static_cast<uint>(assembly::VectorWidth::MMX);
+       iwidth <= static_cast<uint>(assembly::VectorWidth::SCALABLE);
+       ++iwidth) {
+    std::string name = "ProbabilityWidth";
+    name += AsmClassifier::WidthString(
+        static_cast<assembly::VectorWidth>(iwidth));
+    log_table.push_back({name, Logger::FieldType::FLOAT});
+  }
+  for (uint ielem = 0;
+       ielem <= static_cast<uint>(assembly::ElementType::FP64); ++ielem) {
+    std::string name = "ProbabilityElement";
+    name += AsmClassifier::ElementString(
+        static_cast<assembly::ElementType>(ielem));
+    log_table.push_back({name, Logger::FieldType::FLOAT});
+  }
+  for (uint ipack = static_cast<uint>(assembly::VectorPacking::SCALAR);
+       ipack <= static_cast<uint>(assembly::VectorPacking::PACKED); ++ipack) {
+    std::string name = "ProbabilityPacking";
+    name += AsmClassifier::PackingString(
+        static_cast<assembly::VectorPacking>(ipack));
+    log_table.push_back({name, Logger::FieldType::FLOAT});
+  }
+#endif
+#ifdef ENABLE_PERF_EVENTS
+  if (topdown) {
+    for (const char *name :
+         {"TopDownRetiring", "TopDownBadSpeculation", "TopDownFrontendBound",
+          "TopDownBackendBound", "TopDownMemoryBound", "TopDownCoreBound"}) {
+      log_table.push_back({name, Logger::FieldType::FLOAT});
+    }
+  }
 #endif
 #ifdef ENABLE_IPMI
   for (uint i = 0; i < psu_num; ++i) {
@@ -353,9 +425,17 @@ int main(int argc, char **argv) {
         dynamic_cast<RecordReadings *>(perf_record.GetReadings()[0]);
     auto readings_ann =
         dynamic_cast<InstructionReadings *>(perf_annotate.GetReadings()[0]);
+    if (check_profile) {
+      EFM_CHECK(perf_callgraph.Trigger(), EFM_WARN_AND_BREAK);
+    }
 #else
     sleep(kDelay);
 #endif
+#ifdef ENABLE_PERF_EVENTS
+    if (topdown) {
+      EFM_CHECK(topdown->Trigger(), EFM_WARN_AND_BREAK);
+    }
+#endif
 #ifdef ENABLE_RAPL
     EFM_CHECK(rapl_meter.Trigger(), EFM_WARN_AND_BREAK);
 #endif
@@ -378,6 +458,21 @@ int main(int argc, char **argv) {
     }
     LOG_VAL(values, "Timestamp", timestamp);
 
+#if defined(ENABLE_PERF) && defined(ENABLE_RAPL)
+    // Energy attribution: socket energy scaled by the process CPU share
+    if (check_profile) {
+      auto readings_cg =
+          dynamic_cast<CallgraphReadings *>(perf_callgraph.GetReadings()[0]);
+      double socket_power = 0.;
+      for (uint i = 0; i < socket_num; ++i) {
+        socket_power += rapl_readings->socket_power.at(i);
+      }
+      double share = proc_cpu_usage->overall_usage / 100.;
+      double energy = socket_power * share * rapl_readings->difference / 1000.;
+      EFM_CHECK(energy_profile.Attribute(*readings_cg, energy), EFM_WARN);
+    }
+#endif
+
 #ifdef ENABLE_RAPL
     for (uint i = 0; i < socket_num; ++i) {
       std::string name = "SocketPower";
@@ -446,6 +541,49 @@ int main(int argc, char **argv) {
         }
       }
     }
+    // SIMD taxonomy: 0 if there are no instructions of the kind
+    for (uint iwidth = static_cast<uint>(assembly::VectorWidth::MMX);
+         iwidth <= static_cast<uint>(assembly::VectorWidth::SCALABLE);
+         ++iwidth) {
+      auto width = static_cast<assembly::VectorWidth>(iwidth);
+      auto wit = readings_ann->vector_width.find(width);
+      float prob = readings_ann->vector_width.end() == wit ? 0.f : wit->second;
+      std::string name = "ProbabilityWidth";
+      name += AsmClassifier::WidthString(width);
+      LOG_VAL(values, name, prob);
+    }
+    for (uint ielem = 0;
+         ielem <= static_cast<uint>(assembly::ElementType::FP64); ++ielem) {
+      auto element = static_cast<assembly::ElementType>(ielem);
+      auto eit = readings_ann->element_type.find(element);
+      float prob = readings_ann->element_type.end() == eit ? 0.f : eit->second;
+      std::string name = "ProbabilityElement";
+      name += AsmClassifier::ElementString(element);
+      LOG_VAL(values, name, prob);
+    }
+    for (uint ipack = static_cast<uint>(assembly::VectorPacking::SCALAR);
+         ipack <= static_cast<uint>(assembly::VectorPacking::PACKED); ++ipack) {
+      auto packing = static_cast<assembly::VectorPacking>(ipack);
+      auto pit = readings_ann->vector_packing.find(packing);
+      float prob =
+          readings_ann->vector_packing.end() == pit ? 0.f : pit->second;
+      std::string name = "ProbabilityPacking";
+      name += AsmClassifier::PackingString(packing);
+      LOG_VAL(values, name, prob);
+    }
+#endif
+#ifdef ENABLE_PERF_EVENTS
+    // Top-down metrics: -1 if the PMU cannot provide them
+    if (topdown) {
+      auto readings_td =
+          dynamic_cast<TopDownReadings *>(topdown->GetReadings()[0]);
+      LOG_VAL(values, "TopDownRetiring", readings_td->retiring);
+      LOG_VAL(values, "TopDownBadSpeculation", readings_td->bad_speculation);
+      LOG_VAL(values, "TopDownFrontendBound", readings_td->frontend_bound);
+      LOG_VAL(values, "TopDownBackendBound", readings_td->backend_bound);
+      LOG_VAL(values, "TopDownMemoryBound", readings_td->memory_bound);
+      LOG_VAL(values, "TopDownCoreBound", readings_td->core_bound);
+    }
 #endif
 
     // PSU columns
@@ -483,6 +621,17 @@ int main(int argc, char **argv) {
     manager_thread.join();
   }
 
+#ifdef ENABLE_PERF
+  if (check_profile) {
+    EFM_CHECK(energy_profile.WriteFolded(profile_filename), EFM_WARN);
+    EFM_INFO("Energy attributed (J): " +
+             std::to_string(energy_profile.GetTotalEnergy()));
+    for (const auto &entry : energy_profile.TopFunctions(kTopFunctions)) {
+      EFM_INFO("\t" + std::to_string(entry.weight) + " J: " + entry.key);
+    }
+  }
+#endif
+
   EFM_INFO("Finished...");
 
   return 0;
@@ -22,6 +22,8 @@ static constexpr uint kDefaultSampleLimit = 100;  // 100 samples
 static constexpr char kDefaultOutputPath[] = "/tmp";
 /** Default IPC port */
 static constexpr uint kPort = 5550;
+/** Default period of the RAPL sampler */
+static constexpr uint kDefRAPLSampler = 0;  // 0 ms: disabled
 /** Number of log instance */
 [[maybe_unused]] static uint logcounter = 0;
 